@@ -0,0 +1,368 @@
+/*
+ * @file benchmark_exchange.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "mpi.h"
+#include "src/distdir.h"
+#include "benchmarks/benchmark_utils.h"
+
+#define NMODES 8
+#define NTYPES 3
+#define NCOLUMNS 14
+
+#define NPATTERNS 3
+
+enum benchmark_pattern {
+	pattern_oneway   = 0,
+	pattern_shift    = 1,
+	pattern_alltoall = 2
+};
+
+static const char *pattern_names[NPATTERNS] = {"oneway", "shift", "alltoall"};
+
+static const char *mode_names[NMODES] = {"IsendIrecv1", "IsendIrecv2", "IsendRecv1", "IsendRecv2",
+                                         "IsendIrecv1NoWait", "IsendIrecv2NoWait",
+                                         "IsendRecv1NoWait", "IsendRecv2NoWait"};
+
+static const char *type_names[NTYPES] = {"float", "double", "int"};
+
+static MPI_Datatype type_mpi(int type) {
+
+	return type == 0 ? MPI_FLOAT : type == 1 ? MPI_DOUBLE : MPI_INT;
+}
+
+/**
+ * @brief Create the map of the benchmark
+ * 
+ * @details With the oneway pattern the first half of the processes sends npoints
+ *          to the second half, so that the exchange is in one direction as required
+ *          by the NoWait exchangers. With the other patterns each process owns npoints
+ *          consecutive global indices: with the shift pattern the destination of the
+ *          points of each process is the next process, so that each process sends one
+ *          message, with the alltoall pattern the destination is a cyclic decomposition,
+ *          so that each process sends a message to all the processes.
+ * 
+ * @ingroup benchmarks
+ */
+static t_map *new_benchmark_map(int pattern, int npoints, int rank, int size) {
+
+	int *src = (int *)malloc(npoints * sizeof(int));
+	int *dst = (int *)malloc(npoints * sizeof(int));
+	int src_count = npoints;
+	int dst_count = npoints;
+
+	for (int i = 0; i < npoints; i++)
+		src[i] = i + rank * npoints;
+
+	if (pattern == pattern_oneway && size > 1) {
+		int half = size / 2;
+		src_count = rank < half ? npoints : 0;
+		dst_count = rank >= half && rank < 2 * half ? npoints : 0;
+		for (int i = 0; i < npoints; i++)
+			dst[i] = i + (rank - half) * npoints;
+	} else if (pattern == pattern_shift) {
+		int prev = (rank + size - 1) % size;
+		for (int i = 0; i < npoints; i++)
+			dst[i] = i + prev * npoints;
+	} else if (pattern == pattern_alltoall) {
+		for (int i = 0; i < npoints; i++)
+			dst[i] = rank + i * size;
+	} else {
+		for (int i = 0; i < npoints; i++)
+			dst[i] = src[i];
+	}
+
+	t_idxlist *src_idxlist = src_count > 0 ? new_idxlist(src, src_count) : new_idxlist_empty();
+	t_idxlist *dst_idxlist = dst_count > 0 ? new_idxlist(dst, dst_count) : new_idxlist_empty();
+	t_map *map = new_map(src_idxlist, dst_idxlist, -1, MPI_COMM_WORLD);
+
+	delete_idxlist(src_idxlist);
+	delete_idxlist(dst_idxlist);
+	free(src);
+	free(dst);
+
+	return map;
+}
+
+/**
+ * @brief Time the exchanges of an exchanger
+ * 
+ * @details After nwarmup exchanges, each of the nreps exchanges starts after a barrier
+ *          and its time is the max among the processes. The times are returned on the
+ *          process 0.
+ * 
+ * @ingroup benchmarks
+ */
+static void time_exchange(t_exchanger *exchanger, void *src_data, void *dst_data,
+                          int *transform_src, int *transform_dst, int nwarmup, int nreps,
+                          double *times) {
+
+	double *local_times = (double *)malloc(nreps * sizeof(double));
+
+	for (int rep = -nwarmup; rep < nreps; rep++) {
+
+		MPI_Barrier(MPI_COMM_WORLD);
+		double start = MPI_Wtime();
+
+		if (transform_src == NULL)
+			exchanger_go(exchanger, src_data, dst_data);
+		else
+			exchanger_go_with_transform(exchanger, src_data, dst_data, transform_src, transform_dst);
+
+		if (rep >= 0) local_times[rep] = MPI_Wtime() - start;
+	}
+
+	MPI_Reduce(local_times, times, nreps, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+	free(local_times);
+}
+
+/**
+ * @brief Benchmark of the exchangers for a message size
+ * 
+ * @details All the exchanger types are timed for \c exchanger_go and
+ *          \c exchanger_go_with_transform (reversed memory layout). The NoWait exchangers
+ *          are used only with the oneway pattern. The min, median and 99th percentile of
+ *          the time of an exchange are written with the effective bandwidth in GB/s
+ *          (bytes sent by all the processes to other processes divided by the median time).
+ * 
+ * @ingroup benchmarks
+ */
+static void benchmark_exchange(t_benchmark_output *output, t_map *map, long long volume,
+                               int pattern, int type, int npoints, int block_size, int modes,
+                               int nwarmup, int nreps) {
+
+	int rank, size;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+	MPI_Datatype mpi_type = type_mpi(type);
+	int type_size;
+	MPI_Type_size(mpi_type, &type_size);
+
+	size_t data_size = (size_t)npoints * block_size * type_size;
+	void *src_data = malloc(data_size);
+	void *dst_data = malloc(data_size);
+	memset(src_data, 1, data_size);
+	memset(dst_data, 0, data_size);
+
+	int *transform = (int *)malloc(npoints * sizeof(int));
+	for (int i = 0; i < npoints; i++)
+		transform[i] = npoints - 1 - i;
+
+	// bytes sent to other processes
+	double bytes_sent = (double)volume * block_size * type_size;
+	double *times = (double *)malloc(nreps * sizeof(double));
+
+	for (int mode = 0; mode < NMODES; mode++) {
+
+		if (!(modes & (1 << mode))) continue;
+		if (mode >= IsendIrecv1NoWait && pattern != pattern_oneway) continue;
+
+		set_config_exchanger(mode);
+		t_exchanger *exchanger = new_exchanger_with_block_size(map, mpi_type, block_size, CPU);
+
+		for (int operation = 0; operation < 2; operation++) {
+
+			time_exchange(exchanger, src_data, dst_data, operation ? transform : NULL,
+			              operation ? transform : NULL, nwarmup, nreps, times);
+
+			if (rank == 0) {
+				double median = benchmark_percentile(times, nreps, 50.0);
+				double p99 = benchmark_percentile(times, nreps, 99.0);
+
+				const char *keys[NCOLUMNS] = {"pattern", "nprocs", "mode", "type", "operation",
+				                              "bytes", "npoints", "block_size", "nwarmup", "nreps",
+				                              "min", "median", "p99", "bandwidth"};
+				char values[NCOLUMNS][64];
+				const char *pvalues[NCOLUMNS];
+				for (int i = 0; i < NCOLUMNS; i++)
+					pvalues[i] = values[i];
+
+				snprintf(values[0], 64, "%s", pattern_names[pattern]);
+				snprintf(values[1], 64, "%d", size);
+				snprintf(values[2], 64, "%s", mode_names[mode]);
+				snprintf(values[3], 64, "%s", type_names[type]);
+				snprintf(values[4], 64, "%s", operation ? "go_with_transform" : "go");
+				snprintf(values[5], 64, "%zu", data_size);
+				snprintf(values[6], 64, "%d", npoints);
+				snprintf(values[7], 64, "%d", block_size);
+				snprintf(values[8], 64, "%d", nwarmup);
+				snprintf(values[9], 64, "%d", nreps);
+				snprintf(values[10], 64, "%.6e", times[0]);
+				snprintf(values[11], 64, "%.6e", median);
+				snprintf(values[12], 64, "%.6e", p99);
+				snprintf(values[13], 64, "%.6e", median > 0.0 ? bytes_sent / median / 1.0e9 : 0.0);
+				benchmark_write(output, NCOLUMNS, keys, pvalues);
+			}
+		}
+
+		delete_exchanger(exchanger);
+	}
+
+	free(times);
+	free(transform);
+	free(src_data);
+	free(dst_data);
+}
+
+static void usage(const char *name) {
+
+	printf("Usage: %s [-c pattern] [-m min_bytes] [-M max_bytes] [-p npoints] [-w nwarmup]\n"
+	       "       [-r nreps] [-e mode] [-t type] [-f csv|json] [-o file]\n", name);
+	printf("  -c  communication pattern: oneway, shift or alltoall (default oneway)\n");
+	printf("  -m  min size of the data of a process in bytes (default 8)\n");
+	printf("  -M  max size of the data of a process in bytes (default 67108864)\n");
+	printf("  -p  max number of points of a process (at least 3), the larger sizes use blocks\n"
+	       "      (default 1024)\n");
+	printf("  -w  number of warm-up exchanges (default 5)\n");
+	printf("  -r  number of timed exchanges (default 50)\n");
+	printf("  -e  exchanger type (default all):");
+	for (int i = 0; i < NMODES; i++)
+		printf(" %s", mode_names[i]);
+	printf("\n  -t  data type (default all): float double int\n");
+	printf("  -f  format of the results (default csv)\n");
+	printf("  -o  file where the results are appended (default stdout)\n");
+}
+
+int main(int argc, char **argv) {
+
+	distdir_initialize();
+
+	int rank, size;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+	int pattern = pattern_oneway;
+	long long min_bytes = 8;
+	long long max_bytes = 67108864;
+	int max_points = 1024;
+	int nwarmup = 5;
+	int nreps = 50;
+	int modes = (1 << NMODES) - 1;
+	int types = (1 << NTYPES) - 1;
+	int format = benchmark_csv;
+	const char *path = NULL;
+	int error = 0;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "c:m:M:p:w:r:e:t:f:o:h")) != -1) {
+		switch (opt) {
+		case 'c':
+			pattern = -1;
+			for (int i = 0; i < NPATTERNS; i++)
+				if (strcmp(optarg, pattern_names[i]) == 0) pattern = i;
+			error |= pattern == -1;
+			break;
+		case 'm': min_bytes = atoll(optarg); break;
+		case 'M': max_bytes = atoll(optarg); break;
+		case 'p': max_points = atoi(optarg); break;
+		case 'w': nwarmup = atoi(optarg); break;
+		case 'r': nreps = atoi(optarg); break;
+		case 'e':
+			modes = 0;
+			for (int i = 0; i < NMODES; i++)
+				if (strcmp(optarg, mode_names[i]) == 0) modes = 1 << i;
+			error |= modes == 0;
+			break;
+		case 't':
+			types = 0;
+			for (int i = 0; i < NTYPES; i++)
+				if (strcmp(optarg, type_names[i]) == 0) types = 1 << i;
+			error |= types == 0;
+			break;
+		case 'f': format = strcmp(optarg, "json") == 0 ? benchmark_json : benchmark_csv; break;
+		case 'o': path = optarg; break;
+		default: error = opt == 'h' ? -1 : 1; break;
+		}
+	}
+
+	if (error != 0 || min_bytes < 1 || max_bytes < min_bytes || max_points < 3 ||
+	    nwarmup < 0 || nreps < 1) {
+		if (rank == 0) usage(argv[0]);
+		distdir_finalize();
+		return error == -1 ? 0 : 1;
+	}
+
+	t_benchmark_output output;
+	if (rank == 0)
+		benchmark_open(&output, path, format);
+
+	for (int type = 0; type < NTYPES; type++) {
+
+		if (!(types & (1 << type))) continue;
+
+		int type_size;
+		MPI_Type_size(type_mpi(type), &type_size);
+
+		int half = size / 2;
+		int min_points = pattern == pattern_oneway && size > 1 ? (size + half - 1) / half : 1;
+
+		// the size grows by a factor of 4: the number of points first, then the block size
+		t_map *map = NULL;
+		int map_points = 0;
+		long long volume = 0;
+		for (long long bytes = min_bytes; bytes <= max_bytes; bytes *= 4) {
+
+			// the map needs at least one global index per process
+			long long values = bytes / type_size > min_points ? bytes / type_size : min_points;
+			int npoints = values < max_points ? (int)values : max_points;
+			int block_size = (int)(values / npoints);
+
+			if (npoints != map_points) {
+				if (map != NULL) delete_map(map);
+				map = new_benchmark_map(pattern, npoints, rank, size);
+				map_points = npoints;
+				t_map_stats stats;
+				map_stats(map, &stats);
+				// the volume of the map counts the indices both sent and received,
+				// the bytes on the wire are the sum of the sent messages
+				volume = (long long)(stats.global_mean_message * stats.global_messages + 0.5);
+			}
+
+			benchmark_exchange(&output, map, volume, pattern, type, npoints, block_size, modes,
+			                   nwarmup, nreps);
+		}
+		if (map != NULL) delete_map(map);
+	}
+
+	if (rank == 0)
+		benchmark_close(&output);
+
+	distdir_finalize();
+
+	return 0;
+}
@@ -0,0 +1,448 @@
+/*
+ * @file benchmark_kernels.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "mpi.h"
+#include "src/distdir.h"
+#include "src/core/exchange/backend_hardware/backend_cpu.h"
+#include "src/core/algorithm/backend/backend.h"
+#include "src/sort/mergesort.h"
+#include "src/sort/quicksort.h"
+#include "src/sort/timsort.h"
+#include "benchmarks/benchmark_utils.h"
+
+#define NKERNELS 5
+#define NPATTERNS 4
+#define NCOLUMNS 12
+
+/* number of columns of the strided pattern and size of the blocks of the blocked pattern */
+#define STRIDE_COLUMNS 64
+#define BLOCK_SIZE 64
+
+/* each timed repetition packs at least this number of elements, so that
+ * the small sizes (in L1) are not dominated by the resolution of the timer */
+#define MIN_ELEMENTS_PER_REP (1 << 20)
+
+/* quickSort uses the last element as pivot, so it is quadratic for sorted inputs */
+#define QUICKSORT_MAX_SORTED 16384
+
+enum benchmark_kernel {
+	kernel_pack      = 0,
+	kernel_unpack    = 1,
+	kernel_mergesort = 2,
+	kernel_quicksort = 3,
+	kernel_timsort   = 4
+};
+
+enum benchmark_pattern {
+	pattern_contiguous = 0,
+	pattern_strided    = 1,
+	pattern_blocked    = 2,
+	pattern_random     = 3
+};
+
+static const char *kernel_names[NKERNELS] = {"pack", "unpack", "mergeSort", "quickSort", "timSort"};
+
+static const char *pattern_names[NPATTERNS] = {"contiguous", "strided", "blocked", "random"};
+
+static const char *column_keys[NCOLUMNS] = {"kernel", "pattern", "variant", "nprocs", "type_size",
+                                            "bytes", "elements", "nreps", "min", "median",
+                                            "bandwidth", "elements_per_second"};
+
+static unsigned long long next_random(unsigned long long *state) {
+
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+static void shuffle(int *values, int n, unsigned long long *state) {
+
+	for (int i = n - 1; i > 0; i--) {
+		int j = (int)(next_random(state) % (unsigned long long)(i + 1));
+		int tmp = values[i];
+		values[i] = values[j];
+		values[j] = tmp;
+	}
+}
+
+/**
+ * @brief Fill an index list with a permutation of 0..n-1
+ * 
+ * @details The patterns mimic the index lists of the maps:
+ *          - contiguous: indices in order (1D decomposition)
+ *          - strided: column by column walk of a row major 2D array with
+ *            STRIDE_COLUMNS columns (e.g. the levels of a 3D field)
+ *          - blocked: blocks of BLOCK_SIZE consecutive indices in random order
+ *            (e.g. a block cyclic or masked decomposition)
+ *          - random: random permutation
+ *          The same lists are the input of the sorts.
+ * 
+ * @ingroup benchmarks
+ */
+static void fill_pattern(int *idx, int n, int pattern) {
+
+	unsigned long long state = 88172645463325252ULL;
+
+	switch (pattern) {
+		case pattern_contiguous:
+			for (int i = 0; i < n; i++)
+				idx[i] = i;
+			break;
+		case pattern_strided: {
+			int nrows = n / STRIDE_COLUMNS;
+			int nstrided = nrows * STRIDE_COLUMNS;
+			for (int i = 0; i < nstrided; i++)
+				idx[i] = (i % nrows) * STRIDE_COLUMNS + i / nrows;
+			for (int i = nstrided; i < n; i++)
+				idx[i] = i;
+			break;
+		}
+		case pattern_blocked: {
+			int nblocks = (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			int *blocks = (int *)malloc(nblocks * sizeof(int));
+			for (int i = 0; i < nblocks; i++)
+				blocks[i] = i;
+			shuffle(blocks, nblocks, &state);
+			for (int b = 0, i = 0; b < nblocks; b++)
+				for (int j = blocks[b] * BLOCK_SIZE; j < n && j < (blocks[b] + 1) * BLOCK_SIZE; j++)
+					idx[i++] = j;
+			free(blocks);
+			break;
+		}
+		case pattern_random:
+			for (int i = 0; i < n; i++)
+				idx[i] = i;
+			shuffle(idx, n, &state);
+			break;
+	}
+}
+
+/* the same specialization as new_vtable_cpu */
+static void pack_kernels(size_t type_size, kernel_func_pack *pack, kernel_func_pack *unpack) {
+
+	switch (type_size) {
+		case 1:  *pack = pack_cpu_1;  *unpack = unpack_cpu_1;  break;
+		case 2:  *pack = pack_cpu_2;  *unpack = unpack_cpu_2;  break;
+		case 4:  *pack = pack_cpu_4;  *unpack = unpack_cpu_4;  break;
+		case 8:  *pack = pack_cpu_8;  *unpack = unpack_cpu_8;  break;
+		case 12: *pack = pack_cpu_12; *unpack = unpack_cpu_12; break;
+		case 16: *pack = pack_cpu_16; *unpack = unpack_cpu_16; break;
+		case 24: *pack = pack_cpu_24; *unpack = unpack_cpu_24; break;
+		case 32: *pack = pack_cpu_32; *unpack = unpack_cpu_32; break;
+		case 64: *pack = pack_cpu_64; *unpack = unpack_cpu_64; break;
+		default: *pack = pack_cpu_generic; *unpack = unpack_cpu_generic; break;
+	}
+}
+
+/**
+ * @brief Write the results of a kernel
+ * 
+ * @details The min and median time of a call are the max among the processes (the
+ *          slowest core). The bandwidth in GB/s and the elements per second are per core
+ *          and computed with the median time.
+ * 
+ * @ingroup benchmarks
+ */
+static void write_results(t_benchmark_output *output, int kernel, int pattern, const char *variant,
+                          size_t type_size, int n, int nreps, double *times, size_t bytes_per_element) {
+
+	int rank, size;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+	double local[2] = {benchmark_percentile(times, nreps, 0.0),
+	                   benchmark_percentile(times, nreps, 50.0)};
+	double global[2];
+	MPI_Reduce(local, global, 2, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+	if (rank != 0) return;
+
+	double median = global[1];
+	char values[NCOLUMNS][64];
+	const char *pvalues[NCOLUMNS];
+	for (int i = 0; i < NCOLUMNS; i++)
+		pvalues[i] = values[i];
+
+	snprintf(values[0], 64, "%s", kernel_names[kernel]);
+	snprintf(values[1], 64, "%s", pattern_names[pattern]);
+	snprintf(values[2], 64, "%s", variant);
+	snprintf(values[3], 64, "%d", size);
+	snprintf(values[4], 64, "%zu", type_size);
+	snprintf(values[5], 64, "%zu", (size_t)n * type_size);
+	snprintf(values[6], 64, "%d", n);
+	snprintf(values[7], 64, "%d", nreps);
+	snprintf(values[8], 64, "%.6e", global[0]);
+	snprintf(values[9], 64, "%.6e", median);
+	snprintf(values[10], 64, "%.6e", median > 0.0 ? (double)n * bytes_per_element / median / 1.0e9 : 0.0);
+	snprintf(values[11], 64, "%.6e", median > 0.0 ? n / median : 0.0);
+	benchmark_write(output, NCOLUMNS, column_keys, pvalues);
+}
+
+/**
+ * @brief Benchmark of the packing and unpacking kernels
+ * 
+ * @details The whole data array of n elements is packed into (unpacked from) a buffer
+ *          following the index list of the pattern, without and with a transform array
+ *          (reversed memory layout). A call moves two elements and reads the indices
+ *          (and the transform), these are the bytes of the bandwidth.
+ * 
+ * @ingroup benchmarks
+ */
+static void benchmark_pack(t_benchmark_output *output, int kernel, int pattern, size_t type_size,
+                           int n, int nwarmup, int nreps) {
+
+	kernel_func_pack pack, unpack;
+	pack_kernels(type_size, &pack, &unpack);
+	kernel_func_pack func = kernel == kernel_pack ? pack : unpack;
+
+	char *data = (char *)malloc((size_t)n * type_size);
+	char *buffer = (char *)malloc((size_t)n * type_size);
+	int *idx = (int *)malloc(n * sizeof(int));
+	int *transform = (int *)malloc(n * sizeof(int));
+	double *times = (double *)malloc(nreps * sizeof(double));
+
+	memset(data, 1, (size_t)n * type_size);
+	memset(buffer, 2, (size_t)n * type_size);
+	fill_pattern(idx, n, pattern);
+	for (int i = 0; i < n; i++)
+		transform[i] = n - 1 - i;
+
+	int ncalls = n < MIN_ELEMENTS_PER_REP ? MIN_ELEMENTS_PER_REP / n : 1;
+
+	for (int variant = 0; variant < 2; variant++) {
+
+		int *transform_variant = variant ? transform : NULL;
+
+		MPI_Barrier(MPI_COMM_WORLD);
+
+		for (int rep = -nwarmup; rep < nreps; rep++) {
+			double start = MPI_Wtime();
+			for (int call = 0; call < ncalls; call++)
+				func(buffer, data, idx, n, 0, transform_variant, type_size);
+			if (rep >= 0) times[rep] = (MPI_Wtime() - start) / ncalls;
+		}
+
+		write_results(output, kernel, pattern, variant ? "transform" : "plain", type_size, n, nreps,
+		              times, 2 * type_size + (variant ? 2 : 1) * sizeof(int));
+	}
+
+	free(times);
+	free(transform);
+	free(idx);
+	free(buffer);
+	free(data);
+}
+
+/**
+ * @brief Benchmark of the sorts
+ * 
+ * @details The index list of the pattern is sorted alone and with one and two index
+ *          arrays (as in the map construction). The input is restored before each call
+ *          and this copy is not timed. The bandwidth counts the bytes of the sorted arrays.
+ * 
+ * @ingroup benchmarks
+ */
+static void benchmark_sort(t_benchmark_output *output, int kernel, int pattern, int n,
+                           int nwarmup, int nreps) {
+
+	sort_fn sort[3] = {mergeSort, quickSort, timSort};
+	sort_with_idx_fn sort_with_idx[3] = {mergeSort_with_idx, quickSort_with_idx, timSort_with_idx};
+	sort_with_idx2_fn sort_with_idx2[3] = {mergeSort_with_idx2, quickSort_with_idx2, timSort_with_idx2};
+	const char *variant_names[3] = {"plain", "with_idx", "with_idx2"};
+
+	int algorithm = kernel - kernel_mergesort;
+
+	int *input = (int *)malloc(n * sizeof(int));
+	int *keys = (int *)malloc(n * sizeof(int));
+	int *idx1 = (int *)malloc(n * sizeof(int));
+	int *idx2 = (int *)malloc(n * sizeof(int));
+	double *times = (double *)malloc(nreps * sizeof(double));
+
+	fill_pattern(input, n, pattern);
+
+	for (int variant = 0; variant < 3; variant++) {
+
+		MPI_Barrier(MPI_COMM_WORLD);
+
+		for (int rep = -nwarmup; rep < nreps; rep++) {
+			memcpy(keys, input, n * sizeof(int));
+			for (int i = 0; i < n; i++)
+				idx1[i] = idx2[i] = i;
+
+			double start = MPI_Wtime();
+			switch (variant) {
+				case 0: sort[algorithm](keys, 0, n - 1); break;
+				case 1: sort_with_idx[algorithm](keys, idx1, 0, n - 1); break;
+				case 2: sort_with_idx2[algorithm](keys, idx1, idx2, 0, n - 1); break;
+			}
+			if (rep >= 0) times[rep] = MPI_Wtime() - start;
+		}
+
+		write_results(output, kernel, pattern, variant_names[variant], sizeof(int), n, nreps,
+		              times, (1 + variant) * sizeof(int));
+	}
+
+	free(times);
+	free(idx2);
+	free(idx1);
+	free(keys);
+	free(input);
+}
+
+static void usage(const char *name) {
+
+	printf("Usage: %s [-k kernel] [-c pattern] [-s type_size] [-m min_bytes] [-M max_bytes]\n"
+	       "       [-S max_sort_bytes] [-w nwarmup] [-r nreps] [-f csv|json] [-o file]\n", name);
+	printf("  -k  kernel (default all):");
+	for (int i = 0; i < NKERNELS; i++)
+		printf(" %s", kernel_names[i]);
+	printf("\n  -c  index pattern (default all):");
+	for (int i = 0; i < NPATTERNS; i++)
+		printf(" %s", pattern_names[i]);
+	printf("\n  -s  size in bytes of an element for pack and unpack (default 4 and 8)\n");
+	printf("  -m  min size of the data in bytes (default 4096)\n");
+	printf("  -M  max size of the data for pack and unpack in bytes (default 67108864)\n");
+	printf("  -S  max size of the data for the sorts in bytes (default 1048576)\n");
+	printf("  -w  number of warm-up repetitions (default 2)\n");
+	printf("  -r  number of timed repetitions (default 20)\n");
+	printf("  -f  format of the results (default csv)\n");
+	printf("  -o  file where the results are appended (default stdout)\n");
+}
+
+int main(int argc, char **argv) {
+
+	distdir_initialize();
+
+	int rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+	int kernels = (1 << NKERNELS) - 1;
+	int patterns = (1 << NPATTERNS) - 1;
+	size_t type_sizes[2] = {4, 8};
+	int ntype_sizes = 2;
+	long long min_bytes = 4096;
+	long long max_bytes = 67108864;
+	long long max_sort_bytes = 1048576;
+	int nwarmup = 2;
+	int nreps = 20;
+	int format = benchmark_csv;
+	const char *path = NULL;
+	int error = 0;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "k:c:s:m:M:S:w:r:f:o:h")) != -1) {
+		switch (opt) {
+		case 'k':
+			kernels = 0;
+			for (int i = 0; i < NKERNELS; i++)
+				if (strcmp(optarg, kernel_names[i]) == 0) kernels = 1 << i;
+			error |= kernels == 0;
+			break;
+		case 'c':
+			patterns = 0;
+			for (int i = 0; i < NPATTERNS; i++)
+				if (strcmp(optarg, pattern_names[i]) == 0) patterns = 1 << i;
+			error |= patterns == 0;
+			break;
+		case 's':
+			type_sizes[0] = (size_t)atoi(optarg);
+			ntype_sizes = 1;
+			error |= atoi(optarg) < 1;
+			break;
+		case 'm': min_bytes = atoll(optarg); break;
+		case 'M': max_bytes = atoll(optarg); break;
+		case 'S': max_sort_bytes = atoll(optarg); break;
+		case 'w': nwarmup = atoi(optarg); break;
+		case 'r': nreps = atoi(optarg); break;
+		case 'f': format = strcmp(optarg, "json") == 0 ? benchmark_json : benchmark_csv; break;
+		case 'o': path = optarg; break;
+		default: error = opt == 'h' ? -1 : 1; break;
+		}
+	}
+
+	if (error != 0 || min_bytes < 1 || max_bytes < min_bytes || max_sort_bytes < 1 ||
+	    nwarmup < 0 || nreps < 1) {
+		if (rank == 0) usage(argv[0]);
+		distdir_finalize();
+		return error == -1 ? 0 : 1;
+	}
+
+	t_benchmark_output output;
+	if (rank == 0)
+		benchmark_open(&output, path, format);
+
+	for (int kernel = 0; kernel < NKERNELS; kernel++) {
+
+		if (!(kernels & (1 << kernel))) continue;
+
+		int sort = kernel >= kernel_mergesort;
+
+		for (int t = 0; t < (sort ? 1 : ntype_sizes); t++) {
+
+			size_t type_size = sort ? sizeof(int) : type_sizes[t];
+			long long max_size = sort ? max_sort_bytes : max_bytes;
+
+			// the size grows by a factor of 4 (from L1 to DRAM with the default sizes)
+			for (long long bytes = min_bytes; bytes <= max_size; bytes *= 4) {
+
+				int n = bytes / (long long)type_size > 0 ? (int)(bytes / (long long)type_size) : 1;
+
+				for (int pattern = 0; pattern < NPATTERNS; pattern++) {
+
+					if (!(patterns & (1 << pattern))) continue;
+
+					if (sort) {
+						if (kernel == kernel_quicksort && n > QUICKSORT_MAX_SORTED &&
+						    (pattern == pattern_contiguous || pattern == pattern_strided))
+							continue;
+						benchmark_sort(&output, kernel, pattern, n, nwarmup, nreps);
+					} else {
+						benchmark_pack(&output, kernel, pattern, type_size, n, nwarmup, nreps);
+					}
+				}
+			}
+		}
+	}
+
+	if (rank == 0)
+		benchmark_close(&output);
+
+	distdir_finalize();
+
+	return 0;
+}
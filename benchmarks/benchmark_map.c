@@ -0,0 +1,458 @@
+/*
+ * @file benchmark_map.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include "mpi.h"
+#include "src/distdir.h"
+#include "src/utils/timer.h"
+#include "benchmarks/benchmark_utils.h"
+
+#define NPHASES 6
+#define NCOLUMNS 10
+
+enum benchmark_map_case {
+	case_block = 0,
+	case_block_cyclic,
+	case_random,
+	case_transpose,
+	case_stride3d,
+	case_extend3d,
+	case_masked,
+	ncases
+};
+
+static const char *case_names[ncases] = {"block", "block_cyclic", "random", "transpose",
+                                         "stride3d", "extend3d", "masked"};
+
+/* timers of the library reported as phases of the construction of the map */
+static const char *timer_names[NPHASES - 2] = {"new_map", "map_idxlist_to_RD_decomp",
+                                               "map_RD_decomp_to_idxlist", "extend_map_3d"};
+
+struct t_decomposition {
+	int *src;
+	int  src_count;
+	int *dst;
+	int  dst_count;
+	int  stride;
+	int  nlevels;
+};
+typedef struct t_decomposition t_decomposition;
+
+static void block_range(int n, int nblocks, int block, int *start, int *count) {
+
+	*start = (int)((long long)n * block / nblocks);
+	*count = (int)((long long)n * (block + 1) / nblocks) - *start;
+}
+
+/* same pseudo random sequence on all the processes */
+static unsigned long long next_random(unsigned long long *state) {
+
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+/* about 70% of the points are kept (ocean points), the last point is always kept */
+static int masked(int point, int npoints) {
+
+	unsigned long long hash = (unsigned long long)point * 0x9E3779B97F4A7C15ULL;
+	return point != npoints - 1 && (hash >> 32) % 10 >= 7;
+}
+
+static void extend_levels(int **list, int *count, int npoints, int nlevels) {
+
+	int *list3d = (int *)malloc((size_t)*count * nlevels * sizeof(int));
+	for (int k = 0; k < nlevels; k++)
+		for (int i = 0; i < *count; i++)
+			list3d[i + k * *count] = (*list)[i] + k * npoints;
+	free(*list);
+	*list = list3d;
+	*count *= nlevels;
+}
+
+/**
+ * @brief Generate the source and destination decomposition of a case
+ * 
+ * @details The source is a block decomposition over all the processes, except for
+ *          the transposition, and the destination is:
+ *          - block: block decomposition over half of the processes
+ *          - block_cyclic: cyclic decomposition
+ *          - random: random permutation of the global indices split in blocks
+ *          - transpose: 2D domain split in rows for the source and in columns for
+ *            the destination, stored transposed
+ *          - stride3d: cyclic decomposition of a 3D field mapped with stride
+ *          - extend3d: cyclic decomposition of a 2D map extended to 3D
+ *          - masked: cyclic decomposition of the points which are not masked
+ * 
+ * @ingroup benchmarks
+ */
+static void new_decomposition(t_decomposition *decomp, int bcase, int npoints, int nlevels,
+                              int rank, int size) {
+
+	int start, count;
+
+	decomp->stride = -1;
+	decomp->nlevels = 0;
+
+	// source: block decomposition
+	block_range(npoints, size, rank, &start, &count);
+	decomp->src = (int *)malloc((count > 0 ? count : 1) * sizeof(int));
+	decomp->src_count = 0;
+	for (int i = start; i < start + count; i++)
+		if (bcase != case_masked || !masked(i, npoints))
+			decomp->src[decomp->src_count++] = i;
+
+	decomp->dst = (int *)malloc(((npoints + size - 1) / size + 1) * sizeof(int));
+	decomp->dst_count = 0;
+
+	switch (bcase) {
+	case case_block: {
+		int dst_size = size > 1 ? size / 2 : 1;
+		if (rank < dst_size) {
+			block_range(npoints, dst_size, rank, &start, &count);
+			decomp->dst = (int *)realloc(decomp->dst, (count > 0 ? count : 1) * sizeof(int));
+			for (int i = start; i < start + count; i++)
+				decomp->dst[decomp->dst_count++] = i;
+		}
+		break;
+	}
+	case case_random: {
+		int *permutation = (int *)malloc(npoints * sizeof(int));
+		for (int i = 0; i < npoints; i++)
+			permutation[i] = i;
+		unsigned long long state = 88172645463325252ULL;
+		for (int i = npoints - 1; i > 0; i--) {
+			int j = (int)(next_random(&state) % (unsigned long long)(i + 1));
+			int tmp = permutation[i];
+			permutation[i] = permutation[j];
+			permutation[j] = tmp;
+		}
+		block_range(npoints, size, rank, &start, &count);
+		for (int i = start; i < start + count; i++)
+			decomp->dst[decomp->dst_count++] = permutation[i];
+		free(permutation);
+		break;
+	}
+	case case_transpose: {
+		int nrows = (int)sqrt((double)npoints);
+		int ncols = npoints / nrows;
+		free(decomp->src);
+		decomp->src = (int *)malloc(((nrows + size - 1) / size + 1) * ncols * sizeof(int));
+		decomp->src_count = 0;
+		block_range(nrows, size, rank, &start, &count);
+		for (int i = start; i < start + count; i++)
+			for (int j = 0; j < ncols; j++)
+				decomp->src[decomp->src_count++] = j + i * ncols;
+		decomp->dst = (int *)realloc(decomp->dst, ((ncols + size - 1) / size + 1) * nrows * sizeof(int));
+		block_range(ncols, size, rank, &start, &count);
+		for (int j = start; j < start + count; j++)
+			for (int i = 0; i < nrows; i++)
+				decomp->dst[decomp->dst_count++] = j + i * ncols;
+		break;
+	}
+	default:
+		// cyclic decomposition
+		for (int i = rank; i < npoints; i += size)
+			if (bcase != case_masked || !masked(i, npoints))
+				decomp->dst[decomp->dst_count++] = i;
+		break;
+	}
+
+	if (bcase == case_stride3d) {
+		extend_levels(&decomp->src, &decomp->src_count, npoints, nlevels);
+		extend_levels(&decomp->dst, &decomp->dst_count, npoints, nlevels);
+		decomp->stride = npoints;
+	}
+	if (bcase == case_extend3d)
+		decomp->nlevels = nlevels;
+}
+
+static void delete_decomposition(t_decomposition *decomp) {
+
+	free(decomp->src);
+	free(decomp->dst);
+}
+
+/**
+ * @brief Benchmark of the construction of a map
+ * 
+ * @details The map of each case is created and deleted nreps times after a warm-up.
+ *          For each phase, the min, mean and max among the processes of the average
+ *          time per map are written. The phases are the wall time of the construction
+ *          (\c total), measured between two barriers, and the times of the library
+ *          timers. The peak memory of the construction (\c peak_memory) is also written.
+ * 
+ * @ingroup benchmarks
+ */
+static void benchmark_map(t_benchmark_output *output, int bcase, int npoints, int nlevels,
+                          int nreps) {
+
+	int rank, size;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+	t_decomposition decomp;
+	new_decomposition(&decomp, bcase, npoints, nlevels, rank, size);
+
+	t_idxlist *src_idxlist = new_idxlist(decomp.src, decomp.src_count);
+	t_idxlist *dst_idxlist = new_idxlist(decomp.dst, decomp.dst_count);
+
+	double phases[NPHASES] = {0.0};
+	benchmark_reset_peak_memory();
+
+	// the first map is the warm-up
+	for (int rep = -1; rep < nreps; rep++) {
+
+		if (rep == 0) timers_reset();
+
+		MPI_Barrier(MPI_COMM_WORLD);
+		double start = MPI_Wtime();
+
+		t_map *map = new_map(src_idxlist, dst_idxlist, decomp.stride, MPI_COMM_WORLD);
+		if (decomp.nlevels > 0) {
+			t_map *map3d = extend_map_3d(map, decomp.nlevels);
+			delete_map(map);
+			map = map3d;
+		}
+
+		MPI_Barrier(MPI_COMM_WORLD);
+		if (rep >= 0) phases[0] += MPI_Wtime() - start;
+
+		delete_map(map);
+	}
+
+	for (int i = 0; i < NPHASES - 2; i++)
+		phases[i + 1] = timer_total_time(new_timer(timer_names[i]));
+	for (int i = 0; i < NPHASES - 1; i++)
+		phases[i] /= nreps;
+	phases[NPHASES - 1] = (double)benchmark_peak_memory();
+
+	double phases_min[NPHASES], phases_max[NPHASES], phases_sum[NPHASES];
+	MPI_Reduce(phases, phases_min, NPHASES, MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD);
+	MPI_Reduce(phases, phases_max, NPHASES, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+	MPI_Reduce(phases, phases_sum, NPHASES, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+	if (rank == 0) {
+		const char *keys[NCOLUMNS] = {"case", "nprocs", "npoints", "nlevels", "nreps",
+		                              "phase", "unit", "min", "mean", "max"};
+		char values[NCOLUMNS][64];
+		const char *pvalues[NCOLUMNS];
+		for (int i = 0; i < NCOLUMNS; i++)
+			pvalues[i] = values[i];
+
+		for (int phase = 0; phase < NPHASES; phase++) {
+			snprintf(values[0], 64, "%s", case_names[bcase]);
+			snprintf(values[1], 64, "%d", size);
+			snprintf(values[2], 64, "%d", npoints);
+			snprintf(values[3], 64, "%d", bcase == case_stride3d || bcase == case_extend3d ? nlevels : 1);
+			snprintf(values[4], 64, "%d", nreps);
+			snprintf(values[5], 64, "%s", phase == 0 ? "total" :
+			                              phase == NPHASES - 1 ? "peak_memory" : timer_names[phase - 1]);
+			snprintf(values[6], 64, "%s", phase == NPHASES - 1 ? "kB" : "s");
+			snprintf(values[7], 64, "%.6e", phases_min[phase]);
+			snprintf(values[8], 64, "%.6e", phases_sum[phase] / size);
+			snprintf(values[9], 64, "%.6e", phases_max[phase]);
+			benchmark_write(output, NCOLUMNS, keys, pvalues);
+		}
+	}
+
+	delete_idxlist(src_idxlist);
+	delete_idxlist(dst_idxlist);
+	delete_decomposition(&decomp);
+}
+
+struct t_simulated_case {
+	int bcase;
+	int npoints;
+	int nlevels;
+};
+typedef struct t_simulated_case t_simulated_case;
+
+static void simulated_map(int rank, int size, void *ctx) {
+
+	const t_simulated_case *sim_case = (const t_simulated_case *)ctx;
+
+	t_decomposition decomp;
+	new_decomposition(&decomp, sim_case->bcase, sim_case->npoints, sim_case->nlevels, rank, size);
+
+	t_idxlist *src_idxlist = new_idxlist(decomp.src, decomp.src_count);
+	t_idxlist *dst_idxlist = new_idxlist(decomp.dst, decomp.dst_count);
+
+	t_map *map = new_map(src_idxlist, dst_idxlist, decomp.stride, MPI_COMM_WORLD);
+	if (decomp.nlevels > 0) {
+		t_map *map3d = extend_map_3d(map, decomp.nlevels);
+		delete_map(map);
+		map = map3d;
+	}
+
+	delete_map(map);
+	delete_idxlist(src_idxlist);
+	delete_idxlist(dst_idxlist);
+	delete_decomposition(&decomp);
+}
+
+/**
+ * @brief Benchmark of the construction of a map with virtual processes
+ * 
+ * @details The map of each case is created once by nranks virtual processes of the
+ *          simulator on the process 0. The modelled time (\c sim_time), the wall time
+ *          of the simulation (\c sim_wall_time) and the number of messages and bytes
+ *          in total and of the busiest process are written (min, mean and max are the same).
+ * 
+ * @ingroup benchmarks
+ */
+static void benchmark_map_simulated(t_benchmark_output *output, int bcase, int npoints, int nlevels,
+                                    int nranks, int ranks_per_node) {
+
+	t_simulated_case sim_case = {bcase, npoints, nlevels};
+	t_simulator_config config = {nranks, ranks_per_node, 0};
+	t_simulator_stats stats;
+	distdir_simulate(&config, simulated_map, &sim_case, &stats);
+
+	const char *keys[NCOLUMNS] = {"case", "nprocs", "npoints", "nlevels", "nreps",
+	                              "phase", "unit", "min", "mean", "max"};
+	const char *phases[6] = {"sim_time", "sim_wall_time", "sim_messages", "sim_bytes",
+	                         "sim_max_messages", "sim_max_bytes"};
+	double values_phase[6] = {stats.time, stats.wall_time, (double)stats.messages, (double)stats.bytes,
+	                          (double)stats.max_messages, (double)stats.max_bytes};
+	char values[NCOLUMNS][64];
+	const char *pvalues[NCOLUMNS];
+	for (int i = 0; i < NCOLUMNS; i++)
+		pvalues[i] = values[i];
+
+	for (int phase = 0; phase < 6; phase++) {
+		snprintf(values[0], 64, "%s", case_names[bcase]);
+		snprintf(values[1], 64, "%d", nranks);
+		snprintf(values[2], 64, "%d", npoints);
+		snprintf(values[3], 64, "%d", bcase == case_stride3d || bcase == case_extend3d ? nlevels : 1);
+		snprintf(values[4], 64, "%d", 1);
+		snprintf(values[5], 64, "%s", phases[phase]);
+		snprintf(values[6], 64, "%s", phase < 2 ? "s" : phase % 2 == 0 ? "messages" : "B");
+		for (int i = 7; i < NCOLUMNS; i++)
+			snprintf(values[i], 64, "%.6e", values_phase[phase]);
+		benchmark_write(output, NCOLUMNS, keys, pvalues);
+	}
+}
+
+static void usage(const char *name) {
+
+	printf("Usage: %s [-n npoints] [-l nlevels] [-r nreps] [-c case] [-s nranks] [-p ranks_per_node]\n"
+	       "          [-f csv|json] [-o file]\n", name);
+	printf("  -n  number of points of the global 2D domain (default 65536)\n");
+	printf("  -l  number of vertical levels of the 3D cases (default 10)\n");
+	printf("  -r  number of repetitions (default 5)\n");
+	printf("  -c  case (default all):");
+	for (int i = 0; i < ncases; i++)
+		printf(" %s", case_names[i]);
+	printf("\n  -s  number of virtual processes of a simulated run on the process 0 (default 0, no simulation)\n");
+	printf("  -p  number of virtual processes on each node of the simulated run (default 0, a single node)\n");
+	printf("  -f  format of the results (default csv)\n");
+	printf("  -o  file where the results are appended (default stdout)\n");
+}
+
+int main(int argc, char **argv) {
+
+	distdir_initialize();
+	set_config_timers(timers_on);
+
+	int rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+	int npoints = 65536;
+	int nlevels = 10;
+	int nreps = 5;
+	int bcase = -1;
+	int nranks_sim = 0;
+	int ranks_per_node = 0;
+	int format = benchmark_csv;
+	const char *path = NULL;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "n:l:r:c:s:p:f:o:h")) != -1) {
+		switch (opt) {
+		case 'n': npoints = atoi(optarg); break;
+		case 'l': nlevels = atoi(optarg); break;
+		case 'r': nreps = atoi(optarg); break;
+		case 'c':
+			for (int i = 0; i < ncases; i++)
+				if (strcmp(optarg, case_names[i]) == 0) bcase = i;
+			if (bcase == -1) {
+				if (rank == 0) usage(argv[0]);
+				distdir_finalize();
+				return 1;
+			}
+			break;
+		case 's': nranks_sim = atoi(optarg); break;
+		case 'p': ranks_per_node = atoi(optarg); break;
+		case 'f': format = strcmp(optarg, "json") == 0 ? benchmark_json : benchmark_csv; break;
+		case 'o': path = optarg; break;
+		default:
+			if (rank == 0) usage(argv[0]);
+			distdir_finalize();
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	if (npoints < 1 || nlevels < 1 || nreps < 1 || nranks_sim < 0 ||
+	    (long long)npoints * nlevels > 2147483647LL) {
+		if (rank == 0) usage(argv[0]);
+		distdir_finalize();
+		return 1;
+	}
+
+	t_benchmark_output output;
+	if (rank == 0)
+		benchmark_open(&output, path, format);
+
+	for (int i = 0; i < ncases; i++)
+		if (bcase == -1 || bcase == i) {
+			if (nranks_sim > 0) {
+				if (rank == 0)
+					benchmark_map_simulated(&output, i, npoints, nlevels, nranks_sim, ranks_per_node);
+			} else {
+				benchmark_map(&output, i, npoints, nlevels, nreps);
+			}
+		}
+
+	if (rank == 0)
+		benchmark_close(&output);
+
+	distdir_finalize();
+
+	return 0;
+}
@@ -0,0 +1,143 @@
+/*
+ * @file benchmark_utils.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/resource.h>
+
+#include "benchmarks/benchmark_utils.h"
+
+void benchmark_open(t_benchmark_output *output, const char *path, int format) {
+
+	output->format = format;
+	output->file = stdout;
+	output->header = 1;
+
+	if (path != NULL) {
+		output->file = fopen(path, "a");
+		if (output->file == NULL) {
+			printf("Error opening %s\n", path);
+			exit(EXIT_FAILURE);
+		}
+		fseek(output->file, 0, SEEK_END);
+		output->header = ftell(output->file) == 0;
+	}
+}
+
+static int benchmark_is_number(const char *value) {
+
+	char *end;
+	strtod(value, &end);
+	return value[0] != '\0' && *end == '\0';
+}
+
+void benchmark_write(t_benchmark_output *output, int ncols, const char **keys, const char **values) {
+
+	if (output->format == benchmark_csv) {
+		if (output->header) {
+			for (int i = 0; i < ncols; i++)
+				fprintf(output->file, "%s%s", keys[i], i < ncols - 1 ? "," : "\n");
+			output->header = 0;
+		}
+		for (int i = 0; i < ncols; i++)
+			fprintf(output->file, "%s%s", values[i], i < ncols - 1 ? "," : "\n");
+	} else {
+		fprintf(output->file, "{");
+		for (int i = 0; i < ncols; i++) {
+			const char *quote = benchmark_is_number(values[i]) ? "" : "\"";
+			fprintf(output->file, "\"%s\": %s%s%s%s", keys[i], quote, values[i], quote,
+			                                          i < ncols - 1 ? ", " : "");
+		}
+		fprintf(output->file, "}\n");
+	}
+	fflush(output->file);
+}
+
+void benchmark_close(t_benchmark_output *output) {
+
+	if (output->file != stdout)
+		fclose(output->file);
+	output->file = NULL;
+}
+
+static int benchmark_compare_double(const void *a, const void *b) {
+
+	double x = *(const double *)a;
+	double y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+double benchmark_percentile(double *values, int count, double p) {
+
+	qsort(values, count, sizeof(double), benchmark_compare_double);
+
+	int rank = (int)ceil(p / 100.0 * count) - 1;
+	if (rank < 0) rank = 0;
+	if (rank > count - 1) rank = count - 1;
+
+	return values[rank];
+}
+
+void benchmark_reset_peak_memory() {
+
+	FILE *file = fopen("/proc/self/clear_refs", "w");
+	if (file == NULL) return;
+	fprintf(file, "5");
+	fclose(file);
+}
+
+long benchmark_peak_memory() {
+
+	long peak = -1;
+
+	FILE *file = fopen("/proc/self/status", "r");
+	if (file != NULL) {
+		char line[256];
+		while (fgets(line, sizeof(line), file) != NULL)
+			if (strncmp(line, "VmHWM:", 6) == 0) {
+				peak = atol(line + 6);
+				break;
+			}
+		fclose(file);
+	}
+
+	// fallback for systems without /proc
+	if (peak < 0) {
+		struct rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		peak = usage.ru_maxrss;
+	}
+
+	return peak;
+}
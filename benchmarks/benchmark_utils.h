@@ -0,0 +1,139 @@
+/*
+ * @file benchmark_utils.h
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BENCHMARK_UTILS_H
+#define BENCHMARK_UTILS_H
+
+#include <stdio.h>
+
+/** @brief maximum number of columns of a row of results */
+#define BENCHMARK_MAX_COLUMNS 32
+
+/** @enum benchmark_format
+ * 
+ *  @brief Enum for the format of the results
+ * 
+ */
+enum benchmark_format {
+	benchmark_csv  = 0,
+	benchmark_json = 1
+};
+
+/** @struct t_benchmark_output
+ * 
+ *  @brief The structure contains the output of the results of a benchmark
+ * 
+ */
+struct t_benchmark_output {
+	/** @brief file of the results (stdout if no path is given) */
+	FILE *file;
+	/** @brief format of the results */
+	enum benchmark_format format;
+	/** @brief flag set when the header of the CSV file has to be written */
+	int header;
+};
+typedef struct t_benchmark_output t_benchmark_output;
+
+/**
+ * @brief Open the output of the results
+ * 
+ * @details The results are appended to the file, so that the results of several runs
+ *          (e.g. with different numbers of processes) can be collected in the same file.
+ *          The CSV header is written only if the file is empty. The JSON format writes
+ *          one object per line (JSON Lines).
+ * 
+ * @param[out] output pointer to a t_benchmark_output structure
+ * @param[in]  path   path of the file (NULL for stdout)
+ * @param[in]  format format of the results using values of benchmark_format enum
+ * 
+ * @ingroup benchmarks
+ */
+void benchmark_open(t_benchmark_output *output, const char *path, int format);
+
+/**
+ * @brief Write a row of results
+ * 
+ * @param[in] output  pointer to a t_benchmark_output structure
+ * @param[in] ncols   number of columns
+ * @param[in] keys    names of the columns
+ * @param[in] values  values of the columns (numbers are written without quotes in JSON)
+ * 
+ * @ingroup benchmarks
+ */
+void benchmark_write(t_benchmark_output *output, int ncols, const char **keys, const char **values);
+
+/**
+ * @brief Close the output of the results
+ * 
+ * @param[in] output pointer to a t_benchmark_output structure
+ * 
+ * @ingroup benchmarks
+ */
+void benchmark_close(t_benchmark_output *output);
+
+/**
+ * @brief Percentile of a set of values
+ * 
+ * @details The values are sorted in place and the nearest rank percentile is returned.
+ * 
+ * @param[in,out] values array of values
+ * @param[in]     count  number of values
+ * @param[in]     p      percentile between 0 and 100 (e.g. 50 for the median)
+ * 
+ * @return percentile of the values
+ * 
+ * @ingroup benchmarks
+ */
+double benchmark_percentile(double *values, int count, double p);
+
+/**
+ * @brief Reset the peak memory of the process
+ * 
+ * @details The peak resident set size is reset through /proc/self/clear_refs (Linux),
+ *          so that \c benchmark_peak_memory returns the peak since the reset.
+ *          Otherwise the peak since the start of the process is returned.
+ * 
+ * @ingroup benchmarks
+ */
+void benchmark_reset_peak_memory();
+
+/**
+ * @brief Peak memory of the process
+ * 
+ * @return peak resident set size in kB
+ * 
+ * @ingroup benchmarks
+ */
+long benchmark_peak_memory();
+
+#endif
@@ -0,0 +1,28 @@
+#!/bin/sh
+#
+# Sweep of the map construction benchmark over the number of processes and the
+# size of the global domain. The processes are oversubscribed, so that the sweep
+# runs on a single node. The results are appended to a single file.
+#
+# Usage: run_benchmark_map.sh [output file] [format]
+#
+# The environment variables NPROCS, NPOINTS, NLEVELS and NREPS can be used to
+# change the sweep, e.g. NPROCS="2 4 8" NPOINTS="65536 1048576" ./run_benchmark_map.sh
+#
+
+OUTPUT=${1:-benchmark_map.csv}
+FORMAT=${2:-csv}
+NPROCS=${NPROCS:-"1 2 4 8"}
+NPOINTS=${NPOINTS:-"4096 16384 65536"}
+NLEVELS=${NLEVELS:-10}
+NREPS=${NREPS:-5}
+MPIRUN=${MPIRUN:-"mpirun --oversubscribe"}
+
+DIR=$(dirname "$0")
+
+for nprocs in $NPROCS; do
+	for npoints in $NPOINTS; do
+		$MPIRUN -n "$nprocs" "$DIR/benchmark_map" -n "$npoints" -l "$NLEVELS" -r "$NREPS" \
+		        -f "$FORMAT" -o "$OUTPUT" || exit 1
+	done
+done
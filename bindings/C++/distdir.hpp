@@ -35,6 +35,11 @@
 
 #include <vector>
 #include <memory>
+#include <utility>
+#include <string>
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
 extern "C" {
 	#include "src/distdir.h"
 }
@@ -55,6 +60,10 @@ class distdir {
 			distdir_finalize();
 		}
 
+		/* the objects own C objects, copies would free them twice */
+		distdir(const distdir&) = delete;
+		distdir& operator=(const distdir&) = delete;
+
 		void group(MPI_Comm *new_comm ,
 		           MPI_Comm  work_comm,
 		           int       id       ) {
@@ -70,14 +79,158 @@ class distdir {
 			set_config_verbose(verbose_type);
 		}
 
+		void set_precision(int precision_type) {
+			set_config_precision(precision_type);
+		}
+
+		void set_compression(int compression_type) {
+			set_config_compression(compression_type);
+		}
+
+		void set_delta(int delta_type) {
+			set_config_delta(delta_type);
+		}
+
+		void set_buffer_pool(int buffer_pool_type) {
+			set_config_buffer_pool(buffer_pool_type);
+		}
+
+		void set_allocator(int allocator_type) {
+			set_config_allocator(allocator_type);
+		}
+
+		void set_timers(int timers_type) {
+			set_config_timers(timers_type);
+		}
+
+		void set_trace(int trace_type) {
+			set_config_trace(trace_type);
+		}
+
+		void set_timers_report(int timers_report_type) {
+			set_config_timers_report(timers_report_type);
+		}
+
+		void set_timers_report_file(const std::string &path) {
+			set_config_timers_report_file(path.c_str());
+		}
+
+		void set_exchanger_auto_trials(int trials) {
+			set_config_exchanger_auto_trials(trials);
+		}
+
+		void set_exchanger_auto_file(const std::string &path) {
+			set_config_exchanger_auto_file(path.c_str());
+		}
+
+		void set_comm(MPI_Comm comm) {
+			set_config_comm(comm);
+		}
+
+		void set_thread_ranks(int thread_ranks) {
+			set_config_thread_ranks(thread_ranks);
+		}
+
+		void set_progress_thread(int progress_thread_type) {
+			set_config_progress_thread(progress_thread_type);
+		}
+
+		void dump_trace(const std::string &path) {
+			distdir_dump_trace(path.c_str());
+		}
+
+		void set_hooks(distdir_hook begin_fn, distdir_hook end_fn, void *user_ctx = nullptr) {
+			distdir_set_hooks(begin_fn, end_fn, user_ctx);
+		}
+
+		t_comm_stats get_comm_stats() {
+			t_comm_stats stats;
+			distdir_get_comm_stats(&stats);
+			return stats;
+		}
+
+		void reset_comm_stats() {
+			distdir_reset_comm_stats();
+		}
+
+		void dump_comm_matrix(const std::string &path) {
+			distdir_dump_comm_matrix(path.c_str());
+		}
+
+		void calibrate(MPI_Comm comm) {
+			distdir_calibrate(comm);
+		}
+
+		t_cost_params get_cost_params() {
+			t_cost_params params;
+			distdir_get_cost_params(&params);
+			return params;
+		}
+
+		void set_cost_params(const t_cost_params &params) {
+			distdir_set_cost_params(&params);
+		}
+
+		t_memory_report memory_report() {
+			t_memory_report report;
+			distdir_memory_report(&report);
+			return report;
+		}
+
+		t_simulator_stats simulate(const t_simulator_config &config, simulator_fn fn, void *ctx) {
+			t_simulator_stats stats;
+			distdir_simulate(&config, fn, ctx, &stats);
+			return stats;
+		}
+
+		void run_ranks(distdir_ranks_fn fn, void *ctx) {
+			distdir_run_ranks(fn, ctx);
+		}
+
 		int get_exchanger() {
 			return get_config_exchanger();
 		}
 
+		int get_precision() {
+			return get_config_precision();
+		}
+
+		int get_compression() {
+			return get_config_compression();
+		}
+
+		int get_delta() {
+			return get_config_delta();
+		}
+
+		int get_buffer_pool() {
+			return get_config_buffer_pool();
+		}
+
+		int get_allocator() {
+			return get_config_allocator();
+		}
+
+		int get_timers() {
+			return get_config_timers();
+		}
+
+		int get_trace() {
+			return get_config_trace();
+		}
+
 		int get_verbose() {
 			return get_config_verbose();
 		}
 
+		int get_thread_ranks() {
+			return get_config_thread_ranks();
+		}
+
+		int get_progress_thread() {
+			return get_config_progress_thread();
+		}
+
 };
 
 class idxlist {
@@ -102,6 +255,9 @@ class idxlist {
 			delete_idxlist(m_idxlist);
 		}
 
+		idxlist(const idxlist&) = delete;
+		idxlist& operator=(const idxlist&) = delete;
+
 	private:
 		t_idxlist *m_idxlist;
 };
@@ -127,38 +283,193 @@ class map {
 			return m_map;
 		}
 
+		t_map_stats stats() {
+			t_map_stats stats;
+			map_stats(m_map, &stats);
+			return stats;
+		}
+
+		double predict_cost(MPI_Datatype type, int mode) {
+			return map_predict_cost(m_map, type, mode);
+		}
+
+		int predict_exchanger(MPI_Datatype type) {
+			return map_predict_exchanger(m_map, type);
+		}
+
 		~map() {
 			delete_map(m_map);
 		}
 
+		map(const map&) = delete;
+		map& operator=(const map&) = delete;
+
 	private:
 		t_map *m_map;
 };
 
+/* Handle of a C exchanger shared by the exchanger and its futures: the exchanger
+ * resets it to nullptr when it is deleted, which completes the exchange in progress */
+typedef std::shared_ptr<t_exchanger *> exchanger_handle;
+
+/* Progress of the non blocking exchanges awaited by suspended coroutines:
+ * the task runtime calls poller::poll() (e.g. when idle) to test the exchanges
+ * (MPI_Testsome) and resume the coroutines of the completed ones */
+class poller {
+
+	public:
+
+#if defined(__cpp_impl_coroutine)
+		static void add(exchanger_handle exchanger, std::coroutine_handle<> handle) {
+			pending().push_back(std::make_pair(exchanger, handle));
+		}
+#endif
+
+		/* return the number of exchanges still in progress */
+		static int poll() {
+#if defined(__cpp_impl_coroutine)
+			std::vector<std::pair<exchanger_handle, std::coroutine_handle<>>> completed;
+			auto& list = pending();
+			for (auto it = list.begin(); it != list.end();) {
+				/* a deleted exchanger has completed its exchange */
+				if (*it->first == nullptr || exchanger_test(*it->first)) {
+					completed.push_back(*it);
+					it = list.erase(it);
+				} else {
+					++it;
+				}
+			}
+			/* resumed coroutines can start and await new exchanges */
+			for (auto& item : completed)
+				item.second.resume();
+			return static_cast<int>(list.size());
+#else
+			return 0;
+#endif
+		}
+
+	private:
+#if defined(__cpp_impl_coroutine)
+		static std::vector<std::pair<exchanger_handle, std::coroutine_handle<>>>& pending() {
+			static std::vector<std::pair<exchanger_handle, std::coroutine_handle<>>> list;
+			return list;
+		}
+#endif
+};
+
+/* Handle of a non blocking exchange: the data must not be used until the
+ * exchange is completed, the destructor waits for the completion. The future
+ * can outlive its exchanger: deleting the exchanger completes the exchange */
+class exchange_future {
+
+	public:
+
+		explicit exchange_future(exchanger_handle exchanger) : m_exchanger(std::move(exchanger)) {}
+
+		exchange_future(const exchange_future&) = delete;
+		exchange_future& operator=(const exchange_future&) = delete;
+
+		exchange_future(exchange_future&& other) : m_exchanger(std::move(other.m_exchanger)) {}
+
+		exchange_future& operator=(exchange_future&& other) {
+			std::swap(m_exchanger, other.m_exchanger);
+			return *this;
+		}
+
+		~exchange_future() {
+			wait();
+		}
+
+		/* progress the exchange without blocking, return true if completed */
+		bool ready() {
+			if (m_exchanger != nullptr && (*m_exchanger == nullptr || exchanger_test(*m_exchanger)))
+				m_exchanger = nullptr;
+			return m_exchanger == nullptr;
+		}
+
+		void wait() {
+			if (m_exchanger != nullptr) {
+				if (*m_exchanger != nullptr)
+					exchanger_wait(*m_exchanger);
+				m_exchanger = nullptr;
+			}
+		}
+
+		void get() {
+			wait();
+		}
+
+#if defined(__cpp_impl_coroutine)
+		/* co_await suspends the coroutine until the poller completes the exchange */
+		bool await_ready() {
+			return ready();
+		}
+
+		void await_suspend(std::coroutine_handle<> handle) {
+			poller::add(m_exchanger, handle);
+			m_exchanger = nullptr;
+		}
+
+		void await_resume() {}
+#endif
+
+	private:
+		exchanger_handle m_exchanger;
+};
+
 template<class T>
 class exchanger {
 
 	public:
 		typedef std::shared_ptr<exchanger<T>> Ptr;
 		exchanger(map::Ptr map, MPI_Datatype type, distdir_hardware hw=CPU) {
-			m_exchanger = new_exchanger(map->get(), type, hw);
+			m_exchanger = std::make_shared<t_exchanger *>(new_exchanger(map->get(), type, hw));
+		}
+
+		exchanger(map::Ptr map, MPI_Datatype type, int block_size, distdir_hardware hw=CPU) {
+			m_exchanger = std::make_shared<t_exchanger *>(
+			                  new_exchanger_with_block_size(map->get(), type, block_size, hw));
 		}
 
 		void go(std::vector<T>& src_data, std::vector<T>& dst_data) {
-			exchanger_go(m_exchanger, src_data.data(), dst_data.data());
+			exchanger_go(*m_exchanger, src_data.data(), dst_data.data());
 		}
 
 		void go(std::vector<T>& src_data, std::vector<T>& dst_data,
 		        std::vector<int>& transform_src, std::vector<int>& transform_dst) {
-			exchanger_go_with_transform(m_exchanger, src_data.data(), dst_data.data(),
+			exchanger_go_with_transform(*m_exchanger, src_data.data(), dst_data.data(),
 			                            transform_src.data(), transform_dst.data());
 		}
 
+		exchange_future go_async(std::vector<T>& src_data, std::vector<T>& dst_data) {
+			exchanger_start(*m_exchanger, src_data.data(), dst_data.data());
+			return exchange_future(m_exchanger);
+		}
+
+		exchange_future go_async(std::vector<T>& src_data, std::vector<T>& dst_data,
+		                         std::vector<int>& transform_src, std::vector<int>& transform_dst) {
+			exchanger_start_with_transform(*m_exchanger, src_data.data(), dst_data.data(),
+			                               transform_src.data(), transform_dst.data());
+			return exchange_future(m_exchanger);
+		}
+
+		t_comm_stats get_comm_stats() {
+			t_comm_stats stats;
+			exchanger_get_comm_stats(*m_exchanger, &stats);
+			return stats;
+		}
+
+		/* the exchange in progress is completed and the futures are released */
 		~exchanger() {
-			delete_exchanger(m_exchanger);
+			t_exchanger *exch = *m_exchanger;
+			*m_exchanger = nullptr;
+			delete_exchanger(exch);
 		}
+
+		exchanger(const exchanger&) = delete;
+		exchanger& operator=(const exchanger&) = delete;
 	private:
-		t_exchanger *m_exchanger;
+		exchanger_handle m_exchanger;
 };
 
 }
@@ -0,0 +1,335 @@
+/*
+ * @file distdir_typed.hpp
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DISTDIR_TYPED_HPP
+#define DISTDIR_TYPED_HPP
+
+#include <cstddef>
+#include <complex>
+#include <type_traits>
+#include <utility>
+#if __has_include(<version>)
+#include <version>
+#endif
+#if defined(__cpp_lib_span)
+#include <span>
+#endif
+#if defined(__cpp_lib_mdspan)
+#include <mdspan>
+#endif
+#include "bindings/C++/distdir.hpp"
+
+/*
+ * Header-only typed interface (C++17 or later).
+ *
+ * The MPI datatype is deduced from the element type, the classes are move-only
+ * owners of the C objects and the data are passed as views (no copies). On CPU
+ * the pack and unpack kernels of the exchanger are replaced by inline kernels
+ * specialised on the element type and the block size. The C kernels are used
+ * whenever the exchanger needs a conversion (e.g. reduced wire precision) or
+ * the data are on GPU.
+ */
+namespace distdir::typed {
+
+/* Contiguous view: std::span if available, otherwise a minimal equivalent */
+#if defined(__cpp_lib_span)
+template<class T>
+using span = std::span<T>;
+#else
+template<class T>
+class span {
+
+	public:
+
+		constexpr span() noexcept : m_data(nullptr), m_size(0) {}
+
+		constexpr span(T *data, std::size_t size) noexcept : m_data(data), m_size(size) {}
+
+		template<std::size_t N>
+		constexpr span(T (&array)[N]) noexcept : m_data(array), m_size(N) {}
+
+		/* any contiguous container (std::vector, std::array, ...) */
+		template<class Container,
+		         class = std::enable_if_t<std::is_convertible_v<
+		                 decltype(std::declval<Container&>().data()), T*>>>
+		constexpr span(Container& container) noexcept
+		    : m_data(container.data()), m_size(container.size()) {}
+
+		template<class U, class = std::enable_if_t<std::is_convertible_v<U(*)[], T(*)[]>>>
+		constexpr span(const span<U>& other) noexcept : m_data(other.data()), m_size(other.size()) {}
+
+		constexpr T * data() const noexcept { return m_data; }
+
+		constexpr std::size_t size() const noexcept { return m_size; }
+
+		constexpr T& operator[](std::size_t i) const noexcept { return m_data[i]; }
+
+	private:
+		T *m_data;
+		std::size_t m_size;
+};
+#endif
+
+/* MPI datatype of the element type: types without a predefined MPI datatype
+ * are moved as bytes */
+template<class T>
+struct mpi_type {
+	static_assert(std::is_trivially_copyable_v<T>, "exchanged types must be trivially copyable");
+	static MPI_Datatype get() { return MPI_BYTE; }
+	static constexpr int count = sizeof(T);
+};
+
+#define DISTDIR_MPI_TYPE(T, DATATYPE)                           \
+	template<>                                                  \
+	struct mpi_type<T> {                                        \
+		static MPI_Datatype get() { return DATATYPE; }          \
+		static constexpr int count = 1;                         \
+	};
+
+DISTDIR_MPI_TYPE(char, MPI_CHAR)
+DISTDIR_MPI_TYPE(signed char, MPI_SIGNED_CHAR)
+DISTDIR_MPI_TYPE(unsigned char, MPI_UNSIGNED_CHAR)
+DISTDIR_MPI_TYPE(short, MPI_SHORT)
+DISTDIR_MPI_TYPE(unsigned short, MPI_UNSIGNED_SHORT)
+DISTDIR_MPI_TYPE(int, MPI_INT)
+DISTDIR_MPI_TYPE(unsigned int, MPI_UNSIGNED)
+DISTDIR_MPI_TYPE(long, MPI_LONG)
+DISTDIR_MPI_TYPE(unsigned long, MPI_UNSIGNED_LONG)
+DISTDIR_MPI_TYPE(long long, MPI_LONG_LONG)
+DISTDIR_MPI_TYPE(unsigned long long, MPI_UNSIGNED_LONG_LONG)
+DISTDIR_MPI_TYPE(float, MPI_FLOAT)
+DISTDIR_MPI_TYPE(double, MPI_DOUBLE)
+DISTDIR_MPI_TYPE(long double, MPI_LONG_DOUBLE)
+DISTDIR_MPI_TYPE(std::complex<float>, MPI_C_FLOAT_COMPLEX)
+DISTDIR_MPI_TYPE(std::complex<double>, MPI_C_DOUBLE_COMPLEX)
+
+#undef DISTDIR_MPI_TYPE
+
+/* Pack and unpack kernels with the signature of the C kernels (t_kernels),
+ * the element type and the block size are compile time constants */
+template<class T, int BlockSize>
+struct kernels {
+
+	static void pack(void *buffer, void *data, int *buffer_idxlist,
+	                 int buffer_size, int offset, int *transform, std::size_t) {
+
+		T * __restrict__ b = static_cast<T *>(buffer) + static_cast<std::size_t>(offset) * BlockSize;
+		const T * __restrict__ d = static_cast<const T *>(data);
+		const int *idx = buffer_idxlist + offset;
+
+		if (transform == nullptr) {
+			for (int i = 0; i < buffer_size; i++)
+				for (int j = 0; j < BlockSize; j++)
+					b[static_cast<std::size_t>(i) * BlockSize + j] =
+					    d[static_cast<std::size_t>(idx[i]) * BlockSize + j];
+		} else {
+			for (int i = 0; i < buffer_size; i++)
+				for (int j = 0; j < BlockSize; j++)
+					b[static_cast<std::size_t>(i) * BlockSize + j] =
+					    d[static_cast<std::size_t>(transform[idx[i]]) * BlockSize + j];
+		}
+	}
+
+	static void unpack(void *buffer, void *data, int *buffer_idxlist,
+	                   int buffer_size, int offset, int *transform, std::size_t) {
+
+		const T * __restrict__ b = static_cast<const T *>(buffer) + static_cast<std::size_t>(offset) * BlockSize;
+		T * __restrict__ d = static_cast<T *>(data);
+		const int *idx = buffer_idxlist + offset;
+
+		if (transform == nullptr) {
+			for (int i = 0; i < buffer_size; i++)
+				for (int j = 0; j < BlockSize; j++)
+					d[static_cast<std::size_t>(idx[i]) * BlockSize + j] =
+					    b[static_cast<std::size_t>(i) * BlockSize + j];
+		} else {
+			for (int i = 0; i < buffer_size; i++)
+				for (int j = 0; j < BlockSize; j++)
+					d[static_cast<std::size_t>(transform[idx[i]]) * BlockSize + j] =
+					    b[static_cast<std::size_t>(i) * BlockSize + j];
+		}
+	}
+};
+
+class idxlist {
+
+	public:
+
+		idxlist() : m_idxlist(new_idxlist_empty()) {}
+
+		explicit idxlist(span<const int> list)
+		    : m_idxlist(new_idxlist(const_cast<int *>(list.data()), static_cast<int>(list.size()))) {}
+
+		idxlist(const idxlist&) = delete;
+		idxlist& operator=(const idxlist&) = delete;
+
+		idxlist(idxlist&& other) noexcept : m_idxlist(std::exchange(other.m_idxlist, nullptr)) {}
+
+		idxlist& operator=(idxlist&& other) noexcept {
+			std::swap(m_idxlist, other.m_idxlist);
+			return *this;
+		}
+
+		~idxlist() {
+			if (m_idxlist != nullptr) delete_idxlist(m_idxlist);
+		}
+
+		t_idxlist * get() const noexcept {
+			return m_idxlist;
+		}
+
+	private:
+		t_idxlist *m_idxlist;
+};
+
+/* the map has to outlive the exchangers created from it */
+class map {
+
+	public:
+
+		map(const idxlist& src_idxlist, const idxlist& dst_idxlist, MPI_Comm comm, int stride = -1)
+		    : m_map(new_map(src_idxlist.get(), dst_idxlist.get(), stride, comm)) {}
+
+		map(const map& map2d, int nlevels) : m_map(extend_map_3d(map2d.get(), nlevels)) {}
+
+		map(const map&) = delete;
+		map& operator=(const map&) = delete;
+
+		map(map&& other) noexcept : m_map(std::exchange(other.m_map, nullptr)) {}
+
+		map& operator=(map&& other) noexcept {
+			std::swap(m_map, other.m_map);
+			return *this;
+		}
+
+		~map() {
+			if (m_map != nullptr) delete_map(m_map);
+		}
+
+		t_map * get() const noexcept {
+			return m_map;
+		}
+
+	private:
+		t_map *m_map;
+};
+
+template<class T, int BlockSize = 1>
+class exchanger {
+
+	static_assert(BlockSize > 0, "the block size must be positive");
+
+	public:
+
+		explicit exchanger(const map& map, distdir_hardware hw = CPU)
+		    : m_exchanger(new_exchanger_with_block_size(map.get(), mpi_type<T>::get(),
+		                                                mpi_type<T>::count * BlockSize, hw)),
+		      m_handle(std::make_shared<t_exchanger *>(m_exchanger)) {
+
+			/* the inline kernels replace the C kernels only for plain copies on CPU */
+			t_kernels *vtable = m_exchanger->vtable;
+			if (hw == CPU && vtable->pack == vtable->pack_local &&
+			    vtable->type_size == sizeof(T) * BlockSize) {
+				vtable->pack = vtable->pack_local = kernels<T, BlockSize>::pack;
+				vtable->unpack = vtable->unpack_local = kernels<T, BlockSize>::unpack;
+			}
+		}
+
+		exchanger(const exchanger&) = delete;
+		exchanger& operator=(const exchanger&) = delete;
+
+		exchanger(exchanger&& other) noexcept : m_exchanger(std::exchange(other.m_exchanger, nullptr)),
+		                                         m_handle(std::move(other.m_handle)) {}
+
+		exchanger& operator=(exchanger&& other) noexcept {
+			std::swap(m_exchanger, other.m_exchanger);
+			std::swap(m_handle, other.m_handle);
+			return *this;
+		}
+
+		~exchanger() {
+			/* the futures of the exchanger are released */
+			if (m_handle != nullptr) *m_handle = nullptr;
+			if (m_exchanger != nullptr) delete_exchanger(m_exchanger);
+		}
+
+		void go(span<const T> src_data, span<T> dst_data) {
+			exchanger_go(m_exchanger, const_cast<T *>(src_data.data()), dst_data.data());
+		}
+
+		void go(span<const T> src_data, span<T> dst_data,
+		        span<const int> transform_src, span<const int> transform_dst) {
+			exchanger_go_with_transform(m_exchanger, const_cast<T *>(src_data.data()), dst_data.data(),
+			                            const_cast<int *>(transform_src.data()),
+			                            const_cast<int *>(transform_dst.data()));
+		}
+
+		exchange_future go_async(span<const T> src_data, span<T> dst_data) {
+			exchanger_start(m_exchanger, const_cast<T *>(src_data.data()), dst_data.data());
+			return exchange_future(m_handle);
+		}
+
+		exchange_future go_async(span<const T> src_data, span<T> dst_data,
+		                         span<const int> transform_src, span<const int> transform_dst) {
+			exchanger_start_with_transform(m_exchanger, const_cast<T *>(src_data.data()), dst_data.data(),
+			                               const_cast<int *>(transform_src.data()),
+			                               const_cast<int *>(transform_dst.data()));
+			return exchange_future(m_handle);
+		}
+
+#if defined(__cpp_lib_mdspan)
+		/* multidimensional views with contiguous layout */
+		template<class ExtentsSrc, class LayoutSrc, class AccessorSrc,
+		         class ExtentsDst, class LayoutDst, class AccessorDst>
+		void go(std::mdspan<const T, ExtentsSrc, LayoutSrc, AccessorSrc> src_data,
+		        std::mdspan<T, ExtentsDst, LayoutDst, AccessorDst> dst_data) {
+			static_assert(LayoutSrc::template mapping<ExtentsSrc>::is_always_exhaustive() &&
+			              LayoutDst::template mapping<ExtentsDst>::is_always_exhaustive(),
+			              "the mdspan layout must be contiguous");
+			exchanger_go(m_exchanger, const_cast<T *>(src_data.data_handle()), dst_data.data_handle());
+		}
+#endif
+
+		t_exchanger * get() const noexcept {
+			return m_exchanger;
+		}
+
+	private:
+		t_exchanger *m_exchanger;
+		/* handle shared with the futures (see exchange_future) */
+		exchanger_handle m_handle;
+};
+
+}
+
+#endif
@@ -0,0 +1,201 @@
+/*
+ * @file example_basic10.cpp
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <iostream>
+#include <vector>
+#include <optional>
+#include "mpi.h"
+#include "bindings/C++/distdir_typed.hpp"
+
+#define I_SRC 0
+#define I_DST 1
+#define NCOLS 4
+#define NROWS 4
+
+#if defined(__cpp_impl_coroutine)
+/* minimal coroutine type of a task runtime: the coroutine starts immediately
+ * and its frame is destroyed at the end */
+struct task {
+	struct promise_type {
+		task get_return_object() { return {}; }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+};
+
+/* the coroutine is suspended until both exchanges are completed */
+task exchange_fields(distdir::typed::exchanger<double>& exchanger_double,
+                     distdir::typed::exchanger<int>& exchanger_int,
+                     std::vector<double>& data_double, std::vector<int>& data_int, int& done) {
+
+	auto future_double = exchanger_double.go_async(data_double, data_double);
+	auto future_int = exchanger_int.go_async(data_int, data_int);
+	co_await future_double;
+	co_await future_int;
+	done = 1;
+}
+#endif
+
+/**
+ * @brief Basic example of non blocking exchanges between two 2D domain decomposition
+ *        each using 2 MPI processes.
+ * 
+ * @details The example uses a total of 4 MPI processes over a 4x4 global 2D domain
+ *          with the same domain decomposition of example_basic1.
+ * 
+ *          Ranks 0,1 send data to ranks 2,3
+ * 
+ *          An integer field and a double field are exchanged at the same time, first
+ *          waiting on the futures returned by go_async and then (C++20) in a coroutine
+ *          resumed by the poller of the library. Finally a future is moved out of the
+ *          scope of its exchanger, which is moved and deleted before the future.
+ * 
+ * @ingroup examples
+ */
+int example_basic10() {
+
+	distdir::distdir::Ptr distdir( new distdir::distdir() );
+
+	int world_rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+	int world_size;
+	MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+	int world_role;
+	const int npoints_local = NCOLS * NROWS / 2;
+	int error = 0;
+
+	if (world_size != 4) return 1;
+
+	std::vector<int> list;
+	// index list with global indices
+	if (world_rank < 2) {
+		world_role = I_SRC;
+		int ncols_local = NCOLS / (world_size / 2);
+		for (int i=0; i < NROWS; i++)
+			for (int j=0; j < ncols_local; j++)
+				list.push_back( j + i * NCOLS + world_rank * (NCOLS - ncols_local) );
+	} else {
+		world_role = I_DST;
+		int nrows_local = NROWS / (world_size / 2);
+		for (int i=0; i < nrows_local; i++)
+			for (int j=0; j < NCOLS; j++)
+				list.push_back( j + i * NCOLS + (world_rank - (world_size / 2)) * (NROWS - nrows_local) * NCOLS );
+	}
+
+	{
+		distdir::typed::idxlist idxlist_empty;
+		distdir::typed::idxlist idxlist(list);
+
+		distdir::typed::map map(world_role == I_SRC ? idxlist : idxlist_empty,
+		                        world_role == I_SRC ? idxlist_empty : idxlist,
+		                        MPI_COMM_WORLD);
+
+		distdir::typed::exchanger<double> exchanger_double(map);
+		distdir::typed::exchanger<int> exchanger_int(map);
+
+		std::vector<double> data_double(npoints_local, 0.0);
+		std::vector<int> data_int(npoints_local, 0);
+
+		for (int step = 0; step < 2; step++) {
+
+			// src MPI ranks fill data arrays with the global indices
+			if (world_role == I_SRC)
+				for (int i = 0; i < npoints_local; i++) {
+					data_double[i] = list[i] + 0.5 + step;
+					data_int[i] = list[i] + step;
+				}
+
+			if (step == 0) {
+				auto future_double = exchanger_double.go_async(data_double, data_double);
+				auto future_int = exchanger_int.go_async(data_int, data_int);
+				// computation can be done here
+				while (!future_double.ready());
+				future_int.wait();
+			} else {
+#if defined(__cpp_impl_coroutine)
+				int done = 0;
+				exchange_fields(exchanger_double, exchanger_int, data_double, data_int, done);
+				while (!done)
+					distdir::poller::poll();
+#else
+				exchanger_double.go(data_double, data_double);
+				exchanger_int.go(data_int, data_int);
+#endif
+			}
+
+			if (world_role == I_DST)
+				for (int i = 0; i < npoints_local; i++)
+					if (data_double[i] != list[i] + 0.5 + step || data_int[i] != list[i] + step)
+						error = 1;
+		}
+
+		// a future can outlive its exchanger: deleting the exchanger completes the exchange
+		{
+			std::optional<distdir::exchange_future> future;
+			{
+				distdir::typed::exchanger<int> exchanger_tmp(map);
+				if (world_role == I_SRC)
+					for (int i = 0; i < npoints_local; i++)
+						data_int[i] = list[i] + 2;
+				auto future_tmp = exchanger_tmp.go_async(data_int, data_int);
+				distdir::typed::exchanger<int> exchanger_moved(std::move(exchanger_tmp));
+				future.emplace(std::move(future_tmp));
+			}
+			if (!future->ready()) error = 1;
+			future->wait();
+			if (world_role == I_DST)
+				for (int i = 0; i < npoints_local; i++)
+					if (data_int[i] != list[i] + 2)
+						error = 1;
+		}
+
+		std::cout << world_rank << ": ";
+		for (int i = 0; i < npoints_local; i++)
+			std::cout << "(" << data_double[i] << ", " << data_int[i] << ") ";
+		std::cout << std::endl;
+	}
+
+	distdir.reset();
+
+	return error;
+}
+
+int main() {
+
+	int err = example_basic10();
+	if (err != 0) return err;
+
+	return 0;
+}
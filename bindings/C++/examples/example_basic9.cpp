@@ -0,0 +1,139 @@
+/*
+ * @file example_basic9.cpp
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <iostream>
+#include <vector>
+#include "mpi.h"
+#include "bindings/C++/distdir_typed.hpp"
+
+#define I_SRC 0
+#define I_DST 1
+#define NCOLS 4
+#define NROWS 4
+#define NCOMPONENTS 3
+
+/**
+ * @brief Basic example of exchange with the typed C++ interface between two 2D domain decomposition
+ *        each using 2 MPI processes.
+ * 
+ * @details The example uses a total of 4 MPI processes over a 4x4 global 2D domain
+ *          with the same domain decomposition of example_basic1.
+ * 
+ *          Ranks 0,1 send data to ranks 2,3
+ * 
+ *          A vector field with 3 components per grid point (stored in a C array) and an
+ *          integer field (stored in a std::vector) are exchanged. The MPI datatypes are
+ *          deduced from the element types.
+ * 
+ * @ingroup examples
+ */
+int example_basic9() {
+
+	distdir::distdir::Ptr distdir( new distdir::distdir() );
+
+	int world_rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+	int world_size;
+	MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+	int world_role;
+	const int npoints_local = NCOLS * NROWS / 2;
+	int error = 0;
+
+	if (world_size != 4) return 1;
+
+	std::vector<int> list;
+	// index list with global indices
+	if (world_rank < 2) {
+		world_role = I_SRC;
+		int ncols_local = NCOLS / (world_size / 2);
+		for (int i=0; i < NROWS; i++)
+			for (int j=0; j < ncols_local; j++)
+				list.push_back( j + i * NCOLS + world_rank * (NCOLS - ncols_local) );
+	} else {
+		world_role = I_DST;
+		int nrows_local = NROWS / (world_size / 2);
+		for (int i=0; i < nrows_local; i++)
+			for (int j=0; j < NCOLS; j++)
+				list.push_back( j + i * NCOLS + (world_rank - (world_size / 2)) * (NROWS - nrows_local) * NCOLS );
+	}
+
+	{
+		distdir::typed::idxlist idxlist_empty;
+		distdir::typed::idxlist idxlist(list);
+
+		distdir::typed::map map(world_role == I_SRC ? idxlist : idxlist_empty,
+		                        world_role == I_SRC ? idxlist_empty : idxlist,
+		                        MPI_COMM_WORLD);
+
+		distdir::typed::exchanger<double, NCOMPONENTS> exchanger_vector(map);
+		distdir::typed::exchanger<int> exchanger_int(map);
+
+		double vector_field[npoints_local * NCOMPONENTS] = {0};
+		std::vector<int> int_field(npoints_local, 0);
+
+		// src MPI ranks fill data arrays with the global indices
+		if (world_role == I_SRC)
+			for (int i = 0; i < npoints_local; i++) {
+				for (int k = 0; k < NCOMPONENTS; k++)
+					vector_field[i * NCOMPONENTS + k] = list[i] + 0.1 * k;
+				int_field[i] = list[i];
+			}
+
+		exchanger_vector.go(vector_field, vector_field);
+		exchanger_int.go(int_field, int_field);
+
+		if (world_role == I_DST)
+			for (int i = 0; i < npoints_local; i++) {
+				for (int k = 0; k < NCOMPONENTS; k++)
+					if (vector_field[i * NCOMPONENTS + k] != list[i] + 0.1 * k) error = 1;
+				if (int_field[i] != list[i]) error = 1;
+			}
+
+		std::cout << world_rank << ": ";
+		for (int i = 0; i < npoints_local; i++)
+			std::cout << "(" << vector_field[i * NCOMPONENTS] << ", " << int_field[i] << ") ";
+		std::cout << std::endl;
+	}
+
+	distdir.reset();
+
+	return error;
+}
+
+int main() {
+
+	int err = example_basic9();
+	if (err != 0) return err;
+
+	return 0;
+}
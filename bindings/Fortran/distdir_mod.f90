@@ -33,7 +33,8 @@
 
 MODULE distdir_mod
 
-	USE, INTRINSIC :: ISO_C_BINDING, ONLY: c_ptr, c_int, c_null_ptr
+	USE, INTRINSIC :: ISO_C_BINDING, ONLY: c_ptr, c_int, c_long_long, c_size_t, c_double, &
+	                                          c_null_ptr, c_char, c_null_char, c_funptr
 	IMPLICIT NONE
 
 	PRIVATE
@@ -50,10 +51,56 @@ MODULE distdir_mod
 	INTEGER, PARAMETER :: DISTDIR_EXCHANGER_IsendIrecv2NoWait = 5
 	INTEGER, PARAMETER :: DISTDIR_EXCHANGER_IsendRecv1NoWait  = 6
 	INTEGER, PARAMETER :: DISTDIR_EXCHANGER_IsendRecv2NoWait  = 7
+	INTEGER, PARAMETER :: DISTDIR_EXCHANGER_Auto              = 8
 
 	INTEGER, PARAMETER :: DISTDIR_VERBOSE_TRUE  = 0
 	INTEGER, PARAMETER :: DISTDIR_VERBOSE_FALSE = 1
 
+	INTEGER, PARAMETER :: DISTDIR_PRECISION_FULL     = 0
+	INTEGER, PARAMETER :: DISTDIR_PRECISION_FLOAT    = 1
+	INTEGER, PARAMETER :: DISTDIR_PRECISION_BFLOAT16 = 2
+
+	INTEGER, PARAMETER :: DISTDIR_COMPRESSION_OFF = 0
+	INTEGER, PARAMETER :: DISTDIR_COMPRESSION_ON  = 1
+
+	INTEGER, PARAMETER :: DISTDIR_DELTA_OFF = 0
+	INTEGER, PARAMETER :: DISTDIR_DELTA_ON  = 1
+
+	INTEGER, PARAMETER :: DISTDIR_BUFFER_POOL_OFF = 0
+	INTEGER, PARAMETER :: DISTDIR_BUFFER_POOL_ON  = 1
+
+	INTEGER, PARAMETER :: DISTDIR_ALLOCATOR_MALLOC      = 0
+	INTEGER, PARAMETER :: DISTDIR_ALLOCATOR_FIRST_TOUCH = 1
+	INTEGER, PARAMETER :: DISTDIR_ALLOCATOR_HUGE_PAGES  = 2
+	INTEGER, PARAMETER :: DISTDIR_ALLOCATOR_LOCAL_NODE  = 4
+
+	INTEGER, PARAMETER :: DISTDIR_TIMERS_OFF = 0
+	INTEGER, PARAMETER :: DISTDIR_TIMERS_ON  = 1
+
+	INTEGER, PARAMETER :: DISTDIR_TRACE_OFF = 0
+	INTEGER, PARAMETER :: DISTDIR_TRACE_ON  = 1
+
+	INTEGER, PARAMETER :: DISTDIR_MAP_STATS_NBINS = 32
+
+	! the categories are C indices: report%category(DISTDIR_MEMORY_MAP + 1)
+	INTEGER, PARAMETER :: DISTDIR_MEMORY_NCATEGORIES     = 5
+	INTEGER, PARAMETER :: DISTDIR_MEMORY_IDXLIST         = 0
+	INTEGER, PARAMETER :: DISTDIR_MEMORY_MAP             = 1
+	INTEGER, PARAMETER :: DISTDIR_MEMORY_EXCHANGE        = 2
+	INTEGER, PARAMETER :: DISTDIR_MEMORY_WORKSPACE       = 3
+	INTEGER, PARAMETER :: DISTDIR_MEMORY_INSTRUMENTATION = 4
+
+	INTEGER, PARAMETER :: DISTDIR_REGION_PACK      = 0
+	INTEGER, PARAMETER :: DISTDIR_REGION_UNPACK    = 1
+	INTEGER, PARAMETER :: DISTDIR_REGION_POST_SEND = 2
+	INTEGER, PARAMETER :: DISTDIR_REGION_POST_RECV = 3
+	INTEGER, PARAMETER :: DISTDIR_REGION_RECV      = 4
+	INTEGER, PARAMETER :: DISTDIR_REGION_WAIT      = 5
+	INTEGER, PARAMETER :: DISTDIR_REGION_WAIT_SEND = 6
+	INTEGER, PARAMETER :: DISTDIR_REGION_WAIT_RECV = 7
+	INTEGER, PARAMETER :: DISTDIR_REGION_TEST_RECV = 8
+	INTEGER, PARAMETER :: DISTDIR_REGION_TIMER     = 64
+
 	! note: this type must not be extended to contain any other
 	! components, its memory pattern has to match void * exactly, which
 	! it does because of C constraints
@@ -84,6 +131,78 @@ MODULE distdir_mod
 		TYPE(c_ptr) :: cptr = c_null_ptr
 	END TYPE t_exchanger
 
+	! note: the memory pattern of this type has to match the
+	! t_comm_stats structure
+	TYPE, BIND(C), PUBLIC :: t_comm_stats
+		INTEGER(c_long_long) :: exchanges
+		INTEGER(c_long_long) :: messages_sent
+		INTEGER(c_long_long) :: messages_received
+		INTEGER(c_long_long) :: bytes_sent
+		INTEGER(c_long_long) :: bytes_received
+		INTEGER(c_long_long) :: bytes_self
+		INTEGER(c_int)       :: peers_send
+		INTEGER(c_int)       :: peers_recv
+		INTEGER(c_long_long) :: max_message
+	END TYPE t_comm_stats
+
+	! note: the memory pattern of this type has to match the
+	! t_map_stats structure
+	TYPE, BIND(C), PUBLIC :: t_map_stats
+		INTEGER(c_int)       :: peers_send
+		INTEGER(c_int)       :: peers_recv
+		INTEGER(c_int)       :: messages
+		INTEGER(c_int)       :: min_message
+		INTEGER(c_int)       :: max_message
+		REAL(c_double)       :: mean_message
+		INTEGER(c_int)       :: histogram(DISTDIR_MAP_STATS_NBINS)
+		INTEGER(c_long_long) :: volume
+		INTEGER(c_long_long) :: volume_self
+		REAL(c_double)       :: self_fraction
+		INTEGER(c_long_long) :: runs
+		REAL(c_double)       :: runs_per_message
+		INTEGER(c_size_t)    :: index_memory
+		INTEGER(c_int)       :: global_max_peers_send
+		INTEGER(c_int)       :: global_max_peers_recv
+		INTEGER(c_long_long) :: global_messages
+		INTEGER(c_int)       :: global_min_message
+		INTEGER(c_int)       :: global_max_message
+		REAL(c_double)       :: global_mean_message
+		INTEGER(c_long_long) :: global_histogram(DISTDIR_MAP_STATS_NBINS)
+		INTEGER(c_long_long) :: global_max_volume
+		REAL(c_double)       :: global_mean_volume
+		REAL(c_double)       :: global_self_fraction
+		REAL(c_double)       :: global_runs_per_message
+		INTEGER(c_size_t)    :: global_max_index_memory
+		INTEGER(c_size_t)    :: global_index_memory
+	END TYPE t_map_stats
+
+	! note: the memory pattern of this type has to match the
+	! t_cost_params structure
+	TYPE, BIND(C), PUBLIC :: t_cost_params
+		REAL(c_double) :: latency_intra
+		REAL(c_double) :: bandwidth_intra
+		REAL(c_double) :: latency_inter
+		REAL(c_double) :: bandwidth_inter
+		REAL(c_double) :: pack_bandwidth
+		INTEGER(c_int) :: calibrated
+	END TYPE t_cost_params
+
+	! note: the memory pattern of this type has to match the
+	! t_memory_usage structure
+	TYPE, BIND(C), PUBLIC :: t_memory_usage
+		INTEGER(c_size_t) :: current
+		INTEGER(c_size_t) :: peak
+		INTEGER(c_size_t) :: global_current
+		INTEGER(c_size_t) :: global_peak
+	END TYPE t_memory_usage
+
+	! note: the memory pattern of this type has to match the
+	! t_memory_report structure
+	TYPE, BIND(C), PUBLIC :: t_memory_report
+		TYPE(t_memory_usage) :: category(DISTDIR_MEMORY_NCATEGORIES)
+		TYPE(t_memory_usage) :: total
+	END TYPE t_memory_report
+
 	INTERFACE
 
 		SUBROUTINE distdir_initialize_c() BIND(C, name='distdir_initialize')
@@ -117,6 +236,149 @@ MODULE distdir_mod
 			INTEGER(c_int), VALUE, INTENT(IN) :: verbose_type
 		END SUBROUTINE set_config_verbose_c
 
+		SUBROUTINE set_config_precision_c(precision_type) &
+		                                  BIND(C, name='set_config_precision')
+			IMPORT :: c_int
+			IMPLICIT NONE
+			INTEGER(c_int), VALUE, INTENT(IN) :: precision_type
+		END SUBROUTINE set_config_precision_c
+
+		SUBROUTINE set_config_compression_c(compression_type) &
+		                                    BIND(C, name='set_config_compression')
+			IMPORT :: c_int
+			IMPLICIT NONE
+			INTEGER(c_int), VALUE, INTENT(IN) :: compression_type
+		END SUBROUTINE set_config_compression_c
+
+		SUBROUTINE set_config_delta_c(delta_type) &
+		                              BIND(C, name='set_config_delta')
+			IMPORT :: c_int
+			IMPLICIT NONE
+			INTEGER(c_int), VALUE, INTENT(IN) :: delta_type
+		END SUBROUTINE set_config_delta_c
+
+		SUBROUTINE set_config_buffer_pool_c(buffer_pool_type) &
+		                                    BIND(C, name='set_config_buffer_pool')
+			IMPORT :: c_int
+			IMPLICIT NONE
+			INTEGER(c_int), VALUE, INTENT(IN) :: buffer_pool_type
+		END SUBROUTINE set_config_buffer_pool_c
+
+		SUBROUTINE set_config_allocator_c(allocator_type) &
+		                                  BIND(C, name='set_config_allocator')
+			IMPORT :: c_int
+			IMPLICIT NONE
+			INTEGER(c_int), VALUE, INTENT(IN) :: allocator_type
+		END SUBROUTINE set_config_allocator_c
+
+		SUBROUTINE set_config_timers_c(timers_type) &
+		                               BIND(C, name='set_config_timers')
+			IMPORT :: c_int
+			IMPLICIT NONE
+			INTEGER(c_int), VALUE, INTENT(IN) :: timers_type
+		END SUBROUTINE set_config_timers_c
+
+		SUBROUTINE set_config_trace_c(trace_type) &
+		                              BIND(C, name='set_config_trace')
+			IMPORT :: c_int
+			IMPLICIT NONE
+			INTEGER(c_int), VALUE, INTENT(IN) :: trace_type
+		END SUBROUTINE set_config_trace_c
+
+		SUBROUTINE set_config_timers_report_c(timers_report_type) &
+		                                      BIND(C, name='set_config_timers_report')
+			IMPORT :: c_int
+			IMPLICIT NONE
+			INTEGER(c_int), VALUE, INTENT(IN) :: timers_report_type
+		END SUBROUTINE set_config_timers_report_c
+
+		SUBROUTINE set_config_timers_report_file_c(path) &
+		                                           BIND(C, name='set_config_timers_report_file')
+			IMPORT :: c_char
+			IMPLICIT NONE
+			CHARACTER(kind=c_char), DIMENSION(*), INTENT(IN) :: path
+		END SUBROUTINE set_config_timers_report_file_c
+
+		SUBROUTINE set_config_exchanger_auto_trials_c(trials) &
+		                                              BIND(C, name='set_config_exchanger_auto_trials')
+			IMPORT :: c_int
+			IMPLICIT NONE
+			INTEGER(c_int), VALUE, INTENT(IN) :: trials
+		END SUBROUTINE set_config_exchanger_auto_trials_c
+
+		SUBROUTINE set_config_exchanger_auto_file_c(path) &
+		                                            BIND(C, name='set_config_exchanger_auto_file')
+			IMPORT :: c_char
+			IMPLICIT NONE
+			CHARACTER(kind=c_char), DIMENSION(*), INTENT(IN) :: path
+		END SUBROUTINE set_config_exchanger_auto_file_c
+
+		SUBROUTINE set_config_comm_c(comm) BIND(C, name='set_config_comm_f')
+			IMPORT :: c_int
+			IMPLICIT NONE
+			INTEGER(c_int), VALUE, INTENT(IN) :: comm
+		END SUBROUTINE set_config_comm_c
+
+		SUBROUTINE distdir_dump_trace_c(path) &
+		                                BIND(C, name='distdir_dump_trace')
+			IMPORT :: c_char
+			IMPLICIT NONE
+			CHARACTER(kind=c_char), DIMENSION(*), INTENT(IN) :: path
+		END SUBROUTINE distdir_dump_trace_c
+
+		SUBROUTINE distdir_set_hooks_c(begin_fn, end_fn, user_ctx) &
+		                               BIND(C, name='distdir_set_hooks')
+			IMPORT :: c_funptr, c_ptr
+			IMPLICIT NONE
+			TYPE(c_funptr), VALUE, INTENT(IN) :: begin_fn
+			TYPE(c_funptr), VALUE, INTENT(IN) :: end_fn
+			TYPE(c_ptr),    VALUE, INTENT(IN) :: user_ctx
+		END SUBROUTINE distdir_set_hooks_c
+
+		SUBROUTINE distdir_get_comm_stats_c(stats) &
+		                                    BIND(C, name='distdir_get_comm_stats')
+			IMPORT :: t_comm_stats
+			IMPLICIT NONE
+			TYPE(t_comm_stats), INTENT(OUT) :: stats
+		END SUBROUTINE distdir_get_comm_stats_c
+
+		SUBROUTINE distdir_reset_comm_stats_c() BIND(C, name='distdir_reset_comm_stats')
+		END SUBROUTINE distdir_reset_comm_stats_c
+
+		SUBROUTINE distdir_dump_comm_matrix_c(path) &
+		                                      BIND(C, name='distdir_dump_comm_matrix')
+			IMPORT :: c_char
+			IMPLICIT NONE
+			CHARACTER(kind=c_char), DIMENSION(*), INTENT(IN) :: path
+		END SUBROUTINE distdir_dump_comm_matrix_c
+
+		SUBROUTINE distdir_calibrate_c(comm) BIND(C, name='distdir_calibrate_f')
+			IMPORT :: c_int
+			IMPLICIT NONE
+			INTEGER(c_int), VALUE, INTENT(IN) :: comm
+		END SUBROUTINE distdir_calibrate_c
+
+		SUBROUTINE distdir_get_cost_params_c(params) &
+		                                     BIND(C, name='distdir_get_cost_params')
+			IMPORT :: t_cost_params
+			IMPLICIT NONE
+			TYPE(t_cost_params), INTENT(OUT) :: params
+		END SUBROUTINE distdir_get_cost_params_c
+
+		SUBROUTINE distdir_set_cost_params_c(params) &
+		                                     BIND(C, name='distdir_set_cost_params')
+			IMPORT :: t_cost_params
+			IMPLICIT NONE
+			TYPE(t_cost_params), INTENT(IN) :: params
+		END SUBROUTINE distdir_set_cost_params_c
+
+		SUBROUTINE distdir_memory_report_c(report) &
+		                                   BIND(C, name='distdir_memory_report')
+			IMPORT :: t_memory_report
+			IMPLICIT NONE
+			TYPE(t_memory_report), INTENT(OUT) :: report
+		END SUBROUTINE distdir_memory_report_c
+
 		! this function must not be implemented in Fortran because
 		! PGI 11.x chokes on that
 		FUNCTION t_idxlist_f2c(idxlist) BIND(c, name='t_idxlist_f2c') RESULT(p)
@@ -181,6 +443,32 @@ MODULE distdir_mod
 			TYPE(c_ptr), VALUE, INTENT(in) :: ptr
 		END SUBROUTINE delete_map_c
 
+		SUBROUTINE map_stats_c(ptr, stats) BIND(C, name='map_stats')
+			IMPORT :: c_ptr, t_map_stats
+			IMPLICIT NONE
+			TYPE(c_ptr), VALUE, INTENT(in) :: ptr
+			TYPE(t_map_stats), INTENT(OUT) :: stats
+		END SUBROUTINE map_stats_c
+
+		FUNCTION map_predict_cost_c(map, type, mode) &
+		                            BIND(C, name='map_predict_cost_f') RESULT(time)
+			IMPORT :: t_map, c_int, c_double
+			IMPLICIT NONE
+			TYPE(t_map), INTENT(IN) :: map
+			INTEGER(c_int), VALUE, INTENT(IN) :: type
+			INTEGER(c_int), VALUE, INTENT(IN) :: mode
+			REAL(c_double) :: time
+		END FUNCTION map_predict_cost_c
+
+		FUNCTION map_predict_exchanger_c(map, type) &
+		                                 BIND(C, name='map_predict_exchanger_f') RESULT(mode)
+			IMPORT :: t_map, c_int
+			IMPLICIT NONE
+			TYPE(t_map), INTENT(IN) :: map
+			INTEGER(c_int), VALUE, INTENT(IN) :: type
+			INTEGER(c_int) :: mode
+		END FUNCTION map_predict_exchanger_c
+
 		! this function must not be implemented in Fortran because
 		! PGI 11.x chokes on that
 		FUNCTION t_exchanger_f2c(exchanger) BIND(c, name='t_exchanger_f2c') RESULT(p)
@@ -200,6 +488,17 @@ MODULE distdir_mod
 			TYPE(c_ptr) :: exchanger_ptr
 		END FUNCTION new_exchanger_c
 
+		FUNCTION new_exchanger_with_block_size_c(map, type, block_size, hw) &
+		                        BIND(C, name='new_exchanger_with_block_size_f') RESULT(exchanger_ptr)
+			IMPORT :: c_ptr, c_int, t_map
+			IMPLICIT NONE
+			TYPE(t_map), INTENT(in) :: map
+			INTEGER(c_int), VALUE, INTENT(IN) :: type
+			INTEGER(c_int), VALUE, INTENT(IN) :: block_size
+			INTEGER(c_int), VALUE, INTENT(IN) :: hw
+			TYPE(c_ptr) :: exchanger_ptr
+		END FUNCTION new_exchanger_with_block_size_c
+
 		SUBROUTINE delete_exchanger_c(ptr) BIND(C, name='delete_exchanger')
 			IMPORT :: c_ptr
 			IMPLICIT NONE
@@ -225,6 +524,14 @@ MODULE distdir_mod
 			INTEGER(c_int),     INTENT(IN) :: transform_dst(*)
 		END SUBROUTINE exchanger_go_with_transform_c
 
+		SUBROUTINE exchanger_get_comm_stats_c(exchanger, stats) &
+		                                      BIND(C, name='exchanger_get_comm_stats_f')
+			IMPORT :: t_exchanger, t_comm_stats
+			IMPLICIT NONE
+			TYPE(t_exchanger),  INTENT(IN)  :: exchanger
+			TYPE(t_comm_stats), INTENT(OUT) :: stats
+		END SUBROUTINE exchanger_get_comm_stats_c
+
 	END INTERFACE
 
 	INTERFACE new_map
@@ -241,6 +548,7 @@ MODULE distdir_mod
 	INTERFACE new_exchanger
 		MODULE PROCEDURE :: new_exchanger_full
 		MODULE PROCEDURE :: new_exchanger_cpu
+		MODULE PROCEDURE :: new_exchanger_block
 	END INTERFACE
 
 	INTERFACE exchanger_go
@@ -250,16 +558,40 @@ MODULE distdir_mod
 
 	PUBLIC :: DISTDIR_HW_CPU, DISTDIR_HW_GPU_AMD, DISTDIR_HW_GPU_NVIDIA
 	PUBLIC :: DISTDIR_VERBOSE_TRUE, DISTDIR_VERBOSE_FALSE
+	PUBLIC :: DISTDIR_PRECISION_FULL, DISTDIR_PRECISION_FLOAT, DISTDIR_PRECISION_BFLOAT16
+	PUBLIC :: DISTDIR_COMPRESSION_OFF, DISTDIR_COMPRESSION_ON
+	PUBLIC :: DISTDIR_DELTA_OFF, DISTDIR_DELTA_ON
+	PUBLIC :: DISTDIR_BUFFER_POOL_OFF, DISTDIR_BUFFER_POOL_ON
+	PUBLIC :: DISTDIR_ALLOCATOR_MALLOC, DISTDIR_ALLOCATOR_FIRST_TOUCH
+	PUBLIC :: DISTDIR_ALLOCATOR_HUGE_PAGES, DISTDIR_ALLOCATOR_LOCAL_NODE
+	PUBLIC :: DISTDIR_TIMERS_OFF, DISTDIR_TIMERS_ON
+	PUBLIC :: DISTDIR_TRACE_OFF, DISTDIR_TRACE_ON
 	PUBLIC :: DISTDIR_EXCHANGER_IsendIrecv1, DISTDIR_EXCHANGER_IsendIrecv1NoWait
 	PUBLIC :: DISTDIR_EXCHANGER_IsendIrecv2, DISTDIR_EXCHANGER_IsendIrecv2NoWait
 	PUBLIC :: DISTDIR_EXCHANGER_IsendRecv1, DISTDIR_EXCHANGER_IsendRecv1NoWait
 	PUBLIC :: DISTDIR_EXCHANGER_IsendRecv2, DISTDIR_EXCHANGER_IsendRecv2NoWait
+	PUBLIC :: DISTDIR_EXCHANGER_Auto
 	PUBLIC :: distdir_initialize, distdir_finalize
-	PUBLIC :: set_config_exchanger, set_config_verbose
+	PUBLIC :: set_config_exchanger, set_config_verbose, set_config_precision
+	PUBLIC :: set_config_compression, set_config_delta, set_config_buffer_pool
+	PUBLIC :: set_config_allocator, set_config_timers, set_config_trace
+	PUBLIC :: set_config_timers_report, set_config_timers_report_file, set_config_comm
+	PUBLIC :: set_config_exchanger_auto_trials, set_config_exchanger_auto_file
+	PUBLIC :: distdir_dump_trace, distdir_set_hooks
+	PUBLIC :: DISTDIR_REGION_PACK, DISTDIR_REGION_UNPACK
+	PUBLIC :: DISTDIR_REGION_POST_SEND, DISTDIR_REGION_POST_RECV, DISTDIR_REGION_RECV
+	PUBLIC :: DISTDIR_REGION_WAIT, DISTDIR_REGION_WAIT_SEND, DISTDIR_REGION_WAIT_RECV
+	PUBLIC :: DISTDIR_REGION_TEST_RECV, DISTDIR_REGION_TIMER
+	PUBLIC :: distdir_get_comm_stats, distdir_reset_comm_stats, distdir_dump_comm_matrix
+	PUBLIC :: distdir_calibrate, distdir_get_cost_params, distdir_set_cost_params
+	PUBLIC :: DISTDIR_MEMORY_NCATEGORIES, DISTDIR_MEMORY_IDXLIST, DISTDIR_MEMORY_MAP
+	PUBLIC :: DISTDIR_MEMORY_EXCHANGE, DISTDIR_MEMORY_WORKSPACE, DISTDIR_MEMORY_INSTRUMENTATION
+	PUBLIC :: distdir_memory_report
 	PUBLIC :: new_group
 	PUBLIC :: new_idxlist, delete_idxlist
-	PUBLIC :: new_map, delete_map
-	PUBLIC :: new_exchanger, delete_exchanger, exchanger_go
+	PUBLIC :: DISTDIR_MAP_STATS_NBINS
+	PUBLIC :: new_map, delete_map, map_stats, map_predict_cost, map_predict_exchanger
+	PUBLIC :: new_exchanger, delete_exchanger, exchanger_go, exchanger_get_comm_stats
 
 	CONTAINS
 
@@ -293,6 +625,137 @@ MODULE distdir_mod
 		CALL set_config_verbose_c(verbose_type)
 	END SUBROUTINE set_config_verbose
 
+	SUBROUTINE set_config_precision(precision_type)
+		INTEGER, INTENT(IN) :: precision_type
+
+		CALL set_config_precision_c(precision_type)
+	END SUBROUTINE set_config_precision
+
+	SUBROUTINE set_config_compression(compression_type)
+		INTEGER, INTENT(IN) :: compression_type
+
+		CALL set_config_compression_c(compression_type)
+	END SUBROUTINE set_config_compression
+
+	SUBROUTINE set_config_delta(delta_type)
+		INTEGER, INTENT(IN) :: delta_type
+
+		CALL set_config_delta_c(delta_type)
+	END SUBROUTINE set_config_delta
+
+	SUBROUTINE set_config_buffer_pool(buffer_pool_type)
+		INTEGER, INTENT(IN) :: buffer_pool_type
+
+		CALL set_config_buffer_pool_c(buffer_pool_type)
+	END SUBROUTINE set_config_buffer_pool
+
+	SUBROUTINE set_config_allocator(allocator_type)
+		INTEGER, INTENT(IN) :: allocator_type
+
+		CALL set_config_allocator_c(allocator_type)
+	END SUBROUTINE set_config_allocator
+
+	SUBROUTINE set_config_timers(timers_type)
+		INTEGER, INTENT(IN) :: timers_type
+
+		CALL set_config_timers_c(timers_type)
+	END SUBROUTINE set_config_timers
+
+	SUBROUTINE set_config_trace(trace_type)
+		INTEGER, INTENT(IN) :: trace_type
+
+		CALL set_config_trace_c(trace_type)
+	END SUBROUTINE set_config_trace
+
+	SUBROUTINE set_config_timers_report(timers_report_type)
+		INTEGER, INTENT(IN) :: timers_report_type
+
+		CALL set_config_timers_report_c(timers_report_type)
+	END SUBROUTINE set_config_timers_report
+
+	SUBROUTINE set_config_timers_report_file(path)
+		CHARACTER(len=*), INTENT(IN) :: path
+
+		CALL set_config_timers_report_file_c(TRIM(path) // c_null_char)
+	END SUBROUTINE set_config_timers_report_file
+
+	SUBROUTINE set_config_exchanger_auto_trials(trials)
+		INTEGER, INTENT(IN) :: trials
+
+		CALL set_config_exchanger_auto_trials_c(trials)
+	END SUBROUTINE set_config_exchanger_auto_trials
+
+	SUBROUTINE set_config_exchanger_auto_file(path)
+		CHARACTER(len=*), INTENT(IN) :: path
+
+		CALL set_config_exchanger_auto_file_c(TRIM(path) // c_null_char)
+	END SUBROUTINE set_config_exchanger_auto_file
+
+	SUBROUTINE set_config_comm(comm)
+		INTEGER, INTENT(IN) :: comm
+
+		CALL set_config_comm_c(comm)
+	END SUBROUTINE set_config_comm
+
+	SUBROUTINE distdir_dump_trace(path)
+		CHARACTER(len=*), INTENT(IN) :: path
+
+		CALL distdir_dump_trace_c(TRIM(path) // c_null_char)
+	END SUBROUTINE distdir_dump_trace
+
+	! the hooks are BIND(C) subroutines with arguments
+	! (INTEGER(c_int), VALUE :: region, TYPE(c_ptr), VALUE :: name,
+	!  INTEGER(c_int), VALUE :: peer, INTEGER(c_size_t), VALUE :: bytes,
+	!  TYPE(c_ptr), VALUE :: user_ctx) passed with c_funloc
+	SUBROUTINE distdir_set_hooks(begin_fn, end_fn, user_ctx)
+		TYPE(c_funptr), INTENT(IN) :: begin_fn
+		TYPE(c_funptr), INTENT(IN) :: end_fn
+		TYPE(c_ptr),    INTENT(IN) :: user_ctx
+
+		CALL distdir_set_hooks_c(begin_fn, end_fn, user_ctx)
+	END SUBROUTINE distdir_set_hooks
+
+	SUBROUTINE distdir_get_comm_stats(stats)
+		TYPE(t_comm_stats), INTENT(OUT) :: stats
+
+		CALL distdir_get_comm_stats_c(stats)
+	END SUBROUTINE distdir_get_comm_stats
+
+	SUBROUTINE distdir_reset_comm_stats()
+
+		CALL distdir_reset_comm_stats_c()
+	END SUBROUTINE distdir_reset_comm_stats
+
+	SUBROUTINE distdir_dump_comm_matrix(path)
+		CHARACTER(len=*), INTENT(IN) :: path
+
+		CALL distdir_dump_comm_matrix_c(TRIM(path) // c_null_char)
+	END SUBROUTINE distdir_dump_comm_matrix
+
+	SUBROUTINE distdir_calibrate(comm)
+		INTEGER, INTENT(IN) :: comm
+
+		CALL distdir_calibrate_c(comm)
+	END SUBROUTINE distdir_calibrate
+
+	SUBROUTINE distdir_get_cost_params(params)
+		TYPE(t_cost_params), INTENT(OUT) :: params
+
+		CALL distdir_get_cost_params_c(params)
+	END SUBROUTINE distdir_get_cost_params
+
+	SUBROUTINE distdir_set_cost_params(params)
+		TYPE(t_cost_params), INTENT(IN) :: params
+
+		CALL distdir_set_cost_params_c(params)
+	END SUBROUTINE distdir_set_cost_params
+
+	SUBROUTINE distdir_memory_report(report)
+		TYPE(t_memory_report), INTENT(OUT) :: report
+
+		CALL distdir_memory_report_c(report)
+	END SUBROUTINE distdir_memory_report
+
 	FUNCTION t_idxlist_c2f(idxlist) RESULT(p)
 		TYPE(c_ptr), INTENT(in) :: idxlist
 		TYPE(t_idxlist) :: p
@@ -361,6 +824,30 @@ MODULE distdir_mod
 		map%cptr = c_null_ptr
 	END SUBROUTINE delete_map
 
+	SUBROUTINE map_stats(map, stats)
+		type(t_map), INTENT(IN) :: map
+		type(t_map_stats), INTENT(OUT) :: stats
+
+		CALL map_stats_c(map%cptr, stats)
+	END SUBROUTINE map_stats
+
+	FUNCTION map_predict_cost(map, type, mode) RESULT(time)
+		type(t_map), INTENT(IN) :: map
+		INTEGER,     INTENT(IN) :: type
+		INTEGER,     INTENT(IN) :: mode
+		DOUBLE PRECISION :: time
+
+		time = map_predict_cost_c(map, type, mode)
+	END FUNCTION map_predict_cost
+
+	FUNCTION map_predict_exchanger(map, type) RESULT(mode)
+		type(t_map), INTENT(IN) :: map
+		INTEGER,     INTENT(IN) :: type
+		INTEGER :: mode
+
+		mode = map_predict_exchanger_c(map, type)
+	END FUNCTION map_predict_exchanger
+
 	FUNCTION t_exchanger_c2f(exchanger) RESULT(p)
 		TYPE(c_ptr), INTENT(in) :: exchanger
 		TYPE(t_exchanger) :: p
@@ -384,6 +871,16 @@ MODULE distdir_mod
 		exchanger = t_exchanger_c2f(new_exchanger_c(map, type, DISTDIR_HW_CPU))
 	END SUBROUTINE new_exchanger_cpu
 
+	SUBROUTINE new_exchanger_block(exchanger, map, type, block_size, hw)
+		type(t_exchanger), INTENT(OUT) :: exchanger
+		type(t_map),       INTENT(IN)  :: map
+		INTEGER,           INTENT(IN)  :: type
+		INTEGER,           INTENT(IN)  :: block_size
+		INTEGER,           INTENT(IN)  :: hw
+
+		exchanger = t_exchanger_c2f(new_exchanger_with_block_size_c(map, type, block_size, hw))
+	END SUBROUTINE new_exchanger_block
+
 	SUBROUTINE delete_exchanger(exchanger)
 		type(t_exchanger), INTENT(INOUT) :: exchanger
 
@@ -409,4 +906,11 @@ MODULE distdir_mod
 		CALL exchanger_go_with_transform_c(exchanger, src_data, dst_data, transform_src, transform_dst)
 	END SUBROUTINE exchanger_go_with_transform
 
+	SUBROUTINE exchanger_get_comm_stats(exchanger, stats)
+		TYPE(t_exchanger),  INTENT(IN)  :: exchanger
+		TYPE(t_comm_stats), INTENT(OUT) :: stats
+
+		CALL exchanger_get_comm_stats_c(exchanger, stats)
+	END SUBROUTINE exchanger_get_comm_stats
+
 END MODULE distdir_mod
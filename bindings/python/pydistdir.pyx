@@ -32,12 +32,16 @@
 #
  
 import cython
+import sys
 
 import numpy as _np
 cimport mpi4py.libmpi as libmpi
 cimport mpi4py.MPI as MPI
 from mpi4py import MPI
-from enum import IntEnum
+from enum import IntEnum, IntFlag
+
+from cpython.buffer cimport PyObject_GetBuffer, PyBuffer_Release
+from cpython.buffer cimport PyBUF_C_CONTIGUOUS, PyBUF_FORMAT, PyBUF_WRITABLE
 
 cdef extern from "Python.h":
 	int Py_AtExit(void (*)())
@@ -65,6 +69,62 @@ cdef extern from "src/distdir.h":
 	void distdir_finalize()
 	void set_config_exchanger(int exchanger_type)
 	void set_config_verbose(int verbose_type)
+	void set_config_precision(int precision_type)
+	void set_config_compression(int compression_type)
+	void set_config_delta(int delta_type)
+	void set_config_buffer_pool(int buffer_pool_type)
+	void set_config_allocator(int allocator_type)
+	void set_config_timers(int timers_type)
+	void set_config_trace(int trace_type)
+	void set_config_timers_report(int timers_report_type)
+	void set_config_timers_report_file(const char *path)
+	void set_config_exchanger_auto_trials(int trials)
+	void set_config_exchanger_auto_file(const char *path)
+	void set_config_comm(libmpi.MPI_Comm comm)
+	void distdir_dump_trace(const char *path)
+
+	ctypedef void (*distdir_hook) (int, const char *, int, size_t, void *)
+
+	void distdir_set_hooks(distdir_hook begin_fn, distdir_hook end_fn, void *user_ctx)
+
+	ctypedef struct t_comm_stats:
+		long long exchanges
+		long long messages_sent
+		long long messages_received
+		long long bytes_sent
+		long long bytes_received
+		long long bytes_self
+		int peers_send
+		int peers_recv
+		long long max_message
+
+	void distdir_get_comm_stats(t_comm_stats *stats)
+	void distdir_reset_comm_stats()
+	void distdir_dump_comm_matrix(const char *path)
+
+	ctypedef struct t_cost_params:
+		double latency_intra
+		double bandwidth_intra
+		double latency_inter
+		double bandwidth_inter
+		double pack_bandwidth
+		int calibrated
+
+	void distdir_calibrate(libmpi.MPI_Comm comm)
+	void distdir_get_cost_params(t_cost_params *params)
+	void distdir_set_cost_params(const t_cost_params *params)
+
+	ctypedef struct t_memory_usage:
+		size_t current
+		size_t peak
+		size_t global_current
+		size_t global_peak
+
+	ctypedef struct t_memory_report:
+		t_memory_usage category[5]
+		t_memory_usage total
+
+	void distdir_memory_report(t_memory_report *report)
 	void new_group(libmpi.MPI_Comm * new_comm, libmpi.MPI_Comm work_comm, int id)
 
 	ctypedef struct t_idxlist:
@@ -95,7 +155,39 @@ cdef extern from "src/distdir.h":
 	t_map * extend_map_3d(t_map *map2d, int nlevels);
 	void delete_map(t_map *map);
 
-	ctypedef void (*kernel_func_pack) ( void*, void*, int*, int, int, int* );
+	ctypedef struct t_map_stats:
+		int peers_send
+		int peers_recv
+		int messages
+		int min_message
+		int max_message
+		double mean_message
+		int histogram[32]
+		long long volume
+		long long volume_self
+		double self_fraction
+		long long runs
+		double runs_per_message
+		size_t index_memory
+		int global_max_peers_send
+		int global_max_peers_recv
+		long long global_messages
+		int global_min_message
+		int global_max_message
+		double global_mean_message
+		long long global_histogram[32]
+		long long global_max_volume
+		double global_mean_volume
+		double global_self_fraction
+		double global_runs_per_message
+		size_t global_max_index_memory
+		size_t global_index_memory
+
+	void map_stats(t_map *map, t_map_stats *stats)
+	double map_predict_cost(t_map *map, libmpi.MPI_Datatype type, int mode)
+	int map_predict_exchanger(t_map *map, libmpi.MPI_Datatype type)
+
+	ctypedef void (*kernel_func_pack) ( void*, void*, int*, int, int, int*, size_t );
 
 	ctypedef void* (*kernel_func_alloc) (size_t);
 
@@ -106,18 +198,23 @@ cdef extern from "src/distdir.h":
 		kernel_func_pack unpack
 		kernel_func_alloc allocator
 		kernel_func_free deallocator
+		size_t type_size
+		kernel_func_pack pack_local
+		kernel_func_pack unpack_local
+		size_t local_type_size
 
 	ctypedef void (*kernel_backend_func_wait) (int, libmpi.MPI_Request *, libmpi.MPI_Status *);
 
 	ctypedef void (*kernel_func_isendirecv) ( void *, int , libmpi.MPI_Datatype, int, int,
-	                                          libmpi.MPI_Comm, libmpi.MPI_Request *, int ) ;
+	                                          libmpi.MPI_Comm, libmpi.MPI_Request *, libmpi.MPI_Aint ) ;
 
 	ctypedef void (*kernel_func_recv)  ( void *, int, libmpi.MPI_Datatype, int, int,
-	                                     libmpi.MPI_Comm, libmpi.MPI_Status * , int) ;
+	                                     libmpi.MPI_Comm, libmpi.MPI_Status * , libmpi.MPI_Aint) ;
 
 	ctypedef struct t_mpi_exchange:
 		libmpi.MPI_Datatype type
 		libmpi.MPI_Aint type_size
+		int type_is_block
 		libmpi.MPI_Request *req
 		libmpi.MPI_Status *stat
 		int nreq_send
@@ -132,6 +229,13 @@ cdef extern from "src/distdir.h":
 		int buffer_size
 		void *buffer
 		int *buffer_idxlist
+		int self
+		void *self_buffer
+		void *compression
+		void *delta
+		int pooled
+		void *block
+		void *pending
 
 	ctypedef void (*backend_func_wait) (t_mpi_exchange*);
 
@@ -150,17 +254,99 @@ cdef extern from "src/distdir.h":
 		t_wait* vtable_wait
 		t_map *map
 		t_mpi_exchange *mpi_exchange
+		int block_size
+		void *request
+		void *pattern
 
 	t_exchanger* new_exchanger(t_map *map, libmpi.MPI_Datatype type, distdir_hardware hw)
-	void exchanger_go(t_exchanger* exchanger, void *src_data, void* dst_data)
+	t_exchanger* new_exchanger_with_block_size(t_map *map, libmpi.MPI_Datatype type, int block_size,
+	                                           distdir_hardware hw)
+	void exchanger_go(t_exchanger* exchanger, void *src_data, void* dst_data) nogil
 	void exchanger_go_with_transform(t_exchanger* exchanger, void *src_data, void* dst_data,
-	                                 int *transform_src, int *transform_dst)
+	                                 int *transform_src, int *transform_dst) nogil
+	void exchanger_get_comm_stats(t_exchanger* exchanger, t_comm_stats *stats)
 	void delete_exchanger(t_exchanger * exchanger)
 
 class pydistdir_verbose(IntEnum):
 	verbose_true  = 0
 	verbose_false = 1
 
+class pydistdir_precision(IntEnum):
+	precision_full     = 0
+	precision_float    = 1
+	precision_bfloat16 = 2
+
+class pydistdir_compression(IntEnum):
+	compression_off = 0
+	compression_on  = 1
+
+class pydistdir_delta(IntEnum):
+	delta_off = 0
+	delta_on  = 1
+
+class pydistdir_buffer_pool(IntEnum):
+	buffer_pool_off = 0
+	buffer_pool_on  = 1
+
+class pydistdir_allocator(IntFlag):
+	allocator_malloc      = 0
+	allocator_first_touch = 1
+	allocator_huge_pages  = 2
+	allocator_local_node  = 4
+
+class pydistdir_timers(IntEnum):
+	timers_off = 0
+	timers_on  = 1
+
+class pydistdir_timers_report(IntEnum):
+	timers_report_off     = 0
+	timers_report_summary = 1
+	timers_report_full    = 2
+
+class pydistdir_trace(IntEnum):
+	trace_off = 0
+	trace_on  = 1
+
+class pydistdir_region(IntEnum):
+	region_pack                        = 0
+	region_unpack                      = 1
+	region_post_send                   = 2
+	region_post_recv                   = 3
+	region_recv                        = 4
+	region_wait                        = 5
+	region_wait_send                   = 6
+	region_wait_recv                   = 7
+	region_test_recv                   = 8
+	region_new_idxlist                 = 16
+	region_new_idxlist_empty           = 17
+	region_delete_idxlist              = 18
+	region_new_map                     = 19
+	region_extend_map_3d               = 20
+	region_map_stats                   = 21
+	region_delete_map                  = 22
+	region_map_idxlist_to_RD_decomp    = 23
+	region_map_RD_decomp_to_idxlist    = 24
+	region_new_exchanger               = 25
+	region_exchanger_go                = 26
+	region_exchanger_go_with_transform = 27
+	region_exchanger_start             = 28
+	region_exchanger_wait              = 29
+	region_delete_exchanger            = 30
+	region_exchanger_IsendIrecv1       = 31
+	region_exchanger_IsendIrecv2       = 32
+	region_exchanger_IsendRecv1        = 33
+	region_exchanger_IsendRecv2        = 34
+	region_timer                       = 64
+
+cdef object _hook_begin = None
+cdef object _hook_end = None
+
+cdef void _hook_begin_c(int region, const char *name, int peer, size_t nbytes, void *user_ctx) noexcept with gil:
+	_hook_begin(region, name.decode(), peer, nbytes)
+
+cdef void _hook_end_c(int region, const char *name, int peer, size_t nbytes, void *user_ctx) noexcept with gil:
+	_hook_end(region, name.decode(), peer, nbytes)
+
 class pydistdir_hardware(IntEnum):
 	CPU        = 0
 	GPU_NVIDIA = 1
@@ -175,6 +361,7 @@ class pydistdir_exchanger(IntEnum):
 	IsendIrecv2NoWait = 5
 	IsendRecv1NoWait  = 6
 	IsendRecv2NoWait  = 7
+	Auto              = 8
 
 cdef class distdir:
 	def __init__(self):
@@ -189,6 +376,80 @@ cdef class distdir:
 	def verbose(self, verbose_type):
 		set_config_verbose(verbose_type)
 
+	def precision(self, precision_type):
+		set_config_precision(precision_type)
+
+	def compression(self, compression_type):
+		set_config_compression(compression_type)
+
+	def delta(self, delta_type):
+		set_config_delta(delta_type)
+
+	def buffer_pool(self, buffer_pool_type):
+		set_config_buffer_pool(buffer_pool_type)
+
+	def allocator(self, allocator_type):
+		set_config_allocator(allocator_type)
+
+	def timers(self, timers_type):
+		set_config_timers(timers_type)
+
+	def trace(self, trace_type):
+		set_config_trace(trace_type)
+
+	def timers_report(self, timers_report_type):
+		set_config_timers_report(timers_report_type)
+
+	def timers_report_file(self, path):
+		set_config_timers_report_file(path.encode())
+
+	def exchanger_auto_trials(self, trials):
+		set_config_exchanger_auto_trials(trials)
+
+	def exchanger_auto_file(self, path):
+		set_config_exchanger_auto_file(path.encode())
+
+	def comm(self, MPI.Comm comm):
+		set_config_comm(comm.ob_mpi)
+
+	def dump_trace(self, path):
+		distdir_dump_trace(path.encode())
+
+	def set_hooks(self, begin_fn=None, end_fn=None):
+		global _hook_begin, _hook_end
+		_hook_begin = begin_fn
+		_hook_end = end_fn
+		distdir_set_hooks(_hook_begin_c if begin_fn is not None else NULL,
+		                  _hook_end_c if end_fn is not None else NULL, NULL)
+
+	def comm_stats(self):
+		cdef t_comm_stats stats
+		distdir_get_comm_stats(&stats)
+		return stats
+
+	def reset_comm_stats(self):
+		distdir_reset_comm_stats()
+
+	def dump_comm_matrix(self, path):
+		distdir_dump_comm_matrix(path.encode())
+
+	def calibrate(self, MPI.Comm comm):
+		distdir_calibrate(comm.ob_mpi)
+
+	def cost_params(self):
+		cdef t_cost_params params
+		distdir_get_cost_params(&params)
+		return params
+
+	def set_cost_params(self, params):
+		cdef t_cost_params params_c = params
+		distdir_set_cost_params(&params_c)
+
+	def memory_report(self):
+		cdef t_memory_report report
+		distdir_memory_report(&report)
+		return report
+
 	def group(self, MPI.Comm new_comm, MPI.Comm work_comm, id):
 		new_group(&new_comm.ob_mpi, work_comm.ob_mpi, id)
 
@@ -248,12 +509,131 @@ cdef class map:
 	def cleanup(self):
 		delete_map((<map?>self)._map)
 
+	def stats(self):
+		"""
+		Statistics about the communication pattern of the map (collective call).
+		"""
+		cdef t_map_stats stats
+		map_stats(self._map, &stats)
+		return stats
+
+	def predict_cost(self, MPI.Datatype type, mode):
+		"""
+		Predicted time in seconds of an exchange of the map with the given
+		datatype and exchanger type (collective call).
+		"""
+		return map_predict_cost(self._map, type.ob_mpi, mode)
+
+	def predict_exchanger(self, MPI.Datatype type):
+		"""
+		Exchanger type with the lowest predicted time (collective call).
+		"""
+		return map_predict_exchanger(self._map, type.ob_mpi)
+
+
+# Kind of the values of each supported MPI datatype: 'f' floating point, 'i' signed integer,
+# 'u' unsigned integer, 'b' boolean and 'x' any value of one byte.
+_mpi_type_kinds = (
+	(MPI.DOUBLE            , 'f'),
+	(MPI.FLOAT             , 'f'),
+	(MPI.LONG_DOUBLE       , 'f'),
+	(MPI.INT               , 'i'),
+	(MPI.SHORT             , 'i'),
+	(MPI.LONG              , 'i'),
+	(MPI.LONG_LONG         , 'i'),
+	(MPI.SIGNED_CHAR       , 'i'),
+	(MPI.INT8_T            , 'i'),
+	(MPI.INT16_T           , 'i'),
+	(MPI.INT32_T           , 'i'),
+	(MPI.INT64_T           , 'i'),
+	(MPI.UNSIGNED          , 'u'),
+	(MPI.UNSIGNED_SHORT    , 'u'),
+	(MPI.UNSIGNED_LONG     , 'u'),
+	(MPI.UNSIGNED_LONG_LONG, 'u'),
+	(MPI.UNSIGNED_CHAR     , 'u'),
+	(MPI.UINT8_T           , 'u'),
+	(MPI.UINT16_T          , 'u'),
+	(MPI.UINT32_T          , 'u'),
+	(MPI.UINT64_T          , 'u'),
+	(MPI.C_BOOL            , 'b'),
+	(MPI.CHAR              , 'x'),
+	(MPI.BYTE              , 'x'),
+)
+
+# Kind of the values of each struct format character of the buffer protocol.
+_format_kinds = {
+	'e' : 'f', 'f' : 'f', 'd' : 'f', 'g' : 'f',
+	'b' : 'i', 'h' : 'i', 'i' : 'i', 'l' : 'i', 'q' : 'i', 'n' : 'i',
+	'B' : 'u', 'H' : 'u', 'I' : 'u', 'L' : 'u', 'Q' : 'u', 'N' : 'u',
+	'?' : 'b', 'c' : 'x',
+}
+
+_native_byteorder = '<' if sys.byteorder == 'little' else '>'
+
+cdef str _mpi_type_kind(MPI.Datatype type):
+	for mpi_type, kind in _mpi_type_kinds:
+		if type == mpi_type:
+			return kind
+	raise TypeError("MPI datatype not supported by the python bindings")
+
+cdef str _format_kind(const char *format):
+	cdef str fmt = format.decode('ascii')
+	if fmt[:1] in ('@', '='):
+		fmt = fmt[1:]
+	elif fmt[:1] == _native_byteorder:
+		fmt = fmt[1:]
+	return _format_kinds.get(fmt, None)
+
+cdef int _get_buffer(object data, Py_buffer *view, int flags,
+                     str kind, Py_ssize_t itemsize, str name) except -1:
+	"""
+	Get a C contiguous view of the data without any copy. A BufferError is raised
+	by the exporter if the data is not C contiguous (or not writable if requested)
+	and a TypeError if the type of its values does not match the expected one.
+	"""
+	PyObject_GetBuffer(data, view, flags | PyBUF_C_CONTIGUOUS | PyBUF_FORMAT)
+	data_kind = _format_kind(view.format)
+	if view.itemsize != itemsize or data_kind is None or (data_kind != kind and not
+	   (kind == 'x' and itemsize == 1)):
+		fmt = view.format.decode('ascii')
+		PyBuffer_Release(view)
+		raise TypeError(f"{name}: buffer of format '{fmt}' does not match the exchanger "
+		                f"datatype (kind '{kind}', {itemsize} bytes)")
+	return 0
+
+cdef Py_ssize_t _map_exch_range(t_map_exch *exch):
+	"""
+	Number of local indices used by the exchanges in one direction of a map
+	(largest index plus one).
+	"""
+	cdef Py_ssize_t size = 0
+	cdef int i
+	for i in range(exch.buffer_size):
+		if exch.buffer_idxlist[i] >= size:
+			size = exch.buffer_idxlist[i] + 1
+	return size
+
+cdef int _check_size(Py_buffer *view, Py_ssize_t size, str name) except -1:
+	"""
+	Raise a ValueError if the buffer has less than size values.
+	"""
+	cdef Py_ssize_t count = view.len // view.itemsize
+	if count < size:
+		raise ValueError(f"{name}: buffer of {count} values is smaller than the {size} values "
+		                 f"used by the map of the exchanger")
+	return 0
+
 
 cdef class exchanger:
 	cdef t_exchanger *_exchanger
 	cdef MPI.Datatype _type
+	cdef str _kind
+	cdef Py_ssize_t _itemsize
+	cdef Py_ssize_t _src_range
+	cdef Py_ssize_t _dst_range
+	cdef Py_ssize_t _block_size
 
-	def __init__(self, p_map, hw=None, typein=None):
+	def __init__(self, p_map, hw=None, typein=None, block_size=1):
 		cdef distdir_hardware hardware_type
 		if hw is None:
 			hardware_type = pydistdir_hardware.CPU
@@ -265,7 +645,13 @@ cdef class exchanger:
 		else:
 			type = typein
 		self._type = type
-		self._exchanger = new_exchanger((<map?>p_map)._map, type.ob_mpi, hardware_type)
+		self._kind = _mpi_type_kind(type)
+		self._itemsize = type.Get_size()
+		self._exchanger = new_exchanger_with_block_size((<map?>p_map)._map, type.ob_mpi, block_size,
+		                                                hardware_type)
+		self._src_range = _map_exch_range((<map?>p_map)._map.exch_send)
+		self._dst_range = _map_exch_range((<map?>p_map)._map.exch_recv)
+		self._block_size = block_size
 
 	def __del__(self):
 		self.cleanup()
@@ -273,58 +659,47 @@ cdef class exchanger:
 	def cleanup(self):
 		delete_exchanger((<exchanger?>self)._exchanger)
 
+	def comm_stats(self):
+		cdef t_comm_stats stats
+		exchanger_get_comm_stats(self._exchanger, &stats)
+		return stats
+
 	def go(self, src_data, dst_data, transform_src=None, transform_dst=None):
-		cdef int[::1] transform_src_view
-		cdef int[::1] transform_dst_view
-		cdef double[::1] src_data_view_double
-		cdef double[::1] dst_data_view_double
-		cdef int[::1] src_data_view_int
-		cdef int[::1] dst_data_view_int
-		cdef float[::1] src_data_view_float
-		cdef float[::1] dst_data_view_float
-		if transform_src is None or transform_dst is None:
-			if self._type == MPI.DOUBLE:
-				src_data_view_double   = _np.ascontiguousarray(src_data, dtype=_np.double)
-				dst_data_view_double   = _np.ascontiguousarray(dst_data, dtype=_np.double)
-				exchanger_go((<exchanger?>self)._exchanger,
-				              <void*> &src_data_view_double[0],
-				              <void*> &dst_data_view_double[0])
-			elif self._type == MPI.INT:
-				src_data_view_int   = _np.ascontiguousarray(src_data, dtype=_np.int32)
-				dst_data_view_int   = _np.ascontiguousarray(dst_data, dtype=_np.int32)
-				exchanger_go((<exchanger?>self)._exchanger,
-				              <void*> &src_data_view_int[0],
-				              <void*> &dst_data_view_int[0])
-			elif self._type == MPI.FLOAT:
-				src_data_view_float   = _np.ascontiguousarray(src_data, dtype=_np.single)
-				dst_data_view_float   = _np.ascontiguousarray(dst_data, dtype=_np.single)
-				exchanger_go((<exchanger?>self)._exchanger,
-				              <void*> &src_data_view_float[0],
-				              <void*> &dst_data_view_float[0])
-		else:
-			transform_src_view = _np.ascontiguousarray(transform_src, dtype=_np.int32)
-			transform_dst_view = _np.ascontiguousarray(transform_dst, dtype=_np.int32)
-			if self._type == MPI.DOUBLE:
-				src_data_view_double   = _np.ascontiguousarray(src_data, dtype=_np.double)
-				dst_data_view_double   = _np.ascontiguousarray(dst_data, dtype=_np.double)
-				exchanger_go_with_transform((<exchanger?>self)._exchanger,
-				                             <void*> &src_data_view_double[0],
-				                             <void*> &dst_data_view_double[0],
-				                                     &transform_src_view[0],
-				                                     &transform_dst_view[0])
-			elif self._type == MPI.INT:
-				src_data_view_int   = _np.ascontiguousarray(src_data, dtype=_np.int32)
-				dst_data_view_int   = _np.ascontiguousarray(dst_data, dtype=_np.int32)
-				exchanger_go_with_transform((<exchanger?>self)._exchanger,
-				                             <void*> &src_data_view_int[0],
-				                             <void*> &dst_data_view_int[0],
-				                                     &transform_src_view[0],
-				                                     &transform_dst_view[0])
-			elif self._type == MPI.FLOAT:
-				src_data_view_float   = _np.ascontiguousarray(src_data, dtype=_np.single)
-				dst_data_view_float   = _np.ascontiguousarray(dst_data, dtype=_np.single)
-				exchanger_go_with_transform((<exchanger?>self)._exchanger,
-				                             <void*> &src_data_view_float[0],
-				                             <void*> &dst_data_view_float[0],
-				                                     &transform_src_view[0],
-				                                     &transform_dst_view[0])
+		"""
+		Exchange the data. Any object exporting a C contiguous buffer (numpy arrays,
+		typed memoryviews, array.array, ...) whose values match the datatype of the
+		exchanger is used in place: no copy is done and mismatching data raise an error.
+		A ValueError is raised if a buffer is smaller than the range of indices used by
+		the map, or if only one of the transforms is given. The values of the transforms
+		are expected to be indices within the data and are not checked.
+		The GIL is released during the exchange.
+		"""
+		cdef Py_buffer views[4]
+		cdef int nviews = 0
+		cdef t_exchanger *exch = self._exchanger
+		if (transform_src is None) != (transform_dst is None):
+			raise ValueError("transform_src and transform_dst have to be given together")
+		try:
+			_get_buffer(src_data, &views[0], 0, self._kind, self._itemsize, "src_data")
+			nviews = 1
+			_check_size(&views[0], self._src_range * self._block_size, "src_data")
+			_get_buffer(dst_data, &views[1], PyBUF_WRITABLE, self._kind, self._itemsize, "dst_data")
+			nviews = 2
+			_check_size(&views[1], self._dst_range * self._block_size, "dst_data")
+			if transform_src is None:
+				with nogil:
+					exchanger_go(exch, views[0].buf, views[1].buf)
+			else:
+				_get_buffer(transform_src, &views[2], 0, 'i', sizeof(int), "transform_src")
+				nviews = 3
+				_check_size(&views[2], self._src_range, "transform_src")
+				_get_buffer(transform_dst, &views[3], 0, 'i', sizeof(int), "transform_dst")
+				nviews = 4
+				_check_size(&views[3], self._dst_range, "transform_dst")
+				with nogil:
+					exchanger_go_with_transform(exch, views[0].buf, views[1].buf,
+					                            <int*> views[2].buf, <int*> views[3].buf)
+		finally:
+			while nviews > 0:
+				nviews -= 1
+				PyBuffer_Release(&views[nviews])
@@ -36,6 +36,7 @@
 #include <assert.h>
 
 #include "src/core/algorithm/backend/backend.h"
+#include "src/core/algorithm/backend_communication/backend_comm.h"
 #include "src/sort/mergesort.h"
 #include "src/sort/quicksort.h"
 #include "src/sort/timsort.h"
@@ -132,12 +133,7 @@ int num_procs_send_to_each_bucket(const int      *bucket_idxlist,
 
 	// number of processes each bucket receive data from
 	int n_procs_sending_to_bucket;
-	{
-		int recv_count[nbuckets];
-		for (int i = 0; i < nbuckets; i++)
-			recv_count[i] = 1;
-		check_mpi( MPI_Reduce_scatter(send_to_buckets, &n_procs_sending_to_bucket, recv_count, MPI_INT, MPI_SUM, comm) );
-	}
+	get_comm_backend()->reduce_scatter_block(send_to_buckets, &n_procs_sending_to_bucket, 1, MPI_INT, MPI_SUM, comm);
 
 	return n_procs_sending_to_bucket;
 }
@@ -170,6 +166,7 @@ void senders_to_bucket(      int      *senders_to_bucket        ,
                        const int      *n_idx_each_bucket        , 
                              int       n_procs_sending_to_bucket,
                              int       bucket_max_size          ,
+                             int       tag_range                ,
                              int       idxlist_size             ,
                              MPI_Comm  comm                     ,
                              sort_fn   sort                     ) {
@@ -178,27 +175,46 @@ void senders_to_bucket(      int      *senders_to_bucket        ,
 	assert(n_idx_each_bucket != NULL);
 #endif
 
+	const t_comm_backend *backend = get_comm_backend();
+
 	int world_size;
-	check_mpi( MPI_Comm_size(comm, &world_size) );
+	backend->comm_size(comm, &world_size);
 	int world_rank;
-	check_mpi( MPI_Comm_rank(comm, &world_rank) );
+	backend->comm_rank(comm, &world_rank);
 
-	MPI_Request req[idxlist_size+bucket_max_size];
-	MPI_Status stat[idxlist_size+bucket_max_size];
+	t_comm_request req[idxlist_size+bucket_max_size];
 	int nreq = 0;
 
+	// The messages are received from any source, so the tag must not match
+	// the tags used in the following steps of the algorithm
+	// (at most world_size-1 + bucket_max_size*world_size) nor the tags of
+	// the other index list, which a faster process may already be sending
+	int tag_offset = (bucket_max_size + 1) * (world_size + 1) + tag_range * world_size;
+
+#ifdef ERROR_CHECK
+	// the other backends do not pass the tags to MPI
+	if (backend == get_comm_backend_mpi()) {
+		int *tag_ub;
+		int flag;
+		check_mpi( MPI_Comm_get_attr(comm, MPI_TAG_UB, &tag_ub, &flag) );
+		long long max_tag = (long long)(bucket_max_size + 1) * (world_size + 1) +
+		                    (long long)(tag_range + 1) * world_size - 1;
+		assert(flag && max_tag <= *tag_ub);
+	}
+#endif
+
 	for (int i=0; i<world_size; i++)
 		if (n_idx_each_bucket[i] > 0) {
-			check_mpi( MPI_Isend(&world_rank, 1, MPI_INT, i, i+bucket_max_size*(i+1), comm, &req[nreq]) );
+			backend->isend(&world_rank, 1, MPI_INT, i, i+tag_offset, comm, &req[nreq]);
 			nreq++;
 		}
 
 	for (int i=0; i<n_procs_sending_to_bucket; i++) {
-		check_mpi( MPI_Irecv(&senders_to_bucket[i], 1, MPI_INT, MPI_ANY_SOURCE,
-		                      world_rank+bucket_max_size*(world_rank+1), comm, &req[nreq]) );
+		backend->irecv(&senders_to_bucket[i], 1, MPI_INT, MPI_ANY_SOURCE,
+		                world_rank+tag_offset, comm, &req[nreq]);
 		nreq++;
 	}
-	check_mpi( MPI_Waitall(nreq, req, stat) );
+	backend->waitall(nreq, req);
 
 	// sort by process number
 	if (senders_to_bucket != NULL)
@@ -218,28 +234,29 @@ void num_indices_to_bucket_from_each_rank(      int      *bucket_msg_size_sender
 	assert(senders_to_bucket != NULL);
 #endif
 
+	const t_comm_backend *backend = get_comm_backend();
+
 	int world_size;
-	check_mpi( MPI_Comm_size(comm, &world_size) );
+	backend->comm_size(comm, &world_size);
 	int world_rank;
-	check_mpi( MPI_Comm_rank(comm, &world_rank) );
+	backend->comm_rank(comm, &world_rank);
 
-	MPI_Request req[idxlist_size+bucket_max_size];
-	MPI_Status stat[idxlist_size+bucket_max_size];
+	t_comm_request req[idxlist_size+bucket_max_size];
 	int nreq = 0;
 
 	for (int i=0; i<world_size; i++)
 		if (n_idx_each_bucket[i] > 0) {
-			check_mpi( MPI_Isend(&n_idx_each_bucket[i], 1, MPI_INT, i,
-			                      world_rank+bucket_max_size*i, comm, &req[nreq]) );
+			backend->isend(&n_idx_each_bucket[i], 1, MPI_INT, i,
+			                world_rank+bucket_max_size*i, comm, &req[nreq]);
 			nreq++;
 		}
 
 	for (int i=0; i<n_procs_sending_to_bucket; i++) {
-		check_mpi( MPI_Irecv(&bucket_msg_size_senders[i], 1, MPI_INT, senders_to_bucket[i],
-		                      senders_to_bucket[i]+bucket_max_size*world_rank, comm, &req[nreq]) );
+		backend->irecv(&bucket_msg_size_senders[i], 1, MPI_INT, senders_to_bucket[i],
+		                senders_to_bucket[i]+bucket_max_size*world_rank, comm, &req[nreq]);
 		nreq++;
 	}
-	check_mpi( MPI_Waitall(nreq, req, stat) );
+	backend->waitall(nreq, req);
 }
 
 void bucket_idxlist_procs(      int      *bucket_ranks             ,
@@ -257,20 +274,21 @@ void bucket_idxlist_procs(      int      *bucket_ranks             ,
 	assert(senders_to_bucket       != NULL);
 #endif
 
+	const t_comm_backend *backend = get_comm_backend();
+
 	int world_size;
-	check_mpi( MPI_Comm_size(comm, &world_size) );
+	backend->comm_size(comm, &world_size);
 	int world_rank;
-	check_mpi( MPI_Comm_rank(comm, &world_rank) );
+	backend->comm_rank(comm, &world_rank);
 
-	MPI_Request req[idxlist_size+bucket_max_size];
-	MPI_Status stat[idxlist_size+bucket_max_size];
+	t_comm_request req[idxlist_size+bucket_max_size];
 	int nreq = 0;
 
 	// recv bucket idxlist procs
 	int offset = 0;
 	for (int i = 0; i < n_procs_sending_to_bucket; i++) {
-		check_mpi( MPI_Irecv(&bucket_ranks[offset], bucket_msg_size_senders[i], MPI_INT, senders_to_bucket[i],
-		                      world_rank + bucket_max_size * (world_rank + 1), comm, &req[nreq]) );
+		backend->irecv(&bucket_ranks[offset], bucket_msg_size_senders[i], MPI_INT, senders_to_bucket[i],
+		                world_rank + bucket_max_size * (world_rank + 1), comm, &req[nreq]);
 		offset +=  bucket_msg_size_senders[i];
 		nreq++;
 	}
@@ -281,11 +299,11 @@ void bucket_idxlist_procs(      int      *bucket_ranks             ,
 			int myrank_arr[n_idx_each_bucket[i]];
 			for (int j = 0; j < n_idx_each_bucket[i]; j++)
 				myrank_arr[j] = world_rank;
-			check_mpi( MPI_Send(myrank_arr, n_idx_each_bucket[i], MPI_INT, i, i + bucket_max_size * (i + 1), comm) );
+			backend->send(myrank_arr, n_idx_each_bucket[i], MPI_INT, i, i + bucket_max_size * (i + 1), comm);
 		}
 	}
 
-	check_mpi( MPI_Waitall(nreq, req, stat) );
+	backend->waitall(nreq, req);
 }
 
 void bucket_idxlist_elements(      int      *bucket_indices           ,
@@ -304,20 +322,21 @@ void bucket_idxlist_elements(      int      *bucket_indices           ,
 	assert(senders_to_bucket       != NULL);
 #endif
 
+	const t_comm_backend *backend = get_comm_backend();
+
 	int world_size;
-	check_mpi( MPI_Comm_size(comm, &world_size) );
+	backend->comm_size(comm, &world_size);
 	int world_rank;
-	check_mpi( MPI_Comm_rank(comm, &world_rank) );
+	backend->comm_rank(comm, &world_rank);
 
-	MPI_Request req[idxlist_size+bucket_max_size];
-	MPI_Status stat[idxlist_size+bucket_max_size];
+	t_comm_request req[idxlist_size+bucket_max_size];
 	int nreq = 0;
 
 	//  MPI ranks send info to src bucket
 	for (int i = 0, offset = 0; i < world_size; i++) {
 		if (n_idx_each_bucket[i] > 0) {
-			check_mpi( MPI_Isend(&original_idxlist_sorted[offset], n_idx_each_bucket[i], MPI_INT,
-			                      i, i+bucket_max_size*(i+1), comm, &req[nreq]) );
+			backend->isend(&original_idxlist_sorted[offset], n_idx_each_bucket[i], MPI_INT,
+			                i, i+bucket_max_size*(i+1), comm, &req[nreq]);
 			offset += n_idx_each_bucket[i];
 			nreq++;
 		}
@@ -326,11 +345,11 @@ void bucket_idxlist_elements(      int      *bucket_indices           ,
 	// recv src for each bucket
 	int offset = 0;
 	for (int i = 0; i < n_procs_sending_to_bucket; i++) {
-		check_mpi( MPI_Irecv(&bucket_indices[offset], bucket_msg_size_senders[i], MPI_INT,
-		                      senders_to_bucket[i], world_rank+bucket_max_size*(world_rank+1), comm, &req[nreq]) );
+		backend->irecv(&bucket_indices[offset], bucket_msg_size_senders[i], MPI_INT,
+		                senders_to_bucket[i], world_rank+bucket_max_size*(world_rank+1), comm, &req[nreq]);
 		offset +=  bucket_msg_size_senders[i];
 		nreq++;
 	}
 
-	check_mpi( MPI_Waitall(nreq, req, stat) );
+	backend->waitall(nreq, req);
 }
\ No newline at end of file
@@ -166,6 +166,7 @@ void num_indices_to_send_to_each_bucket(      int *n_idx_each_bucket,
  * @param[in]  n_idx_each_bucket         integer array with the number of elements to send to each bucket
  * @param[in]  n_procs_sending_to_bucket the number of processes that send info to the bucket
  * @param[in]  bucket_max_size           Max size between all buckets
+ * @param[in]  tag_range                 tag range of the messages (different for the src and dst index lists)
  * @param[in]  idxlist_size              size of the idxlist array 
  * @param[in]  comm                      MPI communicator containing all the MPI procs involved in the RD decomposition
  * @param[in]  sort                      sorting function
@@ -176,6 +177,7 @@ void senders_to_bucket(      int      *senders_to_bucket        ,
                        const int      *n_idx_each_bucket        , 
                              int       n_procs_sending_to_bucket,
                              int       bucket_max_size          ,
+                             int       tag_range                ,
                              int       idxlist_size             ,
                              MPI_Comm  comm                     ,
                              sort_fn   sort                     );
@@ -0,0 +1,175 @@
+/*
+ * @file backend_comm.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "src/core/algorithm/backend_communication/backend_comm.h"
+#include "src/utils/check.h"
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define COMM_THREAD_LOCAL _Thread_local
+#else
+#define COMM_THREAD_LOCAL __thread
+#endif
+
+/* elementwise reduction of two arrays of type */
+#define COMM_REDUCE(type, inout, in, count, op)                           \
+	do {                                                                  \
+		type *inout_ = (type *)(inout);                                   \
+		const type *in_ = (const type *)(in);                             \
+		for (int i_ = 0; i_ < (count); i_++) {                            \
+			if ((op) == MPI_SUM)                                          \
+				inout_[i_] += in_[i_];                                    \
+			else if ((op) == MPI_MAX)                                     \
+				inout_[i_] = in_[i_] > inout_[i_] ? in_[i_] : inout_[i_]; \
+			else                                                          \
+				inout_[i_] = in_[i_] < inout_[i_] ? in_[i_] : inout_[i_]; \
+		}                                                                 \
+	} while (0)
+
+void comm_reduce_local(void *inout, const void *in, int count,
+                       MPI_Datatype datatype, MPI_Op op) {
+
+	if (op != MPI_SUM && op != MPI_MAX && op != MPI_MIN) {
+		fprintf(stderr, "comm_reduce_local: operation not supported\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if (datatype == MPI_INT)
+		COMM_REDUCE(int, inout, in, count, op);
+	else if (datatype == MPI_LONG_LONG)
+		COMM_REDUCE(long long, inout, in, count, op);
+	else if (datatype == MPI_UNSIGNED_LONG_LONG)
+		COMM_REDUCE(unsigned long long, inout, in, count, op);
+	else if (datatype == MPI_DOUBLE)
+		COMM_REDUCE(double, inout, in, count, op);
+	else {
+		fprintf(stderr, "comm_reduce_local: datatype not supported\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+static void mpi_comm_rank(MPI_Comm comm, int *rank) {
+
+	check_mpi( MPI_Comm_rank(comm, rank) );
+}
+
+static void mpi_comm_size(MPI_Comm comm, int *size) {
+
+	check_mpi( MPI_Comm_size(comm, size) );
+}
+
+static void mpi_isend(const void *buffer, int count, MPI_Datatype datatype, int dest, int tag,
+                      MPI_Comm comm, t_comm_request *request) {
+
+	check_mpi( MPI_Isend(buffer, count, datatype, dest, tag, comm, &request->mpi) );
+}
+
+static void mpi_irecv(void *buffer, int count, MPI_Datatype datatype, int source, int tag,
+                      MPI_Comm comm, t_comm_request *request) {
+
+	check_mpi( MPI_Irecv(buffer, count, datatype, source, tag, comm, &request->mpi) );
+}
+
+static void mpi_send(const void *buffer, int count, MPI_Datatype datatype, int dest, int tag,
+                     MPI_Comm comm) {
+
+	check_mpi( MPI_Send(buffer, count, datatype, dest, tag, comm) );
+}
+
+/* the requests are completed by a single MPI_Waitall: when the union has the size of
+ * MPI_Request (MPI_Request is a pointer) the array is passed as is, otherwise the MPI
+ * requests are gathered in a contiguous array */
+static void mpi_waitall(int count, t_comm_request *requests) {
+
+	if (count == 0) return;
+
+	if (sizeof(t_comm_request) == sizeof(MPI_Request)) {
+		check_mpi( MPI_Waitall(count, (MPI_Request *)requests, MPI_STATUSES_IGNORE) );
+		return;
+	}
+
+	MPI_Request *mpi_requests = (MPI_Request *)malloc(count * sizeof(MPI_Request));
+	for (int i = 0; i < count; i++)
+		mpi_requests[i] = requests[i].mpi;
+	check_mpi( MPI_Waitall(count, mpi_requests, MPI_STATUSES_IGNORE) );
+	for (int i = 0; i < count; i++)
+		requests[i].mpi = mpi_requests[i];
+	free(mpi_requests);
+}
+
+static void mpi_reduce_scatter_block(const void *sendbuf, void *recvbuf, int count,
+                                     MPI_Datatype datatype, MPI_Op op, MPI_Comm comm) {
+
+	check_mpi( MPI_Reduce_scatter_block(sendbuf, recvbuf, count, datatype, op, comm) );
+}
+
+static void mpi_allreduce(const void *sendbuf, void *recvbuf, int count,
+                          MPI_Datatype datatype, MPI_Op op, MPI_Comm comm) {
+
+	check_mpi( MPI_Allreduce(sendbuf, recvbuf, count, datatype, op, comm) );
+}
+
+static void mpi_barrier(MPI_Comm comm) {
+
+	check_mpi( MPI_Barrier(comm) );
+}
+
+static const t_comm_backend comm_backend_mpi = {
+	.comm_rank            = mpi_comm_rank,
+	.comm_size            = mpi_comm_size,
+	.isend                = mpi_isend,
+	.irecv                = mpi_irecv,
+	.send                 = mpi_send,
+	.waitall              = mpi_waitall,
+	.reduce_scatter_block = mpi_reduce_scatter_block,
+	.allreduce            = mpi_allreduce,
+	.barrier              = mpi_barrier,
+};
+
+static COMM_THREAD_LOCAL const t_comm_backend *comm_backend = NULL;
+
+const t_comm_backend * get_comm_backend_mpi() {
+
+	return &comm_backend_mpi;
+}
+
+const t_comm_backend * get_comm_backend() {
+
+	return comm_backend != NULL ? comm_backend : &comm_backend_mpi;
+}
+
+void set_comm_backend(const t_comm_backend *backend) {
+
+	comm_backend = backend;
+}
@@ -0,0 +1,143 @@
+/*
+ * @file backend_comm.h
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BACKEND_COMM_H
+#define BACKEND_COMM_H
+
+#include "mpi.h"
+
+/** @union t_comm_request
+ * 
+ *  @brief Request of a non blocking message of a communication backend.
+ * 
+ */
+union t_comm_request {
+	/** @brief request of the MPI backend */
+	MPI_Request mpi;
+	/** @brief request of the other backends */
+	void *ptr;
+};
+typedef union t_comm_request t_comm_request;
+
+typedef void (*comm_func_rank) (MPI_Comm, int *);
+
+typedef void (*comm_func_isend) (const void *, int, MPI_Datatype, int, int, MPI_Comm, t_comm_request *);
+
+typedef void (*comm_func_irecv) (void *, int, MPI_Datatype, int, int, MPI_Comm, t_comm_request *);
+
+typedef void (*comm_func_send) (const void *, int, MPI_Datatype, int, int, MPI_Comm);
+
+typedef void (*comm_func_waitall) (int, t_comm_request *);
+
+typedef void (*comm_func_reduce) (const void *, void *, int, MPI_Datatype, MPI_Op, MPI_Comm);
+
+typedef void (*comm_func_barrier) (MPI_Comm);
+
+/** @struct t_comm_backend
+ * 
+ *  @brief The structure contains the communication functions used to create a map.
+ * 
+ *  @details The functions have the semantic of the MPI functions with the same name.
+ *           The MPI backend calls them, the other backends (e.g. the simulator) may
+ *           ignore the communicator and use their own ranks.
+ * 
+ */
+struct t_comm_backend {
+	/** @brief rank of the calling process */
+	comm_func_rank comm_rank;
+	/** @brief number of processes */
+	comm_func_rank comm_size;
+	/** @brief non blocking send */
+	comm_func_isend isend;
+	/** @brief non blocking receive (the source can be MPI_ANY_SOURCE) */
+	comm_func_irecv irecv;
+	/** @brief blocking send */
+	comm_func_send send;
+	/** @brief wait for the completion of non blocking messages */
+	comm_func_waitall waitall;
+	/** @brief reduction of count elements scattered to each process (MPI_Reduce_scatter_block) */
+	comm_func_reduce reduce_scatter_block;
+	/** @brief reduction of count elements to all the processes */
+	comm_func_reduce allreduce;
+	/** @brief synchronization of all the processes */
+	comm_func_barrier barrier;
+};
+typedef struct t_comm_backend t_comm_backend;
+
+/**
+ * @brief Return the MPI communication backend.
+ * 
+ * @return pointer to the t_comm_backend object of MPI
+ * 
+ * @ingroup backend_comm
+ */
+const t_comm_backend * get_comm_backend_mpi();
+
+/**
+ * @brief Return the communication backend used by the calling thread to create maps.
+ * 
+ * @details The MPI backend is used unless another backend is set with \c set_comm_backend.
+ * 
+ * @return pointer to t_comm_backend object
+ * 
+ * @ingroup backend_comm
+ */
+const t_comm_backend * get_comm_backend();
+
+/**
+ * @brief Set the communication backend used by the calling thread to create maps.
+ * 
+ * @param[in] backend pointer to t_comm_backend object (NULL sets the MPI backend)
+ * 
+ * @ingroup backend_comm
+ */
+void set_comm_backend(const t_comm_backend *backend);
+
+/**
+ * @brief Reduce an array into another one with the elementwise operation op.
+ * 
+ * @details It is used by the backends which do not use MPI for the reductions.
+ *          The datatypes MPI_INT, MPI_LONG_LONG, MPI_UNSIGNED_LONG_LONG and MPI_DOUBLE
+ *          and the operations MPI_SUM, MPI_MAX and MPI_MIN are supported.
+ * 
+ * @param[inout] inout    array reduced in place
+ * @param[in]    in       array reduced into inout
+ * @param[in]    count    number of elements
+ * @param[in]    datatype MPI datatype of the elements
+ * @param[in]    op       MPI operation
+ * 
+ * @ingroup backend_comm
+ */
+void comm_reduce_local(void *inout, const void *in, int count, MPI_Datatype datatype, MPI_Op op);
+
+#endif
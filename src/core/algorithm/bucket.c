@@ -37,9 +37,12 @@
 
 #include "src/core/algorithm/bucket.h"
 #include "src/core/algorithm/backend/backend.h"
+#include "src/core/algorithm/backend_communication/backend_comm.h"
 #include "src/sort/mergesort.h"
 #include "src/utils/check.h"
 #include "src/utils/timer.h"
+#include "src/utils/trace.h"
+#include "src/utils/memory.h"
 
 timer_map_idxlist_to_RD_decomp_id = -1;
 timer_map_RD_decomp_to_idxlist_id = -1;
@@ -51,14 +54,16 @@ void map_idxlist_to_RD_decomp(t_bucket  *bucket       ,
                               MPI_Comm comm           ) {
 
 	if (timer_map_idxlist_to_RD_decomp_id==-1)
-		timer_map_idxlist_to_RD_decomp_id = new_timer(__func__);
+		timer_map_idxlist_to_RD_decomp_id = new_timer_region(__func__, region_map_idxlist_to_RD_decomp);
 
 	timer_start(timer_map_idxlist_to_RD_decomp_id);
 
+	const t_comm_backend *backend = get_comm_backend();
+
 	int world_size;
-	check_mpi( MPI_Comm_size(comm, &world_size) );
+	backend->comm_size(comm, &world_size);
 	int world_rank;
-	check_mpi( MPI_Comm_rank(comm, &world_rank) );
+	backend->comm_rank(comm, &world_rank);
 
 	sort_fn sort = get_sort_function();
 	sort_with_idx2_fn sort_with_idx2 = get_sort_with_idx2_function();
@@ -87,18 +92,19 @@ void map_idxlist_to_RD_decomp(t_bucket  *bucket       ,
 	bucket->count_recv = num_procs_send_to_each_bucket(bucket_idxlist, world_size, idxlist->count, comm);
 
 	// number of indices to be sent to each bucket
-	bucket->size_ranks = (int *)malloc(nbuckets*sizeof(int));
+	bucket->size_ranks = (int *)memory_malloc(nbuckets*sizeof(int), memory_workspace);
 	num_indices_to_send_to_each_bucket(bucket->size_ranks, bucket_idxlist, idxlist->count, world_size);
 
 	// source of each message
 	if (bucket->count_recv > 0)
-		bucket->src_recv = (int *)malloc(bucket->count_recv*sizeof(int));
+		bucket->src_recv = (int *)memory_malloc(bucket->count_recv*sizeof(int), memory_workspace);
 	senders_to_bucket(bucket->src_recv, bucket->size_ranks, 
-                      bucket->count_recv, bucket->max_size, idxlist->count, comm, sort);
+                      bucket->count_recv, bucket->max_size, bucket->tag_range,
+                      idxlist->count, comm, sort);
 
 	// size of each message that each bucket receive
 	if (bucket->count_recv > 0)
-		bucket->msg_size_recv = (int *)malloc(bucket->count_recv*sizeof(int));
+		bucket->msg_size_recv = (int *)memory_malloc(bucket->count_recv*sizeof(int), memory_workspace);
 	num_indices_to_bucket_from_each_rank(bucket->msg_size_recv, 
                                     bucket->size_ranks, bucket->src_recv,
                                     bucket->count_recv, bucket->max_size,
@@ -130,14 +136,16 @@ void map_RD_decomp_to_idxlist(t_bucket *src_bucket   ,
                               MPI_Comm  comm         ) {
 
 	if (timer_map_RD_decomp_to_idxlist_id == -1)
-		timer_map_RD_decomp_to_idxlist_id = new_timer(__func__);
+		timer_map_RD_decomp_to_idxlist_id = new_timer_region(__func__, region_map_RD_decomp_to_idxlist);
 
 	timer_start(timer_map_RD_decomp_to_idxlist_id);
 
+	const t_comm_backend *backend = get_comm_backend();
+
 	int world_size;
-	check_mpi( MPI_Comm_size(comm, &world_size) );
+	backend->comm_size(comm, &world_size);
 	int world_rank;
-	check_mpi( MPI_Comm_rank(comm, &world_rank) );
+	backend->comm_rank(comm, &world_rank);
 
 	sort_with_idx_fn sort_with_idx = get_sort_with_idx_function();
 
@@ -147,16 +155,16 @@ void map_RD_decomp_to_idxlist(t_bucket *src_bucket   ,
 			if (dst_bucket->idxlist[j] == src_bucket->idxlist[i])
 				dst_bucket_sort_src[i] = dst_bucket->ranks[j];
 
-	src_bucket->rank_exch = (int *)malloc(idxlist_size*sizeof(int));
+	src_bucket->rank_exch = (int *)memory_malloc(idxlist_size*sizeof(int), memory_workspace);
 	{
-		MPI_Request req[nbuckets*nbuckets];
-		MPI_Status stat[nbuckets*nbuckets];
+		// at most one send and one receive per bucket
+		t_comm_request req[2*nbuckets];
 		int nreq = 0;
 		// send dst info to MPI ranks
 		for (int i = 0, offset=0; i < src_bucket->count_recv; i++) {
-			check_mpi( MPI_Isend(&dst_bucket_sort_src[offset], src_bucket->msg_size_recv[i], MPI_INT,
-			                      src_bucket->src_recv[i], world_rank+nbuckets*(1+src_bucket->src_recv[i]),
-			                      comm, &req[nreq]) );
+			backend->isend(&dst_bucket_sort_src[offset], src_bucket->msg_size_recv[i], MPI_INT,
+			                src_bucket->src_recv[i], world_rank+nbuckets*(1+src_bucket->src_recv[i]),
+			                comm, &req[nreq]);
 			offset += src_bucket->msg_size_recv[i];
 			nreq++;
 		}
@@ -164,13 +172,13 @@ void map_RD_decomp_to_idxlist(t_bucket *src_bucket   ,
 		// MPI ranks receive the dst MPI proc for each idxlist point
 		for (int i = 0, offset = 0; i < nbuckets; i++) {
 			if (src_bucket->size_ranks[i] > 0) {
-				check_mpi( MPI_Irecv(&src_bucket->rank_exch[offset], src_bucket->size_ranks[i], MPI_INT, i,
-				                      i+nbuckets*(1+world_rank), comm, &req[nreq]) );
+				backend->irecv(&src_bucket->rank_exch[offset], src_bucket->size_ranks[i], MPI_INT, i,
+				                i+nbuckets*(1+world_rank), comm, &req[nreq]);
 				offset += src_bucket->size_ranks[i];
 				nreq++;
 			}
 		}
-		check_mpi( MPI_Waitall(nreq, req, stat) );
+		backend->waitall(nreq, req);
 	}
 
 	if (idxlist_size > 0) sort_with_idx(src_bucket->rank_exch, idxlist_local, 0, idxlist_size - 1);
@@ -57,6 +57,9 @@ struct t_bucket {
 	int max_size;
 	/** @brief Maximum number of global indices across all buckets  for a single stride*/
 	int max_size_stride;
+	/** @brief Tag range of the messages received from any source (0 for the src index list,
+	           1 for the dst one) */
+	int tag_range;
 	/** @brief Array of indices inside the bucket sorted in ascending order of the MPI processes owning them.
                Size is sizes */
 	int *idxlist;
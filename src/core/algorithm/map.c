@@ -34,12 +34,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <limits.h>
 
 #include "src/core/algorithm/map.h"
 #include "src/core/algorithm/bucket.h"
 #include "src/core/algorithm/backend/backend.h"
+#include "src/core/algorithm/backend_communication/backend_comm.h"
 #include "src/utils/check.h"
 #include "src/utils/timer.h"
+#include "src/utils/trace.h"
+#include "src/utils/memory.h"
 #ifdef CUDA
 #include "src/core/exchange/backend_hardware/backend_cuda.h"
 #endif
@@ -47,6 +51,7 @@
 static int timer_new_map_id = -1;
 static int timer_extend_map_3d_id = -1;
 static int timer_delete_map_id = -1;
+static int timer_map_stats_id = -1;
 
 t_map * new_map(t_idxlist *src_idxlist ,
                 t_idxlist *dst_idxlist ,
@@ -54,14 +59,16 @@ t_map * new_map(t_idxlist *src_idxlist ,
                 MPI_Comm   comm        ) {
 
 	if (timer_new_map_id == -1)
-		timer_new_map_id = new_timer(__func__);
+		timer_new_map_id = new_timer_region(__func__, region_new_map);
 
 	timer_start(timer_new_map_id);
 
+	const t_comm_backend *backend = get_comm_backend();
+
 	int world_size;
-	check_mpi( MPI_Comm_size(comm, &world_size) );
+	backend->comm_size(comm, &world_size);
 	int world_rank;
-	check_mpi( MPI_Comm_rank(comm, &world_rank) );
+	backend->comm_rank(comm, &world_rank);
 
 	sort_fn sort = get_sort_function();
 
@@ -89,7 +96,7 @@ t_map * new_map(t_idxlist *src_idxlist ,
 			for (int i = 0; i < src_idxlist->count; i++)
 				if (src_idxlist->list[i] > max_idx_value)
 				    max_idx_value = src_idxlist->list[i];
-			check_mpi( MPI_Allreduce(&max_idx_value, &src_bucket_size, 1, MPI_INT, MPI_MAX, comm) );
+			backend->allreduce(&max_idx_value, &src_bucket_size, 1, MPI_INT, MPI_MAX, comm);
 		}
 		src_bucket_size++;
 		n_global_indices = src_bucket_size;
@@ -111,8 +118,8 @@ t_map * new_map(t_idxlist *src_idxlist ,
 			src_bucket_size_stride = src_bucket_size;
 
 			src_bucket_size *= (n_global_indices / stride);
-			src_bucket_max_size = src_bucket_max_size_stride * n_global_indices / stride;
-			src_bucket_min_size = src_bucket_min_size_stride * n_global_indices / stride;
+			src_bucket_max_size = src_bucket_max_size_stride * (n_global_indices / stride);
+			src_bucket_min_size = src_bucket_min_size_stride * (n_global_indices / stride);
 		}
 
 		int dst_bucket_size = 0;
@@ -126,7 +133,7 @@ t_map * new_map(t_idxlist *src_idxlist ,
 			for (int i = 0; i < src_idxlist->count; i++)
 				if (src_idxlist->list[i] > max_idx_value)
 				    max_idx_value = src_idxlist->list[i];
-			check_mpi( MPI_Allreduce(&max_idx_value, &dst_bucket_size, 1, MPI_INT, MPI_MAX, comm) );
+			backend->allreduce(&max_idx_value, &dst_bucket_size, 1, MPI_INT, MPI_MAX, comm);
 		}
 		dst_bucket_size++;
 		n_global_indices = dst_bucket_size;
@@ -149,8 +156,8 @@ t_map * new_map(t_idxlist *src_idxlist ,
 			dst_bucket_size_stride = dst_bucket_size;
 
 			dst_bucket_size *= (n_global_indices / stride);
-			dst_bucket_max_size = dst_bucket_max_size_stride * n_global_indices / stride;
-			dst_bucket_min_size = dst_bucket_min_size_stride * n_global_indices / stride;
+			dst_bucket_max_size = dst_bucket_max_size_stride * (n_global_indices / stride);
+			dst_bucket_min_size = dst_bucket_min_size_stride * (n_global_indices / stride);
 
 		}
 
@@ -177,9 +184,9 @@ t_map * new_map(t_idxlist *src_idxlist ,
 	// ========================================================================================
 
 	t_bucket *src_bucket;
-	src_bucket = (t_bucket *)malloc(sizeof(t_bucket));
-	src_bucket->idxlist = (int *)malloc(bucket_size*sizeof(int));
-	src_bucket->ranks = (int *)malloc(bucket_size*sizeof(int));
+	src_bucket = (t_bucket *)memory_malloc(sizeof(t_bucket), memory_workspace);
+	src_bucket->idxlist = (int *)memory_malloc(bucket_size*sizeof(int), memory_workspace);
+	src_bucket->ranks = (int *)memory_malloc(bucket_size*sizeof(int), memory_workspace);
 	src_bucket->size = bucket_size;
 	src_bucket->min_size = bucket_min_size;
 	src_bucket->max_size = bucket_max_size;
@@ -187,15 +194,16 @@ t_map * new_map(t_idxlist *src_idxlist ,
 	src_bucket->min_size_stride = bucket_min_size_stride;
 	src_bucket->max_size_stride = bucket_max_size_stride;
 	src_bucket->stride = stride;
+	src_bucket->tag_range = 0;
 	int src_idxlist_local[src_idxlist->count];
 
 	map_idxlist_to_RD_decomp(src_bucket, src_idxlist, src_idxlist_local, world_size, comm);
 
 	// -----> dst_idxlist
 	t_bucket *dst_bucket;
-	dst_bucket = (t_bucket *)malloc(sizeof(t_bucket));
-	dst_bucket->idxlist = (int *)malloc(bucket_size*sizeof(int));
-	dst_bucket->ranks = (int *)malloc(bucket_size*sizeof(int));
+	dst_bucket = (t_bucket *)memory_malloc(sizeof(t_bucket), memory_workspace);
+	dst_bucket->idxlist = (int *)memory_malloc(bucket_size*sizeof(int), memory_workspace);
+	dst_bucket->ranks = (int *)memory_malloc(bucket_size*sizeof(int), memory_workspace);
 	dst_bucket->size = bucket_size;
 	dst_bucket->min_size = bucket_min_size;
 	dst_bucket->max_size = bucket_max_size;
@@ -203,6 +211,7 @@ t_map * new_map(t_idxlist *src_idxlist ,
 	dst_bucket->min_size_stride = bucket_min_size_stride;
 	dst_bucket->max_size_stride = bucket_max_size_stride;
 	dst_bucket->stride = stride;
+	dst_bucket->tag_range = 1;
 	int dst_idxlist_local[dst_idxlist->count];
 
 	map_idxlist_to_RD_decomp(dst_bucket, dst_idxlist, dst_idxlist_local, world_size, comm);
@@ -222,10 +231,10 @@ t_map * new_map(t_idxlist *src_idxlist ,
 	// group all info into data structure
 	t_map *map;
 
-	map = (t_map *)malloc(sizeof(t_map));
+	map = (t_map *)memory_malloc(sizeof(t_map), memory_map);
 	map->comm = comm;
-	map->exch_send = (t_map_exch *)malloc(sizeof(t_map_exch));
-	map->exch_recv = (t_map_exch *)malloc(sizeof(t_map_exch));
+	map->exch_send = (t_map_exch *)memory_malloc(sizeof(t_map_exch), memory_map);
+	map->exch_recv = (t_map_exch *)memory_malloc(sizeof(t_map_exch), memory_map);
 
 	// number of procs the current rank has to send data to
 	if (src_idxlist->count > 0) {
@@ -244,11 +253,11 @@ t_map * new_map(t_idxlist *src_idxlist ,
 
 	if (src_idxlist->count > 0) {
 
-		map->exch_send->exch = (t_map_exch_per_rank**)malloc(map->exch_send->count * sizeof(t_map_exch_per_rank*));
+		map->exch_send->exch = (t_map_exch_per_rank**)memory_malloc(map->exch_send->count * sizeof(t_map_exch_per_rank*), memory_map);
 
-		map->exch_send->buffer_offset = (int *)malloc(map->exch_send->count * sizeof(int));
+		map->exch_send->buffer_offset = (int *)memory_malloc(map->exch_send->count * sizeof(int), memory_map);
 		map->exch_send->buffer_offset[0] = 0 ;
-		map->exch_send->buffer_idxlist = (int *)malloc(src_idxlist->count*sizeof(int));
+		map->exch_send->buffer_idxlist = (int *)memory_malloc(src_idxlist->count*sizeof(int), memory_map);
 		map->exch_send->buffer_size = src_idxlist->count;
 
 		int count = 0;
@@ -257,7 +266,7 @@ t_map * new_map(t_idxlist *src_idxlist ,
 		for (int i = 0; i < src_idxlist->count; i++) {
 			if (src_bucket->rank_exch[i] != src_bucket->rank_exch[offset]) {
 				if (buffer_size > 0)
-					map->exch_send->exch[count] = (t_map_exch_per_rank *)malloc(sizeof(t_map_exch_per_rank));
+					map->exch_send->exch[count] = (t_map_exch_per_rank *)memory_malloc(sizeof(t_map_exch_per_rank), memory_map);
 				map->exch_send->exch[count]->exch_rank = src_bucket->rank_exch[offset];
 				if (count + 1 < map->exch_send->count)
 					map->exch_send->buffer_offset[count+1] = buffer_size + map->exch_send->buffer_offset[count];
@@ -272,7 +281,7 @@ t_map * new_map(t_idxlist *src_idxlist ,
 			buffer_size++;
 		}
 		if (buffer_size > 0)
-			map->exch_send->exch[count] = (t_map_exch_per_rank *)malloc(sizeof(t_map_exch_per_rank));
+			map->exch_send->exch[count] = (t_map_exch_per_rank *)memory_malloc(sizeof(t_map_exch_per_rank), memory_map);
 		map->exch_send->exch[count]->exch_rank = src_bucket->rank_exch[offset];
 		for (int j=offset; j<src_idxlist->count; j++) {
 			int memory_position = map->exch_send->buffer_offset[count] + j - offset;
@@ -289,7 +298,7 @@ t_map * new_map(t_idxlist *src_idxlist ,
 		}
 
 #ifdef CUDA
-		map->exch_send->buffer_idxlist_gpu = (int *)allocator_cuda(src_idxlist->count*sizeof(int));
+		map->exch_send->buffer_idxlist_gpu = (int *)allocator_cuda_category(src_idxlist->count*sizeof(int), memory_map);
 		memcpy_h2d(map->exch_send->buffer_idxlist_gpu,
 		           map->exch_send->buffer_idxlist,
 		           src_idxlist->count);
@@ -313,11 +322,11 @@ t_map * new_map(t_idxlist *src_idxlist ,
 
 	if (dst_idxlist->count > 0) {
 
-		map->exch_recv->exch = (t_map_exch_per_rank**)malloc(map->exch_recv->count * sizeof(t_map_exch_per_rank*));
+		map->exch_recv->exch = (t_map_exch_per_rank**)memory_malloc(map->exch_recv->count * sizeof(t_map_exch_per_rank*), memory_map);
 
-		map->exch_recv->buffer_offset = (int *)malloc(map->exch_recv->count * sizeof(int));
+		map->exch_recv->buffer_offset = (int *)memory_malloc(map->exch_recv->count * sizeof(int), memory_map);
 		map->exch_recv->buffer_offset[0] = 0 ;
-		map->exch_recv->buffer_idxlist = (int *)malloc(dst_idxlist->count*sizeof(int));
+		map->exch_recv->buffer_idxlist = (int *)memory_malloc(dst_idxlist->count*sizeof(int), memory_map);
 		map->exch_recv->buffer_size = dst_idxlist->count;
 
 		int count = 0;
@@ -326,7 +335,7 @@ t_map * new_map(t_idxlist *src_idxlist ,
 		for (int i = 0; i < dst_idxlist->count; i++) {
 			if (dst_bucket->rank_exch[i] != dst_bucket->rank_exch[offset]) {
 				if (buffer_size > 0)
-					map->exch_recv->exch[count] = (t_map_exch_per_rank *)malloc(sizeof(t_map_exch_per_rank));
+					map->exch_recv->exch[count] = (t_map_exch_per_rank *)memory_malloc(sizeof(t_map_exch_per_rank), memory_map);
 				map->exch_recv->exch[count]->exch_rank = dst_bucket->rank_exch[offset];
 				if (count + 1 < map->exch_recv->count)
 					map->exch_recv->buffer_offset[count+1] = buffer_size + map->exch_recv->buffer_offset[count];
@@ -341,7 +350,7 @@ t_map * new_map(t_idxlist *src_idxlist ,
 			buffer_size++;
 		}
 		if (buffer_size > 0)
-			map->exch_recv->exch[count] = (t_map_exch_per_rank *)malloc(sizeof(t_map_exch_per_rank));
+			map->exch_recv->exch[count] = (t_map_exch_per_rank *)memory_malloc(sizeof(t_map_exch_per_rank), memory_map);
 		map->exch_recv->exch[count]->exch_rank = dst_bucket->rank_exch[offset];
 		for (int j=offset; j<dst_idxlist->count; j++) {
 			int memory_position = map->exch_recv->buffer_offset[count] + j - offset;
@@ -358,7 +367,7 @@ t_map * new_map(t_idxlist *src_idxlist ,
 		}
 
 #ifdef CUDA
-		map->exch_recv->buffer_idxlist_gpu = (int *)allocator_cuda(dst_idxlist->count*sizeof(int));
+		map->exch_recv->buffer_idxlist_gpu = (int *)allocator_cuda_category(dst_idxlist->count*sizeof(int), memory_map);
 		memcpy_h2d(map->exch_recv->buffer_idxlist_gpu,
 		           map->exch_recv->buffer_idxlist,
 		           dst_idxlist->count);
@@ -366,25 +375,25 @@ t_map * new_map(t_idxlist *src_idxlist ,
 	}
 
 	// free buckets memory
-	free(src_bucket->idxlist);
-	free(src_bucket->ranks);
+	memory_free(src_bucket->idxlist);
+	memory_free(src_bucket->ranks);
 	if (src_bucket->count_recv > 0)
-		free(src_bucket->src_recv);
+		memory_free(src_bucket->src_recv);
 	if (src_bucket->count_recv > 0)
-		free(src_bucket->msg_size_recv);
-	free(src_bucket->size_ranks);
-	free(src_bucket->rank_exch);
-	free(src_bucket);
+		memory_free(src_bucket->msg_size_recv);
+	memory_free(src_bucket->size_ranks);
+	memory_free(src_bucket->rank_exch);
+	memory_free(src_bucket);
 
-	free(dst_bucket->idxlist);
-	free(dst_bucket->ranks);
+	memory_free(dst_bucket->idxlist);
+	memory_free(dst_bucket->ranks);
 	if (dst_bucket->count_recv > 0)
-		free(dst_bucket->src_recv);
+		memory_free(dst_bucket->src_recv);
 	if (dst_bucket->count_recv > 0)
-		free(dst_bucket->msg_size_recv);
-	free(dst_bucket->size_ranks);
-	free(dst_bucket->rank_exch);
-	free(dst_bucket);
+		memory_free(dst_bucket->msg_size_recv);
+	memory_free(dst_bucket->size_ranks);
+	memory_free(dst_bucket->rank_exch);
+	memory_free(dst_bucket);
 
 	timer_stop(timer_new_map_id);
 
@@ -395,16 +404,16 @@ t_map * extend_map_3d(t_map *map2d  ,
                       int    nlevels) {
 
 	if (timer_extend_map_3d_id == -1)
-		timer_extend_map_3d_id = new_timer(__func__);
+		timer_extend_map_3d_id = new_timer_region(__func__, region_extend_map_3d);
 
 	timer_start(timer_extend_map_3d_id);
 	// group all info into data structure
 	t_map *map;
 
-	map = (t_map *)malloc(sizeof(t_map));
+	map = (t_map *)memory_malloc(sizeof(t_map), memory_map);
 	map->comm = map2d->comm;
-	map->exch_send = (t_map_exch *)malloc(sizeof(t_map_exch));
-	map->exch_recv = (t_map_exch *)malloc(sizeof(t_map_exch));
+	map->exch_send = (t_map_exch *)memory_malloc(sizeof(t_map_exch), memory_map);
+	map->exch_recv = (t_map_exch *)memory_malloc(sizeof(t_map_exch), memory_map);
 
 	// number of procs the current rank has to send data to
 	map->exch_send->count = map2d->exch_send->count;
@@ -412,10 +421,10 @@ t_map * extend_map_3d(t_map *map2d  ,
 
 	if (map->exch_send->count > 0) {
 
-		map->exch_send->buffer_offset = (int *)malloc(map->exch_send->count*sizeof(int));
+		map->exch_send->buffer_offset = (int *)memory_malloc(map->exch_send->count*sizeof(int), memory_map);
 		for (int i=0; i<map->exch_send->count; i++)
 			map->exch_send->buffer_offset[i] = map2d->exch_send->buffer_offset[i] * nlevels;
-		map->exch_send->buffer_idxlist = (int *)malloc(map2d->exch_send->buffer_size * nlevels * sizeof(int));
+		map->exch_send->buffer_idxlist = (int *)memory_malloc(map2d->exch_send->buffer_size * nlevels * sizeof(int), memory_map);
 
 		for (int count=0; count<map->exch_send->count; count++) {
 
@@ -444,7 +453,7 @@ t_map * extend_map_3d(t_map *map2d  ,
 		}
 
 #ifdef CUDA
-		map->exch_send->buffer_idxlist_gpu = (int *)allocator_cuda(map2d->exch_send->buffer_size*nlevels*sizeof(int));
+		map->exch_send->buffer_idxlist_gpu = (int *)allocator_cuda_category(map2d->exch_send->buffer_size*nlevels*sizeof(int), memory_map);
 		memcpy_h2d(map->exch_send->buffer_idxlist_gpu,
 		           map->exch_send->buffer_idxlist,
 		           map2d->exch_send->buffer_size*nlevels);
@@ -453,10 +462,10 @@ t_map * extend_map_3d(t_map *map2d  ,
 
 	// fill info about each send message
 	if (map->exch_send->count > 0) {
-		map->exch_send->exch = (t_map_exch_per_rank**)malloc(map->exch_send->count * sizeof(t_map_exch_per_rank*));
+		map->exch_send->exch = (t_map_exch_per_rank**)memory_malloc(map->exch_send->count * sizeof(t_map_exch_per_rank*), memory_map);
 		for (int count = 0; count < map->exch_send->count; count++) {
 			if (map2d->exch_send->exch[count]!=NULL)
-				map->exch_send->exch[count] = (t_map_exch_per_rank *)malloc(sizeof(t_map_exch_per_rank));
+				map->exch_send->exch[count] = (t_map_exch_per_rank *)memory_malloc(sizeof(t_map_exch_per_rank), memory_map);
 			map->exch_send->exch[count]->exch_rank = map2d->exch_send->exch[count]->exch_rank;
 		}
 	}
@@ -467,10 +476,10 @@ t_map * extend_map_3d(t_map *map2d  ,
 
 	if (map->exch_recv->count > 0) {
 	
-		map->exch_recv->buffer_offset = (int *)malloc(map->exch_recv->count*sizeof(int));
+		map->exch_recv->buffer_offset = (int *)memory_malloc(map->exch_recv->count*sizeof(int), memory_map);
 		for (int i=0; i<map->exch_recv->count; i++)
 			map->exch_recv->buffer_offset[i] = map2d->exch_recv->buffer_offset[i] * nlevels;
-		map->exch_recv->buffer_idxlist = (int *)malloc(map2d->exch_recv->buffer_size * nlevels * sizeof(int));
+		map->exch_recv->buffer_idxlist = (int *)memory_malloc(map2d->exch_recv->buffer_size * nlevels * sizeof(int), memory_map);
 
 		for (int count=0; count<map->exch_recv->count; count++) {
 
@@ -498,7 +507,7 @@ t_map * extend_map_3d(t_map *map2d  ,
 			}
 		}
 #ifdef CUDA
-		map->exch_recv->buffer_idxlist_gpu = (int *)allocator_cuda(map2d->exch_recv->buffer_size*nlevels*sizeof(int));
+		map->exch_recv->buffer_idxlist_gpu = (int *)allocator_cuda_category(map2d->exch_recv->buffer_size*nlevels*sizeof(int), memory_map);
 		memcpy_h2d(map->exch_recv->buffer_idxlist_gpu,
 		           map->exch_recv->buffer_idxlist,
 		           map2d->exch_recv->buffer_size*nlevels);
@@ -507,10 +516,10 @@ t_map * extend_map_3d(t_map *map2d  ,
 
 	// fill info about each recv message
 	if (map->exch_recv->count > 0) {
-		map->exch_recv->exch = (t_map_exch_per_rank**)malloc(map->exch_recv->count * sizeof(t_map_exch_per_rank*));
+		map->exch_recv->exch = (t_map_exch_per_rank**)memory_malloc(map->exch_recv->count * sizeof(t_map_exch_per_rank*), memory_map);
 		for (int count = 0; count < map->exch_recv->count; count++) {
 			if (map2d->exch_recv->exch[count]!=NULL)
-				map->exch_recv->exch[count] = (t_map_exch_per_rank *)malloc(sizeof(t_map_exch_per_rank));
+				map->exch_recv->exch[count] = (t_map_exch_per_rank *)memory_malloc(sizeof(t_map_exch_per_rank), memory_map);
 			map->exch_recv->exch[count]->exch_rank = map2d->exch_recv->exch[count]->exch_rank;
 		}
 	}
@@ -520,38 +529,181 @@ t_map * extend_map_3d(t_map *map2d  ,
 	return map;
 }
 
+/* add the messages of one direction of the map to the local statistics */
+static void map_stats_exch(t_map_exch *map_exch, int rank, int send, int *peers,
+                           long long *volume_exch, t_map_stats *stats, long long *histogram) {
+
+	*peers = 0;
+	*volume_exch = 0;
+
+	// sizeof(t_map_exch) is added once per direction
+	stats->index_memory += sizeof(t_map_exch);
+
+	if (map_exch->count == 0) return;
+
+	stats->index_memory += map_exch->count * (sizeof(t_map_exch_per_rank *) +
+	                                          sizeof(t_map_exch_per_rank) + sizeof(int)) +
+	                       map_exch->buffer_size * sizeof(int);
+
+	for (int count = 0; count < map_exch->count; count++) {
+
+		int offset = map_exch->buffer_offset[count];
+
+		int upper_bound = count == map_exch->count-1 ?
+		                           map_exch->buffer_size :
+		                           map_exch->buffer_offset[count + 1];
+
+		int size = upper_bound - offset;
+
+		/* the exchange with the same process is a local copy (counted once) */
+		if (map_exch->exch[count]->exch_rank == rank) {
+			if (send) stats->volume_self += size;
+			continue;
+		}
+
+		(*peers)++;
+		*volume_exch += size;
+		stats->messages++;
+		stats->volume += size;
+		if (stats->messages == 1 || size < stats->min_message)
+			stats->min_message = size;
+		if (size > stats->max_message)
+			stats->max_message = size;
+
+		int bin = 0;
+		while (bin < MAP_STATS_NBINS - 1 && (size >> (bin + 1)) > 0)
+			bin++;
+		histogram[bin]++;
+
+		if (size > 0) stats->runs++;
+		for (int i = offset + 1; i < upper_bound; i++)
+			if (map_exch->buffer_idxlist[i] != map_exch->buffer_idxlist[i-1] + 1)
+				stats->runs++;
+	}
+}
+
+void map_stats(t_map       *map  ,
+               t_map_stats *stats) {
+
+	if (timer_map_stats_id == -1)
+		timer_map_stats_id = new_timer_region(__func__, region_map_stats);
+
+	timer_start(timer_map_stats_id);
+
+	const t_comm_backend *backend = get_comm_backend();
+
+	int rank;
+	backend->comm_rank(map->comm, &rank);
+	int size;
+	backend->comm_size(map->comm, &size);
+
+	stats->messages = 0;
+	stats->min_message = 0;
+	stats->max_message = 0;
+	stats->volume = 0;
+	stats->volume_self = 0;
+	stats->runs = 0;
+	stats->index_memory = sizeof(t_map);
+
+	/* local statistics, the histogram of the sent messages is kept apart
+	 * to count each message once in the global histogram */
+	long long histogram_send[MAP_STATS_NBINS] = {0};
+	long long histogram_recv[MAP_STATS_NBINS] = {0};
+	long long volume_send, volume_recv;
+	map_stats_exch(map->exch_send, rank, 1, &stats->peers_send, &volume_send, stats, histogram_send);
+	int messages_send = stats->messages;
+	map_stats_exch(map->exch_recv, rank, 0, &stats->peers_recv, &volume_recv, stats, histogram_recv);
+
+	for (int bin = 0; bin < MAP_STATS_NBINS; bin++)
+		stats->histogram[bin] = (int)(histogram_send[bin] + histogram_recv[bin]);
+
+	stats->mean_message = stats->messages > 0 ? (double)stats->volume / stats->messages : 0.0;
+	stats->self_fraction = stats->volume + stats->volume_self > 0 ?
+	                       2.0 * stats->volume_self / (stats->volume + 2.0 * stats->volume_self) : 0.0;
+	stats->runs_per_message = stats->messages > 0 ? (double)stats->runs / stats->messages : 0.0;
+
+	/* global statistics with one reduction for the sums and one for the maxima */
+	enum {sum_messages, sum_volume_send, sum_volume, sum_volume_self, sum_runs, sum_runs_messages,
+	      sum_index_memory, sum_histogram, nsum = sum_histogram + MAP_STATS_NBINS};
+	long long sums[nsum];
+	sums[sum_messages]      = messages_send;
+	sums[sum_volume_send]   = volume_send;
+	sums[sum_volume]        = stats->volume;
+	sums[sum_volume_self]   = stats->volume_self;
+	sums[sum_runs]          = stats->runs;
+	sums[sum_runs_messages] = stats->messages;
+	sums[sum_index_memory]  = stats->index_memory;
+	for (int bin = 0; bin < MAP_STATS_NBINS; bin++)
+		sums[sum_histogram + bin] = histogram_send[bin];
+
+	enum {max_peers_send, max_peers_recv, max_message, max_min_message, max_volume,
+	      max_index_memory, nmax};
+	long long maxs[nmax];
+	maxs[max_peers_send]   = stats->peers_send;
+	maxs[max_peers_recv]   = stats->peers_recv;
+	maxs[max_message]      = stats->max_message;
+	// the minimum is the opposite of the maximum of the opposite values
+	maxs[max_min_message]  = stats->messages > 0 ? -stats->min_message : LLONG_MIN;
+	maxs[max_volume]       = stats->volume;
+	maxs[max_index_memory] = stats->index_memory;
+
+	backend->allreduce(MPI_IN_PLACE, sums, nsum, MPI_LONG_LONG, MPI_SUM, map->comm);
+	backend->allreduce(MPI_IN_PLACE, maxs, nmax, MPI_LONG_LONG, MPI_MAX, map->comm);
+
+	stats->global_max_peers_send = (int)maxs[max_peers_send];
+	stats->global_max_peers_recv = (int)maxs[max_peers_recv];
+	stats->global_messages = sums[sum_messages];
+	stats->global_min_message = maxs[max_min_message] == LLONG_MIN ? 0 : (int)(-maxs[max_min_message]);
+	stats->global_max_message = (int)maxs[max_message];
+	stats->global_mean_message = sums[sum_messages] > 0 ?
+	                             (double)sums[sum_volume_send] / sums[sum_messages] : 0.0;
+	for (int bin = 0; bin < MAP_STATS_NBINS; bin++)
+		stats->global_histogram[bin] = sums[sum_histogram + bin];
+	stats->global_max_volume = maxs[max_volume];
+	stats->global_mean_volume = (double)sums[sum_volume] / size;
+	stats->global_self_fraction = sums[sum_volume] + sums[sum_volume_self] > 0 ?
+	                              2.0 * sums[sum_volume_self] /
+	                              (sums[sum_volume] + 2.0 * sums[sum_volume_self]) : 0.0;
+	stats->global_runs_per_message = sums[sum_runs_messages] > 0 ?
+	                                 (double)sums[sum_runs] / sums[sum_runs_messages] : 0.0;
+	stats->global_max_index_memory = (size_t)maxs[max_index_memory];
+	stats->global_index_memory = (size_t)sums[sum_index_memory];
+
+	timer_stop(timer_map_stats_id);
+}
+
 void delete_map(t_map *map) {
 
 	if (timer_delete_map_id == -1)
-		timer_delete_map_id = new_timer(__func__);
+		timer_delete_map_id = new_timer_region(__func__, region_delete_map);
 
 	timer_start(timer_delete_map_id);
 
 	// map send info
 	if (map->exch_send->count > 0) {
 		for (int count = 0; count < map->exch_send->count; count++)
-			free(map->exch_send->exch[count]);
-		free(map->exch_send->exch);
+			memory_free(map->exch_send->exch[count]);
+		memory_free(map->exch_send->exch);
 		if (map->exch_send->buffer_size > 0)
-			free(map->exch_send->buffer_idxlist);
+			memory_free(map->exch_send->buffer_idxlist);
 		if (map->exch_send->count > 0)
-			free(map->exch_send->buffer_offset);
+			memory_free(map->exch_send->buffer_offset);
 	}
-	free(map->exch_send);
+	memory_free(map->exch_send);
 
 	// map recv info
 	if (map->exch_recv->count > 0) {
 		for (int count = 0; count < map->exch_recv->count; count++)
-			free(map->exch_recv->exch[count]);
-		free(map->exch_recv->exch);
+			memory_free(map->exch_recv->exch[count]);
+		memory_free(map->exch_recv->exch);
 		if (map->exch_recv->buffer_size > 0)
-			free(map->exch_recv->buffer_idxlist);
+			memory_free(map->exch_recv->buffer_idxlist);
 		if (map->exch_recv->count > 0)
-			free(map->exch_recv->buffer_offset);
+			memory_free(map->exch_recv->buffer_offset);
 	}
-	free(map->exch_recv);
+	memory_free(map->exch_recv);
 
-	free(map);
+	memory_free(map);
 
 	timer_stop(timer_delete_map_id);
 }
\ No newline at end of file
@@ -34,6 +34,7 @@
 #ifndef MAP_H
 #define MAP_H
 
+#include <stddef.h>
 #include "mpi.h"
 
 #include "src/core/indices/idxlist.h"
@@ -86,6 +87,74 @@ struct t_map {
 };
 typedef struct t_map t_map;
 
+/** @brief number of bins of the histogram of the message sizes */
+#define MAP_STATS_NBINS 32
+
+/** @struct t_map_stats
+ * 
+ *  @brief The structure contains statistics about the communication pattern of a map
+ * 
+ *  @details The sizes and volumes are numbers of indices. The exchange with the same
+ *           process is not a message and it is counted only in volume_self. The fields
+ *           with the global prefix are computed over all the processes of the map.
+ * 
+ */
+struct t_map_stats {
+	/** @brief number of processes the messages are sent to */
+	int peers_send;
+	/** @brief number of processes the messages are received from */
+	int peers_recv;
+	/** @brief number of messages sent and received */
+	int messages;
+	/** @brief size of the smallest message (0 if there are no messages) */
+	int min_message;
+	/** @brief size of the largest message */
+	int max_message;
+	/** @brief mean size of the messages */
+	double mean_message;
+	/** @brief number of messages with size in [2^i, 2^(i+1)) */
+	int histogram[MAP_STATS_NBINS];
+	/** @brief number of indices sent and received */
+	long long volume;
+	/** @brief number of indices of the exchange with the same process */
+	long long volume_self;
+	/** @brief fraction of the indices of the map exchanged with the same process */
+	double self_fraction;
+	/** @brief number of runs of contiguous indices in the messages */
+	long long runs;
+	/** @brief mean number of runs of contiguous indices per message */
+	double runs_per_message;
+	/** @brief size in bytes of the host memory of the map */
+	size_t index_memory;
+	/** @brief maximum number of processes the messages are sent to */
+	int global_max_peers_send;
+	/** @brief maximum number of processes the messages are received from */
+	int global_max_peers_recv;
+	/** @brief number of messages of all the processes (each message counted once) */
+	long long global_messages;
+	/** @brief size of the smallest message */
+	int global_min_message;
+	/** @brief size of the largest message */
+	int global_max_message;
+	/** @brief mean size of the messages */
+	double global_mean_message;
+	/** @brief number of messages with size in [2^i, 2^(i+1)) (each message counted once) */
+	long long global_histogram[MAP_STATS_NBINS];
+	/** @brief maximum number of indices sent and received by a process */
+	long long global_max_volume;
+	/** @brief mean number of indices sent and received by a process */
+	double global_mean_volume;
+	/** @brief fraction of the indices of the map exchanged with the same process */
+	double global_self_fraction;
+	/** @brief mean number of runs of contiguous indices per message */
+	double global_runs_per_message;
+	/** @brief maximum size in bytes of the host memory of the map on a process */
+	size_t global_max_index_memory;
+	/** @brief size in bytes of the host memory of the map on all the processes */
+	size_t global_index_memory;
+};
+typedef struct t_map_stats t_map_stats;
+
 /**
  * @brief Create a new t_map structure
  * 
@@ -120,6 +189,20 @@ t_map * new_map(t_idxlist *src_idxlist ,
 t_map * extend_map_3d(t_map *map2d  ,
                       int    nlevels);
 
+/**
+ * @brief Statistics about the communication pattern of a map
+ * 
+ * @details Compute the statistics of the messages of the map on the calling process and
+ *          on all the processes of the map. Collective call over the communicator of the map.
+ * 
+ * @param[in]  map   pointer to t_map structure
+ * @param[out] stats pointer to t_map_stats structure
+ * 
+ * @ingroup map
+ */
+void map_stats(t_map       *map  ,
+               t_map_stats *stats);
+
 /**
  * @brief Clean memory of a t_map structure
  * 
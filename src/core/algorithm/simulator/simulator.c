@@ -0,0 +1,550 @@
+/*
+ * @file simulator.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "mpi.h"
+#include "src/core/algorithm/simulator/simulator.h"
+#include "src/core/algorithm/backend_communication/backend_comm.h"
+#include "src/core/exchange/cost_model/cost_model.h"
+#include "src/utils/check.h"
+#include "src/utils/timer.h"
+#include "src/utils/memory.h"
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define SIMULATOR_THREAD_LOCAL _Thread_local
+#else
+#define SIMULATOR_THREAD_LOCAL __thread
+#endif
+
+/* message sent before the matching receive is posted */
+struct t_sim_message {
+	int source;
+	int tag;
+	size_t bytes;
+	double arrival;
+	void *data;
+	struct t_sim_message *next;
+};
+typedef struct t_sim_message t_sim_message;
+
+/* receive request (the sends are eager and they are complete on return) */
+struct t_sim_request {
+	int owner;
+	int source;
+	int tag;
+	size_t bytes;
+	void *buffer;
+	double arrival;
+	int complete;
+	int waited;
+	struct t_sim_request *next;
+};
+typedef struct t_sim_request t_sim_request;
+
+struct t_sim_rank {
+	ucontext_t context;
+	void *stack;
+	double clock;
+	long long messages;
+	long long bytes;
+	/* messages arrived before the receive is posted (FIFO) */
+	t_sim_message *unexpected_head;
+	t_sim_message *unexpected_tail;
+	/* receives posted before the message arrives (FIFO) */
+	t_sim_request *posted_head;
+	t_sim_request *posted_tail;
+	/* number of incomplete requests of the current waitall */
+	int pending;
+	/* receive buffer of the current collective */
+	void *coll_recvbuf;
+};
+typedef struct t_sim_rank t_sim_rank;
+
+struct t_simulator {
+	int nranks;
+	int ranks_per_node;
+	size_t stack_size;
+	size_t page_size;
+	simulator_fn fn;
+	void *ctx;
+	t_sim_rank *ranks;
+	ucontext_t main_context;
+	int current;
+	int nfinished;
+	/* FIFO of the ranks ready to run, each rank is at most once in the queue */
+	int *ready;
+	int ready_head;
+	int ready_count;
+	/* wall time when the current rank was resumed or made its last call */
+	double last_time;
+	double compute_time;
+	long long collectives;
+	t_cost_params params;
+	/* state of the current collective */
+	int coll_arrived;
+	int coll_count;
+	int coll_scatter;
+	MPI_Datatype coll_datatype;
+	MPI_Op coll_op;
+	void *coll_buffer;
+	double coll_clock;
+};
+typedef struct t_simulator t_simulator;
+
+static SIMULATOR_THREAD_LOCAL t_simulator *simulator = NULL;
+
+static void simulator_check(int ret, const char *func) {
+
+	if (ret != 0) {
+		perror(func);
+		fprintf(stderr, "distdir_simulate: %s failed\n", func);
+		exit(EXIT_FAILURE);
+	}
+}
+
+static void simulator_update_clock(t_simulator *sim) {
+
+	double now = MPI_Wtime();
+	sim->ranks[sim->current].clock += now - sim->last_time;
+	sim->compute_time += now - sim->last_time;
+	sim->last_time = now;
+}
+
+static void simulator_push_ready(t_simulator *sim, int rank) {
+
+	sim->ready[(sim->ready_head + sim->ready_count) % sim->nranks] = rank;
+	sim->ready_count++;
+}
+
+static int simulator_pop_ready(t_simulator *sim) {
+
+	int rank = sim->ready[sim->ready_head];
+	sim->ready_head = (sim->ready_head + 1) % sim->nranks;
+	sim->ready_count--;
+	return rank;
+}
+
+/* the calling rank waits until another rank pushes it in the ready queue */
+static void simulator_block(t_simulator *sim) {
+
+	simulator_check(swapcontext(&sim->ranks[sim->current].context, &sim->main_context), "swapcontext");
+}
+
+static int simulator_same_node(const t_simulator *sim, int rank1, int rank2) {
+
+	if (sim->ranks_per_node <= 0) return 1;
+	return rank1 / sim->ranks_per_node == rank2 / sim->ranks_per_node;
+}
+
+static double simulator_message_time(const t_simulator *sim, int source, int dest, size_t bytes) {
+
+	if (simulator_same_node(sim, source, dest))
+		return sim->params.latency_intra + (double)bytes / sim->params.bandwidth_intra;
+	return sim->params.latency_inter + (double)bytes / sim->params.bandwidth_inter;
+}
+
+static size_t simulator_bytes(int count, MPI_Datatype datatype) {
+
+	int type_size;
+	check_mpi( MPI_Type_size(datatype, &type_size) );
+	return (size_t)count * (size_t)type_size;
+}
+
+static void simulator_complete(t_simulator *sim, t_sim_request *request,
+                               const void *data, size_t bytes, double arrival) {
+
+#ifdef ERROR_CHECK
+	assert(bytes <= request->bytes);
+#endif
+
+	if (bytes > 0) memcpy(request->buffer, data, bytes);
+	request->arrival = arrival;
+	request->complete = 1;
+
+	t_sim_rank *owner = &sim->ranks[request->owner];
+	if (request->waited && --owner->pending == 0)
+		simulator_push_ready(sim, request->owner);
+}
+
+static void simulator_comm_rank(MPI_Comm comm, int *rank) {
+
+	(void)comm;
+	*rank = simulator->current;
+}
+
+static void simulator_comm_size(MPI_Comm comm, int *size) {
+
+	(void)comm;
+	*size = simulator->nranks;
+}
+
+static void simulator_send(const void *buffer, int count, MPI_Datatype datatype, int dest, int tag,
+                           MPI_Comm comm) {
+
+	(void)comm;
+	t_simulator *sim = simulator;
+	simulator_update_clock(sim);
+
+#ifdef ERROR_CHECK
+	assert(dest >= 0 && dest < sim->nranks);
+#endif
+
+	int source = sim->current;
+	t_sim_rank *sender = &sim->ranks[source];
+	size_t bytes = simulator_bytes(count, datatype);
+	double arrival = sender->clock + simulator_message_time(sim, source, dest, bytes);
+	sender->messages++;
+	sender->bytes += bytes;
+
+	// match the first receive posted by the destination
+	t_sim_rank *receiver = &sim->ranks[dest];
+	for (t_sim_request *prev = NULL, *request = receiver->posted_head; request != NULL;
+	     prev = request, request = request->next) {
+		if ((request->source == source || request->source == MPI_ANY_SOURCE) && request->tag == tag) {
+			if (prev == NULL)
+				receiver->posted_head = request->next;
+			else
+				prev->next = request->next;
+			if (receiver->posted_tail == request) receiver->posted_tail = prev;
+			simulator_complete(sim, request, buffer, bytes, arrival);
+			return;
+		}
+	}
+
+	// otherwise the message is buffered by the destination
+	t_sim_message *message = (t_sim_message *)memory_malloc(sizeof(t_sim_message), memory_workspace);
+	message->source = source;
+	message->tag = tag;
+	message->bytes = bytes;
+	message->arrival = arrival;
+	message->data = NULL;
+	if (bytes > 0) {
+		message->data = memory_malloc(bytes, memory_workspace);
+		memcpy(message->data, buffer, bytes);
+	}
+	message->next = NULL;
+	if (receiver->unexpected_tail == NULL)
+		receiver->unexpected_head = message;
+	else
+		receiver->unexpected_tail->next = message;
+	receiver->unexpected_tail = message;
+}
+
+static void simulator_isend(const void *buffer, int count, MPI_Datatype datatype, int dest, int tag,
+                            MPI_Comm comm, t_comm_request *request) {
+
+	simulator_send(buffer, count, datatype, dest, tag, comm);
+	request->ptr = NULL;
+}
+
+static void simulator_irecv(void *buffer, int count, MPI_Datatype datatype, int source, int tag,
+                            MPI_Comm comm, t_comm_request *comm_request) {
+
+	(void)comm;
+	t_simulator *sim = simulator;
+	simulator_update_clock(sim);
+
+	t_sim_request *request = (t_sim_request *)memory_malloc(sizeof(t_sim_request), memory_workspace);
+	request->owner = sim->current;
+	request->source = source;
+	request->tag = tag;
+	request->bytes = simulator_bytes(count, datatype);
+	request->buffer = buffer;
+	request->arrival = 0.0;
+	request->complete = 0;
+	request->waited = 0;
+	request->next = NULL;
+	comm_request->ptr = request;
+
+	// match the first message buffered by the calling rank
+	t_sim_rank *receiver = &sim->ranks[sim->current];
+	for (t_sim_message *prev = NULL, *message = receiver->unexpected_head; message != NULL;
+	     prev = message, message = message->next) {
+		if ((message->source == source || source == MPI_ANY_SOURCE) && message->tag == tag) {
+			if (prev == NULL)
+				receiver->unexpected_head = message->next;
+			else
+				prev->next = message->next;
+			if (receiver->unexpected_tail == message) receiver->unexpected_tail = prev;
+			simulator_complete(sim, request, message->data, message->bytes, message->arrival);
+			if (message->data != NULL) memory_free(message->data);
+			memory_free(message);
+			return;
+		}
+	}
+
+	if (receiver->posted_tail == NULL)
+		receiver->posted_head = request;
+	else
+		receiver->posted_tail->next = request;
+	receiver->posted_tail = request;
+}
+
+static void simulator_waitall(int count, t_comm_request *requests) {
+
+	t_simulator *sim = simulator;
+	simulator_update_clock(sim);
+
+	t_sim_rank *rank = &sim->ranks[sim->current];
+	rank->pending = 0;
+	for (int i = 0; i < count; i++) {
+		t_sim_request *request = (t_sim_request *)requests[i].ptr;
+		if (request != NULL && !request->complete) {
+			request->waited = 1;
+			rank->pending++;
+		}
+	}
+
+	if (rank->pending > 0) simulator_block(sim);
+
+	for (int i = 0; i < count; i++) {
+		t_sim_request *request = (t_sim_request *)requests[i].ptr;
+		if (request != NULL) {
+			if (request->arrival > rank->clock) rank->clock = request->arrival;
+			memory_free(request);
+			requests[i].ptr = NULL;
+		}
+	}
+}
+
+/* the last rank joining the collective completes it for all the ranks:
+ * recursive doubling with ceil(log2(nranks)) steps of latency plus the
+ * transfer of the reduced data */
+static void simulator_collective(const void *sendbuf, void *recvbuf, int count,
+                                 MPI_Datatype datatype, MPI_Op op, int scatter) {
+
+	t_simulator *sim = simulator;
+	simulator_update_clock(sim);
+
+	t_sim_rank *rank = &sim->ranks[sim->current];
+	int nelems = scatter ? count * sim->nranks : count;
+	size_t bytes = datatype == MPI_DATATYPE_NULL ? 0 : simulator_bytes(nelems, datatype);
+
+	if (sendbuf == MPI_IN_PLACE) sendbuf = recvbuf;
+
+	if (sim->coll_arrived == 0) {
+		sim->coll_count = count;
+		sim->coll_scatter = scatter;
+		sim->coll_datatype = datatype;
+		sim->coll_op = op;
+		sim->coll_clock = rank->clock;
+		sim->coll_buffer = NULL;
+		if (bytes > 0) {
+			sim->coll_buffer = memory_malloc(bytes, memory_workspace);
+			memcpy(sim->coll_buffer, sendbuf, bytes);
+		}
+	} else {
+#ifdef ERROR_CHECK
+		assert(sim->coll_count == count && sim->coll_scatter == scatter);
+		assert(sim->coll_datatype == datatype && sim->coll_op == op);
+#endif
+		if (bytes > 0) comm_reduce_local(sim->coll_buffer, sendbuf, nelems, datatype, op);
+		if (rank->clock > sim->coll_clock) sim->coll_clock = rank->clock;
+	}
+	rank->coll_recvbuf = recvbuf;
+
+	if (++sim->coll_arrived < sim->nranks) {
+		simulator_block(sim);
+		return;
+	}
+
+	// all the ranks joined the collective
+	int steps = 0;
+	while ((1 << steps) < sim->nranks) steps++;
+	int inter = sim->ranks_per_node > 0 && sim->ranks_per_node < sim->nranks;
+	double latency = inter ? sim->params.latency_inter : sim->params.latency_intra;
+	double bandwidth = inter ? sim->params.bandwidth_inter : sim->params.bandwidth_intra;
+	double time = sim->coll_clock + steps * latency;
+	if (scatter)
+		time += (double)bytes / bandwidth;
+	else
+		time += steps * ((double)bytes / bandwidth);
+
+	size_t recv_bytes = scatter ? bytes / sim->nranks : bytes;
+	for (int i = 0; i < sim->nranks; i++) {
+		if (recv_bytes > 0) {
+			const char *result = (const char *)sim->coll_buffer + (scatter ? i * recv_bytes : 0);
+			memcpy(sim->ranks[i].coll_recvbuf, result, recv_bytes);
+		}
+		sim->ranks[i].clock = time;
+		if (i != sim->current) simulator_push_ready(sim, i);
+	}
+
+	if (sim->coll_buffer != NULL) memory_free(sim->coll_buffer);
+	sim->coll_buffer = NULL;
+	sim->coll_arrived = 0;
+	sim->collectives++;
+}
+
+static void simulator_reduce_scatter_block(const void *sendbuf, void *recvbuf, int count,
+                                           MPI_Datatype datatype, MPI_Op op, MPI_Comm comm) {
+
+	(void)comm;
+	simulator_collective(sendbuf, recvbuf, count, datatype, op, 1);
+}
+
+static void simulator_allreduce(const void *sendbuf, void *recvbuf, int count,
+                                MPI_Datatype datatype, MPI_Op op, MPI_Comm comm) {
+
+	(void)comm;
+	simulator_collective(sendbuf, recvbuf, count, datatype, op, 0);
+}
+
+static void simulator_barrier(MPI_Comm comm) {
+
+	(void)comm;
+	simulator_collective(NULL, NULL, 0, MPI_DATATYPE_NULL, MPI_OP_NULL, 0);
+}
+
+static const t_comm_backend comm_backend_simulator = {
+	.comm_rank            = simulator_comm_rank,
+	.comm_size            = simulator_comm_size,
+	.isend                = simulator_isend,
+	.irecv                = simulator_irecv,
+	.send                 = simulator_send,
+	.waitall              = simulator_waitall,
+	.reduce_scatter_block = simulator_reduce_scatter_block,
+	.allreduce            = simulator_allreduce,
+	.barrier              = simulator_barrier,
+};
+
+static void simulator_entry(void) {
+
+	t_simulator *sim = simulator;
+	sim->fn(sim->current, sim->nranks, sim->ctx);
+	simulator_update_clock(sim);
+	sim->nfinished++;
+	// the context returns to the scheduler (uc_link)
+}
+
+void distdir_simulate(const t_simulator_config *config,
+                      simulator_fn              fn    ,
+                      void                     *ctx   ,
+                      t_simulator_stats        *stats ) {
+
+#ifdef ERROR_CHECK
+	assert(config != NULL && fn != NULL);
+	assert(config->nranks > 0);
+	assert(simulator == NULL);
+#endif
+
+	double start_time = MPI_Wtime();
+
+	t_simulator sim;
+	memset(&sim, 0, sizeof(t_simulator));
+	sim.nranks = config->nranks;
+	sim.ranks_per_node = config->ranks_per_node;
+	sim.page_size = (size_t)sysconf(_SC_PAGESIZE);
+	sim.stack_size = config->stack_size > 0 ? config->stack_size : SIMULATOR_STACK_SIZE;
+	sim.stack_size = (sim.stack_size + sim.page_size - 1) / sim.page_size * sim.page_size;
+	sim.fn = fn;
+	sim.ctx = ctx;
+	sim.ranks = (t_sim_rank *)memory_calloc(sim.nranks, sizeof(t_sim_rank), memory_workspace);
+	sim.ready = (int *)memory_malloc(sim.nranks * sizeof(int), memory_workspace);
+	distdir_get_cost_params(&sim.params);
+
+	// each rank has its own stack with a guard page below it
+	for (int i = 0; i < sim.nranks; i++) {
+		t_sim_rank *rank = &sim.ranks[i];
+		rank->stack = mmap(NULL, sim.stack_size + sim.page_size, PROT_READ | PROT_WRITE,
+		                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		simulator_check(rank->stack == MAP_FAILED ? -1 : 0, "mmap");
+		simulator_check(mprotect(rank->stack, sim.page_size, PROT_NONE), "mprotect");
+
+		simulator_check(getcontext(&rank->context), "getcontext");
+		rank->context.uc_stack.ss_sp = (char *)rank->stack + sim.page_size;
+		rank->context.uc_stack.ss_size = sim.stack_size;
+		rank->context.uc_link = &sim.main_context;
+		makecontext(&rank->context, simulator_entry, 0);
+
+		simulator_push_ready(&sim, i);
+	}
+
+	const t_comm_backend *backend = get_comm_backend();
+	int timers_active = timers_get_active();
+	set_comm_backend(&comm_backend_simulator);
+	timers_set_active(0);
+	simulator = &sim;
+
+	while (sim.nfinished < sim.nranks) {
+		if (sim.ready_count == 0) {
+			fprintf(stderr, "distdir_simulate: deadlock, %d virtual processes are blocked\n",
+			        sim.nranks - sim.nfinished);
+			exit(EXIT_FAILURE);
+		}
+		sim.current = simulator_pop_ready(&sim);
+		sim.last_time = MPI_Wtime();
+		simulator_check(swapcontext(&sim.main_context, &sim.ranks[sim.current].context), "swapcontext");
+	}
+
+	simulator = NULL;
+	timers_set_active(timers_active);
+	set_comm_backend(backend);
+
+	if (stats != NULL) {
+		memset(stats, 0, sizeof(t_simulator_stats));
+		stats->nranks = sim.nranks;
+		for (int i = 0; i < sim.nranks; i++) {
+			t_sim_rank *rank = &sim.ranks[i];
+			stats->messages += rank->messages;
+			stats->bytes += rank->bytes;
+			if (rank->messages > stats->max_messages) stats->max_messages = rank->messages;
+			if (rank->bytes > stats->max_bytes) stats->max_bytes = rank->bytes;
+			if (rank->clock > stats->time) stats->time = rank->clock;
+		}
+		stats->collectives = sim.collectives;
+		stats->compute_time = sim.compute_time;
+	}
+
+	for (int i = 0; i < sim.nranks; i++) {
+		t_sim_rank *rank = &sim.ranks[i];
+		while (rank->unexpected_head != NULL) {
+			t_sim_message *message = rank->unexpected_head;
+			rank->unexpected_head = message->next;
+			if (message->data != NULL) memory_free(message->data);
+			memory_free(message);
+		}
+		simulator_check(munmap(rank->stack, sim.stack_size + sim.page_size), "munmap");
+	}
+	memory_free(sim.ready);
+	memory_free(sim.ranks);
+
+	if (stats != NULL) stats->wall_time = MPI_Wtime() - start_time;
+}
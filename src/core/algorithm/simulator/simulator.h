@@ -0,0 +1,123 @@
+/*
+ * @file simulator.h
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <stddef.h>
+
+/** @brief default stack size in bytes of each virtual process */
+#define SIMULATOR_STACK_SIZE (1024*1024)
+
+/**
+ * @brief Function run by each virtual process of the simulator.
+ * 
+ * @param[in] rank rank of the virtual process
+ * @param[in] size number of virtual processes
+ * @param[in] ctx  pointer passed to \c distdir_simulate
+ */
+typedef void (*simulator_fn) (int rank, int size, void *ctx);
+
+/** @struct t_simulator_config
+ * 
+ *  @brief The structure contains the configuration of a simulation
+ * 
+ */
+struct t_simulator_config {
+	/** @brief number of virtual processes */
+	int nranks;
+	/** @brief number of virtual processes on each node (<= 0 means a single node) */
+	int ranks_per_node;
+	/** @brief stack size in bytes of each virtual process (0 means SIMULATOR_STACK_SIZE) */
+	size_t stack_size;
+};
+typedef struct t_simulator_config t_simulator_config;
+
+/** @struct t_simulator_stats
+ * 
+ *  @brief The structure contains the statistics of a simulation
+ * 
+ *  @details The time of a virtual process is its compute time plus the modelled
+ *           time it waits for messages. A message of n bytes arrives latency + n / bandwidth
+ *           seconds after it is sent, with the parameters of the cost model of the
+ *           processes on the same node or on different nodes. A collective completes
+ *           ceil(log2(nranks)) message steps after the last process joins it.
+ * 
+ */
+struct t_simulator_stats {
+	/** @brief number of virtual processes */
+	int nranks;
+	/** @brief total number of point-to-point messages */
+	long long messages;
+	/** @brief total number of bytes of the point-to-point messages */
+	long long bytes;
+	/** @brief largest number of messages sent by a virtual process */
+	long long max_messages;
+	/** @brief largest number of bytes sent by a virtual process */
+	long long max_bytes;
+	/** @brief number of collective calls (counted once for all the processes) */
+	long long collectives;
+	/** @brief modelled time in seconds (largest time of the virtual processes) */
+	double time;
+	/** @brief compute time in seconds summed over the virtual processes */
+	double compute_time;
+	/** @brief wall time in seconds of the simulation */
+	double wall_time;
+};
+typedef struct t_simulator_stats t_simulator_stats;
+
+/**
+ * @brief Run a function on virtual processes inside the calling process.
+ * 
+ * @details The virtual processes are coroutines run one at a time by the calling
+ *          thread, so that the creation of a map (\c new_map) can be studied with
+ *          many more processes than the available ones. While the function runs,
+ *          the communication backend of the map creation is the simulator: the
+ *          communicator passed to \c new_map is ignored and the maps must be deleted
+ *          before the function returns. The exchangers are not simulated and the
+ *          timers are disabled during the simulation. The simulation aborts if all
+ *          the virtual processes wait for a message that is never sent.
+ * 
+ * @param[in]  config pointer to t_simulator_config structure
+ * @param[in]  fn     function run by each virtual process
+ * @param[in]  ctx    pointer passed to the function
+ * @param[out] stats  pointer to t_simulator_stats structure (it can be NULL)
+ * 
+ * @ingroup simulator
+ */
+void distdir_simulate(const t_simulator_config *config,
+                      simulator_fn              fn    ,
+                      void                     *ctx   ,
+                      t_simulator_stats        *stats );
+
+#endif
@@ -0,0 +1,211 @@
+/*
+ * @file autotune.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "src/core/exchange/autotune/autotune.h"
+#include "src/setup/setting.h"
+#include "src/utils/memory.h"
+#include "src/core/algorithm/backend_communication/backend_comm.h"
+
+/* FNV-1a hash of an integer */
+static unsigned long long autotune_hash(unsigned long long hash, long long value) {
+
+	for (int i = 0; i < 8; i++) {
+		hash ^= (unsigned long long)(value >> (8 * i)) & 0xffULL;
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+/* the fingerprint depends on the messages of all the processes and on the
+ * size of the elements, so that the same map used with another datatype or
+ * number of processes is tuned again */
+static unsigned long long autotune_fingerprint(t_map *map, size_t type_size) {
+
+	const t_comm_backend *backend = get_comm_backend();
+
+	int world_size;
+	backend->comm_size(map->comm, &world_size);
+	int world_rank;
+	backend->comm_rank(map->comm, &world_rank);
+
+	unsigned long long hash = 0xcbf29ce484222325ULL;
+	hash = autotune_hash(hash, world_rank);
+	hash = autotune_hash(hash, world_size);
+	hash = autotune_hash(hash, (long long)type_size);
+
+	t_map_exch *exchs[2] = {map->exch_send, map->exch_recv};
+	for (int i = 0; i < 2; i++) {
+		t_map_exch *exch = exchs[i];
+		hash = autotune_hash(hash, exch->count);
+		for (int count = 0; count < exch->count; count++) {
+			int upper_bound = count == exch->count-1 ?
+			                           exch->buffer_size :
+			                           exch->buffer_offset[count + 1];
+			hash = autotune_hash(hash, exch->exch[count]->exch_rank);
+			hash = autotune_hash(hash, upper_bound - exch->buffer_offset[count]);
+		}
+	}
+
+	/* the contribution of each process is different, the sum wraps around (the
+	 * reductions of the communication backends do not support MPI_BXOR) */
+	unsigned long long fingerprint;
+	backend->allreduce(&hash, &fingerprint, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, map->comm);
+
+	return fingerprint;
+}
+
+/* exchanger type stored for the fingerprint in the file (-1 if not found) */
+static int autotune_load(const char *path, unsigned long long fingerprint) {
+
+	FILE *file = fopen(path, "r");
+	if (file == NULL) return -1;
+
+	int mode = -1;
+	unsigned long long key;
+	int value;
+	/* the last selection of a fingerprint is used */
+	while (fscanf(file, "%llx %d", &key, &value) == 2)
+		if (key == fingerprint) mode = value;
+
+	fclose(file);
+
+	return mode;
+}
+
+static void autotune_store(const char *path, unsigned long long fingerprint, int mode) {
+
+	FILE *file = fopen(path, "a");
+	if (file == NULL) {
+		fprintf(stderr, "distdir: cannot write the exchanger selection to %s\n", path);
+		return;
+	}
+
+	fprintf(file, "%016llx %d\n", fingerprint, mode);
+	fclose(file);
+}
+
+t_autotune * new_autotune(t_map *map, size_t type_size) {
+
+	t_autotune *autotune = (t_autotune *)memory_malloc(sizeof(t_autotune), memory_exchange);
+	const t_comm_backend *backend = get_comm_backend();
+
+	autotune->comm = map->comm;
+	autotune->trials = get_config_exchanger_auto_trials() > 0 ? get_config_exchanger_auto_trials() : 1;
+	autotune->calls = 0;
+	autotune->mode = -1;
+
+	/* the NoWait exchangers can be used only if the sending and the receiving
+	 * processes do not overlap */
+	int two_way = map->exch_send->count > 0 && map->exch_recv->count > 0;
+	backend->allreduce(MPI_IN_PLACE, &two_way, 1, MPI_INT, MPI_MAX, map->comm);
+
+	int modes[AUTOTUNE_MAX_CANDIDATES] = {IsendIrecv1, IsendIrecv2, IsendRecv1, IsendRecv2,
+	                                      IsendIrecv1NoWait, IsendIrecv2NoWait,
+	                                      IsendRecv1NoWait, IsendRecv2NoWait};
+	autotune->ncandidates = two_way ? 4 : AUTOTUNE_MAX_CANDIDATES;
+	for (int i = 0; i < autotune->ncandidates; i++) {
+		autotune->candidates[i] = modes[i];
+		autotune->times[i] = 0.0;
+	}
+
+	autotune->fingerprint = autotune_fingerprint(map, type_size);
+
+	const char *path = get_config_exchanger_auto_file();
+	if (path != NULL) {
+		int world_rank;
+		backend->comm_rank(map->comm, &world_rank);
+
+		/* the selection read by the first process is broadcast with a reduction
+		 * (the other processes contribute -1, the lowest value of mode) */
+		int mode = world_rank == 0 ? autotune_load(path, autotune->fingerprint) : -1;
+		backend->allreduce(MPI_IN_PLACE, &mode, 1, MPI_INT, MPI_MAX, map->comm);
+
+		for (int i = 0; i < autotune->ncandidates; i++)
+			if (autotune->candidates[i] == mode)
+				autotune->mode = mode;
+	}
+
+	return autotune;
+}
+
+int autotune_mode(t_autotune *autotune) {
+
+	if (autotune->mode >= 0) return autotune->mode;
+
+	return autotune->candidates[autotune->calls / (autotune->trials + 1)];
+}
+
+int autotune_record(t_autotune *autotune, double time) {
+
+	if (autotune->mode >= 0) return 0;
+
+	/* the first exchange of each candidate is a warm-up (it also completes
+	 * the messages of the previous candidate) */
+	int candidate = autotune->calls / (autotune->trials + 1);
+	if (autotune->calls % (autotune->trials + 1) != 0)
+		autotune->times[candidate] += time;
+
+	autotune->calls++;
+
+	if (autotune->calls < autotune->ncandidates * (autotune->trials + 1))
+		return autotune->calls % (autotune->trials + 1) == 0;
+
+	/* an exchange is as fast as its slowest process */
+	const t_comm_backend *backend = get_comm_backend();
+	backend->allreduce(MPI_IN_PLACE, autotune->times, autotune->ncandidates, MPI_DOUBLE,
+	                   MPI_MAX, autotune->comm);
+
+	int best = 0;
+	for (int i = 1; i < autotune->ncandidates; i++)
+		if (autotune->times[i] < autotune->times[best])
+			best = i;
+	autotune->mode = autotune->candidates[best];
+
+	const char *path = get_config_exchanger_auto_file();
+	if (path != NULL) {
+		int world_rank;
+		backend->comm_rank(autotune->comm, &world_rank);
+		if (world_rank == 0)
+			autotune_store(path, autotune->fingerprint, autotune->mode);
+	}
+
+	return autotune->mode != autotune->candidates[autotune->ncandidates - 1];
+}
+
+void delete_autotune(t_autotune *autotune) {
+
+	memory_free(autotune);
+}
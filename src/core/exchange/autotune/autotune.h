@@ -0,0 +1,126 @@
+/*
+ * @file autotune.h
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include "src/core/algorithm/map.h"
+
+/** @brief number of exchanger types the automatic selection can choose from */
+#define AUTOTUNE_MAX_CANDIDATES 8
+
+/** @struct t_autotune
+ * 
+ *  @brief The structure contains the state of the automatic selection of the
+ *         exchanger type of an exchanger
+ * 
+ *  @details Each candidate exchanger type is used for one warm-up exchange and
+ *           \c trials timed exchanges, then the processes agree on the type with
+ *           the lowest time (max among the processes) and keep it.
+ * 
+ */
+struct t_autotune {
+	/** @brief number of candidate exchanger types */
+	int ncandidates;
+	/** @brief candidate exchanger types (values of distdir_exchanger enum) */
+	int candidates[AUTOTUNE_MAX_CANDIDATES];
+	/** @brief number of timed exchanges per candidate */
+	int trials;
+	/** @brief number of exchanges done during the selection */
+	int calls;
+	/** @brief sum of the times of the timed exchanges of each candidate */
+	double times[AUTOTUNE_MAX_CANDIDATES];
+	/** @brief selected exchanger type (-1 during the selection) */
+	int mode;
+	/** @brief fingerprint of the communication pattern of the exchanger */
+	unsigned long long fingerprint;
+	/** @brief MPI communicator of the map */
+	MPI_Comm comm;
+};
+typedef struct t_autotune t_autotune;
+
+/**
+ * @brief Create t_autotune object.
+ * 
+ * @details Collective call over the communicator of the map. The NoWait exchanger
+ *          types are candidates only if no process both sends and receives messages.
+ *          If a file of selections is set (\c set_config_exchanger_auto_file) and it
+ *          contains the fingerprint of the exchanger, the stored type is used
+ *          without timing the candidates.
+ *  
+ * @param[in] map       pointer to t_map structure
+ * @param[in] type_size size in bytes of the exchanged elements (block included)
+ * 
+ * @return pointer to t_autotune object
+ * 
+ * @ingroup autotune
+ */
+t_autotune * new_autotune(t_map *map, size_t type_size);
+
+/**
+ * @brief Exchanger type of the next exchange
+ * 
+ * @param[in] autotune pointer to t_autotune object
+ * 
+ * @return value of distdir_exchanger enum
+ * 
+ * @ingroup autotune
+ */
+int autotune_mode(t_autotune *autotune);
+
+/**
+ * @brief Record the time of an exchange
+ * 
+ * @details The last exchange of the selection is collective over the communicator
+ *          of the map: the processes agree on the fastest exchanger type and the
+ *          process 0 appends it to the file of selections (if set).
+ *  
+ * @param[in] autotune pointer to t_autotune object
+ * @param[in] time     time of the exchange in seconds
+ * 
+ * @return 1 if the exchanger type of the next exchange changes, 0 otherwise
+ * 
+ * @ingroup autotune
+ */
+int autotune_record(t_autotune *autotune, double time);
+
+/**
+ * @brief Free memory of t_autotune object.
+ *  
+ * @param[in] autotune pointer to t_autotune object
+ * 
+ * @ingroup autotune
+ */
+void delete_autotune(t_autotune *autotune);
+
+#endif
@@ -33,104 +33,102 @@
 
 #include <stdlib.h>
 #include "src/core/exchange/backend_communication/backend_mpi.h"
+#include "src/core/exchange/backend_communication/backend_threads.h"
 #include "src/utils/check.h"
-
-t_mpi_exchange * new_mpi_exchanger(MPI_Datatype  type, int size) {
-
-	t_mpi_exchange *mpi_exchange = (t_mpi_exchange *)malloc(sizeof(t_mpi_exchange));
-	if (type == MPI_INT || type == MPI_INTEGER) {
-		mpi_exchange->isend = (kernel_func_isendirecv)mpi_wrapper_isend_int;
-		mpi_exchange->irecv = (kernel_func_isendirecv)mpi_wrapper_irecv_int;
-		mpi_exchange->recv  = (kernel_func_recv      )mpi_wrapper_recv_int ;
-	} else if (type == MPI_REAL || type == MPI_FLOAT) {
-		mpi_exchange->isend = (kernel_func_isendirecv)mpi_wrapper_isend_float;
-		mpi_exchange->irecv = (kernel_func_isendirecv)mpi_wrapper_irecv_float;
-		mpi_exchange->recv  = (kernel_func_recv      )mpi_wrapper_recv_float ;
-	} else if (type == MPI_DOUBLE || type == MPI_DOUBLE_PRECISION) {
-		mpi_exchange->isend = (kernel_func_isendirecv)mpi_wrapper_isend_double;
-		mpi_exchange->irecv = (kernel_func_isendirecv)mpi_wrapper_irecv_double;
-		mpi_exchange->recv  = (kernel_func_recv      )mpi_wrapper_recv_double ;
+#include "src/utils/memory.h"
+
+t_mpi_exchange * new_mpi_exchanger(MPI_Datatype  type, int block_size, int size) {
+
+	t_mpi_exchange *mpi_exchange = (t_mpi_exchange *)memory_malloc(sizeof(t_mpi_exchange), memory_exchange);
+	if (thread_ranks_active()) {
+		mpi_exchange->isend    = threads_wrapper_isend;
+		mpi_exchange->irecv    = threads_wrapper_irecv;
+		mpi_exchange->recv     = threads_wrapper_recv;
+		mpi_exchange->wait     = threads_wrapper_waitall;
+		mpi_exchange->waitsome = threads_wrapper_waitsome;
+		mpi_exchange->testsome = threads_wrapper_testsome;
+		mpi_exchange->testall  = threads_wrapper_testall;
+	} else {
+		mpi_exchange->isend    = mpi_wrapper_isend;
+		mpi_exchange->irecv    = mpi_wrapper_irecv;
+		mpi_exchange->recv     = mpi_wrapper_recv;
+		mpi_exchange->wait     = mpi_wrapper_waitall;
+		mpi_exchange->waitsome = mpi_wrapper_waitsome;
+		mpi_exchange->testsome = mpi_wrapper_testsome;
+		mpi_exchange->testall  = mpi_wrapper_testall;
 	}
 
-
-	mpi_exchange->req = (MPI_Request *)malloc(size * sizeof(MPI_Request));
-	mpi_exchange->stat = (MPI_Status *)malloc(size * sizeof(MPI_Status));
+	mpi_exchange->req = (MPI_Request *)memory_malloc(size * sizeof(MPI_Request), memory_exchange);
+	/* the blocking receives write one status also when there are no send requests */
+	mpi_exchange->stat = (MPI_Status *)memory_malloc((size > 0 ? size : 1) * sizeof(MPI_Status), memory_exchange);
+
+	/* each element of a message is a block of contiguous values */
+	if (block_size > 1) {
+		check_mpi( MPI_Type_contiguous(block_size, type, &mpi_exchange->type) );
+		check_mpi( MPI_Type_commit(&mpi_exchange->type) );
+		mpi_exchange->type_is_block = 1;
+	} else {
+		mpi_exchange->type = type;
+		mpi_exchange->type_is_block = 0;
+	}
 
 	MPI_Aint type_size;
 	MPI_Aint type_lb;
-	check_mpi( MPI_Type_get_extent(type, &type_lb, &type_size) );
+	check_mpi( MPI_Type_get_extent(mpi_exchange->type, &type_lb, &type_size) );
 
 	mpi_exchange->type_size = type_size;
-	mpi_exchange->type = type;
 	mpi_exchange->nreq_send = 0;
 	mpi_exchange->nreq_recv = 0;
-	mpi_exchange->wait = mpi_wrapper_waitall;
 
 	return mpi_exchange;
 }
 
 void delete_mpi_exchanger(t_mpi_exchange *mpi_exchange) {
 
-	free(mpi_exchange->req);
-	free(mpi_exchange->stat);
-	free(mpi_exchange);
-}
-
-void mpi_wrapper_isend_int(int *buffer, int count, MPI_Datatype datatype, int dest, int tag,
-                           MPI_Comm comm, MPI_Request *request, int offset) {
-
-	check_mpi( MPI_Isend(&buffer[offset], count, datatype, dest, tag, comm, request) );
-}
-
-void mpi_wrapper_isend_float(float *buffer, int count, MPI_Datatype datatype, int dest, int tag,
-                             MPI_Comm comm, MPI_Request *request, int offset) {
+	if (mpi_exchange->type_is_block)
+		check_mpi( MPI_Type_free(&mpi_exchange->type) );
 
-	check_mpi( MPI_Isend(&buffer[offset], count, datatype, dest, tag, comm, request) );
+	memory_free(mpi_exchange->req);
+	memory_free(mpi_exchange->stat);
+	memory_free(mpi_exchange);
 }
 
-void mpi_wrapper_isend_double(double *buffer, int count, MPI_Datatype datatype, int dest, int tag,
-                              MPI_Comm comm, MPI_Request *request, int offset) {
+void mpi_wrapper_isend(void *buffer, int count, MPI_Datatype datatype, int dest, int tag,
+                       MPI_Comm comm, MPI_Request *request, MPI_Aint offset) {
 
-	check_mpi( MPI_Isend(&buffer[offset], count, datatype, dest, tag, comm, request) );
+	check_mpi( MPI_Isend((char *)buffer + offset, count, datatype, dest, tag, comm, request) );
 }
 
-void mpi_wrapper_irecv_int(int *buffer, int count, MPI_Datatype datatype, int source, int tag,
-                           MPI_Comm comm, MPI_Request *request, int offset) {
+void mpi_wrapper_irecv(void *buffer, int count, MPI_Datatype datatype, int source, int tag,
+                       MPI_Comm comm, MPI_Request *request, MPI_Aint offset) {
 
-	check_mpi( MPI_Irecv(&buffer[offset], count, datatype, source, tag, comm, request) );
+	check_mpi( MPI_Irecv((char *)buffer + offset, count, datatype, source, tag, comm, request) );
 }
 
-void mpi_wrapper_irecv_float(float *buffer, int count, MPI_Datatype datatype, int source, int tag,
-                             MPI_Comm comm, MPI_Request *request, int offset) {
+void mpi_wrapper_recv(void *buffer, int count, MPI_Datatype datatype, int source, int tag,
+                      MPI_Comm comm, MPI_Status *status, MPI_Aint offset) {
 
-	check_mpi( MPI_Irecv(&buffer[offset], count, datatype, source, tag, comm, request) );
+	check_mpi( MPI_Recv((char *)buffer + offset, count, datatype, source, tag, comm, status) );
 }
 
-void mpi_wrapper_irecv_double(double *buffer, int count, MPI_Datatype datatype, int source, int tag,
-                              MPI_Comm comm, MPI_Request *request, int offset) {
-
-	check_mpi( MPI_Irecv(&buffer[offset], count, datatype, source, tag, comm, request) );
-}
-
-void mpi_wrapper_recv_int(int *buffer, int count, MPI_Datatype datatype, int source, int tag,
-                          MPI_Comm comm, MPI_Status *status, int offset) {
+void mpi_wrapper_waitall(int count, MPI_Request *requests, MPI_Status *statuses) {
 
-	check_mpi( MPI_Recv(&buffer[offset], count, datatype, source, tag, comm, status) );
+	check_mpi( MPI_Waitall(count, requests, statuses) );
 }
 
-void mpi_wrapper_recv_float(float *buffer, int count, MPI_Datatype datatype, int source, int tag,
-                            MPI_Comm comm, MPI_Status *status, int offset) {
+void mpi_wrapper_waitsome(int count, MPI_Request *requests, int *outcount, int *indices,
+                          MPI_Status *statuses) {
 
-	check_mpi( MPI_Recv(&buffer[offset], count, datatype, source, tag, comm, status) );
+	check_mpi( MPI_Waitsome(count, requests, outcount, indices, statuses) );
 }
 
-void mpi_wrapper_recv_double(double *buffer, int count, MPI_Datatype datatype, int source, int tag,
-                             MPI_Comm comm, MPI_Status *status, int offset) {
+void mpi_wrapper_testsome(int count, MPI_Request *requests, int *outcount, int *indices,
+                          MPI_Status *statuses) {
 
-	check_mpi( MPI_Recv(&buffer[offset], count, datatype, source, tag, comm, status) );
+	check_mpi( MPI_Testsome(count, requests, outcount, indices, statuses) );
 }
 
-void mpi_wrapper_waitall(int count, MPI_Request *requests, MPI_Status *statuses) {
+void mpi_wrapper_testall(int count, MPI_Request *requests, int *flag, MPI_Status *statuses) {
 
-	check_mpi( MPI_Waitall(count, requests, statuses) );
+	check_mpi( MPI_Testall(count, requests, flag, statuses) );
 }
@@ -38,11 +38,15 @@
 
 typedef void (*kernel_backend_func_wait) (int, MPI_Request *, MPI_Status *);
 
+typedef void (*kernel_backend_func_waitsome) (int, MPI_Request *, int *, int *, MPI_Status *);
+
+typedef void (*kernel_backend_func_testall) (int, MPI_Request *, int *, MPI_Status *);
+
 typedef void (*kernel_func_isendirecv) ( void *, int , MPI_Datatype, int, int,
-                                    MPI_Comm, MPI_Request *, int ) ;
+                                    MPI_Comm, MPI_Request *, MPI_Aint ) ;
 
 typedef void (*kernel_func_recv)  ( void *, int, MPI_Datatype, int, int,
-                                    MPI_Comm, MPI_Status * , int) ;
+                                    MPI_Comm, MPI_Status * , MPI_Aint) ;
 
 /** @struct t_mpi_exchange
  * 
@@ -52,8 +56,10 @@ typedef void (*kernel_func_recv)  ( void *, int, MPI_Datatype, int, int,
 struct t_mpi_exchange {
 	/** @brief MPI datatype used for the exchange */
 	MPI_Datatype type;
-	/** @brief Size of the MPI datatype used for the exchange */
+	/** @brief Extent of the MPI datatype used for the exchange */
 	MPI_Aint type_size;
+	/** @brief flag set if type is a block datatype owned by the structure */
+	int type_is_block;
 	/** @brief array of message requests */
 	MPI_Request *req;
 	/** @brief array of message status */
@@ -64,6 +70,12 @@ struct t_mpi_exchange {
 	int nreq_recv;
 	/** @brief communication library wait function */
 	kernel_backend_func_wait wait;
+	/** @brief communication library function waiting for some messages */
+	kernel_backend_func_waitsome waitsome;
+	/** @brief communication library function testing some messages */
+	kernel_backend_func_waitsome testsome;
+	/** @brief communication library function testing all messages */
+	kernel_backend_func_testall testall;
 	/** @brief communication library non blocking send function */
 	kernel_func_isendirecv isend;
 	/** @brief communication library non blocking recv function */
@@ -76,14 +88,20 @@ typedef struct t_mpi_exchange t_mpi_exchange;
 /**
  * @brief Create t_mpi_exchange object.
  *  
- * @param[in] type MPI type
- * @param[in] size size of MPI requests and statuses
+ * @details If block_size is larger than 1, a contiguous MPI datatype of block_size
+ *          elements of type is created and used for the messages. The messages of
+ *          the thread ranks (see \c distdir_run_ranks) use the functions of the
+ *          threads backend.
+ *  
+ * @param[in] type       MPI type
+ * @param[in] block_size number of contiguous elements of type per exchanged element
+ * @param[in] size       size of MPI requests and statuses
  * 
  * @return pointer to t_mpi_exchange object
  * 
  * @ingroup backend_mpi
  */
-t_mpi_exchange * new_mpi_exchanger(MPI_Datatype  type, int size);
+t_mpi_exchange * new_mpi_exchanger(MPI_Datatype  type, int block_size, int size);
 
 /**
  * @brief Free memory of t_mpi_exchange object.
@@ -95,7 +113,7 @@ t_mpi_exchange * new_mpi_exchanger(MPI_Datatype  type, int size);
 void delete_mpi_exchanger(t_mpi_exchange *mpi_exchange);
 
 /**
- * @brief Lightweight wrapper around MPI_Isend for integer buffers.
+ * @brief Lightweight wrapper around MPI_Isend.
  *  
  * @param[in]  buffer   buffer to be sent
  * @param[in]  count    size of the message
@@ -104,158 +122,96 @@ void delete_mpi_exchanger(t_mpi_exchange *mpi_exchange);
  * @param[in]  tag      message tag
  * @param[in]  comm     MPI communicator
  * @param[out] request  MPI request for non blocking messages
- * @param[in]  offset   buffer offset
- * 
- * @ingroup backend_mpi
- */
-void mpi_wrapper_isend_int(int *buffer, int count, MPI_Datatype datatype, int dest, int tag,
-                           MPI_Comm comm, MPI_Request *request, int offset);
-
-/**
- * @brief Lightweight wrapper around MPI_Isend for float buffers.
- *  
- * @param[in]  buffer   buffer to be sent
- * @param[in]  count    size of the message
- * @param[in]  datatype data type of buffer
- * @param[in]  dest     rank to send the message to
- * @param[in]  tag      message tag
- * @param[in]  comm     MPI communicator
- * @param[out] request  MPI request for non blocking messages
- * @param[in]  offset   buffer offset
- * 
- * @ingroup backend_mpi
- */
-void mpi_wrapper_isend_float(float *buffer, int count, MPI_Datatype datatype, int dest, int tag,
-                             MPI_Comm comm, MPI_Request *request, int offset);
-
-/**
- * @brief Lightweight wrapper around MPI_Isend for double buffers.
- *  
- * @param[in]  buffer   buffer to be sent
- * @param[in]  count    size of the message
- * @param[in]  datatype data type of buffer
- * @param[in]  dest     rank to send the message to
- * @param[in]  tag      message tag
- * @param[in]  comm     MPI communicator
- * @param[out] request  MPI request for non blocking messages
- * @param[in]  offset   buffer offset
- * 
- * @ingroup backend_mpi
- */
-void mpi_wrapper_isend_double(double *buffer, int count, MPI_Datatype datatype, int dest, int tag,
-                              MPI_Comm comm, MPI_Request *request, int offset);
-
-/**
- * @brief Lightweight wrapper around MPI_Irecv for integer buffers.
- *  
- * @param[in]  buffer   buffer to be received
- * @param[in]  count    size of the message
- * @param[in]  datatype data type of buffer
- * @param[in]  source     rank to receive the message from
- * @param[in]  tag      message tag
- * @param[in]  comm     MPI communicator
- * @param[out] request  MPI request for non blocking messages
- * @param[in]  offset   buffer offset
+ * @param[in]  offset   buffer offset in bytes
  * 
  * @ingroup backend_mpi
  */
-void mpi_wrapper_irecv_int(int *buffer, int count, MPI_Datatype datatype, int source, int tag,
-                           MPI_Comm comm, MPI_Request *request, int offset);
+void mpi_wrapper_isend(void *buffer, int count, MPI_Datatype datatype, int dest, int tag,
+                       MPI_Comm comm, MPI_Request *request, MPI_Aint offset);
 
 /**
- * @brief Lightweight wrapper around MPI_Irecv for float buffers.
+ * @brief Lightweight wrapper around MPI_Irecv.
  *  
  * @param[in]  buffer   buffer to be received
  * @param[in]  count    size of the message
  * @param[in]  datatype data type of buffer
- * @param[in]  source     rank to receive the message from
+ * @param[in]  source   rank to receive the message from
  * @param[in]  tag      message tag
  * @param[in]  comm     MPI communicator
  * @param[out] request  MPI request for non blocking messages
- * @param[in]  offset   buffer offset
+ * @param[in]  offset   buffer offset in bytes
  * 
  * @ingroup backend_mpi
  */
-void mpi_wrapper_irecv_float(float *buffer, int count, MPI_Datatype datatype, int source, int tag,
-                             MPI_Comm comm, MPI_Request *request, int offset);
+void mpi_wrapper_irecv(void *buffer, int count, MPI_Datatype datatype, int source, int tag,
+                       MPI_Comm comm, MPI_Request *request, MPI_Aint offset);
 
 /**
- * @brief Lightweight wrapper around MPI_Irecv for double buffers.
+ * @brief Lightweight wrapper around MPI_Recv.
  *  
  * @param[in]  buffer   buffer to be received
  * @param[in]  count    size of the message
  * @param[in]  datatype data type of buffer
- * @param[in]  source     rank to receive the message from
+ * @param[in]  source   rank to receive the message from
  * @param[in]  tag      message tag
  * @param[in]  comm     MPI communicator
- * @param[out] request  MPI request for non blocking messages
- * @param[in]  offset   buffer offset
+ * @param[out] status   message status
+ * @param[in]  offset   buffer offset in bytes
  * 
  * @ingroup backend_mpi
  */
-void mpi_wrapper_irecv_double(double *buffer, int count, MPI_Datatype datatype, int source, int tag,
-                              MPI_Comm comm, MPI_Request *request, int offset);
+void mpi_wrapper_recv(void *buffer, int count, MPI_Datatype datatype, int source, int tag,
+                      MPI_Comm comm, MPI_Status *status, MPI_Aint offset);
 
 /**
- * @brief Lightweight wrapper around MPI_Recv for integer buffers.
+ * @brief Lightweight wrapper around MPI_Waitall.
  *  
- * @param[in]  buffer   buffer to be received
- * @param[in]  count    size of the message
- * @param[in]  datatype data type of buffer
- * @param[in]  source     rank to receive the message from
- * @param[in]  tag      message tag
- * @param[in]  comm     MPI communicator
- * @param[out] status   message status
- * @param[in]  offset   buffer offset
+ * @param[in]  count    number of non blocking messages
+ * @param[in]  requests array of MPI request
+ * @param[out] statuses array of message statuses
  * 
  * @ingroup backend_mpi
  */
-void mpi_wrapper_recv_int(int *buffer, int count, MPI_Datatype datatype, int source, int tag,
-                          MPI_Comm comm, MPI_Status *status, int offset);
+void mpi_wrapper_waitall(int count, MPI_Request *requests, MPI_Status *statuses);
 
 /**
- * @brief Lightweight wrapper around MPI_Recv for float buffers.
+ * @brief Lightweight wrapper around MPI_Waitsome.
  *  
- * @param[in]  buffer   buffer to be received
- * @param[in]  count    size of the message
- * @param[in]  datatype data type of buffer
- * @param[in]  source     rank to receive the message from
- * @param[in]  tag      message tag
- * @param[in]  comm     MPI communicator
- * @param[out] status   message status
- * @param[in]  offset   buffer offset
+ * @param[in]  count    number of non blocking messages
+ * @param[in]  requests array of MPI request
+ * @param[out] outcount number of completed messages
+ * @param[out] indices  indices of the completed requests
+ * @param[out] statuses array of message statuses
  * 
  * @ingroup backend_mpi
  */
-void mpi_wrapper_recv_float(float *buffer, int count, MPI_Datatype datatype, int source, int tag,
-                            MPI_Comm comm, MPI_Status *status, int offset);
+void mpi_wrapper_waitsome(int count, MPI_Request *requests, int *outcount, int *indices,
+                          MPI_Status *statuses);
 
 /**
- * @brief Lightweight wrapper around MPI_Recv for double buffers.
+ * @brief Lightweight wrapper around MPI_Testsome.
  *  
- * @param[in]  buffer   buffer to be received
- * @param[in]  count    size of the message
- * @param[in]  datatype data type of buffer
- * @param[in]  source     rank to receive the message from
- * @param[in]  tag      message tag
- * @param[in]  comm     MPI communicator
- * @param[out] status   message status
- * @param[in]  offset   buffer offset
+ * @param[in]  count    number of non blocking messages
+ * @param[in]  requests array of MPI request
+ * @param[out] outcount number of completed messages
+ * @param[out] indices  indices of the completed requests
+ * @param[out] statuses array of message statuses
  * 
  * @ingroup backend_mpi
  */
-void mpi_wrapper_recv_double(double *buffer, int count, MPI_Datatype datatype, int source, int tag,
-                             MPI_Comm comm, MPI_Status *status, int offset);
+void mpi_wrapper_testsome(int count, MPI_Request *requests, int *outcount, int *indices,
+                          MPI_Status *statuses);
 
 /**
- * @brief Lightweight wrapper around MPI_Waitall.
+ * @brief Lightweight wrapper around MPI_Testall.
  *  
  * @param[in]  count    number of non blocking messages
  * @param[in]  requests array of MPI request
+ * @param[out] flag     1 if all the messages are completed
  * @param[out] statuses array of message statuses
  * 
  * @ingroup backend_mpi
  */
-void mpi_wrapper_waitall(int count, MPI_Request *requests, MPI_Status *statuses);
+void mpi_wrapper_testall(int count, MPI_Request *requests, int *flag, MPI_Status *statuses);
 
 #endif
\ No newline at end of file
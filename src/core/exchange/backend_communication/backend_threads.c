@@ -0,0 +1,586 @@
+/*
+ * @file backend_threads.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <sched.h>
+#include <pthread.h>
+#include "src/core/exchange/backend_communication/backend_threads.h"
+#include "src/setup/setting.h"
+#include "src/utils/check.h"
+#include "src/utils/memory.h"
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define THREADS_THREAD_LOCAL _Thread_local
+#else
+#define THREADS_THREAD_LOCAL __thread
+#endif
+
+/* size in bytes of a cache line, the indices of a queue are on different lines */
+#define THREADS_CACHE_LINE 64
+
+/* message posted by a send, the receiver copies the data from the send buffer */
+struct t_thread_message {
+	int source;
+	int tag;
+	MPI_Comm comm;
+	const void *buffer;
+	size_t bytes;
+	/* set by the receiver when the data is copied */
+	int done;
+	/* next message in the list of the unexpected messages of the receiver */
+	struct t_thread_message *next;
+};
+typedef struct t_thread_message t_thread_message;
+
+/* ring of messages with a single producer (source) and a single consumer (destination) */
+struct t_thread_queue {
+	t_thread_message *slots[THREADS_QUEUE_SIZE];
+	/* next slot read by the consumer */
+	size_t head;
+	char pad_head[THREADS_CACHE_LINE - sizeof(size_t)];
+	/* next slot written by the producer */
+	size_t tail;
+	char pad_tail[THREADS_CACHE_LINE - sizeof(size_t)];
+};
+typedef struct t_thread_queue t_thread_queue;
+
+/* send or receive posted by a thread rank, identified by the address of its request */
+struct t_thread_op {
+	const void *key;
+	int is_send;
+	/* message of the send (it points to send_message) */
+	t_thread_message *message;
+	t_thread_message send_message;
+	/* matching information and buffer of the receive */
+	int source;
+	int tag;
+	MPI_Comm comm;
+	void *buffer;
+	size_t bytes;
+	int complete;
+	struct t_thread_op *next;
+};
+typedef struct t_thread_op t_thread_op;
+
+/* state shared by the thread ranks */
+struct t_thread_ranks {
+	int nranks;
+	/* queue of the messages from the rank i to the rank j is queues[i * nranks + j] */
+	t_thread_queue *queues;
+	pthread_barrier_t barrier;
+	/* send buffers of the current collective */
+	const void **coll_send;
+	distdir_ranks_fn fn;
+	void *ctx;
+	MPI_Comm comm;
+};
+typedef struct t_thread_ranks t_thread_ranks;
+
+/* state of a thread rank, used only by its thread */
+struct t_thread_rank {
+	int rank;
+	t_thread_ranks *shared;
+	/* posted operations in the order of their post */
+	t_thread_op *ops_head;
+	t_thread_op *ops_tail;
+	/* messages received before the matching receive is posted */
+	t_thread_message *unexpected_head;
+	t_thread_message *unexpected_tail;
+	/* completed operations kept for the next posts */
+	t_thread_op *ops_free;
+};
+typedef struct t_thread_rank t_thread_rank;
+
+static THREADS_THREAD_LOCAL t_thread_rank *thread_rank = NULL;
+
+static int queue_push(t_thread_queue *queue, t_thread_message *message) {
+
+	size_t tail = queue->tail;
+	size_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+	if (tail - head == THREADS_QUEUE_SIZE) return 0;
+
+	queue->slots[tail & (THREADS_QUEUE_SIZE - 1)] = message;
+	__atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+static t_thread_message * queue_pop(t_thread_queue *queue) {
+
+	size_t head = queue->head;
+	size_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+	if (head == tail) return NULL;
+
+	t_thread_message *message = queue->slots[head & (THREADS_QUEUE_SIZE - 1)];
+	__atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+	return message;
+}
+
+/* move the new messages to the unexpected list, copy the messages of the posted
+ * receives (in the order of their post) and check the completion of the sends */
+static void threads_progress(t_thread_rank *self) {
+
+	t_thread_ranks *shared = self->shared;
+
+	for (int source = 0; source < shared->nranks; source++) {
+		t_thread_queue *queue = &shared->queues[source * shared->nranks + self->rank];
+		t_thread_message *message;
+		while ((message = queue_pop(queue)) != NULL) {
+			message->next = NULL;
+			if (self->unexpected_tail == NULL)
+				self->unexpected_head = message;
+			else
+				self->unexpected_tail->next = message;
+			self->unexpected_tail = message;
+		}
+	}
+
+	for (t_thread_op *op = self->ops_head; op != NULL; op = op->next) {
+
+		if (op->complete) continue;
+
+		if (op->is_send) {
+			op->complete = __atomic_load_n(&op->message->done, __ATOMIC_ACQUIRE);
+			continue;
+		}
+
+		for (t_thread_message *prev = NULL, *message = self->unexpected_head; message != NULL;
+		     prev = message, message = message->next) {
+			if ((op->source == message->source || op->source == MPI_ANY_SOURCE) &&
+			    op->tag == message->tag && op->comm == message->comm) {
+				if (prev == NULL)
+					self->unexpected_head = message->next;
+				else
+					prev->next = message->next;
+				if (self->unexpected_tail == message) self->unexpected_tail = prev;
+#ifdef ERROR_CHECK
+				assert(message->bytes <= op->bytes);
+#endif
+				if (message->bytes > 0) memcpy(op->buffer, message->buffer, message->bytes);
+				/* the sender can free the message from now on */
+				__atomic_store_n(&message->done, 1, __ATOMIC_RELEASE);
+				op->complete = 1;
+				break;
+			}
+		}
+	}
+}
+
+static t_thread_op * threads_new_op(t_thread_rank *self, const void *key) {
+
+	t_thread_op *op = self->ops_free;
+	if (op != NULL)
+		self->ops_free = op->next;
+	else
+		op = (t_thread_op *)memory_malloc(sizeof(t_thread_op), memory_workspace);
+	op->key = key;
+	op->message = NULL;
+	op->complete = 0;
+	op->next = NULL;
+
+	if (self->ops_tail == NULL)
+		self->ops_head = op;
+	else
+		self->ops_tail->next = op;
+	self->ops_tail = op;
+
+	return op;
+}
+
+static void threads_post_send(const void *buffer, size_t bytes, int dest, int tag,
+                              MPI_Comm comm, const void *key) {
+
+	t_thread_rank *self = thread_rank;
+	t_thread_ranks *shared = self->shared;
+
+#ifdef ERROR_CHECK
+	assert(dest >= 0 && dest < shared->nranks);
+#endif
+
+	t_thread_op *op = threads_new_op(self, key);
+	op->is_send = 1;
+
+	t_thread_message *message = &op->send_message;
+	message->source = self->rank;
+	message->tag = tag;
+	message->comm = comm;
+	message->buffer = buffer;
+	message->bytes = bytes;
+	message->done = 0;
+	message->next = NULL;
+	op->message = message;
+
+	/* the receives of the calling thread progress while the queue is full */
+	t_thread_queue *queue = &shared->queues[self->rank * shared->nranks + dest];
+	while (!queue_push(queue, message)) {
+		threads_progress(self);
+		sched_yield();
+	}
+}
+
+static void threads_post_recv(void *buffer, size_t bytes, int source, int tag,
+                              MPI_Comm comm, const void *key) {
+
+	t_thread_rank *self = thread_rank;
+
+#ifdef ERROR_CHECK
+	assert(source == MPI_ANY_SOURCE || (source >= 0 && source < self->shared->nranks));
+#endif
+
+	t_thread_op *op = threads_new_op(self, key);
+	op->is_send = 0;
+	op->source = source;
+	op->tag = tag;
+	op->comm = comm;
+	op->buffer = buffer;
+	op->bytes = bytes;
+}
+
+/* count the operations of the requests [base, base + count * stride) and the completed
+ * ones, the completed operations are moved to the free list if remove is set and their
+ * indices are stored */
+static void threads_scan(t_thread_rank *self, const void *base, size_t stride, int count,
+                         int remove, int *nactive, int *ncomplete, int *indices) {
+
+	uintptr_t begin = (uintptr_t)base;
+	uintptr_t end = begin + (uintptr_t)count * stride;
+
+	*nactive = 0;
+	*ncomplete = 0;
+
+	for (t_thread_op *prev = NULL, *op = self->ops_head; op != NULL; ) {
+		t_thread_op *next = op->next;
+		uintptr_t key = (uintptr_t)op->key;
+		if (key >= begin && key < end) {
+			(*nactive)++;
+			if (op->complete) {
+				if (indices != NULL) indices[*ncomplete] = (int)((key - begin) / stride);
+				(*ncomplete)++;
+				if (remove) {
+					if (prev == NULL)
+						self->ops_head = next;
+					else
+						prev->next = next;
+					if (self->ops_tail == op) self->ops_tail = prev;
+					op->next = self->ops_free;
+					self->ops_free = op;
+					op = next;
+					continue;
+				}
+			}
+		}
+		prev = op;
+		op = next;
+	}
+}
+
+static void threads_wait(const void *base, size_t stride, int count) {
+
+	t_thread_rank *self = thread_rank;
+	int nactive, ncomplete;
+
+	while (1) {
+		threads_progress(self);
+		threads_scan(self, base, stride, count, 1, &nactive, &ncomplete, NULL);
+		if (nactive == ncomplete) break;
+		sched_yield();
+	}
+}
+
+/* size in bytes of the data, the data is copied with memcpy so the datatype has to be contiguous */
+static size_t threads_bytes(int count, MPI_Datatype datatype) {
+
+	int type_size;
+	MPI_Aint lb, extent, true_lb, true_extent;
+	check_mpi( MPI_Type_size(datatype, &type_size) );
+	check_mpi( MPI_Type_get_extent(datatype, &lb, &extent) );
+	check_mpi( MPI_Type_get_true_extent(datatype, &true_lb, &true_extent) );
+
+	if (lb != 0 || true_lb != 0 || extent != type_size || true_extent != type_size) {
+		fprintf(stderr, "distdir: the thread ranks support only contiguous datatypes\n");
+		check_mpi(MPI_ERR_TYPE);
+	}
+
+	return (size_t)count * (size_t)type_size;
+}
+
+void threads_wrapper_isend(void *buffer, int count, MPI_Datatype datatype, int dest, int tag,
+                           MPI_Comm comm, MPI_Request *request, MPI_Aint offset) {
+
+	*request = MPI_REQUEST_NULL;
+	threads_post_send((char *)buffer + offset, threads_bytes(count, datatype), dest, tag, comm, request);
+}
+
+void threads_wrapper_irecv(void *buffer, int count, MPI_Datatype datatype, int source, int tag,
+                           MPI_Comm comm, MPI_Request *request, MPI_Aint offset) {
+
+	*request = MPI_REQUEST_NULL;
+	threads_post_recv((char *)buffer + offset, threads_bytes(count, datatype), source, tag, comm, request);
+}
+
+void threads_wrapper_recv(void *buffer, int count, MPI_Datatype datatype, int source, int tag,
+                          MPI_Comm comm, MPI_Status *status, MPI_Aint offset) {
+
+	(void)status;
+	MPI_Request request;
+	threads_post_recv((char *)buffer + offset, threads_bytes(count, datatype), source, tag, comm, &request);
+	threads_wait(&request, sizeof(MPI_Request), 1);
+}
+
+void threads_wrapper_waitall(int count, MPI_Request *requests, MPI_Status *statuses) {
+
+	(void)statuses;
+	threads_wait(requests, sizeof(MPI_Request), count);
+}
+
+void threads_wrapper_testsome(int count, MPI_Request *requests, int *outcount, int *indices,
+                              MPI_Status *statuses) {
+
+	(void)statuses;
+	t_thread_rank *self = thread_rank;
+	int nactive;
+
+	threads_progress(self);
+	threads_scan(self, requests, sizeof(MPI_Request), count, 1, &nactive, outcount, indices);
+	if (nactive == 0) *outcount = MPI_UNDEFINED;
+}
+
+void threads_wrapper_waitsome(int count, MPI_Request *requests, int *outcount, int *indices,
+                              MPI_Status *statuses) {
+
+	while (1) {
+		threads_wrapper_testsome(count, requests, outcount, indices, statuses);
+		if (*outcount != 0) break;
+		sched_yield();
+	}
+}
+
+void threads_wrapper_testall(int count, MPI_Request *requests, int *flag, MPI_Status *statuses) {
+
+	(void)statuses;
+	t_thread_rank *self = thread_rank;
+	int nactive, ncomplete;
+
+	threads_progress(self);
+	threads_scan(self, requests, sizeof(MPI_Request), count, 0, &nactive, &ncomplete, NULL);
+	*flag = nactive == ncomplete;
+	if (*flag)
+		threads_scan(self, requests, sizeof(MPI_Request), count, 1, &nactive, &ncomplete, NULL);
+}
+
+static void threads_comm_rank(MPI_Comm comm, int *rank) {
+
+	(void)comm;
+	*rank = thread_rank->rank;
+}
+
+static void threads_comm_size(MPI_Comm comm, int *size) {
+
+	(void)comm;
+	*size = thread_rank->shared->nranks;
+}
+
+static void threads_isend(const void *buffer, int count, MPI_Datatype datatype, int dest, int tag,
+                          MPI_Comm comm, t_comm_request *request) {
+
+	request->ptr = NULL;
+	threads_post_send(buffer, threads_bytes(count, datatype), dest, tag, comm, request);
+}
+
+static void threads_irecv(void *buffer, int count, MPI_Datatype datatype, int source, int tag,
+                          MPI_Comm comm, t_comm_request *request) {
+
+	request->ptr = NULL;
+	threads_post_recv(buffer, threads_bytes(count, datatype), source, tag, comm, request);
+}
+
+static void threads_send(const void *buffer, int count, MPI_Datatype datatype, int dest, int tag,
+                         MPI_Comm comm) {
+
+	t_comm_request request;
+	threads_isend(buffer, count, datatype, dest, tag, comm, &request);
+	threads_wait(&request, sizeof(t_comm_request), 1);
+}
+
+static void threads_waitall(int count, t_comm_request *requests) {
+
+	threads_wait(requests, sizeof(t_comm_request), count);
+}
+
+/* each thread reduces its part of the send buffers of all the threads,
+ * the buffers are read between two barriers */
+static void threads_collective(const void *sendbuf, void *recvbuf, int count,
+                               MPI_Datatype datatype, MPI_Op op, int scatter) {
+
+	t_thread_rank *self = thread_rank;
+	t_thread_ranks *shared = self->shared;
+
+	if (sendbuf == MPI_IN_PLACE) sendbuf = recvbuf;
+
+	size_t bytes = threads_bytes(count, datatype);
+	size_t offset = scatter ? self->rank * bytes : 0;
+
+	shared->coll_send[self->rank] = sendbuf;
+	pthread_barrier_wait(&shared->barrier);
+
+	void *result = memory_malloc(bytes > 0 ? bytes : 1, memory_workspace);
+	memcpy(result, (const char *)shared->coll_send[0] + offset, bytes);
+	for (int i = 1; i < shared->nranks; i++)
+		comm_reduce_local(result, (const char *)shared->coll_send[i] + offset, count, datatype, op);
+
+	pthread_barrier_wait(&shared->barrier);
+
+	memcpy(recvbuf, result, bytes);
+	memory_free(result);
+}
+
+static void threads_reduce_scatter_block(const void *sendbuf, void *recvbuf, int count,
+                                         MPI_Datatype datatype, MPI_Op op, MPI_Comm comm) {
+
+	(void)comm;
+	threads_collective(sendbuf, recvbuf, count, datatype, op, 1);
+}
+
+static void threads_allreduce(const void *sendbuf, void *recvbuf, int count,
+                              MPI_Datatype datatype, MPI_Op op, MPI_Comm comm) {
+
+	(void)comm;
+	threads_collective(sendbuf, recvbuf, count, datatype, op, 0);
+}
+
+static void threads_barrier(MPI_Comm comm) {
+
+	(void)comm;
+	pthread_barrier_wait(&thread_rank->shared->barrier);
+}
+
+static const t_comm_backend comm_backend_threads = {
+	.comm_rank            = threads_comm_rank,
+	.comm_size            = threads_comm_size,
+	.isend                = threads_isend,
+	.irecv                = threads_irecv,
+	.send                 = threads_send,
+	.waitall              = threads_waitall,
+	.reduce_scatter_block = threads_reduce_scatter_block,
+	.allreduce            = threads_allreduce,
+	.barrier              = threads_barrier,
+};
+
+const t_comm_backend * get_comm_backend_threads() {
+
+	return &comm_backend_threads;
+}
+
+int thread_ranks_active() {
+
+	return thread_rank != NULL;
+}
+
+static void * threads_main(void *arg) {
+
+	t_thread_rank *self = (t_thread_rank *)arg;
+	t_thread_ranks *shared = self->shared;
+
+	thread_rank = self;
+	set_comm_backend(&comm_backend_threads);
+
+	shared->fn(self->rank, shared->nranks, shared->comm, shared->ctx);
+
+#ifdef ERROR_CHECK
+	assert(self->ops_head == NULL && self->unexpected_head == NULL);
+#endif
+
+	while (self->ops_free != NULL) {
+		t_thread_op *op = self->ops_free;
+		self->ops_free = op->next;
+		memory_free(op);
+	}
+
+	set_comm_backend(NULL);
+	thread_rank = NULL;
+
+	return NULL;
+}
+
+void distdir_run_ranks(distdir_ranks_fn fn, void *ctx) {
+
+	MPI_Comm comm = get_config_comm();
+	int nranks = get_config_thread_ranks();
+
+	if (nranks <= 0) {
+		int rank, size;
+		check_mpi( MPI_Comm_rank(comm, &rank) );
+		check_mpi( MPI_Comm_size(comm, &size) );
+		fn(rank, size, comm, ctx);
+		return;
+	}
+
+#ifdef ERROR_CHECK
+	assert(thread_rank == NULL);
+#endif
+
+	t_thread_ranks shared;
+	shared.nranks = nranks;
+	shared.queues = (t_thread_queue *)memory_calloc((size_t)nranks * nranks, sizeof(t_thread_queue),
+	                                                memory_workspace);
+	shared.coll_send = (const void **)memory_malloc(nranks * sizeof(void *), memory_workspace);
+	shared.fn = fn;
+	shared.ctx = ctx;
+	shared.comm = comm;
+	pthread_barrier_init(&shared.barrier, NULL, nranks);
+
+	t_thread_rank *ranks = (t_thread_rank *)memory_calloc(nranks, sizeof(t_thread_rank), memory_workspace);
+	pthread_t *threads = (pthread_t *)memory_malloc(nranks * sizeof(pthread_t), memory_workspace);
+
+	for (int i = 0; i < nranks; i++) {
+		ranks[i].rank = i;
+		ranks[i].shared = &shared;
+		if (pthread_create(&threads[i], NULL, threads_main, &ranks[i]) != 0) {
+			fprintf(stderr, "distdir_run_ranks: creation of the thread rank %d failed\n", i);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	for (int i = 0; i < nranks; i++)
+		pthread_join(threads[i], NULL);
+
+	pthread_barrier_destroy(&shared.barrier);
+	memory_free(threads);
+	memory_free(ranks);
+	memory_free(shared.coll_send);
+	memory_free(shared.queues);
+}
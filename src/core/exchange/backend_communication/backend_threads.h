@@ -0,0 +1,194 @@
+/*
+ * @file backend_threads.h
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef BACKEND_THREADS_H
+#define BACKEND_THREADS_H
+
+#include "mpi.h"
+#include "src/core/algorithm/backend_communication/backend_comm.h"
+
+/** @brief number of messages of the queue between two thread ranks (power of 2) */
+#define THREADS_QUEUE_SIZE 64
+
+/**
+ * @brief Function run by each rank of \c distdir_run_ranks.
+ * 
+ * @param[in] rank rank of the calling process or thread
+ * @param[in] size number of processes or threads
+ * @param[in] comm MPI communicator to be used to create the maps
+ * @param[in] ctx  pointer passed to \c distdir_run_ranks
+ */
+typedef void (*distdir_ranks_fn) (int rank, int size, MPI_Comm comm, void *ctx);
+
+/**
+ * @brief Run a function on the ranks selected by the configuration of the library.
+ * 
+ * @details If the number of thread ranks of the configuration is zero (default), the
+ *          function is called once by the calling process with its rank in the
+ *          communicator of the library. Otherwise, the function is called by that
+ *          number of threads of the calling process, which are the ranks of the maps
+ *          and of the exchangers created by the function: the messages between the
+ *          threads go through shared memory queues and are copied once, from the
+ *          send buffer to the receive buffer. The messages are matched on the
+ *          source, the tag and the communicator and their datatypes must be
+ *          contiguous. The communicator passed to the function
+ *          is ignored by the maps and the exchangers of the threads. The maps and the
+ *          exchangers must be deleted before the function returns.
+ * 
+ * @param[in] fn  function run by each rank
+ * @param[in] ctx pointer passed to the function
+ * 
+ * @ingroup backend_threads
+ */
+void distdir_run_ranks(distdir_ranks_fn fn, void *ctx);
+
+/**
+ * @brief Return 1 if the calling thread is a thread rank, 0 otherwise.
+ * 
+ * @ingroup backend_threads
+ */
+int thread_ranks_active();
+
+/**
+ * @brief Return the communication backend of the map creation of the thread ranks.
+ * 
+ * @ingroup backend_threads
+ */
+const t_comm_backend * get_comm_backend_threads();
+
+/**
+ * @brief Non blocking send between thread ranks with the semantic of MPI_Isend.
+ * 
+ * @details The message is completed when the receiver has copied it.
+ * 
+ * @param[in]  buffer   buffer to be sent
+ * @param[in]  count    size of the message
+ * @param[in]  datatype data type of buffer
+ * @param[in]  dest     rank to send the message to
+ * @param[in]  tag      message tag
+ * @param[in]  comm     MPI communicator (ignored)
+ * @param[out] request  request of the message (set to MPI_REQUEST_NULL, its address identifies the message)
+ * @param[in]  offset   buffer offset in bytes
+ * 
+ * @ingroup backend_threads
+ */
+void threads_wrapper_isend(void *buffer, int count, MPI_Datatype datatype, int dest, int tag,
+                           MPI_Comm comm, MPI_Request *request, MPI_Aint offset);
+
+/**
+ * @brief Non blocking receive between thread ranks with the semantic of MPI_Irecv.
+ * 
+ * @param[in]  buffer   buffer to be received
+ * @param[in]  count    size of the message
+ * @param[in]  datatype data type of buffer
+ * @param[in]  source   rank to receive the message from (or MPI_ANY_SOURCE)
+ * @param[in]  tag      message tag
+ * @param[in]  comm     MPI communicator (ignored)
+ * @param[out] request  request of the message (set to MPI_REQUEST_NULL, its address identifies the message)
+ * @param[in]  offset   buffer offset in bytes
+ * 
+ * @ingroup backend_threads
+ */
+void threads_wrapper_irecv(void *buffer, int count, MPI_Datatype datatype, int source, int tag,
+                           MPI_Comm comm, MPI_Request *request, MPI_Aint offset);
+
+/**
+ * @brief Blocking receive between thread ranks with the semantic of MPI_Recv.
+ * 
+ * @param[in]  buffer   buffer to be received
+ * @param[in]  count    size of the message
+ * @param[in]  datatype data type of buffer
+ * @param[in]  source   rank to receive the message from (or MPI_ANY_SOURCE)
+ * @param[in]  tag      message tag
+ * @param[in]  comm     MPI communicator (ignored)
+ * @param[out] status   message status (ignored)
+ * @param[in]  offset   buffer offset in bytes
+ * 
+ * @ingroup backend_threads
+ */
+void threads_wrapper_recv(void *buffer, int count, MPI_Datatype datatype, int source, int tag,
+                          MPI_Comm comm, MPI_Status *status, MPI_Aint offset);
+
+/**
+ * @brief Wait for the messages of an array of requests with the semantic of MPI_Waitall.
+ * 
+ * @param[in]  count    number of requests
+ * @param[in]  requests array of requests
+ * @param[out] statuses array of message statuses (ignored)
+ * 
+ * @ingroup backend_threads
+ */
+void threads_wrapper_waitall(int count, MPI_Request *requests, MPI_Status *statuses);
+
+/**
+ * @brief Wait for at least one message of an array of requests with the semantic of MPI_Waitsome.
+ * 
+ * @param[in]  count    number of requests
+ * @param[in]  requests array of requests
+ * @param[out] outcount number of completed messages (MPI_UNDEFINED if there are no active requests)
+ * @param[out] indices  indices of the completed requests
+ * @param[out] statuses array of message statuses (ignored)
+ * 
+ * @ingroup backend_threads
+ */
+void threads_wrapper_waitsome(int count, MPI_Request *requests, int *outcount, int *indices,
+                              MPI_Status *statuses);
+
+/**
+ * @brief Test the messages of an array of requests with the semantic of MPI_Testsome.
+ * 
+ * @param[in]  count    number of requests
+ * @param[in]  requests array of requests
+ * @param[out] outcount number of completed messages (MPI_UNDEFINED if there are no active requests)
+ * @param[out] indices  indices of the completed requests
+ * @param[out] statuses array of message statuses (ignored)
+ * 
+ * @ingroup backend_threads
+ */
+void threads_wrapper_testsome(int count, MPI_Request *requests, int *outcount, int *indices,
+                              MPI_Status *statuses);
+
+/**
+ * @brief Test the messages of an array of requests with the semantic of MPI_Testall.
+ * 
+ * @param[in]  count    number of requests
+ * @param[in]  requests array of requests
+ * @param[out] flag     1 if all the messages are completed, 0 otherwise
+ * @param[out] statuses array of message statuses (ignored)
+ * 
+ * @ingroup backend_threads
+ */
+void threads_wrapper_testall(int count, MPI_Request *requests, int *flag, MPI_Status *statuses);
+
+#endif
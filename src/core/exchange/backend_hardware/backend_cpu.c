@@ -33,161 +33,483 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
 #include "src/core/exchange/backend_hardware/backend_cpu.h"
+#include "src/setup/setting.h"
 #include "src/utils/check.h"
+#include "src/utils/memory.h"
 
-t_kernels * new_vtable_cpu(MPI_Datatype type) {
-
-	t_kernels * table_kernels = (t_kernels *)malloc(sizeof(t_kernels));
-
-	/* Malloc / Free functions */
-	table_kernels->allocator = allocator_cpu;
-	table_kernels->deallocator = deallocator_cpu;
-
-	if (type == MPI_INT || type == MPI_INTEGER) {
-
-		/* Packing / Unpacking functions */
-		table_kernels->pack = (kernel_func_pack)pack_cpu_int;
-		table_kernels->unpack = (kernel_func_pack)unpack_cpu_int;
-	} else if (type == MPI_REAL || type == MPI_FLOAT) {
-
-		/* Packing / Unpacking functions */
-		table_kernels->pack = (kernel_func_pack)pack_cpu_float;
-		table_kernels->unpack = (kernel_func_pack)unpack_cpu_float;
-	} else if (type == MPI_DOUBLE || type == MPI_DOUBLE_PRECISION) {
-
-		/* Packing / Unpacking functions */
-		table_kernels->pack = (kernel_func_pack)pack_cpu_double;
-		table_kernels->unpack = (kernel_func_pack)unpack_cpu_double;
-	}
-}
-
-void delete_vtable(t_kernels *vtable) {
-
-	free(vtable);
-}
-
-void pack_cpu_int(int *buffer, int *data, int *buffer_idxlist, int buffer_size, int offset, int *transform) {
+/* The element size is a compile time constant in the specialized kernels,
+ * so memcpy is turned into a single load/store of the right width */
+static inline void pack_cpu_kernel(char *buffer, const char *data, const int *buffer_idxlist,
+                                   int buffer_size, int offset, const int *transform,
+                                   const size_t type_size) {
 
 	if (transform == NULL) {
 
 		for (int i = 0; i < buffer_size; i++) {
-			int data_idx = buffer_idxlist[offset+i];
-			buffer[offset+i] = data[data_idx];
+			size_t data_idx = buffer_idxlist[offset+i];
+			memcpy(&buffer[(offset+i)*type_size], &data[data_idx*type_size], type_size);
 		}
 	} else {
 
 		for (int i = 0; i < buffer_size; i++) {
 			int data_idx = buffer_idxlist[offset+i];
-			int data_idx_transform = transform[data_idx];
-			buffer[offset+i] = data[data_idx_transform];
+			size_t data_idx_transform = transform[data_idx];
+			memcpy(&buffer[(offset+i)*type_size], &data[data_idx_transform*type_size], type_size);
 		}
 	}
 }
 
-void unpack_cpu_int(int *buffer, int *data, int *buffer_idxlist, int buffer_size, int offset, int *transform) {
+static inline void unpack_cpu_kernel(const char *buffer, char *data, const int *buffer_idxlist,
+                                     int buffer_size, int offset, const int *transform,
+                                     const size_t type_size) {
 
 	if (transform == NULL) {
 
 		for (int i = 0; i < buffer_size; i++) {
-			int data_idx = buffer_idxlist[offset+i];
-			data[data_idx] = buffer[offset+i];
+			size_t data_idx = buffer_idxlist[offset+i];
+			memcpy(&data[data_idx*type_size], &buffer[(offset+i)*type_size], type_size);
 		}
 	} else {
 
 		for (int i = 0; i < buffer_size; i++) {
 			int data_idx = buffer_idxlist[offset+i];
-			int data_idx_transform = transform[data_idx];
-			data[data_idx_transform] = buffer[offset+i];
+			size_t data_idx_transform = transform[data_idx];
+			memcpy(&data[data_idx_transform*type_size], &buffer[(offset+i)*type_size], type_size);
 		}
 	}
 }
 
-void pack_cpu_float(float *buffer, float *data, int *buffer_idxlist, int buffer_size, int offset, int *transform) {
+/* Round to nearest even the double to bfloat16 in a single step (a conversion
+ * through float rounds twice), NaN are kept quiet */
+static inline uint16_t double_to_bfloat16(double value) {
+
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	const uint16_t sign = (uint16_t)((bits >> 48) & 0x8000u);
+	const uint64_t abs = bits & 0x7fffffffffffffffULL;
+	const int exponent = (int)(abs >> 52);
+
+	if (abs > 0x7ff0000000000000ULL)
+		return sign | 0x7fc0u | (uint16_t)((abs >> 45) & 0x7fu);
+	/* |value| >= 2^128 */
+	if (exponent >= 1151)
+		return sign | 0x7f80u;
+
+	/* bits of the significand below the bfloat16 precision, more for subnormals */
+	const int shift = exponent >= 897 ? 45 : 45 + 897 - exponent;
+	if (shift > 53)
+		return sign;
+	uint64_t significand = abs & 0x000fffffffffffffULL;
+	if (exponent > 0) significand |= 1ULL << 52;
+
+	uint64_t result = significand >> shift;
+	const uint64_t rest = significand & ((1ULL << shift) - 1);
+	const uint64_t half = 1ULL << (shift - 1);
+	if (rest > half || (rest == half && (result & 1)))
+		result++;
+	/* the implicit bit and the carry of the rounding increase the exponent */
+	if (exponent >= 897)
+		result += (uint64_t)(exponent - 897) << 7;
+	if (result > 0x7f80u)
+		result = 0x7f80u;
+	return sign | (uint16_t)result;
+}
 
-	if (transform == NULL) {
+static inline double bfloat16_to_double(uint16_t value) {
 
-		for (int i = 0; i < buffer_size; i++) {
-			int data_idx = buffer_idxlist[offset+i];
-			buffer[offset+i] = data[data_idx];
-		}
-	} else {
+	uint32_t bits = (uint32_t)value << 16;
+	float f;
+	memcpy(&f, &bits, sizeof(f));
+	return (double)f;
+}
 
-		for (int i = 0; i < buffer_size; i++) {
-			int data_idx = buffer_idxlist[offset+i];
-			int data_idx_transform = transform[data_idx];
-			buffer[offset+i] = data[data_idx_transform];
-		}
+/* The conversion kernels work on blocks of n values, where the inner loop
+ * over the block is contiguous in both arrays and it is vectorized */
+static inline void pack_cpu_double_to_float_kernel(float *restrict buffer, const double *restrict data,
+                                                   const int *buffer_idxlist, int buffer_size,
+                                                   int offset, const int *transform, const size_t n) {
+
+	for (int i = 0; i < buffer_size; i++) {
+		size_t data_idx = buffer_idxlist[offset+i];
+		if (transform != NULL) data_idx = transform[data_idx];
+		const double *restrict src = &data[data_idx*n];
+		float *restrict dst = &buffer[(offset+i)*n];
+		for (size_t j = 0; j < n; j++)
+			dst[j] = (float)src[j];
 	}
 }
 
-void unpack_cpu_float(float *buffer, float *data, int *buffer_idxlist, int buffer_size, int offset, int *transform) {
-
-	if (transform == NULL) {
+static inline void unpack_cpu_float_to_double_kernel(const float *restrict buffer, double *restrict data,
+                                                     const int *buffer_idxlist, int buffer_size,
+                                                     int offset, const int *transform, const size_t n) {
+
+	for (int i = 0; i < buffer_size; i++) {
+		size_t data_idx = buffer_idxlist[offset+i];
+		if (transform != NULL) data_idx = transform[data_idx];
+		const float *restrict src = &buffer[(offset+i)*n];
+		double *restrict dst = &data[data_idx*n];
+		for (size_t j = 0; j < n; j++)
+			dst[j] = (double)src[j];
+	}
+}
 
-		for (int i = 0; i < buffer_size; i++) {
-			int data_idx = buffer_idxlist[offset+i];
-			data[data_idx] = buffer[offset+i];
-		}
-	} else {
+static inline void pack_cpu_double_to_bfloat16_kernel(uint16_t *restrict buffer, const double *restrict data,
+                                                      const int *buffer_idxlist, int buffer_size,
+                                                      int offset, const int *transform, const size_t n) {
+
+	for (int i = 0; i < buffer_size; i++) {
+		size_t data_idx = buffer_idxlist[offset+i];
+		if (transform != NULL) data_idx = transform[data_idx];
+		const double *restrict src = &data[data_idx*n];
+		uint16_t *restrict dst = &buffer[(offset+i)*n];
+		for (size_t j = 0; j < n; j++)
+			dst[j] = double_to_bfloat16(src[j]);
+	}
+}
 
-		for (int i = 0; i < buffer_size; i++) {
-			int data_idx = buffer_idxlist[offset+i];
-			int data_idx_transform = transform[data_idx];
-			data[data_idx_transform] = buffer[offset+i];
-		}
+static inline void unpack_cpu_bfloat16_to_double_kernel(const uint16_t *restrict buffer, double *restrict data,
+                                                        const int *buffer_idxlist, int buffer_size,
+                                                        int offset, const int *transform, const size_t n) {
+
+	for (int i = 0; i < buffer_size; i++) {
+		size_t data_idx = buffer_idxlist[offset+i];
+		if (transform != NULL) data_idx = transform[data_idx];
+		const uint16_t *restrict src = &buffer[(offset+i)*n];
+		double *restrict dst = &data[data_idx*n];
+		for (size_t j = 0; j < n; j++)
+			dst[j] = bfloat16_to_double(src[j]);
 	}
 }
 
-void pack_cpu_double(double *buffer, double *data, int *buffer_idxlist, int buffer_size, int offset, int *transform) {
+t_kernels * new_vtable_cpu(size_t type_size) {
 
-	if (transform == NULL) {
+#ifdef ERROR_CHECK
+	assert(type_size > 0);
+#endif
 
-		for (int i = 0; i < buffer_size; i++) {
-			int data_idx = buffer_idxlist[offset+i];
-			buffer[offset+i] = data[data_idx];
-		}
-	} else {
+	t_kernels * table_kernels = (t_kernels *)memory_malloc(sizeof(t_kernels), memory_exchange);
 
-		for (int i = 0; i < buffer_size; i++) {
-			int data_idx = buffer_idxlist[offset+i];
-			int data_idx_transform = transform[data_idx];
-			buffer[offset+i] = data[data_idx_transform];
-		}
+	/* Malloc / Free functions */
+	table_kernels->allocator = allocator_cpu;
+	table_kernels->deallocator = deallocator_cpu;
+
+	/* Packing / Unpacking functions */
+	table_kernels->type_size = type_size;
+	switch (type_size) {
+		case 1:
+			table_kernels->pack   = pack_cpu_1;
+			table_kernels->unpack = unpack_cpu_1;
+			break;
+		case 2:
+			table_kernels->pack   = pack_cpu_2;
+			table_kernels->unpack = unpack_cpu_2;
+			break;
+		case 4:
+			table_kernels->pack   = pack_cpu_4;
+			table_kernels->unpack = unpack_cpu_4;
+			break;
+		case 8:
+			table_kernels->pack   = pack_cpu_8;
+			table_kernels->unpack = unpack_cpu_8;
+			break;
+		case 12:
+			table_kernels->pack   = pack_cpu_12;
+			table_kernels->unpack = unpack_cpu_12;
+			break;
+		case 16:
+			table_kernels->pack   = pack_cpu_16;
+			table_kernels->unpack = unpack_cpu_16;
+			break;
+		case 24:
+			table_kernels->pack   = pack_cpu_24;
+			table_kernels->unpack = unpack_cpu_24;
+			break;
+		case 32:
+			table_kernels->pack   = pack_cpu_32;
+			table_kernels->unpack = unpack_cpu_32;
+			break;
+		case 64:
+			table_kernels->pack   = pack_cpu_64;
+			table_kernels->unpack = unpack_cpu_64;
+			break;
+		default:
+			table_kernels->pack   = pack_cpu_generic;
+			table_kernels->unpack = unpack_cpu_generic;
+			break;
 	}
+
+	/* no precision conversion */
+	table_kernels->pack_local = table_kernels->pack;
+	table_kernels->unpack_local = table_kernels->unpack;
+	table_kernels->local_type_size = type_size;
+
+	return table_kernels;
 }
 
-void unpack_cpu_double(double *buffer, double *data, int *buffer_idxlist, int buffer_size, int offset, int *transform) {
+t_kernels * new_vtable_cpu_reduced_precision(int block_size, int precision) {
+
+#ifdef ERROR_CHECK
+	assert(block_size > 0);
+	assert(precision == precision_float || precision == precision_bfloat16);
+#endif
+
+	/* the local functions move full precision blocks of doubles */
+	t_kernels * table_kernels = new_vtable_cpu(block_size * sizeof(double));
+
+	switch (precision) {
+		case precision_float:
+			table_kernels->pack   = pack_cpu_double_to_float;
+			table_kernels->unpack = unpack_cpu_float_to_double;
+			table_kernels->type_size = block_size * sizeof(float);
+			break;
+		case precision_bfloat16:
+			table_kernels->pack   = pack_cpu_double_to_bfloat16;
+			table_kernels->unpack = unpack_cpu_bfloat16_to_double;
+			table_kernels->type_size = block_size * sizeof(uint16_t);
+			break;
+	}
 
-	if (transform == NULL) {
+	return table_kernels;
+}
 
-		for (int i = 0; i < buffer_size; i++) {
-			int data_idx = buffer_idxlist[offset+i];
-			data[data_idx] = buffer[offset+i];
-		}
-	} else {
+void delete_vtable(t_kernels *vtable) {
 
-		for (int i = 0; i < buffer_size; i++) {
-			int data_idx = buffer_idxlist[offset+i];
-			int data_idx_transform = transform[data_idx];
-			data[data_idx_transform] = buffer[offset+i];
-		}
-	}
+	memory_free(vtable);
+}
+
+void pack_cpu_1(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                int *transform, size_t type_size) {
+
+	(void)type_size;
+	pack_cpu_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 1);
+}
+
+void unpack_cpu_1(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                  int *transform, size_t type_size) {
+
+	(void)type_size;
+	unpack_cpu_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 1);
+}
+
+void pack_cpu_2(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                int *transform, size_t type_size) {
+
+	(void)type_size;
+	pack_cpu_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 2);
+}
+
+void unpack_cpu_2(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                  int *transform, size_t type_size) {
+
+	(void)type_size;
+	unpack_cpu_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 2);
+}
+
+void pack_cpu_4(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                int *transform, size_t type_size) {
+
+	(void)type_size;
+	pack_cpu_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 4);
+}
+
+void unpack_cpu_4(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                  int *transform, size_t type_size) {
+
+	(void)type_size;
+	unpack_cpu_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 4);
+}
+
+void pack_cpu_8(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                int *transform, size_t type_size) {
+
+	(void)type_size;
+	pack_cpu_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 8);
+}
+
+void unpack_cpu_8(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                  int *transform, size_t type_size) {
+
+	(void)type_size;
+	unpack_cpu_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 8);
+}
+
+void pack_cpu_12(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                 int *transform, size_t type_size) {
+
+	(void)type_size;
+	pack_cpu_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 12);
+}
+
+void unpack_cpu_12(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                   int *transform, size_t type_size) {
+
+	(void)type_size;
+	unpack_cpu_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 12);
+}
+
+void pack_cpu_16(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                 int *transform, size_t type_size) {
+
+	(void)type_size;
+	pack_cpu_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 16);
+}
+
+void unpack_cpu_16(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                   int *transform, size_t type_size) {
+
+	(void)type_size;
+	unpack_cpu_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 16);
+}
+
+void pack_cpu_24(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                 int *transform, size_t type_size) {
+
+	(void)type_size;
+	pack_cpu_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 24);
+}
+
+void unpack_cpu_24(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                   int *transform, size_t type_size) {
+
+	(void)type_size;
+	unpack_cpu_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 24);
+}
+
+void pack_cpu_32(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                 int *transform, size_t type_size) {
+
+	(void)type_size;
+	pack_cpu_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 32);
+}
+
+void unpack_cpu_32(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                   int *transform, size_t type_size) {
+
+	(void)type_size;
+	unpack_cpu_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 32);
+}
+
+void pack_cpu_64(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                 int *transform, size_t type_size) {
+
+	(void)type_size;
+	pack_cpu_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 64);
+}
+
+void unpack_cpu_64(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                   int *transform, size_t type_size) {
+
+	(void)type_size;
+	unpack_cpu_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 64);
+}
+
+void pack_cpu_generic(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                      int *transform, size_t type_size) {
+
+	pack_cpu_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, type_size);
+}
+
+void unpack_cpu_generic(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                        int *transform, size_t type_size) {
+
+	unpack_cpu_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, type_size);
+}
+
+void pack_cpu_double_to_float(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                              int *transform, size_t type_size) {
+
+	size_t n = type_size / sizeof(float);
+	if (n == 1)
+		pack_cpu_double_to_float_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 1);
+	else
+		pack_cpu_double_to_float_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, n);
+}
+
+void unpack_cpu_float_to_double(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                                int *transform, size_t type_size) {
+
+	size_t n = type_size / sizeof(float);
+	if (n == 1)
+		unpack_cpu_float_to_double_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 1);
+	else
+		unpack_cpu_float_to_double_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, n);
+}
+
+void pack_cpu_double_to_bfloat16(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                                 int *transform, size_t type_size) {
+
+	size_t n = type_size / sizeof(uint16_t);
+	if (n == 1)
+		pack_cpu_double_to_bfloat16_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 1);
+	else
+		pack_cpu_double_to_bfloat16_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, n);
+}
+
+void unpack_cpu_bfloat16_to_double(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                                   int *transform, size_t type_size) {
+
+	size_t n = type_size / sizeof(uint16_t);
+	if (n == 1)
+		unpack_cpu_bfloat16_to_double_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, 1);
+	else
+		unpack_cpu_bfloat16_to_double_kernel(buffer, data, buffer_idxlist, buffer_size, offset, transform, n);
 }
 
 void* allocator_cpu(size_t buffer_size) {
 
-	void *ptr = malloc(buffer_size);
+	return memory_malloc(buffer_size, memory_exchange);
+}
+
+/* memory policy of the mbind system call: allocation on the node of the calling thread */
+#ifndef MPOL_LOCAL
+#define MPOL_LOCAL 4
+#endif
 
-	if (!ptr && (buffer_size > 0)) {
-	  fprintf(stderr, "malloc failed!\n");
-	  exit(EXIT_FAILURE);
-	}
+void* allocator_cpu_with_policy(size_t buffer_size, int policy) {
+
+	if (policy == allocator_malloc || buffer_size == 0)
+		return allocator_cpu(buffer_size);
+
+	/* page aligned buffers do not share pages with other data, so the
+	 * pages can be advised and bound without side effects */
+	size_t alignment = (policy & allocator_huge_pages) && buffer_size >= ALLOCATOR_HUGE_PAGE_SIZE ?
+	                   ALLOCATOR_HUGE_PAGE_SIZE : ALLOCATOR_PAGE_SIZE;
+	size_t size = (buffer_size + alignment - 1) / alignment * alignment;
+
+	void *ptr = memory_aligned_alloc(alignment, size, memory_exchange);
+
+	/* huge pages and node binding are hints: errors are ignored */
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	if (alignment == ALLOCATOR_HUGE_PAGE_SIZE)
+		madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+#if defined(__linux__) && defined(SYS_mbind)
+	if (policy & allocator_local_node)
+		syscall(SYS_mbind, ptr, size, MPOL_LOCAL, NULL, 0, 0);
+#endif
+
+	/* the pages are placed on the node of the process which packs and unpacks the buffer */
+	if (policy & allocator_first_touch)
+		memset(ptr, 0, size);
 
 	return ptr;
 }
 
+void* allocator_cpu_policy(size_t buffer_size) {
+
+	return allocator_cpu_with_policy(buffer_size, get_config_allocator());
+}
+
 void deallocator_cpu(void *buffer) {
 
-	free(buffer);
-}
\ No newline at end of file
+	memory_free(buffer);
+}
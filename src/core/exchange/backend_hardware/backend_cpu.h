@@ -35,19 +35,44 @@
 #define BACKEND_CPU_H
 
 #include <stdlib.h>
-#include "mpi.h"
 #include "src/core/exchange/backend_hardware/backend_hw.h"
 
+/** @brief size in bytes of the pages */
+#define ALLOCATOR_PAGE_SIZE 4096
+/** @brief size in bytes of the huge pages (buffers smaller than this use normal pages) */
+#define ALLOCATOR_HUGE_PAGE_SIZE 2097152
+
 /**
  * @brief Create new t_kernels data structure
  * 
- * @param[in] type MPI datatype of the exchanged fields
+ * @details The pack and unpack functions are selected based on the size of
+ *          the exchanged elements. Specialized functions are used for elements
+ *          of 1, 2, 4, 8, 12, 16, 24, 32 and 64 bytes, while a generic function is
+ *          used for any other size (e.g. user defined structures).
+ * 
+ * @param[in] type_size size in bytes of the exchanged elements (datatype extent times block size)
  * 
  * @return pointer to t_kernels structure
  * 
  * @ingroup backend_cpu
  */
-t_kernels * new_vtable_cpu(MPI_Datatype type);
+t_kernels * new_vtable_cpu(size_t type_size);
+
+/**
+ * @brief Create new t_kernels data structure with reduced precision on the wire
+ * 
+ * @details The data are blocks of doubles which are converted to float or bfloat16
+ *          during packing and back to double during unpacking. The local pack and
+ *          unpack functions move the blocks without conversion.
+ * 
+ * @param[in] block_size number of doubles per exchanged element
+ * @param[in] precision  wire precision using values of distdir_precision enum
+ * 
+ * @return pointer to t_kernels structure
+ * 
+ * @ingroup backend_cpu
+ */
+t_kernels * new_vtable_cpu_reduced_precision(int block_size, int precision);
 
 /**
  * @brief Delete t_kernels data structure
@@ -59,100 +84,438 @@ t_kernels * new_vtable_cpu(MPI_Datatype type);
 void delete_vtable(t_kernels *vtable);
 
 /**
- * @brief Packing function for int arrays.
+ * @brief Packing function for 1-byte elements.
+ * 
+ * @details Pack array data into a buffer using the buffer_idxlist
+ *  
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
+ * @param[in]  buffer_idxlist integer array with the information to fill the buffer
+ * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the filling of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cpu
+ */
+void pack_cpu_1(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                int *transform, size_t type_size);
+
+/**
+ * @brief Unpacking function for 1-byte elements.
+ * 
+ * @details Unpack buffer into array data using the buffer_idxlist
+ *  
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
+ * @param[in]  buffer_idxlist integer array with the information to fill the data array
+ * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the unpacking of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cpu
+ */
+void unpack_cpu_1(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                  int *transform, size_t type_size);
+
+/**
+ * @brief Packing function for 2-byte elements.
+ * 
+ * @details Pack array data into a buffer using the buffer_idxlist
+ *  
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
+ * @param[in]  buffer_idxlist integer array with the information to fill the buffer
+ * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the filling of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cpu
+ */
+void pack_cpu_2(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                int *transform, size_t type_size);
+
+/**
+ * @brief Unpacking function for 2-byte elements.
+ * 
+ * @details Unpack buffer into array data using the buffer_idxlist
+ *  
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
+ * @param[in]  buffer_idxlist integer array with the information to fill the data array
+ * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the unpacking of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cpu
+ */
+void unpack_cpu_2(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                  int *transform, size_t type_size);
+
+/**
+ * @brief Packing function for 4-byte elements.
+ * 
+ * @details Pack array data into a buffer using the buffer_idxlist
+ *  
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
+ * @param[in]  buffer_idxlist integer array with the information to fill the buffer
+ * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the filling of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cpu
+ */
+void pack_cpu_4(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                int *transform, size_t type_size);
+
+/**
+ * @brief Unpacking function for 4-byte elements.
+ * 
+ * @details Unpack buffer into array data using the buffer_idxlist
+ *  
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
+ * @param[in]  buffer_idxlist integer array with the information to fill the data array
+ * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the unpacking of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cpu
+ */
+void unpack_cpu_4(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                  int *transform, size_t type_size);
+
+/**
+ * @brief Packing function for 8-byte elements.
+ * 
+ * @details Pack array data into a buffer using the buffer_idxlist
+ *  
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
+ * @param[in]  buffer_idxlist integer array with the information to fill the buffer
+ * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the filling of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cpu
+ */
+void pack_cpu_8(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                int *transform, size_t type_size);
+
+/**
+ * @brief Unpacking function for 8-byte elements.
+ * 
+ * @details Unpack buffer into array data using the buffer_idxlist
+ *  
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
+ * @param[in]  buffer_idxlist integer array with the information to fill the data array
+ * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the unpacking of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cpu
+ */
+void unpack_cpu_8(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                  int *transform, size_t type_size);
+
+/**
+ * @brief Packing function for 16-byte elements.
+ * 
+ * @details Pack array data into a buffer using the buffer_idxlist
+ *  
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
+ * @param[in]  buffer_idxlist integer array with the information to fill the buffer
+ * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the filling of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cpu
+ */
+void pack_cpu_16(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                 int *transform, size_t type_size);
+
+/**
+ * @brief Unpacking function for 16-byte elements.
+ * 
+ * @details Unpack buffer into array data using the buffer_idxlist
+ *  
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
+ * @param[in]  buffer_idxlist integer array with the information to fill the data array
+ * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the unpacking of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cpu
+ */
+void unpack_cpu_16(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                   int *transform, size_t type_size);
+
+/**
+ * @brief Packing function for 12-byte elements.
+ * 
+ * @details Pack array data into a buffer using the buffer_idxlist
+ *  
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
+ * @param[in]  buffer_idxlist integer array with the information to fill the buffer
+ * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the filling of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cpu
+ */
+void pack_cpu_12(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                 int *transform, size_t type_size);
+
+/**
+ * @brief Unpacking function for 12-byte elements.
+ * 
+ * @details Unpack buffer into array data using the buffer_idxlist
+ *  
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
+ * @param[in]  buffer_idxlist integer array with the information to fill the data array
+ * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the unpacking of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cpu
+ */
+void unpack_cpu_12(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                   int *transform, size_t type_size);
+
+/**
+ * @brief Packing function for 24-byte elements.
+ * 
+ * @details Pack array data into a buffer using the buffer_idxlist
+ *  
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
+ * @param[in]  buffer_idxlist integer array with the information to fill the buffer
+ * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the filling of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cpu
+ */
+void pack_cpu_24(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                 int *transform, size_t type_size);
+
+/**
+ * @brief Unpacking function for 24-byte elements.
+ * 
+ * @details Unpack buffer into array data using the buffer_idxlist
+ *  
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
+ * @param[in]  buffer_idxlist integer array with the information to fill the data array
+ * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the unpacking of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cpu
+ */
+void unpack_cpu_24(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                   int *transform, size_t type_size);
+
+/**
+ * @brief Packing function for 32-byte elements.
+ * 
+ * @details Pack array data into a buffer using the buffer_idxlist
+ *  
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
+ * @param[in]  buffer_idxlist integer array with the information to fill the buffer
+ * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the filling of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cpu
+ */
+void pack_cpu_32(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                 int *transform, size_t type_size);
+
+/**
+ * @brief Unpacking function for 32-byte elements.
+ * 
+ * @details Unpack buffer into array data using the buffer_idxlist
+ *  
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
+ * @param[in]  buffer_idxlist integer array with the information to fill the data array
+ * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the unpacking of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cpu
+ */
+void unpack_cpu_32(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                   int *transform, size_t type_size);
+
+/**
+ * @brief Packing function for 64-byte elements.
  * 
  * @details Pack array data into a buffer using the buffer_idxlist
  *  
- * @param[out] buffer         integer array to be filled
- * @param[in]  data           integer array with the data
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
  * @param[in]  buffer_idxlist integer array with the information to fill the buffer
  * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
  * @param[in]  offset         buffer offset to start the filling of the buffer array
  * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
  * 
  * @ingroup backend_cpu
  */
-void pack_cpu_int(int *buffer, int *data, int *buffer_idxlist, int buffer_size, int offset, int* transform);
+void pack_cpu_64(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                 int *transform, size_t type_size);
 
 /**
- * @brief Unpacking function for int arrays.
+ * @brief Unpacking function for 64-byte elements.
  * 
- * @details Unpack beffer into array data using the buffer_idxlist
+ * @details Unpack buffer into array data using the buffer_idxlist
  *  
- * @param[in]  buffer         integer array with the data
- * @param[out] data           integer array to be filled
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
  * @param[in]  buffer_idxlist integer array with the information to fill the data array
  * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
  * @param[in]  offset         buffer offset to start the unpacking of the buffer array
  * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
  * 
  * @ingroup backend_cpu
  */
-void unpack_cpu_int(int *buffer, int *data, int *buffer_idxlist, int buffer_size, int offset, int *transform);
+void unpack_cpu_64(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                   int *transform, size_t type_size);
 
 /**
- * @brief Packing function for float arrays.
+ * @brief Packing function for elements of arbitrary size.
+ * 
+ * @details Pack array data into a buffer using the buffer_idxlist.
+ *          Each element is copied with memcpy.
+ *  
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
+ * @param[in]  buffer_idxlist integer array with the information to fill the buffer
+ * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the filling of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element
+ * 
+ * @ingroup backend_cpu
+ */
+void pack_cpu_generic(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                      int *transform, size_t type_size);
+
+/**
+ * @brief Unpacking function for elements of arbitrary size.
+ * 
+ * @details Unpack buffer into array data using the buffer_idxlist.
+ *          Each element is copied with memcpy.
+ *  
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
+ * @param[in]  buffer_idxlist integer array with the information to fill the data array
+ * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the unpacking of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element
+ * 
+ * @ingroup backend_cpu
+ */
+void unpack_cpu_generic(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                        int *transform, size_t type_size);
+
+/**
+ * @brief Packing function with conversion from double to float.
  * 
  * @details Pack array data into a buffer using the buffer_idxlist
  *  
- * @param[out] buffer         float array to be filled
- * @param[in]  data           float array with the data
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
  * @param[in]  buffer_idxlist integer array with the information to fill the buffer
  * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
  * @param[in]  offset         buffer offset to start the filling of the buffer array
  * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a buffer element (block of float values)
  * 
  * @ingroup backend_cpu
  */
-void pack_cpu_float(float *buffer, float *data, int *buffer_idxlist, int buffer_size, int offset, int *transform);
+void pack_cpu_double_to_float(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                              int *transform, size_t type_size);
 
 /**
- * @brief Unpacking function for float arrays.
+ * @brief Unpacking function with conversion from float to double.
  * 
- * @details Unpack beffer into array data using the buffer_idxlist
+ * @details Unpack buffer into array data using the buffer_idxlist
  *  
- * @param[in]  buffer         float array with the data
- * @param[out] data           float array to be filled
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
  * @param[in]  buffer_idxlist integer array with the information to fill the data array
  * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
  * @param[in]  offset         buffer offset to start the unpacking of the buffer array
  * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a buffer element (block of float values)
  * 
  * @ingroup backend_cpu
  */
-void unpack_cpu_float(float *buffer, float *data, int *buffer_idxlist, int buffer_size, int offset, int *transform);
+void unpack_cpu_float_to_double(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                                int *transform, size_t type_size);
 
 /**
- * @brief Packing function for double arrays.
+ * @brief Packing function with conversion from double to bfloat16.
  * 
  * @details Pack array data into a buffer using the buffer_idxlist
  *  
- * @param[out] buffer         double array to be filled
- * @param[in]  data           double array with the data
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
  * @param[in]  buffer_idxlist integer array with the information to fill the buffer
  * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
  * @param[in]  offset         buffer offset to start the filling of the buffer array
  * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a buffer element (block of bfloat16 values)
  * 
  * @ingroup backend_cpu
  */
-void pack_cpu_double(double *buffer, double *data, int *buffer_idxlist, int buffer_size, int offset, int*transform);
+void pack_cpu_double_to_bfloat16(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                                 int *transform, size_t type_size);
 
 /**
- * @brief Unpacking function for double arrays.
+ * @brief Unpacking function with conversion from bfloat16 to double.
  * 
- * @details Unpack beffer into array data using the buffer_idxlist
+ * @details Unpack buffer into array data using the buffer_idxlist
  *  
- * @param[in]  buffer         double array with the data
- * @param[out] data           double array to be filled
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
  * @param[in]  buffer_idxlist integer array with the information to fill the data array
  * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
  * @param[in]  offset         buffer offset to start the unpacking of the buffer array
  * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a buffer element (block of bfloat16 values)
  * 
  * @ingroup backend_cpu
  */
-void unpack_cpu_double(double *buffer, double *data, int *buffer_idxlist, int buffer_size, int offset, int *transform);
+void unpack_cpu_bfloat16_to_double(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                                   int *transform, size_t type_size);
 
 /**
  * @brief Allocate array.
@@ -165,6 +528,34 @@ void unpack_cpu_double(double *buffer, double *data, int *buffer_idxlist, int bu
  */
 void* allocator_cpu(size_t buffer_size);
 
+/**
+ * @brief Allocate array with a memory placement policy.
+ * 
+ * @details The policy is a combination of the values of the distdir_allocator enum:
+ *          the memory can be touched at allocation (first touch), aligned and advised
+ *          to use huge pages if larger than \c ALLOCATOR_HUGE_PAGE_SIZE and bound to
+ *          the NUMA node of the calling process. The memory is freed with deallocator_cpu.
+ *  
+ * @param[in]  buffer_size byte size of the array to be allocated
+ * @param[in]  policy      combination of distdir_allocator values
+ *
+ * @return pointer to the allocated memory
+ * 
+ * @ingroup backend_cpu
+ */
+void* allocator_cpu_with_policy(size_t buffer_size, int policy);
+
+/**
+ * @brief Allocate array with the memory placement policy of the library configuration.
+ *  
+ * @param[in]  buffer_size byte size of the array to be allocated
+ *
+ * @return pointer to the allocated memory
+ * 
+ * @ingroup backend_cpu
+ */
+void* allocator_cpu_policy(size_t buffer_size);
+
 /**
  * @brief Deallocate array.
  *  
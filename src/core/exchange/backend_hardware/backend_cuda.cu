@@ -35,8 +35,34 @@
 #include <stdio.h>
 #include <cuda.h>
 #include "src/core/exchange/backend_hardware/backend_cuda.h"
+#include "src/utils/memory.h"
 
-__global__ void pack_int(int *buffer, int *data, int *buffer_idxlist, int buffer_size, int offset) {
+/* 16-byte element (e.g. double complex) copied with two 8-byte accesses */
+struct t_elem16 {
+	unsigned long long lo;
+	unsigned long long hi;
+};
+
+/* blocks of 3 floats and of 3, 4 and 8 doubles (multi-component fields) */
+struct t_elem12 {
+	unsigned int v[3];
+};
+
+struct t_elem24 {
+	unsigned long long v[3];
+};
+
+struct t_elem32 {
+	unsigned long long v[4];
+};
+
+struct t_elem64 {
+	unsigned long long v[8];
+};
+
+template <typename T>
+__global__ void pack_kernel(T *buffer, const T *data, const int *buffer_idxlist,
+                            int buffer_size, int offset) {
 
 	int id = blockDim.x * blockIdx.x + threadIdx.x;
 	if(id < buffer_size) {
@@ -45,8 +71,9 @@ __global__ void pack_int(int *buffer, int *data, int *buffer_idxlist, int buffer
 	}
 }
 
-__global__ void pack_int_transform(int *buffer, int *data, int *buffer_idxlist,
-                                   int buffer_size, int offset, int *transform) {
+template <typename T>
+__global__ void pack_kernel_transform(T *buffer, const T *data, const int *buffer_idxlist,
+                                      int buffer_size, int offset, const int *transform) {
 
 	int id = blockDim.x * blockIdx.x + threadIdx.x;
 	if(id < buffer_size) {
@@ -56,253 +83,332 @@ __global__ void pack_int_transform(int *buffer, int *data, int *buffer_idxlist,
 	}
 }
 
-__global__ void pack_float(float *buffer, float *data, int *buffer_idxlist, int buffer_size, int offset) {
+template <typename T>
+__global__ void unpack_kernel(const T *buffer, T *data, const int *buffer_idxlist,
+                              int buffer_size, int offset) {
 
 	int id = blockDim.x * blockIdx.x + threadIdx.x;
 	if(id < buffer_size) {
 		int data_idx = buffer_idxlist[offset+id];
-		buffer[offset+id] = data[data_idx];
+		data[data_idx] = buffer[offset+id];
 	}
 }
 
-__global__ void pack_float_transform(float *buffer, float *data, int *buffer_idxlist,
-                                     int buffer_size, int offset, int *transform) {
+template <typename T>
+__global__ void unpack_kernel_transform(const T *buffer, T *data, const int *buffer_idxlist,
+                                        int buffer_size, int offset, const int *transform) {
 
 	int id = blockDim.x * blockIdx.x + threadIdx.x;
 	if(id < buffer_size) {
 		int data_idx = buffer_idxlist[offset+id];
 		int data_idx_transform = transform[data_idx];
-		buffer[offset+id] = data[data_idx_transform];
+		data[data_idx_transform] = buffer[offset+id];
 	}
 }
 
-__global__ void pack_double(double *buffer, double *data, int *buffer_idxlist, int buffer_size, int offset) {
+/* one thread per byte of the packed buffer */
+__global__ void pack_kernel_generic(char *buffer, const char *data, const int *buffer_idxlist,
+                                    int buffer_size, int offset, const int *transform,
+                                    size_t type_size) {
+
+	size_t id = (size_t)blockDim.x * blockIdx.x + threadIdx.x;
+	if(id < (size_t)buffer_size * type_size) {
+		int i = id / type_size;
+		int byte = id % type_size;
+		size_t data_idx = buffer_idxlist[offset+i];
+		if (transform != NULL) data_idx = transform[data_idx];
+		buffer[(offset+i)*type_size+byte] = data[data_idx*type_size+byte];
+	}
+}
 
-	int id = blockDim.x * blockIdx.x + threadIdx.x;
-	if(id < buffer_size) {
-		int data_idx = buffer_idxlist[offset+id];
-		buffer[offset+id] = data[data_idx];
+__global__ void unpack_kernel_generic(const char *buffer, char *data, const int *buffer_idxlist,
+                                      int buffer_size, int offset, const int *transform,
+                                      size_t type_size) {
+
+	size_t id = (size_t)blockDim.x * blockIdx.x + threadIdx.x;
+	if(id < (size_t)buffer_size * type_size) {
+		int i = id / type_size;
+		int byte = id % type_size;
+		size_t data_idx = buffer_idxlist[offset+i];
+		if (transform != NULL) data_idx = transform[data_idx];
+		data[data_idx*type_size+byte] = buffer[(offset+i)*type_size+byte];
 	}
 }
 
-__global__ void pack_double_transform(double *buffer, double *data, int *buffer_idxlist,
-                                      int buffer_size, int offset, int *transform) {
+static void check_cuda_kernel(const char *name) {
 
-	int id = blockDim.x * blockIdx.x + threadIdx.x;
-	if(id < buffer_size) {
-		int data_idx = buffer_idxlist[offset+id];
-		int data_idx_transform = transform[data_idx];
-		buffer[offset+id] = data[data_idx_transform];
+	cudaError_t err = cudaDeviceSynchronize();
+	if ( err != cudaSuccess ) {
+		fprintf(stderr, "CUDA error (%s): %s\n", name, cudaGetErrorString(err));
+		exit(EXIT_FAILURE);
 	}
 }
 
-__global__ void unpack_int(int *buffer, int *data, int *buffer_idxlist, int buffer_size, int offset) {
+template <typename T>
+static void pack_cuda_launch(void *buffer, void *data, int *buffer_idxlist,
+                             int buffer_size, int offset, int *transform) {
 
-	int id = blockDim.x * blockIdx.x + threadIdx.x;
-	if(id < buffer_size) {
-		int data_idx = buffer_idxlist[offset+id];
-		data[data_idx] = buffer[offset+id];
-	}
+	if (buffer_size <= 0) return;
+
+	int thr_per_blk = 256;
+	int blk_in_grid = ceil( float(buffer_size) / thr_per_blk );
+
+	if (transform == NULL)
+		pack_kernel<T><<< blk_in_grid, thr_per_blk >>>((T *)buffer, (const T *)data, buffer_idxlist,
+		                                               buffer_size, offset);
+	else
+		pack_kernel_transform<T><<< blk_in_grid, thr_per_blk >>>((T *)buffer, (const T *)data, buffer_idxlist,
+		                                                         buffer_size, offset, transform);
+
+	check_cuda_kernel("pack");
 }
 
-__global__ void unpack_int_transform(int *buffer, int *data, int *buffer_idxlist,
-                                     int buffer_size, int offset, int *transform) {
+template <typename T>
+static void unpack_cuda_launch(void *buffer, void *data, int *buffer_idxlist,
+                               int buffer_size, int offset, int *transform) {
 
-	int id = blockDim.x * blockIdx.x + threadIdx.x;
-	if(id < buffer_size) {
-		int data_idx = buffer_idxlist[offset+id];
-		int data_idx_transform = transform[data_idx];
-		data[data_idx_transform] = buffer[offset+id];
-	}
+	if (buffer_size <= 0) return;
+
+	int thr_per_blk = 256;
+	int blk_in_grid = ceil( float(buffer_size) / thr_per_blk );
+
+	if (transform == NULL)
+		unpack_kernel<T><<< blk_in_grid, thr_per_blk >>>((const T *)buffer, (T *)data, buffer_idxlist,
+		                                                 buffer_size, offset);
+	else
+		unpack_kernel_transform<T><<< blk_in_grid, thr_per_blk >>>((const T *)buffer, (T *)data, buffer_idxlist,
+		                                                           buffer_size, offset, transform);
+
+	check_cuda_kernel("unpack");
 }
 
-__global__ void unpack_float(float *buffer, float *data, int *buffer_idxlist, int buffer_size, int offset) {
+extern "C" t_kernels * new_vtable_cuda(size_t type_size) {
 
-	int id = blockDim.x * blockIdx.x + threadIdx.x;
-	if(id < buffer_size) {
-		int data_idx = buffer_idxlist[offset+id];
-		data[data_idx] = buffer[offset+id];
+	t_kernels * table_kernels = (t_kernels *)memory_malloc(sizeof(t_kernels), memory_exchange);
+
+	/* Malloc / Free functions */
+	table_kernels->allocator = allocator_cuda;
+	table_kernels->deallocator = deallocator_cuda;
+
+	/* Packing / Unpacking functions */
+	table_kernels->type_size = type_size;
+	switch (type_size) {
+		case 1:
+			table_kernels->pack   = pack_cuda_1;
+			table_kernels->unpack = unpack_cuda_1;
+			break;
+		case 2:
+			table_kernels->pack   = pack_cuda_2;
+			table_kernels->unpack = unpack_cuda_2;
+			break;
+		case 4:
+			table_kernels->pack   = pack_cuda_4;
+			table_kernels->unpack = unpack_cuda_4;
+			break;
+		case 8:
+			table_kernels->pack   = pack_cuda_8;
+			table_kernels->unpack = unpack_cuda_8;
+			break;
+		case 12:
+			table_kernels->pack   = pack_cuda_12;
+			table_kernels->unpack = unpack_cuda_12;
+			break;
+		case 16:
+			table_kernels->pack   = pack_cuda_16;
+			table_kernels->unpack = unpack_cuda_16;
+			break;
+		case 24:
+			table_kernels->pack   = pack_cuda_24;
+			table_kernels->unpack = unpack_cuda_24;
+			break;
+		case 32:
+			table_kernels->pack   = pack_cuda_32;
+			table_kernels->unpack = unpack_cuda_32;
+			break;
+		case 64:
+			table_kernels->pack   = pack_cuda_64;
+			table_kernels->unpack = unpack_cuda_64;
+			break;
+		default:
+			table_kernels->pack   = pack_cuda_generic;
+			table_kernels->unpack = unpack_cuda_generic;
+			break;
 	}
+
+	/* no precision conversion */
+	table_kernels->pack_local = table_kernels->pack;
+	table_kernels->unpack_local = table_kernels->unpack;
+	table_kernels->local_type_size = type_size;
+
+	return table_kernels;
 }
 
-__global__ void unpack_float_transform(float *buffer, float *data, int *buffer_idxlist,
-                                       int buffer_size, int offset, int *transform) {
+extern "C" void pack_cuda_1(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                            int *transform, size_t type_size) {
 
-	int id = blockDim.x * blockIdx.x + threadIdx.x;
-	if(id < buffer_size) {
-		int data_idx = buffer_idxlist[offset+id];
-		int data_idx_transform = transform[data_idx];
-		data[data_idx_transform] = buffer[offset+id];
-	}
+	(void)type_size;
+	pack_cuda_launch<unsigned char>(buffer, data, buffer_idxlist, buffer_size, offset, transform);
 }
 
-__global__ void unpack_double(double *buffer, double *data, int *buffer_idxlist, int buffer_size, int offset) {
+extern "C" void unpack_cuda_1(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                              int *transform, size_t type_size) {
 
-	int id = blockDim.x * blockIdx.x + threadIdx.x;
-	if(id < buffer_size) {
-		int data_idx = buffer_idxlist[offset+id];
-		data[data_idx] = buffer[offset+id];
-	}
+	(void)type_size;
+	unpack_cuda_launch<unsigned char>(buffer, data, buffer_idxlist, buffer_size, offset, transform);
 }
 
-__global__ void unpack_double_transform(double *buffer, double *data, int *buffer_idxlist,
-                                        int buffer_size, int offset, int *transform) {
+extern "C" void pack_cuda_2(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                            int *transform, size_t type_size) {
 
-	int id = blockDim.x * blockIdx.x + threadIdx.x;
-	if(id < buffer_size) {
-		int data_idx = buffer_idxlist[offset+id];
-		int data_idx_transform = transform[data_idx];
-		data[data_idx_transform] = buffer[offset+id];
-	}
+	(void)type_size;
+	pack_cuda_launch<unsigned short>(buffer, data, buffer_idxlist, buffer_size, offset, transform);
 }
 
+extern "C" void unpack_cuda_2(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                              int *transform, size_t type_size) {
 
-extern "C" t_kernels * new_vtable_cuda(MPI_Datatype type) {
+	(void)type_size;
+	unpack_cuda_launch<unsigned short>(buffer, data, buffer_idxlist, buffer_size, offset, transform);
+}
 
-	t_kernels * table_kernels = (t_kernels *)malloc(sizeof(t_kernels));
+extern "C" void pack_cuda_4(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                            int *transform, size_t type_size) {
 
-	/* Malloc / Free functions */
-	table_kernels->allocator = allocator_cuda;
-	table_kernels->deallocator = deallocator_cuda;
+	(void)type_size;
+	pack_cuda_launch<unsigned int>(buffer, data, buffer_idxlist, buffer_size, offset, transform);
+}
 
-	if (type == MPI_INT || type == MPI_INTEGER) {
+extern "C" void unpack_cuda_4(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                              int *transform, size_t type_size) {
 
-		/* Packing / Unpacking functions */
-		table_kernels->pack = (kernel_func_pack)pack_cuda_int;
-		table_kernels->unpack = (kernel_func_pack)unpack_cuda_int;
-	} else if (type == MPI_REAL || type == MPI_FLOAT) {
+	(void)type_size;
+	unpack_cuda_launch<unsigned int>(buffer, data, buffer_idxlist, buffer_size, offset, transform);
+}
 
-		/* Packing / Unpacking functions */
-		table_kernels->pack = (kernel_func_pack)pack_cuda_float;
-		table_kernels->unpack = (kernel_func_pack)unpack_cuda_float;
-	} else if (type == MPI_DOUBLE || type == MPI_DOUBLE_PRECISION) {
+extern "C" void pack_cuda_8(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                            int *transform, size_t type_size) {
 
-		/* Packing / Unpacking functions */
-		table_kernels->pack = (kernel_func_pack)pack_cuda_double;
-		table_kernels->unpack = (kernel_func_pack)unpack_cuda_double;
-	}
+	(void)type_size;
+	pack_cuda_launch<unsigned long long>(buffer, data, buffer_idxlist, buffer_size, offset, transform);
 }
 
-extern "C" void pack_cuda_int(int *buffer, int *data, int *buffer_idxlist,
-                              int buffer_size, int offset, int *transform) {
+extern "C" void unpack_cuda_8(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                              int *transform, size_t type_size) {
 
-	int thr_per_blk = 256;
-	int blk_in_grid = ceil( float(buffer_size) / thr_per_blk );
+	(void)type_size;
+	unpack_cuda_launch<unsigned long long>(buffer, data, buffer_idxlist, buffer_size, offset, transform);
+}
 
-	if (transform == NULL)
-		pack_int<<< blk_in_grid, thr_per_blk >>>(buffer, data, buffer_idxlist, buffer_size, offset);
-	else
-		pack_int_transform<<< blk_in_grid, thr_per_blk >>>(buffer, data, buffer_idxlist,
-		                                                   buffer_size, offset, transform);
+extern "C" void pack_cuda_12(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                             int *transform, size_t type_size) {
 
-	cudaError_t err = cudaDeviceSynchronize();
-	if ( err != cudaSuccess ) {
-		fprintf(stderr, "CUDA error (pack_int): %s\n", cudaGetErrorString(err));
-		exit(EXIT_FAILURE);
-	}
+	(void)type_size;
+	pack_cuda_launch<t_elem12>(buffer, data, buffer_idxlist, buffer_size, offset, transform);
 }
 
-extern "C" void pack_cuda_float(float *buffer, float *data, int *buffer_idxlist,
-                                int buffer_size, int offset, int *transform) {
+extern "C" void unpack_cuda_12(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                               int *transform, size_t type_size) {
 
-	int thr_per_blk = 256;
-	int blk_in_grid = ceil( float(buffer_size) / thr_per_blk );
+	(void)type_size;
+	unpack_cuda_launch<t_elem12>(buffer, data, buffer_idxlist, buffer_size, offset, transform);
+}
 
-	if (transform == NULL)
-		pack_float<<< blk_in_grid, thr_per_blk >>>(buffer, data, buffer_idxlist, buffer_size, offset);
-	else
-		pack_float_transform<<< blk_in_grid, thr_per_blk >>>(buffer, data, buffer_idxlist,
-		                                                     buffer_size, offset, transform);
+extern "C" void pack_cuda_16(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                             int *transform, size_t type_size) {
 
-	cudaError_t err = cudaDeviceSynchronize();
-	if ( err != cudaSuccess ) {
-		fprintf(stderr, "CUDA error (pack_float): %s\n", cudaGetErrorString(err));
-		exit(EXIT_FAILURE);
-	}
+	(void)type_size;
+	pack_cuda_launch<t_elem16>(buffer, data, buffer_idxlist, buffer_size, offset, transform);
 }
 
-extern "C" void pack_cuda_double(double *buffer, double *data, int *buffer_idxlist,
-                                 int buffer_size, int offset, int *transform) {
+extern "C" void unpack_cuda_16(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                               int *transform, size_t type_size) {
 
-	int thr_per_blk = 256;
-	int blk_in_grid = ceil( float(buffer_size) / thr_per_blk );
+	(void)type_size;
+	unpack_cuda_launch<t_elem16>(buffer, data, buffer_idxlist, buffer_size, offset, transform);
+}
 
-	if (transform == NULL)
-		pack_double<<< blk_in_grid, thr_per_blk >>>(buffer, data, buffer_idxlist, buffer_size, offset);
-	else
-		pack_double_transform<<< blk_in_grid, thr_per_blk >>>(buffer, data, buffer_idxlist,
-		                                                      buffer_size, offset, transform);
+extern "C" void pack_cuda_24(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                             int *transform, size_t type_size) {
 
-	cudaError_t err = cudaDeviceSynchronize();
-	if ( err != cudaSuccess ) {
-		fprintf(stderr, "CUDA error (pack_double): %s\n", cudaGetErrorString(err));
-		exit(EXIT_FAILURE);
-	}
+	(void)type_size;
+	pack_cuda_launch<t_elem24>(buffer, data, buffer_idxlist, buffer_size, offset, transform);
 }
 
-extern "C" void unpack_cuda_int(int *buffer, int *data, int *buffer_idxlist,
-                                int buffer_size, int offset, int *transform) {
+extern "C" void unpack_cuda_24(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                               int *transform, size_t type_size) {
 
-	int thr_per_blk = 256;
-	int blk_in_grid = ceil( float(buffer_size) / thr_per_blk );
+	(void)type_size;
+	unpack_cuda_launch<t_elem24>(buffer, data, buffer_idxlist, buffer_size, offset, transform);
+}
 
-	if (transform == NULL)
-		unpack_int<<< blk_in_grid, thr_per_blk >>>(buffer, data, buffer_idxlist, buffer_size, offset);
-	else
-		unpack_int_transform<<< blk_in_grid, thr_per_blk >>>(buffer, data, buffer_idxlist,
-		                                                     buffer_size, offset, transform);
+extern "C" void pack_cuda_32(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                             int *transform, size_t type_size) {
 
-	cudaError_t err = cudaDeviceSynchronize();
-	if ( err != cudaSuccess ) {
-		fprintf(stderr, "CUDA error (unpack_int): %s\n", cudaGetErrorString(err));
-		exit(EXIT_FAILURE);
-	}
+	(void)type_size;
+	pack_cuda_launch<t_elem32>(buffer, data, buffer_idxlist, buffer_size, offset, transform);
+}
+
+extern "C" void unpack_cuda_32(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                               int *transform, size_t type_size) {
+
+	(void)type_size;
+	unpack_cuda_launch<t_elem32>(buffer, data, buffer_idxlist, buffer_size, offset, transform);
+}
+
+extern "C" void pack_cuda_64(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                             int *transform, size_t type_size) {
+
+	(void)type_size;
+	pack_cuda_launch<t_elem64>(buffer, data, buffer_idxlist, buffer_size, offset, transform);
 }
 
-extern "C" void unpack_cuda_float(float *buffer, float *data, int *buffer_idxlist,
-                                  int buffer_size, int offset, int *transform) {
+extern "C" void unpack_cuda_64(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                               int *transform, size_t type_size) {
+
+	(void)type_size;
+	unpack_cuda_launch<t_elem64>(buffer, data, buffer_idxlist, buffer_size, offset, transform);
+}
+
+extern "C" void pack_cuda_generic(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                                  int *transform, size_t type_size) {
+
+	if (buffer_size <= 0) return;
 
 	int thr_per_blk = 256;
-	int blk_in_grid = ceil( float(buffer_size) / thr_per_blk );
+	int blk_in_grid = ceil( float((size_t)buffer_size * type_size) / thr_per_blk );
 
-	if (transform == NULL)
-		unpack_float<<< blk_in_grid, thr_per_blk >>>(buffer, data, buffer_idxlist, buffer_size, offset);
-	else
-		unpack_float_transform<<< blk_in_grid, thr_per_blk >>>(buffer, data, buffer_idxlist,
-		                                                       buffer_size, offset, transform);
+	pack_kernel_generic<<< blk_in_grid, thr_per_blk >>>((char *)buffer, (char *)data, buffer_idxlist,
+	                                                    buffer_size, offset, transform, type_size);
 
-	cudaError_t err = cudaDeviceSynchronize();
-	if ( err != cudaSuccess ) {
-		fprintf(stderr, "CUDA error (unpack_float): %s\n", cudaGetErrorString(err));
-		exit(EXIT_FAILURE);
-	}
+	check_cuda_kernel("pack_generic");
 }
 
-extern "C" void unpack_cuda_double(double *buffer, double *data, int *buffer_idxlist,
-                                   int buffer_size, int offset, int *transform) {
+extern "C" void unpack_cuda_generic(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                                    int *transform, size_t type_size) {
+
+	if (buffer_size <= 0) return;
 
 	int thr_per_blk = 256;
-	int blk_in_grid = ceil( float(buffer_size) / thr_per_blk );
+	int blk_in_grid = ceil( float((size_t)buffer_size * type_size) / thr_per_blk );
 
-	if (transform == NULL)
-		unpack_double<<< blk_in_grid, thr_per_blk >>>(buffer, data, buffer_idxlist, buffer_size, offset);
-	else
-		unpack_double_transform<<< blk_in_grid, thr_per_blk >>>(buffer, data, buffer_idxlist,
-		                                                        buffer_size, offset, transform);
+	unpack_kernel_generic<<< blk_in_grid, thr_per_blk >>>((char *)buffer, (char *)data, buffer_idxlist,
+	                                                      buffer_size, offset, transform, type_size);
 
-	cudaError_t err = cudaDeviceSynchronize();
-	if ( err != cudaSuccess ) {
-		fprintf(stderr, "CUDA error (unpack_double): %s\n", cudaGetErrorString(err));
-		exit(EXIT_FAILURE);
-	}
+	check_cuda_kernel("unpack_generic");
 }
 
 extern "C" void* allocator_cuda(size_t buffer_size) {
 
+	return allocator_cuda_category(buffer_size, memory_exchange);
+}
+
+extern "C" void* allocator_cuda_category(size_t buffer_size, int category) {
+
 	void *p;
 
 	cudaError_t err = cudaMalloc(&p, buffer_size);
 	if (err == cudaSuccess) {
+		memory_register(p, buffer_size, category);
 		return p;
 	} else {
 		fprintf(stderr, "CUDA error (cudaMalloc): %s\n", cudaGetErrorString(err));
@@ -312,6 +418,7 @@ extern "C" void* allocator_cuda(size_t buffer_size) {
 
 extern "C" void deallocator_cuda(void *buffer) {
 
+	memory_unregister(buffer);
 	cudaError_t err = cudaFree ( buffer );
 	if ( err != cudaSuccess ) {
 		fprintf(stderr, "CUDA error (cudaFree): %s\n", cudaGetErrorString(err));
@@ -37,115 +37,383 @@
 extern "C" {
 #endif
 
-#include "mpi.h"
 #include "src/core/exchange/backend_hardware/backend_hw.h"
 
 /**
  * @brief Create new t_kernels data structure
  * 
- * @param[in] type MPI datatype of the exchanged fields
+ * @details The pack and unpack functions are selected based on the size of
+ *          the exchanged elements. Specialized functions are used for elements
+ *          of 1, 2, 4, 8, 12, 16, 24, 32 and 64 bytes, while a generic function is
+ *          used for any other size.
+ * 
+ * @param[in] type_size size in bytes of the exchanged elements (datatype extent times block size)
  * 
  * @return pointer to t_kernels structure
  * 
  * @ingroup backend_cuda
  */
-t_kernels * new_vtable_cuda(MPI_Datatype type);
+t_kernels * new_vtable_cuda(size_t type_size);
 
 /**
- * @brief Packing function for int arrays.
+ * @brief Packing function for 1-byte elements.
  * 
  * @details Pack array data into a buffer using the buffer_idxlist
  *  
- * @param[out] buffer         integer array to be filled
- * @param[in]  data           integer array with the data
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
  * @param[in]  buffer_idxlist integer array with the information to fill the buffer
  * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
  * @param[in]  offset         buffer offset to start the filling of the buffer array
  * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cuda
+ */
+void pack_cuda_1(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                 int *transform, size_t type_size);
+
+/**
+ * @brief Unpacking function for 1-byte elements.
+ * 
+ * @details Unpack buffer into array data using the buffer_idxlist
+ *  
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
+ * @param[in]  buffer_idxlist integer array with the information to fill the data array
+ * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the unpacking of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
  * 
  * @ingroup backend_cuda
  */
-void pack_cuda_int(int *buffer, int *data, int *buffer_idxlist, int buffer_size, int offset, int *transform);
+void unpack_cuda_1(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                   int *transform, size_t type_size);
 
 /**
- * @brief Packing function for float arrays.
+ * @brief Packing function for 2-byte elements.
  * 
  * @details Pack array data into a buffer using the buffer_idxlist
  *  
- * @param[out] buffer         float array to be filled
- * @param[in]  data           float array with the data
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
  * @param[in]  buffer_idxlist integer array with the information to fill the buffer
  * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
  * @param[in]  offset         buffer offset to start the filling of the buffer array
  * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cuda
+ */
+void pack_cuda_2(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                 int *transform, size_t type_size);
+
+/**
+ * @brief Unpacking function for 2-byte elements.
+ * 
+ * @details Unpack buffer into array data using the buffer_idxlist
+ *  
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
+ * @param[in]  buffer_idxlist integer array with the information to fill the data array
+ * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the unpacking of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cuda
+ */
+void unpack_cuda_2(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                   int *transform, size_t type_size);
+
+/**
+ * @brief Packing function for 4-byte elements.
+ * 
+ * @details Pack array data into a buffer using the buffer_idxlist
+ *  
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
+ * @param[in]  buffer_idxlist integer array with the information to fill the buffer
+ * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the filling of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cuda
+ */
+void pack_cuda_4(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                 int *transform, size_t type_size);
+
+/**
+ * @brief Unpacking function for 4-byte elements.
+ * 
+ * @details Unpack buffer into array data using the buffer_idxlist
+ *  
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
+ * @param[in]  buffer_idxlist integer array with the information to fill the data array
+ * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the unpacking of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
  * 
  * @ingroup backend_cuda
  */
-void pack_cuda_float(float *buffer, float *data, int *buffer_idxlist, int buffer_size, int offset, int *transform);
+void unpack_cuda_4(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                   int *transform, size_t type_size);
 
 /**
- * @brief Packing function for double arrays.
+ * @brief Packing function for 8-byte elements.
  * 
  * @details Pack array data into a buffer using the buffer_idxlist
  *  
- * @param[out] buffer         double array to be filled
- * @param[in]  data           double array with the data
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
  * @param[in]  buffer_idxlist integer array with the information to fill the buffer
  * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
  * @param[in]  offset         buffer offset to start the filling of the buffer array
  * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
  * 
  * @ingroup backend_cuda
  */
-void pack_cuda_double(double *buffer, double *data, int *buffer_idxlist, int buffer_size, int offset, int *transform);
+void pack_cuda_8(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                 int *transform, size_t type_size);
 
 /**
- * @brief Unpacking function for int arrays.
+ * @brief Unpacking function for 8-byte elements.
  * 
- * @details Unpack beffer into array data using the buffer_idxlist
+ * @details Unpack buffer into array data using the buffer_idxlist
  *  
- * @param[in]  buffer         integer array with the data
- * @param[out] data           integer array to be filled
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
  * @param[in]  buffer_idxlist integer array with the information to fill the data array
  * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
  * @param[in]  offset         buffer offset to start the unpacking of the buffer array
  * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cuda
+ */
+void unpack_cuda_8(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                   int *transform, size_t type_size);
+
+/**
+ * @brief Packing function for 16-byte elements.
+ * 
+ * @details Pack array data into a buffer using the buffer_idxlist
+ *  
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
+ * @param[in]  buffer_idxlist integer array with the information to fill the buffer
+ * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the filling of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
  * 
  * @ingroup backend_cuda
  */
-void unpack_cuda_int(int *buffer, int *data, int *buffer_idxlist, int buffer_size, int offset, int *transform);
+void pack_cuda_16(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                  int *transform, size_t type_size);
 
 /**
- * @brief Unpacking function for float arrays.
+ * @brief Unpacking function for 16-byte elements.
  * 
- * @details Unpack beffer into array data using the buffer_idxlist
+ * @details Unpack buffer into array data using the buffer_idxlist
  *  
- * @param[in]  buffer         float array with the data
- * @param[out] data           float array to be filled
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
  * @param[in]  buffer_idxlist integer array with the information to fill the data array
  * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
  * @param[in]  offset         buffer offset to start the unpacking of the buffer array
  * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
  * 
  * @ingroup backend_cuda
  */
-void unpack_cuda_float(float *buffer, float *data, int *buffer_idxlist, int buffer_size, int offset, int *transform);
+void unpack_cuda_16(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                    int *transform, size_t type_size);
 
 /**
- * @brief Unpacking function for double arrays.
+ * @brief Packing function for 12-byte elements.
  * 
- * @details Unpack beffer into array data using the buffer_idxlist
+ * @details Pack array data into a buffer using the buffer_idxlist
  *  
- * @param[in]  buffer         double array with the data
- * @param[out] data           double array to be filled
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
+ * @param[in]  buffer_idxlist integer array with the information to fill the buffer
+ * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the filling of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cuda
+ */
+void pack_cuda_12(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                  int *transform, size_t type_size);
+
+/**
+ * @brief Unpacking function for 12-byte elements.
+ * 
+ * @details Unpack buffer into array data using the buffer_idxlist
+ *  
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
  * @param[in]  buffer_idxlist integer array with the information to fill the data array
  * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
  * @param[in]  offset         buffer offset to start the unpacking of the buffer array
  * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
  * 
  * @ingroup backend_cuda
  */
-void unpack_cuda_double(double *buffer, double *data, int *buffer_idxlist, int buffer_size, int offset, int *transform);
+void unpack_cuda_12(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                    int *transform, size_t type_size);
+
+/**
+ * @brief Packing function for 24-byte elements.
+ * 
+ * @details Pack array data into a buffer using the buffer_idxlist
+ *  
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
+ * @param[in]  buffer_idxlist integer array with the information to fill the buffer
+ * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the filling of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cuda
+ */
+void pack_cuda_24(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                  int *transform, size_t type_size);
+
+/**
+ * @brief Unpacking function for 24-byte elements.
+ * 
+ * @details Unpack buffer into array data using the buffer_idxlist
+ *  
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
+ * @param[in]  buffer_idxlist integer array with the information to fill the data array
+ * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the unpacking of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cuda
+ */
+void unpack_cuda_24(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                    int *transform, size_t type_size);
+
+/**
+ * @brief Packing function for 32-byte elements.
+ * 
+ * @details Pack array data into a buffer using the buffer_idxlist
+ *  
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
+ * @param[in]  buffer_idxlist integer array with the information to fill the buffer
+ * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the filling of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cuda
+ */
+void pack_cuda_32(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                  int *transform, size_t type_size);
+
+/**
+ * @brief Unpacking function for 32-byte elements.
+ * 
+ * @details Unpack buffer into array data using the buffer_idxlist
+ *  
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
+ * @param[in]  buffer_idxlist integer array with the information to fill the data array
+ * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the unpacking of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cuda
+ */
+void unpack_cuda_32(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                    int *transform, size_t type_size);
+
+/**
+ * @brief Packing function for 64-byte elements.
+ * 
+ * @details Pack array data into a buffer using the buffer_idxlist
+ *  
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
+ * @param[in]  buffer_idxlist integer array with the information to fill the buffer
+ * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the filling of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cuda
+ */
+void pack_cuda_64(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                  int *transform, size_t type_size);
+
+/**
+ * @brief Unpacking function for 64-byte elements.
+ * 
+ * @details Unpack buffer into array data using the buffer_idxlist
+ *  
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
+ * @param[in]  buffer_idxlist integer array with the information to fill the data array
+ * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the unpacking of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element (unused)
+ * 
+ * @ingroup backend_cuda
+ */
+void unpack_cuda_64(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                    int *transform, size_t type_size);
+
+/**
+ * @brief Packing function for elements of arbitrary size.
+ * 
+ * @details Pack array data into a buffer using the buffer_idxlist
+ *  
+ * @param[out] buffer         array to be filled
+ * @param[in]  data           array with the data
+ * @param[in]  buffer_idxlist integer array with the information to fill the buffer
+ * @param[in]  buffer_size    size of the buffer to be filled (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the filling of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element
+ * 
+ * @ingroup backend_cuda
+ */
+void pack_cuda_generic(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                       int *transform, size_t type_size);
+
+/**
+ * @brief Unpacking function for elements of arbitrary size.
+ * 
+ * @details Unpack buffer into array data using the buffer_idxlist
+ *  
+ * @param[in]  buffer         array with the data
+ * @param[out] data           array to be filled
+ * @param[in]  buffer_idxlist integer array with the information to fill the data array
+ * @param[in]  buffer_size    size of the buffer to unpack (it can be a subset of the buffer array)
+ * @param[in]  offset         buffer offset to start the unpacking of the buffer array
+ * @param[in]  transform      array of indices to transform the memory layout
+ * @param[in]  type_size      size in bytes of a single element
+ * 
+ * @ingroup backend_cuda
+ */
+void unpack_cuda_generic(void *buffer, void *data, int *buffer_idxlist, int buffer_size, int offset,
+                         int *transform, size_t type_size);
 
 /**
  * @brief Allocate array.
@@ -158,6 +426,18 @@ void unpack_cuda_double(double *buffer, double *data, int *buffer_idxlist, int b
  */
 void* allocator_cuda(size_t buffer_size);
 
+/**
+ * @brief Allocate array on device memory accounted in a memory category.
+ *  
+ * @param[in]  buffer_size byte size of the array to be allocated
+ * @param[in]  category    category of the memory (distdir_memory_category)
+ *
+ * @return pointer to the allocated memory
+ * 
+ * @ingroup backend_cuda
+ */
+void* allocator_cuda_category(size_t buffer_size, int category);
+
 /**
  * @brief Deallocate array.
  *  
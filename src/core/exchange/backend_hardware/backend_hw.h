@@ -34,7 +34,9 @@
 #ifndef BACKEND_HW_H
 #define BACKEND_HW_H
 
-typedef void (*kernel_func_pack) ( void*, void*, int*, int, int, int* );
+#include <stddef.h>
+
+typedef void (*kernel_func_pack) ( void*, void*, int*, int, int, int*, size_t );
 
 typedef void* (*kernel_func_alloc) (size_t);
 
@@ -54,6 +56,14 @@ struct t_kernels {
 	kernel_func_alloc allocator;
 	/** @brief pointer to free function */
 	kernel_func_free deallocator;
+	/** @brief size in bytes of a single element moved by the pack and unpack functions */
+	size_t type_size;
+	/** @brief pointer to pack function without precision conversion (exchange with the same process) */
+	kernel_func_pack pack_local;
+	/** @brief pointer to unpack function without precision conversion (exchange with the same process) */
+	kernel_func_pack unpack_local;
+	/** @brief size in bytes of a single element moved by the local pack and unpack functions */
+	size_t local_type_size;
 };
 typedef struct t_kernels t_kernels;
 
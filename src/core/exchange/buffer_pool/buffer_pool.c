@@ -0,0 +1,149 @@
+/*
+ * @file buffer_pool.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include "src/core/exchange/buffer_pool/buffer_pool.h"
+#include "src/utils/memory.h"
+
+/* free buffers of each size class */
+static t_buffer_block *free_blocks[BUFFER_POOL_NCLASSES] = {NULL};
+/* total size of the buffers allocated by the pool */
+static size_t allocated_size = 0;
+/* the pool is shared by the thread ranks, the lists and the size are protected by the mutex */
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int size_class(size_t size) {
+
+	int size_class = 0;
+	while (((size_t)1 << (size_class + BUFFER_POOL_MIN_CLASS)) < size)
+		size_class++;
+
+#ifdef ERROR_CHECK
+	assert(size_class < BUFFER_POOL_NCLASSES);
+#endif
+
+	return size_class;
+}
+
+t_buffer_block * buffer_pool_acquire(size_t size, kernel_func_alloc allocator,
+                                     kernel_func_free deallocator) {
+
+	int class = size_class(size);
+
+	/* reuse a free buffer of the same class and hardware */
+	pthread_mutex_lock(&pool_mutex);
+	t_buffer_block **prev = &free_blocks[class];
+	for (t_buffer_block *block = free_blocks[class]; block != NULL; block = block->next) {
+		if (block->allocator == allocator) {
+			*prev = block->next;
+			block->next = NULL;
+			block->refcount = 1;
+			pthread_mutex_unlock(&pool_mutex);
+			return block;
+		}
+		prev = &block->next;
+	}
+	pthread_mutex_unlock(&pool_mutex);
+
+	t_buffer_block *block = (t_buffer_block *)memory_malloc(sizeof(t_buffer_block), memory_exchange);
+	block->size = (size_t)1 << (class + BUFFER_POOL_MIN_CLASS);
+	block->size_class = class;
+	block->refcount = 1;
+	block->allocator = allocator;
+	block->deallocator = deallocator;
+	block->next = NULL;
+	block->buffer = allocator(block->size);
+
+	pthread_mutex_lock(&pool_mutex);
+	allocated_size += block->size;
+	pthread_mutex_unlock(&pool_mutex);
+
+	return block;
+}
+
+void buffer_pool_retain(t_buffer_block *block) {
+
+#ifdef ERROR_CHECK
+	assert(block->refcount > 0);
+#endif
+
+	block->refcount++;
+}
+
+void buffer_pool_release(t_buffer_block *block) {
+
+	if (block == NULL) return;
+
+#ifdef ERROR_CHECK
+	assert(block->refcount > 0);
+#endif
+
+	pthread_mutex_lock(&pool_mutex);
+	block->refcount--;
+	if (block->refcount == 0) {
+		block->next = free_blocks[block->size_class];
+		free_blocks[block->size_class] = block;
+	}
+	pthread_mutex_unlock(&pool_mutex);
+}
+
+void buffer_pool_clear() {
+
+	for (int class = 0; class < BUFFER_POOL_NCLASSES; class++) {
+		/* the buffers are detached under the mutex and freed outside of it */
+		pthread_mutex_lock(&pool_mutex);
+		t_buffer_block *block = free_blocks[class];
+		free_blocks[class] = NULL;
+		for (t_buffer_block *b = block; b != NULL; b = b->next)
+			allocated_size -= b->size;
+		pthread_mutex_unlock(&pool_mutex);
+
+		while (block != NULL) {
+			t_buffer_block *next = block->next;
+			block->deallocator(block->buffer);
+			memory_free(block);
+			block = next;
+		}
+	}
+}
+
+size_t buffer_pool_allocated_size() {
+
+	pthread_mutex_lock(&pool_mutex);
+	size_t size = allocated_size;
+	pthread_mutex_unlock(&pool_mutex);
+
+	return size;
+}
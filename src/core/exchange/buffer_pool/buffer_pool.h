@@ -0,0 +1,126 @@
+/*
+ * @file buffer_pool.h
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <stddef.h>
+#include "src/core/exchange/backend_hardware/backend_hw.h"
+
+/** @brief log2 of the size in bytes of the smallest size class */
+#define BUFFER_POOL_MIN_CLASS 8
+/** @brief number of size classes (largest class is 2^(BUFFER_POOL_MIN_CLASS+BUFFER_POOL_NCLASSES-1) bytes) */
+#define BUFFER_POOL_NCLASSES 48
+
+/** @struct t_buffer_block
+ * 
+ *  @brief The structure contains a buffer of the pool
+ * 
+ */
+struct t_buffer_block {
+	/** @brief pointer to the memory of the buffer */
+	void *buffer;
+	/** @brief size in bytes of the buffer (size of its class) */
+	size_t size;
+	/** @brief size class of the buffer */
+	int size_class;
+	/** @brief number of references to the buffer (0 if the buffer is free in the pool) */
+	int refcount;
+	/** @brief pointer to the allocate function of the buffer */
+	kernel_func_alloc allocator;
+	/** @brief pointer to the free function of the buffer */
+	kernel_func_free deallocator;
+	/** @brief next free buffer of the same size class */
+	struct t_buffer_block *next;
+};
+typedef struct t_buffer_block t_buffer_block;
+
+/**
+ * @brief Lend a buffer of the pool.
+ * 
+ * @details The size is rounded up to a power of two size class. A free buffer
+ *          of the class allocated with the same allocator is reused, otherwise
+ *          a new buffer is allocated. The buffer is returned with one reference.
+ *          The rounding can almost double the memory of the buffer (a size of
+ *          2^k+1 bytes uses 2^(k+1) bytes). The pool is thread safe.
+ *  
+ * @param[in] size        size in bytes of the buffer
+ * @param[in] allocator   pointer to the allocate function (hardware of the buffer)
+ * @param[in] deallocator pointer to the free function (hardware of the buffer)
+ * 
+ * @return pointer to t_buffer_block object
+ * 
+ * @ingroup buffer_pool
+ */
+t_buffer_block * buffer_pool_acquire(size_t size, kernel_func_alloc allocator,
+                                     kernel_func_free deallocator);
+
+/**
+ * @brief Add a reference to a buffer of the pool.
+ * 
+ * @details Used to keep a buffer while it is in use by pending communication.
+ *  
+ * @param[inout] block pointer to t_buffer_block object
+ * 
+ * @ingroup buffer_pool
+ */
+void buffer_pool_retain(t_buffer_block *block);
+
+/**
+ * @brief Remove a reference to a buffer of the pool.
+ * 
+ * @details The buffer is returned to the pool when there are no more references.
+ *  
+ * @param[inout] block pointer to t_buffer_block object (it can be NULL)
+ * 
+ * @ingroup buffer_pool
+ */
+void buffer_pool_release(t_buffer_block *block);
+
+/**
+ * @brief Free all the free buffers of the pool.
+ * 
+ * @details Buffers still referenced are not affected.
+ * 
+ * @ingroup buffer_pool
+ */
+void buffer_pool_clear();
+
+/**
+ * @brief Return the total size in bytes of the buffers allocated by the pool.
+ * 
+ * @ingroup buffer_pool
+ */
+size_t buffer_pool_allocated_size();
+
+#endif
@@ -0,0 +1,375 @@
+/*
+ * @file comm_stats.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "src/core/exchange/comm_stats/comm_stats.h"
+#include "src/utils/check.h"
+#include "src/utils/memory.h"
+#include "src/core/exchange/backend_communication/backend_threads.h"
+#include "src/core/algorithm/backend_communication/backend_comm.h"
+
+/* maximum length of a line of the communication matrix */
+#define COMM_MATRIX_LINE 64
+
+/* patterns of the exchangers in use */
+static t_comm_pattern *patterns = NULL;
+
+/* volume of the exchangers already deleted */
+static t_comm_peer *retired = NULL;
+static int nretired = 0;
+static long long retired_exchanges = 0;
+static long long retired_max_message = 0;
+
+static pthread_mutex_t comm_stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int compare_comm_peer(const void *a, const void *b) {
+
+	int rank_a = ((const t_comm_peer *)a)->rank;
+	int rank_b = ((const t_comm_peer *)b)->rank;
+
+	return (rank_a > rank_b) - (rank_a < rank_b);
+}
+
+/* sort the peers by rank and merge the entries with the same rank */
+static int comm_peers_compact(t_comm_peer *peers, int npeers) {
+
+	if (npeers == 0) return 0;
+
+	qsort(peers, npeers, sizeof(t_comm_peer), compare_comm_peer);
+
+	int n = 0;
+	for (int i = 1; i < npeers; i++) {
+		if (peers[i].rank == peers[n].rank) {
+			peers[n].messages_sent     += peers[i].messages_sent;
+			peers[n].bytes_sent        += peers[i].bytes_sent;
+			peers[n].messages_received += peers[i].messages_received;
+			peers[n].bytes_received    += peers[i].bytes_received;
+		} else {
+			peers[++n] = peers[i];
+		}
+	}
+
+	return n + 1;
+}
+
+/* append the volume of the exchanges done with a pattern */
+static int comm_peers_append(t_comm_peer *peers, int npeers, t_comm_pattern *pattern,
+                             long long exchanges) {
+
+	for (int i = 0; i < pattern->npeers; i++) {
+		peers[npeers] = pattern->peers[i];
+		peers[npeers].messages_sent     *= exchanges;
+		peers[npeers].bytes_sent        *= exchanges;
+		peers[npeers].messages_received *= exchanges;
+		peers[npeers].bytes_received    *= exchanges;
+		npeers++;
+	}
+
+	return npeers;
+}
+
+/* fill the counters given the volume exchanged with each process */
+static void comm_stats_fill(t_comm_stats *stats, t_comm_peer *peers, int npeers, int self_rank) {
+
+	stats->messages_sent     = 0;
+	stats->messages_received = 0;
+	stats->bytes_sent        = 0;
+	stats->bytes_received    = 0;
+	stats->bytes_self        = 0;
+	stats->peers_send        = 0;
+	stats->peers_recv        = 0;
+
+	for (int i = 0; i < npeers; i++) {
+		if (peers[i].rank == self_rank) {
+			stats->bytes_self += peers[i].bytes_sent;
+			continue;
+		}
+		stats->messages_sent     += peers[i].messages_sent;
+		stats->messages_received += peers[i].messages_received;
+		stats->bytes_sent        += peers[i].bytes_sent;
+		stats->bytes_received    += peers[i].bytes_received;
+		stats->peers_send        += peers[i].messages_sent > 0;
+		stats->peers_recv        += peers[i].messages_received > 0;
+	}
+}
+
+/* add the messages of one direction of the map */
+static int comm_peers_add_map_exch(t_comm_peer *peers, int npeers, t_map_exch *map_exch,
+                                   int *world_ranks, size_t type_size, int send) {
+
+	for (int count = 0; count < map_exch->count; count++) {
+
+		int upper_bound = count == map_exch->count-1 ?
+		                           map_exch->buffer_size :
+		                           map_exch->buffer_offset[count + 1];
+
+		long long bytes = (long long)(upper_bound - map_exch->buffer_offset[count]) * type_size;
+
+		peers[npeers].rank              = world_ranks[count];
+		peers[npeers].messages_sent     = send;
+		peers[npeers].bytes_sent        = send ? bytes : 0;
+		peers[npeers].messages_received = !send;
+		peers[npeers].bytes_received    = send ? 0 : bytes;
+		npeers++;
+	}
+
+	return npeers;
+}
+
+/* translate the ranks of the map to ranks in MPI_COMM_WORLD */
+static int * comm_world_ranks(t_map *map, t_map_exch *map_exch) {
+
+	int *ranks = (int *)memory_malloc((map_exch->count + 1) * sizeof(int), memory_workspace);
+	int *world_ranks = (int *)memory_malloc((map_exch->count + 1) * sizeof(int), memory_workspace);
+
+	for (int count = 0; count < map_exch->count; count++)
+		ranks[count] = map_exch->exch[count]->exch_rank;
+
+	/* the thread ranks are not MPI processes */
+	if (thread_ranks_active()) {
+		memory_free(world_ranks);
+		return ranks;
+	}
+
+	MPI_Group group, world_group;
+	check_mpi( MPI_Comm_group(map->comm, &group) );
+	check_mpi( MPI_Comm_group(MPI_COMM_WORLD, &world_group) );
+	check_mpi( MPI_Group_translate_ranks(group, map_exch->count, ranks, world_group, world_ranks) );
+	check_mpi( MPI_Group_free(&group) );
+	check_mpi( MPI_Group_free(&world_group) );
+
+	memory_free(ranks);
+
+	return world_ranks;
+}
+
+t_comm_pattern * new_comm_pattern(t_map *map, size_t type_size) {
+
+	t_comm_pattern *pattern = (t_comm_pattern *)memory_malloc(sizeof(t_comm_pattern), memory_instrumentation);
+
+	if (thread_ranks_active())
+		get_comm_backend()->comm_rank(map->comm, &pattern->self_rank);
+	else
+		check_mpi( MPI_Comm_rank(MPI_COMM_WORLD, &pattern->self_rank) );
+
+	int nmessages = map->exch_send->count + map->exch_recv->count;
+	pattern->peers = (t_comm_peer *)memory_malloc((nmessages + 1) * sizeof(t_comm_peer),
+	                                              memory_instrumentation);
+
+	int *send_ranks = comm_world_ranks(map, map->exch_send);
+	int *recv_ranks = comm_world_ranks(map, map->exch_recv);
+
+	int npeers = comm_peers_add_map_exch(pattern->peers, 0, map->exch_send, send_ranks, type_size, 1);
+	npeers = comm_peers_add_map_exch(pattern->peers, npeers, map->exch_recv, recv_ranks, type_size, 0);
+
+	/* the largest message (the exchange with the same process is not a message) */
+	pattern->max_message = 0;
+	for (int i = 0; i < npeers; i++) {
+		if (pattern->peers[i].rank == pattern->self_rank) continue;
+		long long bytes = pattern->peers[i].bytes_sent + pattern->peers[i].bytes_received;
+		if (bytes > pattern->max_message)
+			pattern->max_message = bytes;
+	}
+
+	pattern->npeers = comm_peers_compact(pattern->peers, npeers);
+	pattern->exchanges = 0;
+
+	memory_free(send_ranks);
+	memory_free(recv_ranks);
+
+	pthread_mutex_lock(&comm_stats_mutex);
+	pattern->prev = NULL;
+	pattern->next = patterns;
+	if (patterns != NULL)
+		patterns->prev = pattern;
+	patterns = pattern;
+	pthread_mutex_unlock(&comm_stats_mutex);
+
+	return pattern;
+}
+
+void delete_comm_pattern(t_comm_pattern *pattern) {
+
+	pthread_mutex_lock(&comm_stats_mutex);
+
+	if (pattern->prev != NULL)
+		pattern->prev->next = pattern->next;
+	else
+		patterns = pattern->next;
+	if (pattern->next != NULL)
+		pattern->next->prev = pattern->prev;
+
+	long long exchanges = __atomic_load_n(&pattern->exchanges, __ATOMIC_RELAXED);
+	if (exchanges > 0) {
+		retired = (t_comm_peer *)memory_realloc(retired, (nretired + pattern->npeers) * sizeof(t_comm_peer),
+		                                        memory_instrumentation);
+		nretired = comm_peers_append(retired, nretired, pattern, exchanges);
+		nretired = comm_peers_compact(retired, nretired);
+		retired_exchanges += exchanges;
+		if (pattern->max_message > retired_max_message)
+			retired_max_message = pattern->max_message;
+	}
+
+	pthread_mutex_unlock(&comm_stats_mutex);
+
+	memory_free(pattern->peers);
+	memory_free(pattern);
+}
+
+void comm_pattern_count(t_comm_pattern *pattern) {
+
+	__atomic_fetch_add(&pattern->exchanges, 1LL, __ATOMIC_RELAXED);
+}
+
+void comm_pattern_get_stats(t_comm_pattern *pattern, t_comm_stats *stats) {
+
+	long long exchanges = __atomic_load_n(&pattern->exchanges, __ATOMIC_RELAXED);
+
+	/* the counters of one exchange times the number of exchanges */
+	comm_stats_fill(stats, pattern->peers, pattern->npeers, pattern->self_rank);
+	stats->messages_sent     *= exchanges;
+	stats->messages_received *= exchanges;
+	stats->bytes_sent        *= exchanges;
+	stats->bytes_received    *= exchanges;
+	stats->bytes_self        *= exchanges;
+
+	stats->exchanges = exchanges;
+	stats->max_message = pattern->max_message;
+}
+
+/* volume of all the exchanges of the process with each process */
+static t_comm_peer * comm_peers_all(int *npeers, long long *exchanges, long long *max_message) {
+
+	pthread_mutex_lock(&comm_stats_mutex);
+
+	int size = nretired;
+	for (t_comm_pattern *pattern = patterns; pattern != NULL; pattern = pattern->next)
+		size += pattern->npeers;
+
+	t_comm_peer *peers = (t_comm_peer *)memory_malloc((size + 1) * sizeof(t_comm_peer), memory_workspace);
+	if (nretired > 0)
+		memcpy(peers, retired, nretired * sizeof(t_comm_peer));
+
+	int n = nretired;
+	*exchanges = retired_exchanges;
+	*max_message = retired_max_message;
+	for (t_comm_pattern *pattern = patterns; pattern != NULL; pattern = pattern->next) {
+		long long pattern_exchanges = __atomic_load_n(&pattern->exchanges, __ATOMIC_RELAXED);
+		if (pattern_exchanges == 0) continue;
+		n = comm_peers_append(peers, n, pattern, pattern_exchanges);
+		*exchanges += pattern_exchanges;
+		if (pattern->max_message > *max_message)
+			*max_message = pattern->max_message;
+	}
+
+	pthread_mutex_unlock(&comm_stats_mutex);
+
+	*npeers = comm_peers_compact(peers, n);
+
+	return peers;
+}
+
+void distdir_get_comm_stats(t_comm_stats *stats) {
+
+	int world_rank;
+	check_mpi( MPI_Comm_rank(MPI_COMM_WORLD, &world_rank) );
+
+	int npeers;
+	long long exchanges, max_message;
+	t_comm_peer *peers = comm_peers_all(&npeers, &exchanges, &max_message);
+
+	comm_stats_fill(stats, peers, npeers, world_rank);
+	stats->exchanges = exchanges;
+	stats->max_message = max_message;
+
+	memory_free(peers);
+}
+
+void distdir_reset_comm_stats() {
+
+	pthread_mutex_lock(&comm_stats_mutex);
+
+	memory_free(retired);
+	retired = NULL;
+	nretired = 0;
+	retired_exchanges = 0;
+	retired_max_message = 0;
+
+	for (t_comm_pattern *pattern = patterns; pattern != NULL; pattern = pattern->next)
+		__atomic_store_n(&pattern->exchanges, 0LL, __ATOMIC_RELAXED);
+
+	pthread_mutex_unlock(&comm_stats_mutex);
+}
+
+void distdir_dump_comm_matrix(const char *path) {
+
+	int world_rank;
+	check_mpi( MPI_Comm_rank(MPI_COMM_WORLD, &world_rank) );
+
+	int npeers;
+	long long exchanges, max_message;
+	t_comm_peer *peers = comm_peers_all(&npeers, &exchanges, &max_message);
+
+	/* each process writes its row of the matrix */
+	char *row = (char *)memory_malloc((npeers + 1) * COMM_MATRIX_LINE, memory_workspace);
+	int length = 0;
+
+	if (world_rank == 0)
+		length += sprintf(row, "src,dst,bytes,messages\n");
+
+	for (int i = 0; i < npeers; i++)
+		if (peers[i].messages_sent > 0)
+			length += sprintf(row + length, "%d,%d,%lld,%lld\n", world_rank, peers[i].rank,
+			                  peers[i].bytes_sent, peers[i].messages_sent);
+
+	// the rows are written in rank order
+	long long row_length = length;
+	long long offset = 0;
+	check_mpi( MPI_Exscan(&row_length, &offset, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD) );
+	if (world_rank == 0) offset = 0;
+
+	MPI_File file;
+	check_mpi( MPI_File_open(MPI_COMM_WORLD, path, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+	                         MPI_INFO_NULL, &file) );
+	check_mpi( MPI_File_set_size(file, 0) );
+	check_mpi( MPI_File_write_at_all(file, (MPI_Offset)offset, row, length,
+	                                 MPI_CHAR, MPI_STATUS_IGNORE) );
+	check_mpi( MPI_File_close(&file) );
+
+	memory_free(row);
+	memory_free(peers);
+}
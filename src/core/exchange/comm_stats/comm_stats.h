@@ -0,0 +1,191 @@
+/*
+ * @file comm_stats.h
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef COMM_STATS_H
+#define COMM_STATS_H
+
+#include "src/core/algorithm/map.h"
+
+/** @struct t_comm_stats
+ * 
+ *  @brief The structure contains the communication volume counters
+ * 
+ *  @details The bytes are the size of the messages in the exchange datatype
+ *           (before the delta and compression stages). The exchange with the
+ *           same process is counted only in bytes_self. The peers of an exchanger
+ *           are counted also before the first exchange.
+ * 
+ */
+struct t_comm_stats {
+	/** @brief number of exchanges */
+	long long exchanges;
+	/** @brief number of messages sent */
+	long long messages_sent;
+	/** @brief number of messages received */
+	long long messages_received;
+	/** @brief number of bytes sent */
+	long long bytes_sent;
+	/** @brief number of bytes received */
+	long long bytes_received;
+	/** @brief number of bytes copied in the exchange with the same process */
+	long long bytes_self;
+	/** @brief number of processes the messages are sent to */
+	int peers_send;
+	/** @brief number of processes the messages are received from */
+	int peers_recv;
+	/** @brief size in bytes of the largest message */
+	long long max_message;
+};
+typedef struct t_comm_stats t_comm_stats;
+
+/** @struct t_comm_peer
+ * 
+ *  @brief The structure contains the volume exchanged with one process
+ * 
+ */
+struct t_comm_peer {
+	/** @brief rank of the process in MPI_COMM_WORLD */
+	int rank;
+	/** @brief number of messages sent to the process */
+	long long messages_sent;
+	/** @brief number of bytes sent to the process */
+	long long bytes_sent;
+	/** @brief number of messages received from the process */
+	long long messages_received;
+	/** @brief number of bytes received from the process */
+	long long bytes_received;
+};
+typedef struct t_comm_peer t_comm_peer;
+
+/** @struct t_comm_pattern
+ * 
+ *  @brief The structure contains the volume of one exchange of an exchanger
+ *         and the number of exchanges done
+ * 
+ */
+struct t_comm_pattern {
+	/** @brief number of processes of the exchange (including the same process) */
+	int npeers;
+	/** @brief volume of one exchange with each process sorted by rank */
+	t_comm_peer *peers;
+	/** @brief rank of the process in MPI_COMM_WORLD */
+	int self_rank;
+	/** @brief size in bytes of the largest message */
+	long long max_message;
+	/** @brief number of exchanges done */
+	long long exchanges;
+	/** @brief previous pattern in the list of the patterns in use */
+	struct t_comm_pattern *prev;
+	/** @brief next pattern in the list of the patterns in use */
+	struct t_comm_pattern *next;
+};
+typedef struct t_comm_pattern t_comm_pattern;
+
+/**
+ * @brief Create t_comm_pattern object.
+ * 
+ * @details The volume of one exchange is computed once from the map, so that
+ *          counting an exchange costs a single increment.
+ *  
+ * @param[in] map       pointer to t_map structure
+ * @param[in] type_size size in bytes of the exchanged elements
+ * 
+ * @return pointer to t_comm_pattern object
+ * 
+ * @ingroup comm_stats
+ */
+t_comm_pattern * new_comm_pattern(t_map *map, size_t type_size);
+
+/**
+ * @brief Free memory of t_comm_pattern object.
+ * 
+ * @details The exchanges done are added to the global counters.
+ *  
+ * @param[inout] pattern pointer to t_comm_pattern object
+ * 
+ * @ingroup comm_stats
+ */
+void delete_comm_pattern(t_comm_pattern *pattern);
+
+/**
+ * @brief Count one exchange.
+ *  
+ * @param[inout] pattern pointer to t_comm_pattern object
+ * 
+ * @ingroup comm_stats
+ */
+void comm_pattern_count(t_comm_pattern *pattern);
+
+/**
+ * @brief Get the counters of the exchanges done with a pattern.
+ *  
+ * @param[in]  pattern pointer to t_comm_pattern object
+ * @param[out] stats   pointer to t_comm_stats structure
+ * 
+ * @ingroup comm_stats
+ */
+void comm_pattern_get_stats(t_comm_pattern *pattern, t_comm_stats *stats);
+
+/**
+ * @brief Get the counters of all the exchanges of the process.
+ * 
+ * @details The counters include the exchangers in use and the deleted ones.
+ *  
+ * @param[out] stats pointer to t_comm_stats structure
+ * 
+ * @ingroup comm_stats
+ */
+void distdir_get_comm_stats(t_comm_stats *stats);
+
+/**
+ * @brief Reset the counters of all the exchanges of the process.
+ * 
+ * @ingroup comm_stats
+ */
+void distdir_reset_comm_stats();
+
+/**
+ * @brief Write the communication matrix of all the processes.
+ * 
+ * @details Collective call over MPI_COMM_WORLD. The sparse matrix is written in a single
+ *          CSV file with one line "src,dst,bytes,messages" for each pair of processes
+ *          which exchanged data, where src and dst are ranks in MPI_COMM_WORLD. The
+ *          diagonal contains the exchange with the same process.
+ *  
+ * @param[in] path name of the file
+ * 
+ * @ingroup comm_stats
+ */
+void distdir_dump_comm_matrix(const char *path);
+
+#endif
@@ -0,0 +1,265 @@
+/*
+ * @file compression.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include "src/core/exchange/compression/compression.h"
+#include "src/utils/memory.h"
+
+/* run length encoding (PackBits): a control byte c < 128 is followed by
+ * c+1 literal bytes, while c >= 128 is followed by a byte repeated c-125 times */
+#define RLE_MIN_RUN 3
+#define RLE_MAX_RUN 130
+#define RLE_MAX_LITERAL 128
+
+static size_t rle_encode(const unsigned char *src, size_t nbytes, unsigned char *dst) {
+
+	size_t i = 0;
+	size_t out = 0;
+
+	while (i < nbytes) {
+
+		size_t run = 1;
+		while (i + run < nbytes && run < RLE_MAX_RUN && src[i+run] == src[i])
+			run++;
+
+		if (run >= RLE_MIN_RUN) {
+			dst[out++] = (unsigned char)(run + 125);
+			dst[out++] = src[i];
+			i += run;
+		} else {
+			size_t start = i;
+			size_t literal = 0;
+			while (i < nbytes && literal < RLE_MAX_LITERAL) {
+				if (i + 2 < nbytes && src[i] == src[i+1] && src[i] == src[i+2])
+					break;
+				i++;
+				literal++;
+			}
+			dst[out++] = (unsigned char)(literal - 1);
+			memcpy(&dst[out], &src[start], literal);
+			out += literal;
+		}
+	}
+
+	return out;
+}
+
+static void rle_decode(const unsigned char *src, size_t csize, unsigned char *dst, size_t nbytes) {
+
+	/* the output size is only checked with ERROR_CHECK */
+	(void)nbytes;
+
+	size_t i = 0;
+	size_t out = 0;
+
+	while (i < csize) {
+
+		unsigned char c = src[i++];
+		if (c < 128) {
+			size_t literal = (size_t)c + 1;
+#ifdef ERROR_CHECK
+			assert(out + literal <= nbytes);
+#endif
+			memcpy(&dst[out], &src[i], literal);
+			i += literal;
+			out += literal;
+		} else {
+			size_t run = (size_t)c - 125;
+#ifdef ERROR_CHECK
+			assert(out + run <= nbytes);
+#endif
+			memset(&dst[out], src[i++], run);
+			out += run;
+		}
+	}
+#ifdef ERROR_CHECK
+	assert(out == nbytes);
+#endif
+}
+
+size_t compress_bound(size_t nbytes) {
+
+	return nbytes + nbytes / RLE_MAX_LITERAL + 1;
+}
+
+size_t compress_bytes(const void *src, size_t nbytes, size_t type_size, void *dst, void *work) {
+
+	const unsigned char *s = src;
+	unsigned char *w = work;
+	size_t n = nbytes / type_size;
+
+	/* XOR with the previous element and byte shuffle */
+	for (size_t k = 0; k < type_size; k++) {
+		unsigned char prev = 0;
+		for (size_t i = 0; i < n; i++) {
+			unsigned char byte = s[i*type_size+k];
+			w[k*n+i] = byte ^ prev;
+			prev = byte;
+		}
+	}
+
+	return rle_encode(w, nbytes, dst);
+}
+
+void decompress_bytes(const void *src, size_t csize, size_t type_size, void *dst, size_t nbytes, void *work) {
+
+	unsigned char *d = dst;
+	unsigned char *w = work;
+	size_t n = nbytes / type_size;
+
+	rle_decode(src, csize, w, nbytes);
+
+	for (size_t k = 0; k < type_size; k++) {
+		unsigned char prev = 0;
+		for (size_t i = 0; i < n; i++) {
+			prev ^= w[k*n+i];
+			d[i*type_size+k] = prev;
+		}
+	}
+}
+
+t_compression * new_compression(t_map_exch *map_exch, size_t type_size) {
+
+	int nactive = 0;
+	for (int count = 0; count < map_exch->count; count++) {
+		int upper_bound = count == map_exch->count-1 ?
+		                           map_exch->buffer_size :
+		                           map_exch->buffer_offset[count + 1];
+		size_t raw_size = (size_t)(upper_bound - map_exch->buffer_offset[count]) * type_size;
+		if (raw_size >= COMPRESSION_MIN_SIZE) nactive++;
+	}
+
+	if (nactive == 0) return NULL;
+
+	t_compression *compression = (t_compression *)memory_malloc(sizeof(t_compression), memory_exchange);
+	compression->count = map_exch->count;
+	compression->type_size = type_size;
+	compression->active = (int *)memory_malloc(map_exch->count * sizeof(int), memory_exchange);
+	compression->raw_size = (size_t *)memory_malloc(map_exch->count * sizeof(size_t), memory_exchange);
+	compression->offset = (size_t *)memory_malloc(map_exch->count * sizeof(size_t), memory_exchange);
+	compression->skip = (int *)memory_malloc(map_exch->count * sizeof(int), memory_exchange);
+
+	size_t staging_size = 0;
+	size_t max_raw_size = 0;
+	for (int count = 0; count < map_exch->count; count++) {
+		int upper_bound = count == map_exch->count-1 ?
+		                           map_exch->buffer_size :
+		                           map_exch->buffer_offset[count + 1];
+		size_t raw_size = (size_t)(upper_bound - map_exch->buffer_offset[count]) * type_size;
+		compression->raw_size[count] = raw_size;
+		compression->active[count] = raw_size >= COMPRESSION_MIN_SIZE;
+		compression->skip[count] = 0;
+		compression->offset[count] = staging_size;
+		if (compression->active[count]) {
+			/* keep the headers 8 bytes aligned */
+			staging_size += (COMPRESSION_HEADER_SIZE + compress_bound(raw_size) + 7) & ~(size_t)7;
+			if (raw_size > max_raw_size) max_raw_size = raw_size;
+		}
+	}
+
+	compression->buffer = (char *)memory_malloc(staging_size, memory_exchange);
+	compression->work = (char *)memory_malloc(max_raw_size, memory_exchange);
+
+	return compression;
+}
+
+void delete_compression(t_compression *compression) {
+
+	if (compression == NULL) return;
+
+	memory_free(compression->active);
+	memory_free(compression->raw_size);
+	memory_free(compression->offset);
+	memory_free(compression->skip);
+	memory_free(compression->buffer);
+	memory_free(compression->work);
+	memory_free(compression);
+}
+
+int compression_is_active(t_compression *compression, int count) {
+
+	return compression != NULL && compression->active[count];
+}
+
+void * compression_compress(t_compression *compression, int count, const void *data, int *nbytes) {
+
+	size_t raw_size = compression->raw_size[count];
+	char *message = compression->buffer + compression->offset[count];
+	char *payload = message + COMPRESSION_HEADER_SIZE;
+	uint32_t header[2] = {0, (uint32_t)raw_size};
+
+	if (compression->skip[count] > 0) {
+		compression->skip[count]--;
+	} else {
+		size_t csize = compress_bytes(data, raw_size, compression->type_size, payload, compression->work);
+		if (csize * 8 < raw_size * COMPRESSION_MAX_RATIO) {
+			header[0] = 1;
+			header[1] = (uint32_t)csize;
+		} else {
+			/* poor ratio: send raw for the next exchanges */
+			compression->skip[count] = COMPRESSION_RETRY;
+		}
+	}
+
+	if (header[0] == 0)
+		memcpy(payload, data, raw_size);
+
+	memcpy(message, header, sizeof(header));
+	*nbytes = (int)(COMPRESSION_HEADER_SIZE + header[1]);
+
+	return message;
+}
+
+void * compression_recv_buffer(t_compression *compression, int count, int *nbytes) {
+
+	*nbytes = (int)(COMPRESSION_HEADER_SIZE + compress_bound(compression->raw_size[count]));
+
+	return compression->buffer + compression->offset[count];
+}
+
+void compression_decompress(t_compression *compression, int count, void *data) {
+
+	const char *message = compression->buffer + compression->offset[count];
+	const char *payload = message + COMPRESSION_HEADER_SIZE;
+	uint32_t header[2];
+	memcpy(header, message, sizeof(header));
+
+	if (header[0] == 1)
+		decompress_bytes(payload, header[1], compression->type_size, data,
+		                 compression->raw_size[count], compression->work);
+	else
+		memcpy(data, payload, compression->raw_size[count]);
+}
@@ -0,0 +1,199 @@
+/*
+ * @file compression.h
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <stddef.h>
+#include "src/core/algorithm/map.h"
+
+/** @brief messages smaller than this size in bytes are never compressed */
+#define COMPRESSION_MIN_SIZE 4096
+
+/** @brief a compressed message is sent only if smaller than this fraction (in 1/8) of the raw message */
+#define COMPRESSION_MAX_RATIO 7
+
+/** @brief number of exchanges a message is sent raw after a poor compression ratio */
+#define COMPRESSION_RETRY 16
+
+/** @brief size in bytes of the header in front of each compressed message */
+#define COMPRESSION_HEADER_SIZE 8
+
+/** @struct t_compression
+ * 
+ *  @brief The structure contains the staging buffers and the state of the
+ *         compression of the messages in one direction
+ * 
+ */
+struct t_compression {
+	/** @brief number of messages */
+	int count;
+	/** @brief size in bytes of an element of the messages */
+	size_t type_size;
+	/** @brief flag for each message if it is above the size threshold */
+	int *active;
+	/** @brief raw size in bytes of each message */
+	size_t *raw_size;
+	/** @brief offset in bytes of each message in the staging buffer */
+	size_t *offset;
+	/** @brief number of remaining exchanges without trying to compress each message */
+	int *skip;
+	/** @brief staging buffer with the messages on the wire */
+	char *buffer;
+	/** @brief scratch buffer used by the codec */
+	char *work;
+};
+typedef struct t_compression t_compression;
+
+/**
+ * @brief Create t_compression object.
+ * 
+ * @details The messages of the map above the size threshold are compressed.
+ *          If no message is above the threshold, NULL is returned.
+ *  
+ * @param[in] map_exch  pointer to t_map_exch structure (one direction of the map)
+ * @param[in] type_size size in bytes of the exchanged elements
+ * 
+ * @return pointer to t_compression object or NULL
+ * 
+ * @ingroup compression
+ */
+t_compression * new_compression(t_map_exch *map_exch, size_t type_size);
+
+/**
+ * @brief Free memory of t_compression object.
+ *  
+ * @param[inout] compression pointer to t_compression object
+ * 
+ * @ingroup compression
+ */
+void delete_compression(t_compression *compression);
+
+/**
+ * @brief Check if a message goes through the compression stage.
+ *  
+ * @param[in] compression pointer to t_compression object (it can be NULL)
+ * @param[in] count       index of the message
+ * 
+ * @return 1 if the message is sent with a header through the staging buffer, 0 otherwise
+ * 
+ * @ingroup compression
+ */
+int compression_is_active(t_compression *compression, int count);
+
+/**
+ * @brief Compress a message into the staging buffer.
+ * 
+ * @details The message is compressed unless the previous attempts had a poor ratio
+ *          (adaptive bypass), in which case it is copied raw after the header.
+ *  
+ * @param[inout] compression pointer to t_compression object
+ * @param[in]    count       index of the message
+ * @param[in]    data        raw message
+ * @param[out]   nbytes      size in bytes of the message on the wire
+ * 
+ * @return pointer to the message on the wire
+ * 
+ * @ingroup compression
+ */
+void * compression_compress(t_compression *compression, int count, const void *data, int *nbytes);
+
+/**
+ * @brief Return the staging buffer to receive a message.
+ *  
+ * @param[in]  compression pointer to t_compression object
+ * @param[in]  count       index of the message
+ * @param[out] nbytes      maximum size in bytes of the message on the wire
+ * 
+ * @return pointer to the receive location of the message
+ * 
+ * @ingroup compression
+ */
+void * compression_recv_buffer(t_compression *compression, int count, int *nbytes);
+
+/**
+ * @brief Decompress a received message from the staging buffer.
+ *  
+ * @param[in]  compression pointer to t_compression object
+ * @param[in]  count       index of the message
+ * @param[out] data        raw message
+ * 
+ * @ingroup compression
+ */
+void compression_decompress(t_compression *compression, int count, void *data);
+
+/**
+ * @brief Worst case size in bytes of a compressed array.
+ *  
+ * @param[in] nbytes size in bytes of the raw array
+ * 
+ * @return maximum size in bytes of the compressed array
+ * 
+ * @ingroup compression
+ */
+size_t compress_bound(size_t nbytes);
+
+/**
+ * @brief Lossless compression of an array of elements.
+ * 
+ * @details Each element is XOR-ed with the previous one and the bytes are shuffled,
+ *          so that equal or smooth values give long runs of equal bytes, which are
+ *          then encoded with a run length encoding (PackBits).
+ *  
+ * @param[in]  src       raw array
+ * @param[in]  nbytes    size in bytes of the raw array (multiple of type_size)
+ * @param[in]  type_size size in bytes of an element
+ * @param[out] dst       compressed array (at least compress_bound(nbytes) bytes)
+ * @param[out] work      scratch array of nbytes bytes
+ * 
+ * @return size in bytes of the compressed array
+ * 
+ * @ingroup compression
+ */
+size_t compress_bytes(const void *src, size_t nbytes, size_t type_size, void *dst, void *work);
+
+/**
+ * @brief Decompression of an array compressed with compress_bytes.
+ *  
+ * @param[in]  src       compressed array
+ * @param[in]  csize     size in bytes of the compressed array
+ * @param[in]  type_size size in bytes of an element
+ * @param[out] dst       raw array
+ * @param[in]  nbytes    size in bytes of the raw array
+ * @param[out] work      scratch array of nbytes bytes
+ * 
+ * @ingroup compression
+ */
+void decompress_bytes(const void *src, size_t csize, size_t type_size, void *dst, size_t nbytes, void *work);
+
+#endif
@@ -0,0 +1,368 @@
+/*
+ * @file cost_model.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "src/core/exchange/cost_model/cost_model.h"
+#include "src/core/exchange/backend_hardware/backend_cpu.h"
+#include "src/setup/setting.h"
+#include "src/utils/check.h"
+#include "src/utils/memory.h"
+
+/* size in bytes of the messages of the latency ping-pong */
+#define COST_MODEL_SMALL_MESSAGE 8
+/* size in bytes of the messages of the bandwidth ping-pong */
+#define COST_MODEL_LARGE_MESSAGE 4194304
+/* number of round trips of the latency and bandwidth ping-pongs */
+#define COST_MODEL_SMALL_REPS 100
+#define COST_MODEL_LARGE_REPS 10
+/* number of elements, index stride and repetitions of the pack benchmark */
+#define COST_MODEL_PACK_SIZE 1048576
+#define COST_MODEL_PACK_STRIDE 7
+#define COST_MODEL_PACK_REPS 5
+
+static t_cost_params cost_params = {COST_MODEL_LATENCY_INTRA, COST_MODEL_BANDWIDTH_INTRA,
+                                    COST_MODEL_LATENCY_INTER, COST_MODEL_BANDWIDTH_INTER,
+                                    COST_MODEL_PACK_BANDWIDTH, 0};
+
+/* cost of one message of the map */
+struct t_cost_message {
+	/* flag set for the exchange with the same process (no MPI message) */
+	int self;
+	/* latency in seconds */
+	double latency;
+	/* time in seconds to transfer the message */
+	double transfer;
+	/* time in seconds to pack or unpack the message */
+	double pack;
+};
+typedef struct t_cost_message t_cost_message;
+
+/* identifier of the node of each process (lowest rank of the processes of the node) */
+static int * cost_model_node_ids(MPI_Comm comm) {
+
+	int world_size;
+	check_mpi( MPI_Comm_size(comm, &world_size) );
+	int world_rank;
+	check_mpi( MPI_Comm_rank(comm, &world_rank) );
+
+	MPI_Comm node_comm;
+	check_mpi( MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, world_rank, MPI_INFO_NULL, &node_comm) );
+	int node_id;
+	check_mpi( MPI_Allreduce(&world_rank, &node_id, 1, MPI_INT, MPI_MIN, node_comm) );
+	check_mpi( MPI_Comm_free(&node_comm) );
+
+	int *node_ids = (int *)memory_malloc(world_size * sizeof(int), memory_workspace);
+	check_mpi( MPI_Allgather(&node_id, 1, MPI_INT, node_ids, 1, MPI_INT, comm) );
+
+	return node_ids;
+}
+
+/* one way time of a message between the process 0 and the peer */
+static double cost_model_pingpong(MPI_Comm comm, int peer, char *buffer, int nbytes, int reps) {
+
+	int world_rank;
+	check_mpi( MPI_Comm_rank(comm, &world_rank) );
+
+	/* the first round trip is a warm-up */
+	double start = 0.0;
+	for (int i = -1; i < reps; i++) {
+		if (i == 0) start = MPI_Wtime();
+		if (world_rank == 0) {
+			check_mpi( MPI_Send(buffer, nbytes, MPI_BYTE, peer, 0, comm) );
+			check_mpi( MPI_Recv(buffer, nbytes, MPI_BYTE, peer, 0, comm, MPI_STATUS_IGNORE) );
+		} else {
+			check_mpi( MPI_Recv(buffer, nbytes, MPI_BYTE, 0, 0, comm, MPI_STATUS_IGNORE) );
+			check_mpi( MPI_Send(buffer, nbytes, MPI_BYTE, 0, 0, comm) );
+		}
+	}
+
+	return (MPI_Wtime() - start) / (2.0 * reps);
+}
+
+/* latency and bandwidth between the process 0 and the peer (only the two processes take part) */
+static void cost_model_fit(MPI_Comm comm, int peer, char *buffer, double *latency, double *bandwidth) {
+
+	int world_rank;
+	check_mpi( MPI_Comm_rank(comm, &world_rank) );
+	if (world_rank != 0 && world_rank != peer) return;
+
+	*latency = cost_model_pingpong(comm, peer, buffer, COST_MODEL_SMALL_MESSAGE, COST_MODEL_SMALL_REPS);
+	double time = cost_model_pingpong(comm, peer, buffer, COST_MODEL_LARGE_MESSAGE, COST_MODEL_LARGE_REPS);
+
+	/* the latency is negligible for large messages on a noisy system */
+	double transfer = time > *latency ? time - *latency : time;
+	*bandwidth = COST_MODEL_LARGE_MESSAGE / transfer;
+}
+
+/* throughput of the pack and unpack kernels of doubles with a strided index list */
+static double cost_model_pack_bandwidth() {
+
+	double *data = (double *)memory_malloc(COST_MODEL_PACK_SIZE * sizeof(double), memory_workspace);
+	double *buffer = (double *)memory_malloc(COST_MODEL_PACK_SIZE * sizeof(double), memory_workspace);
+	int *idxlist = (int *)memory_malloc(COST_MODEL_PACK_SIZE * sizeof(int), memory_workspace);
+
+	for (int i = 0; i < COST_MODEL_PACK_SIZE; i++) {
+		data[i] = (double)i;
+		idxlist[i] = (int)(((long long)i * COST_MODEL_PACK_STRIDE) % COST_MODEL_PACK_SIZE);
+	}
+
+	t_kernels *vtable = new_vtable_cpu(sizeof(double));
+
+	/* the first pack is a warm-up */
+	vtable->pack(buffer, data, idxlist, COST_MODEL_PACK_SIZE, 0, NULL, sizeof(double));
+
+	double start = MPI_Wtime();
+	for (int i = 0; i < COST_MODEL_PACK_REPS; i++) {
+		vtable->pack(buffer, data, idxlist, COST_MODEL_PACK_SIZE, 0, NULL, sizeof(double));
+		vtable->unpack(buffer, data, idxlist, COST_MODEL_PACK_SIZE, 0, NULL, sizeof(double));
+	}
+	double time = MPI_Wtime() - start;
+
+	delete_vtable(vtable);
+	memory_free(idxlist);
+	memory_free(buffer);
+	memory_free(data);
+
+	return 2.0 * COST_MODEL_PACK_REPS * COST_MODEL_PACK_SIZE * sizeof(double) / time;
+}
+
+void distdir_calibrate(MPI_Comm comm) {
+
+	MPI_Comm calibrate_comm;
+	check_mpi( MPI_Comm_dup(comm, &calibrate_comm) );
+
+	int world_size;
+	check_mpi( MPI_Comm_size(calibrate_comm, &world_size) );
+
+	/* the first process on the same node and on another node than the process 0 */
+	int *node_ids = cost_model_node_ids(calibrate_comm);
+	int peer_intra = -1;
+	int peer_inter = -1;
+	for (int rank = 1; rank < world_size; rank++) {
+		if (node_ids[rank] == node_ids[0] && peer_intra < 0) peer_intra = rank;
+		if (node_ids[rank] != node_ids[0] && peer_inter < 0) peer_inter = rank;
+	}
+	memory_free(node_ids);
+
+	double params[4] = {cost_params.latency_intra, cost_params.bandwidth_intra,
+	                    cost_params.latency_inter, cost_params.bandwidth_inter};
+
+	char *buffer = (char *)memory_calloc(COST_MODEL_LARGE_MESSAGE, 1, memory_workspace);
+	if (peer_intra > 0)
+		cost_model_fit(calibrate_comm, peer_intra, buffer, &params[0], &params[1]);
+	if (peer_inter > 0)
+		cost_model_fit(calibrate_comm, peer_inter, buffer, &params[2], &params[3]);
+	memory_free(buffer);
+
+	if (peer_intra < 0 && peer_inter > 0) {
+		params[0] = params[2];
+		params[1] = params[3];
+	}
+	if (peer_inter < 0 && peer_intra > 0) {
+		params[2] = params[0];
+		params[3] = params[1];
+	}
+	check_mpi( MPI_Bcast(params, 4, MPI_DOUBLE, 0, calibrate_comm) );
+
+	/* the exchange is as fast as the slowest process */
+	double pack_bandwidth = cost_model_pack_bandwidth();
+	check_mpi( MPI_Allreduce(MPI_IN_PLACE, &pack_bandwidth, 1, MPI_DOUBLE, MPI_MIN, calibrate_comm) );
+
+	check_mpi( MPI_Comm_free(&calibrate_comm) );
+
+	cost_params.latency_intra   = params[0];
+	cost_params.bandwidth_intra = params[1];
+	cost_params.latency_inter   = params[2];
+	cost_params.bandwidth_inter = params[3];
+	cost_params.pack_bandwidth  = pack_bandwidth;
+	cost_params.calibrated      = 1;
+}
+
+void distdir_get_cost_params(t_cost_params *params) {
+
+	*params = cost_params;
+}
+
+void distdir_set_cost_params(const t_cost_params *params) {
+
+#ifdef ERROR_CHECK
+	assert(params->bandwidth_intra > 0.0 && params->bandwidth_inter > 0.0);
+	assert(params->pack_bandwidth > 0.0);
+#endif
+
+	cost_params = *params;
+}
+
+/* cost of the messages of one direction of the map */
+static t_cost_message * cost_model_messages(t_map_exch *map_exch, int *node_ids, int world_rank,
+                                            size_t type_size) {
+
+	t_cost_message *messages = (t_cost_message *)memory_malloc((map_exch->count + 1) * sizeof(t_cost_message), memory_workspace);
+
+	for (int count = 0; count < map_exch->count; count++) {
+
+		int upper_bound = count == map_exch->count-1 ?
+		                           map_exch->buffer_size :
+		                           map_exch->buffer_offset[count + 1];
+
+		double bytes = (double)(upper_bound - map_exch->buffer_offset[count]) * type_size;
+		int rank = map_exch->exch[count]->exch_rank;
+		int intra = node_ids[rank] == node_ids[world_rank];
+
+		messages[count].self     = rank == world_rank;
+		messages[count].latency  = intra ? cost_params.latency_intra : cost_params.latency_inter;
+		messages[count].transfer = bytes / (intra ? cost_params.bandwidth_intra :
+		                                            cost_params.bandwidth_inter);
+		messages[count].pack     = bytes / cost_params.pack_bandwidth;
+	}
+
+	return messages;
+}
+
+/* time of an exchange of the process following the steps of the exchanger type */
+static double cost_model_time(t_cost_message *send, int nsend, t_cost_message *recv, int nrecv,
+                              int mode) {
+
+	int pack_all    = mode == IsendIrecv2 || mode == IsendIrecv2NoWait;
+	int blocking    = mode == IsendRecv1  || mode == IsendRecv2 ||
+	                  mode == IsendRecv1NoWait || mode == IsendRecv2NoWait;
+	int unpack_each = mode == IsendRecv2  || mode == IsendRecv2NoWait;
+	int nowait      = mode >= IsendIrecv1NoWait;
+
+	/* the messages are injected one after the other as soon as they are packed */
+	double packed = 0.0;
+	if (pack_all)
+		for (int i = 0; i < nsend; i++)
+			packed += send[i].pack;
+
+	double injected = 0.0;
+	double send_done = 0.0;
+	for (int i = 0; i < nsend; i++) {
+		if (!pack_all) packed += send[i].pack;
+		if (send[i].self) continue;
+		injected = (injected > packed ? injected : packed) + send[i].transfer;
+		if (injected + send[i].latency > send_done)
+			send_done = injected + send[i].latency;
+	}
+
+	/* the receives are posted after the sends, the latencies of the posted
+	 * receives overlap while the blocking receives are done one at a time */
+	double recv_done = packed;
+	double latency = 0.0;
+	double unpack = 0.0;
+	for (int i = 0; i < nrecv; i++) {
+		if (unpack_each)
+			recv_done += recv[i].pack;
+		else
+			unpack += recv[i].pack;
+		if (recv[i].self) continue;
+		if (blocking) {
+			recv_done += recv[i].latency + recv[i].transfer;
+		} else {
+			recv_done += recv[i].transfer;
+			if (recv[i].latency > latency) latency = recv[i].latency;
+		}
+	}
+	recv_done += latency + unpack;
+
+	/* the sends of the NoWait types are completed by the next exchange */
+	if (nowait || send_done < recv_done) return recv_done;
+	return send_done;
+}
+
+/* predicted time of each exchanger type (max among the processes), the last
+ * element is set if a process both sends and receives messages */
+static void cost_model_predict(t_map *map, MPI_Datatype type, double *times) {
+
+	int world_rank;
+	check_mpi( MPI_Comm_rank(map->comm, &world_rank) );
+
+	MPI_Aint type_lb;
+	MPI_Aint type_size;
+	check_mpi( MPI_Type_get_extent(type, &type_lb, &type_size) );
+
+	int *node_ids = cost_model_node_ids(map->comm);
+	t_cost_message *send = cost_model_messages(map->exch_send, node_ids, world_rank, type_size);
+	t_cost_message *recv = cost_model_messages(map->exch_recv, node_ids, world_rank, type_size);
+
+	for (int mode = 0; mode < Auto; mode++)
+		times[mode] = cost_model_time(send, map->exch_send->count, recv, map->exch_recv->count, mode);
+	times[Auto] = map->exch_send->count > 0 && map->exch_recv->count > 0;
+
+	check_mpi( MPI_Allreduce(MPI_IN_PLACE, times, Auto + 1, MPI_DOUBLE, MPI_MAX, map->comm) );
+
+	memory_free(send);
+	memory_free(recv);
+	memory_free(node_ids);
+}
+
+/* fastest exchanger type, the NoWait types can be used only if the sending
+ * and the receiving processes do not overlap (see new_autotune) */
+static int cost_model_best(double *times) {
+
+	int nmodes = times[Auto] > 0.0 ? IsendIrecv1NoWait : Auto;
+
+	int best = 0;
+	for (int mode = 1; mode < nmodes; mode++)
+		if (times[mode] < times[best])
+			best = mode;
+
+	return best;
+}
+
+double map_predict_cost(t_map        *map ,
+                        MPI_Datatype  type,
+                        int           mode) {
+
+#ifdef ERROR_CHECK
+	assert(mode >= IsendIrecv1 && mode <= Auto);
+#endif
+
+	double times[Auto + 1];
+	cost_model_predict(map, type, times);
+
+	if (mode == Auto) mode = cost_model_best(times);
+
+	return times[mode];
+}
+
+int map_predict_exchanger(t_map        *map ,
+                          MPI_Datatype  type) {
+
+	double times[Auto + 1];
+	cost_model_predict(map, type, times);
+
+	return cost_model_best(times);
+}
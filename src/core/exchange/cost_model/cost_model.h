@@ -0,0 +1,152 @@
+/*
+ * @file cost_model.h
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef COST_MODEL_H
+#define COST_MODEL_H
+
+#include "src/core/algorithm/map.h"
+
+/** @brief default latency in seconds of a message between processes on the same node */
+#define COST_MODEL_LATENCY_INTRA 1.0e-6
+/** @brief default bandwidth in bytes/s between processes on the same node */
+#define COST_MODEL_BANDWIDTH_INTRA 1.0e10
+/** @brief default latency in seconds of a message between processes on different nodes */
+#define COST_MODEL_LATENCY_INTER 2.0e-6
+/** @brief default bandwidth in bytes/s between processes on different nodes */
+#define COST_MODEL_BANDWIDTH_INTER 1.0e10
+/** @brief default throughput in bytes/s of the pack and unpack kernels */
+#define COST_MODEL_PACK_BANDWIDTH 5.0e9
+
+/** @struct t_cost_params
+ * 
+ *  @brief The structure contains the parameters of the cost model of the exchanges
+ * 
+ *  @details A message of n bytes takes latency + n / bandwidth seconds, with the
+ *           parameters of the processes on the same node or on different nodes.
+ *           Packing or unpacking n bytes takes n / pack_bandwidth seconds.
+ * 
+ */
+struct t_cost_params {
+	/** @brief latency in seconds of a message between processes on the same node */
+	double latency_intra;
+	/** @brief bandwidth in bytes/s between processes on the same node */
+	double bandwidth_intra;
+	/** @brief latency in seconds of a message between processes on different nodes */
+	double latency_inter;
+	/** @brief bandwidth in bytes/s between processes on different nodes */
+	double bandwidth_inter;
+	/** @brief throughput in bytes/s of the pack and unpack kernels */
+	double pack_bandwidth;
+	/** @brief flag set if the parameters were measured by distdir_calibrate */
+	int calibrated;
+};
+typedef struct t_cost_params t_cost_params;
+
+/**
+ * @brief Measure the parameters of the cost model
+ * 
+ * @details Collective call over the communicator. The latency and the bandwidth are
+ *          measured with a ping-pong between the process 0 and another process on the
+ *          same node and on a different node (the parameters of a missing pair are the
+ *          ones of the other pair). The throughput of the pack and unpack kernels is
+ *          the lowest among the processes. The parameters are the same on all the
+ *          processes and they are used by the following predictions.
+ * 
+ * @param[in] comm MPI communicator
+ * 
+ * @ingroup cost_model
+ */
+void distdir_calibrate(MPI_Comm comm);
+
+/**
+ * @brief Get the parameters of the cost model
+ * 
+ * @param[out] params pointer to t_cost_params structure
+ * 
+ * @ingroup cost_model
+ */
+void distdir_get_cost_params(t_cost_params *params);
+
+/**
+ * @brief Set the parameters of the cost model
+ * 
+ * @details The parameters can be measured once on the target system and set in
+ *          later runs instead of calling \c distdir_calibrate.
+ * 
+ * @param[in] params pointer to t_cost_params structure
+ * 
+ * @ingroup cost_model
+ */
+void distdir_set_cost_params(const t_cost_params *params);
+
+/**
+ * @brief Predict the time of an exchange of a map
+ * 
+ * @details Collective call over the communicator of the map. The time of
+ *          \c exchanger_go is predicted for each process from the messages of the map,
+ *          the size of the datatype and the parameters of the cost model, following
+ *          the order of the pack, send, receive and unpack steps of the exchanger type.
+ *          The exchange is as fast as its slowest process, so the result is the maximum
+ *          among the processes. With the \c Auto type it is the time of the fastest
+ *          exchanger type the Auto exchanger can select.
+ * 
+ * @param[in] map  pointer to t_map structure
+ * @param[in] type type of the data in the form of MPI datatype
+ * @param[in] mode exchanger type using values of distdir_exchanger enum
+ * 
+ * @return predicted time in seconds
+ * 
+ * @ingroup cost_model
+ */
+double map_predict_cost(t_map        *map ,
+                        MPI_Datatype  type,
+                        int           mode);
+
+/**
+ * @brief Predict the fastest exchanger type of a map
+ * 
+ * @details Collective call over the communicator of the map. The candidates are the
+ *          exchanger types of the Auto exchanger, so the result can be set with
+ *          \c set_config_exchanger instead of timing the candidates.
+ * 
+ * @param[in] map  pointer to t_map structure
+ * @param[in] type type of the data in the form of MPI datatype
+ * 
+ * @return value of distdir_exchanger enum
+ * 
+ * @ingroup cost_model
+ */
+int map_predict_exchanger(t_map        *map ,
+                          MPI_Datatype  type);
+
+#endif
@@ -0,0 +1,178 @@
+/*
+ * @file delta.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include "src/core/exchange/delta/delta.h"
+#include "src/utils/memory.h"
+
+t_delta * new_delta(t_map_exch *map_exch, size_t type_size, int send) {
+
+	if (map_exch->count == 0) return NULL;
+
+	t_delta *delta = (t_delta *)memory_malloc(sizeof(t_delta), memory_exchange);
+	delta->count = map_exch->count;
+	delta->type_size = type_size;
+	delta->valid = 0;
+	delta->size = (int *)memory_malloc(map_exch->count * sizeof(int), memory_exchange);
+	delta->offset = (size_t *)memory_malloc(map_exch->count * sizeof(size_t), memory_exchange);
+
+	size_t staging_size = 0;
+	for (int count = 0; count < map_exch->count; count++) {
+		int upper_bound = count == map_exch->count-1 ?
+		                           map_exch->buffer_size :
+		                           map_exch->buffer_offset[count + 1];
+		delta->size[count] = upper_bound - map_exch->buffer_offset[count];
+		delta->offset[count] = staging_size;
+		/* keep the headers 8 bytes aligned */
+		staging_size += (DELTA_HEADER_SIZE + (size_t)delta->size[count] * type_size + 7) & ~(size_t)7;
+	}
+
+	delta->buffer = (char *)memory_malloc(staging_size, memory_exchange);
+	delta->previous = send ? (char *)memory_malloc(staging_size, memory_exchange) : NULL;
+
+	return delta;
+}
+
+void delete_delta(t_delta *delta) {
+
+	if (delta == NULL) return;
+
+	memory_free(delta->size);
+	memory_free(delta->offset);
+	memory_free(delta->previous);
+	memory_free(delta->buffer);
+	memory_free(delta);
+}
+
+void * delta_encode(t_delta *delta, int count, const void *data, int *nbytes) {
+
+	const size_t type_size = delta->type_size;
+	const int size = delta->size[count];
+	const char *current = data;
+	char *previous = delta->previous + delta->offset[count];
+	char *message = delta->buffer + delta->offset[count];
+	char *payload = message + DELTA_HEADER_SIZE;
+	uint32_t header[2] = {delta_full, (uint32_t)size};
+	size_t raw_size = (size_t)size * type_size;
+
+	if (delta->valid) {
+
+		int nchanged = 0;
+		for (int i = 0; i < size; i++)
+			if (memcmp(&current[i*type_size], &previous[i*type_size], type_size) != 0)
+				nchanged++;
+
+		if (nchanged == 0) {
+			header[0] = delta_unchanged;
+			header[1] = 0;
+		} else if ((size_t)nchanged * (sizeof(int32_t) + type_size) < raw_size) {
+			/* positions first, then the values */
+			int32_t *positions = (int32_t *)payload;
+			char *values = payload + (size_t)nchanged * sizeof(int32_t);
+			int n = 0;
+			for (int i = 0; i < size; i++)
+				if (memcmp(&current[i*type_size], &previous[i*type_size], type_size) != 0) {
+					positions[n] = i;
+					memcpy(&values[n*type_size], &current[i*type_size], type_size);
+					memcpy(&previous[i*type_size], &current[i*type_size], type_size);
+					n++;
+				}
+			header[0] = delta_sparse;
+			header[1] = (uint32_t)nchanged;
+		}
+	}
+
+	size_t payload_size = 0;
+	switch (header[0]) {
+		case delta_full:
+			memcpy(payload, current, raw_size);
+			memcpy(previous, current, raw_size);
+			payload_size = raw_size;
+			break;
+		case delta_sparse:
+			payload_size = (size_t)header[1] * (sizeof(int32_t) + type_size);
+			break;
+		default:
+			break;
+	}
+
+	memcpy(message, header, sizeof(header));
+	*nbytes = (int)(DELTA_HEADER_SIZE + payload_size);
+
+	return message;
+}
+
+void delta_commit(t_delta *delta) {
+
+	if (delta != NULL) delta->valid = 1;
+}
+
+void * delta_recv_buffer(t_delta *delta, int count, int *nbytes) {
+
+	*nbytes = (int)(DELTA_HEADER_SIZE + (size_t)delta->size[count] * delta->type_size);
+
+	return delta->buffer + delta->offset[count];
+}
+
+void delta_decode(t_delta *delta, int count, void *data) {
+
+	const size_t type_size = delta->type_size;
+	const char *message = delta->buffer + delta->offset[count];
+	const char *payload = message + DELTA_HEADER_SIZE;
+	char *current = data;
+	uint32_t header[2];
+	memcpy(header, message, sizeof(header));
+
+	switch (header[0]) {
+		case delta_full:
+#ifdef ERROR_CHECK
+			assert(header[1] == (uint32_t)delta->size[count]);
+#endif
+			memcpy(current, payload, (size_t)delta->size[count] * type_size);
+			break;
+		case delta_sparse: {
+			const char *values = payload + (size_t)header[1] * sizeof(int32_t);
+			for (uint32_t n = 0; n < header[1]; n++) {
+				int32_t position;
+				memcpy(&position, &payload[n*sizeof(int32_t)], sizeof(int32_t));
+				memcpy(&current[position*type_size], &values[n*type_size], type_size);
+			}
+			break;
+		}
+		default:
+			break;
+	}
+}
@@ -0,0 +1,153 @@
+/*
+ * @file delta.h
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DELTA_H
+#define DELTA_H
+
+#include <stddef.h>
+#include "src/core/algorithm/map.h"
+
+/** @brief size in bytes of the header in front of each delta message */
+#define DELTA_HEADER_SIZE 8
+
+/** @enum delta_kind
+ * 
+ *  @brief Enum for the content of a delta message
+ * 
+ */
+enum delta_kind {
+	delta_unchanged = 0,
+	delta_sparse    = 1,
+	delta_full      = 2
+};
+
+/** @struct t_delta
+ * 
+ *  @brief The structure contains the staging buffers and the last exchanged
+ *         messages in one direction
+ * 
+ */
+struct t_delta {
+	/** @brief number of messages */
+	int count;
+	/** @brief size in bytes of an element of the messages */
+	size_t type_size;
+	/** @brief number of elements of each message */
+	int *size;
+	/** @brief offset in bytes of each message in the staging buffer and in the previous buffer */
+	size_t *offset;
+	/** @brief flag set after the first exchange (the previous messages are valid) */
+	int valid;
+	/** @brief last packed messages (send direction only) */
+	char *previous;
+	/** @brief staging buffer with the messages on the wire */
+	char *buffer;
+};
+typedef struct t_delta t_delta;
+
+/**
+ * @brief Create t_delta object.
+ *  
+ * @param[in] map_exch  pointer to t_map_exch structure (one direction of the map)
+ * @param[in] type_size size in bytes of the exchanged elements
+ * @param[in] send      flag to keep the last packed messages (send direction)
+ * 
+ * @return pointer to t_delta object or NULL if there are no messages
+ * 
+ * @ingroup delta
+ */
+t_delta * new_delta(t_map_exch *map_exch, size_t type_size, int send);
+
+/**
+ * @brief Free memory of t_delta object.
+ *  
+ * @param[inout] delta pointer to t_delta object
+ * 
+ * @ingroup delta
+ */
+void delete_delta(t_delta *delta);
+
+/**
+ * @brief Encode a message as difference to the last exchanged one.
+ * 
+ * @details The message on the wire contains nothing if no element changed,
+ *          the changed elements as (position, value) pairs or the full message,
+ *          whichever is smaller. The first exchange always sends the full message.
+ *  
+ * @param[inout] delta  pointer to t_delta object
+ * @param[in]    count  index of the message
+ * @param[in]    data   packed message
+ * @param[out]   nbytes size in bytes of the message on the wire
+ * 
+ * @return pointer to the message on the wire
+ * 
+ * @ingroup delta
+ */
+void * delta_encode(t_delta *delta, int count, const void *data, int *nbytes);
+
+/**
+ * @brief Mark the end of an exchange in the send direction.
+ * 
+ * @details After the first call, the following messages are encoded as differences.
+ *  
+ * @param[inout] delta pointer to t_delta object (it can be NULL)
+ * 
+ * @ingroup delta
+ */
+void delta_commit(t_delta *delta);
+
+/**
+ * @brief Return the staging buffer to receive a message.
+ *  
+ * @param[in]  delta  pointer to t_delta object
+ * @param[in]  count  index of the message
+ * @param[out] nbytes maximum size in bytes of the message on the wire
+ * 
+ * @return pointer to the receive location of the message
+ * 
+ * @ingroup delta
+ */
+void * delta_recv_buffer(t_delta *delta, int count, int *nbytes);
+
+/**
+ * @brief Apply a received message to the last received one.
+ *  
+ * @param[in]    delta pointer to t_delta object
+ * @param[in]    count index of the message
+ * @param[inout] data  last received message, updated with the new values
+ * 
+ * @ingroup delta
+ */
+void delta_decode(t_delta *delta, int count, void *data);
+
+#endif
@@ -37,18 +37,29 @@
 #include "src/core/exchange/exchange.h"
 #include "src/utils/check.h"
 #include "src/utils/timer.h"
+#include "src/utils/trace.h"
+#include "src/utils/memory.h"
 #include "src/setup/setting.h"
 #include "src/core/exchange/backend_hardware/backend_cpu.h"
 #ifdef CUDA
 #include "src/core/exchange/backend_hardware/backend_cuda.h"
 #endif
 #include "src/core/exchange/backend_communication/backend_mpi.h"
+#include "src/core/exchange/backend_communication/backend_threads.h"
+#include "src/core/algorithm/backend_communication/backend_comm.h"
+#include "src/core/exchange/compression/compression.h"
+#include "src/core/exchange/delta/delta.h"
+#include "src/core/exchange/buffer_pool/buffer_pool.h"
+#include "src/core/exchange/comm_stats/comm_stats.h"
+#include "src/core/exchange/progress/progress.h"
 #include <stdio.h>
 
 static int timer_new_exchanger_id = -1;
 static int timer_delete_exchanger_id = -1;
 static int timer_exchanger_go_id = -1;
 static int timer_exchanger_go_with_transform_id = -1;
+static int timer_exchanger_start_id = -1;
+static int timer_exchanger_wait_id = -1;
 static int timer_exchanger_IsendIrecv1_id = -1;
 static int timer_exchanger_IsendIrecv2_id = -1;
 static int timer_exchanger_IsendRecv1_id = -1;
@@ -56,9 +67,12 @@ static int timer_exchanger_IsendRecv2_id = -1;
 
 static void exchanger_waitall(t_mpi_exchange* mpi_exchange) {
 
-	if ((mpi_exchange->nreq_send + mpi_exchange->nreq_recv) > 0)
+	if ((mpi_exchange->nreq_send + mpi_exchange->nreq_recv) > 0) {
+		double begin = trace_begin(region_wait, "wait", -1, 0);
 		mpi_exchange->wait(mpi_exchange->nreq_send + mpi_exchange->nreq_recv,
 		                       mpi_exchange->req, mpi_exchange->stat);
+		trace_end(region_wait, "wait", -1, 0, begin);
+	}
 }
 
 static void exchanger_waitall_dummy(t_mpi_exchange* mpi_exchange) {
@@ -68,16 +82,252 @@ static void exchanger_waitall_dummy(t_mpi_exchange* mpi_exchange) {
 
 static void exchanger_waitall_send(t_mpi_exchange* mpi_exchange) {
 
-	if (mpi_exchange->nreq_send > 0)
+	if (mpi_exchange->nreq_send > 0) {
+		double begin = trace_begin(region_wait_send, "wait_send", -1, 0);
 		mpi_exchange->wait(mpi_exchange->nreq_send,
 		                       mpi_exchange->req, mpi_exchange->stat);
+		trace_end(region_wait_send, "wait_send", -1, 0, begin);
+	}
 }
 
 static void exchanger_waitall_recv(t_mpi_exchange *mpi_exchange) {
 
-	if (mpi_exchange->nreq_recv > 0)
+	if (mpi_exchange->nreq_recv > 0) {
+		double begin = trace_begin(region_wait_recv, "wait_recv", -1, 0);
 		mpi_exchange->wait(mpi_exchange->nreq_recv,
 		                       mpi_exchange->req, mpi_exchange->stat);
+		trace_end(region_wait_recv, "wait_recv", -1, 0, begin);
+	}
+}
+
+/* lend the buffers of the pool to the exchanger before the exchange */
+static void exchanger_lend_buffers(t_exchanger *exchanger) {
+
+	t_exchange *exchs[2] = {exchanger->exch_send, exchanger->exch_recv};
+
+	for (int i = 0; i < 2; i++) {
+		t_exchange *exch = exchs[i];
+		if (!exch->pooled) continue;
+		/* the messages of the previous exchange have to be completed */
+		if (exch->pending != NULL) {
+			exchanger->vtable_wait->pre_wait(exchanger->mpi_exchange);
+			buffer_pool_release(exch->pending);
+			exch->pending = NULL;
+		}
+		exch->block = buffer_pool_acquire(exch->buffer_size * exchanger->mpi_exchange->type_size,
+		                                  exchanger->vtable->allocator, exchanger->vtable->deallocator);
+		exch->buffer = exch->block->buffer;
+	}
+}
+
+/* return the buffers to the pool after the exchange, the send buffer
+ * is kept until the completion of the messages for NoWait exchangers */
+static void exchanger_return_buffers(t_exchanger *exchanger) {
+
+	t_exchange *exchs[2] = {exchanger->exch_send, exchanger->exch_recv};
+
+	for (int i = 0; i < 2; i++) {
+		t_exchange *exch = exchs[i];
+		if (!exch->pooled) continue;
+		if (exch == exchanger->exch_send &&
+		    exchanger->vtable_wait->pre_wait != exchanger_waitall_dummy) {
+			exch->pending = exch->block;
+			buffer_pool_retain(exch->pending);
+		}
+		buffer_pool_release(exch->block);
+		exch->block = NULL;
+		exch->buffer = NULL;
+	}
+}
+
+/* pack one message, the exchange with the same process is copied without conversion */
+static inline void exchanger_pack(t_exchange *exch, t_kernels *vtable, void *data,
+                                  int count, int peer, int size, int offset, int *transform) {
+
+	double begin = trace_begin(region_pack, "pack", peer, size * vtable->type_size);
+
+	if (count == exch->self)
+		vtable->pack_local(exch->self_buffer, data, exch->buffer_idxlist + offset,
+		                   size, 0, transform, vtable->local_type_size);
+	else
+		vtable->pack(exch->buffer, data, exch->buffer_idxlist,
+		             size, offset, transform, vtable->type_size);
+
+	trace_end(region_pack, "pack", peer, size * vtable->type_size, begin);
+}
+
+/* unpack one message, the exchange with the same process is copied without conversion */
+static inline void exchanger_unpack(t_exchange *exch, t_kernels *vtable, void *data,
+                                    int count, int peer, int size, int offset, int *transform) {
+
+	double begin = trace_begin(region_unpack, "unpack", peer, size * vtable->type_size);
+
+	if (count == exch->self)
+		vtable->unpack_local(exch->self_buffer, data, exch->buffer_idxlist + offset,
+		                     size, 0, transform, vtable->local_type_size);
+	else
+		vtable->unpack(exch->buffer, data, exch->buffer_idxlist,
+		               size, offset, transform, vtable->type_size);
+
+	trace_end(region_unpack, "unpack", peer, size * vtable->type_size, begin);
+}
+
+/* pack all messages, the buffer is split around the exchange with the same process */
+static void exchanger_pack_all(t_exchange *exch, t_map_exch *map_exch, t_kernels *vtable,
+                               void *data, int *transform) {
+
+	if (exch->self < 0) {
+		size_t nbytes = map_exch->buffer_size * vtable->type_size;
+		double begin = trace_begin(region_pack, "pack", -1, nbytes);
+		vtable->pack(exch->buffer, data, exch->buffer_idxlist,
+		             map_exch->buffer_size, 0, transform, vtable->type_size);
+		trace_end(region_pack, "pack", -1, nbytes, begin);
+		return;
+	}
+
+	int self_offset = map_exch->buffer_offset[exch->self];
+	int self_upper_bound = exch->self == map_exch->count-1 ?
+	                                     map_exch->buffer_size :
+	                                     map_exch->buffer_offset[exch->self + 1];
+
+	size_t nbytes = (map_exch->buffer_size - self_upper_bound + self_offset) * vtable->type_size;
+	double begin = trace_begin(region_pack, "pack", -1, nbytes);
+	vtable->pack(exch->buffer, data, exch->buffer_idxlist,
+	             self_offset, 0, transform, vtable->type_size);
+	vtable->pack(exch->buffer, data, exch->buffer_idxlist,
+	             map_exch->buffer_size - self_upper_bound, self_upper_bound,
+	             transform, vtable->type_size);
+	trace_end(region_pack, "pack", -1, nbytes, begin);
+	exchanger_pack(exch, vtable, data, exch->self, map_exch->exch[exch->self]->exch_rank,
+	               self_upper_bound - self_offset, self_offset, transform);
+}
+
+/* unpack all messages, the buffer is split around the exchange with the same process */
+static void exchanger_unpack_all(t_exchange *exch, t_map_exch *map_exch, t_kernels *vtable,
+                                 void *data, int *transform) {
+
+	if (exch->self < 0) {
+		size_t nbytes = map_exch->buffer_size * vtable->type_size;
+		double begin = trace_begin(region_unpack, "unpack", -1, nbytes);
+		vtable->unpack(exch->buffer, data, exch->buffer_idxlist,
+		               map_exch->buffer_size, 0, transform, vtable->type_size);
+		trace_end(region_unpack, "unpack", -1, nbytes, begin);
+		return;
+	}
+
+	int self_offset = map_exch->buffer_offset[exch->self];
+	int self_upper_bound = exch->self == map_exch->count-1 ?
+	                                     map_exch->buffer_size :
+	                                     map_exch->buffer_offset[exch->self + 1];
+
+	size_t nbytes = (map_exch->buffer_size - self_upper_bound + self_offset) * vtable->type_size;
+	double begin = trace_begin(region_unpack, "unpack", -1, nbytes);
+	vtable->unpack(exch->buffer, data, exch->buffer_idxlist,
+	               self_offset, 0, transform, vtable->type_size);
+	vtable->unpack(exch->buffer, data, exch->buffer_idxlist,
+	               map_exch->buffer_size - self_upper_bound, self_upper_bound,
+	               transform, vtable->type_size);
+	trace_end(region_unpack, "unpack", -1, nbytes, begin);
+	exchanger_unpack(exch, vtable, data, exch->self, map_exch->exch[exch->self]->exch_rank,
+	                 self_upper_bound - self_offset, self_offset, transform);
+}
+
+/* send one message, the messages go through the delta stage
+ * or large messages go through the compression stage */
+static inline void exchanger_isend(t_exchange *exch, t_mpi_exchange *mpi_exchange,
+                                   int count, int size, int offset,
+                                   int dest, int tag, MPI_Comm comm, MPI_Request *request) {
+
+	int nbytes = size * mpi_exchange->type_size;
+	double begin = trace_begin(region_post_send, "post_send", dest, nbytes);
+
+	if (exch->delta != NULL) {
+		void *message = delta_encode(exch->delta, count,
+		                             (char *)exch->buffer + offset * mpi_exchange->type_size,
+		                             &nbytes);
+		mpi_exchange->isend(message, nbytes, MPI_BYTE, dest, tag, comm, request, 0);
+	} else if (compression_is_active(exch->compression, count)) {
+		void *message = compression_compress(exch->compression, count,
+		                                     (char *)exch->buffer + offset * mpi_exchange->type_size,
+		                                     &nbytes);
+		mpi_exchange->isend(message, nbytes, MPI_BYTE, dest, tag, comm, request, 0);
+	} else {
+		mpi_exchange->isend(exch->buffer, size, mpi_exchange->type, dest, tag, comm, request,
+		                    offset * mpi_exchange->type_size);
+	}
+
+	trace_end(region_post_send, "post_send", dest, nbytes, begin);
+}
+
+/* receive one message, the messages are received in the delta or compression stage
+ * and decoded after the wait */
+static inline void exchanger_irecv(t_exchange *exch, t_mpi_exchange *mpi_exchange,
+                                   int count, int size, int offset,
+                                   int source, int tag, MPI_Comm comm, MPI_Request *request) {
+
+	int nbytes = size * mpi_exchange->type_size;
+	double begin = trace_begin(region_post_recv, "post_recv", source, nbytes);
+
+	if (exch->delta != NULL) {
+		void *message = delta_recv_buffer(exch->delta, count, &nbytes);
+		mpi_exchange->irecv(message, nbytes, MPI_BYTE, source, tag, comm, request, 0);
+	} else if (compression_is_active(exch->compression, count)) {
+		void *message = compression_recv_buffer(exch->compression, count, &nbytes);
+		mpi_exchange->irecv(message, nbytes, MPI_BYTE, source, tag, comm, request, 0);
+	} else {
+		mpi_exchange->irecv(exch->buffer, size, mpi_exchange->type, source, tag, comm, request,
+		                    offset * mpi_exchange->type_size);
+	}
+
+	trace_end(region_post_recv, "post_recv", source, nbytes, begin);
+}
+
+/* blocking receive of one message, delta and large messages are decoded */
+static inline void exchanger_recv(t_exchange *exch, t_mpi_exchange *mpi_exchange,
+                                  int count, int size, int offset,
+                                  int source, int tag, MPI_Comm comm, MPI_Status *status) {
+
+	int nbytes = size * mpi_exchange->type_size;
+	double begin = trace_begin(region_recv, "recv", source, nbytes);
+
+	if (exch->delta != NULL) {
+		void *message = delta_recv_buffer(exch->delta, count, &nbytes);
+		mpi_exchange->recv(message, nbytes, MPI_BYTE, source, tag, comm, status, 0);
+		delta_decode(exch->delta, count,
+		             (char *)exch->buffer + offset * mpi_exchange->type_size);
+	} else if (compression_is_active(exch->compression, count)) {
+		void *message = compression_recv_buffer(exch->compression, count, &nbytes);
+		mpi_exchange->recv(message, nbytes, MPI_BYTE, source, tag, comm, status, 0);
+		compression_decompress(exch->compression, count,
+		                       (char *)exch->buffer + offset * mpi_exchange->type_size);
+	} else {
+		mpi_exchange->recv(exch->buffer, size, mpi_exchange->type, source, tag, comm, status,
+		                   offset * mpi_exchange->type_size);
+	}
+
+	trace_end(region_recv, "recv", source, nbytes, begin);
+}
+
+/* decode one received message (delta or compression stage) */
+static inline void exchanger_decode(t_exchange *exch, t_map_exch *map_exch,
+                                    t_mpi_exchange *mpi_exchange, int count) {
+
+	void *data = (char *)exch->buffer + map_exch->buffer_offset[count] * mpi_exchange->type_size;
+	if (exch->delta != NULL)
+		delta_decode(exch->delta, count, data);
+	else if (compression_is_active(exch->compression, count))
+		compression_decompress(exch->compression, count, data);
+}
+
+/* decode all received messages (delta or compression stage) */
+static void exchanger_decode_all(t_exchange *exch, t_map_exch *map_exch,
+                                 t_mpi_exchange *mpi_exchange) {
+
+	if (exch->delta == NULL && exch->compression == NULL) return;
+
+	for (int count = 0; count < map_exch->count; count++)
+		if (count != exch->self)
+			exchanger_decode(exch, map_exch, mpi_exchange, count);
 }
 
 static void exchanger_IsendIrecv1(t_exchange *exch_send, t_exchange *exch_recv,
@@ -87,14 +337,16 @@ static void exchanger_IsendIrecv1(t_exchange *exch_send, t_exchange *exch_recv,
                                  int *transform_src, int *transform_dst) {
 
 	if (timer_exchanger_IsendIrecv1_id == -1)
-		timer_exchanger_IsendIrecv1_id = new_timer(__func__);
+		timer_exchanger_IsendIrecv1_id = new_timer_region(__func__, region_exchanger_IsendIrecv1);
 
 	timer_start(timer_exchanger_IsendIrecv1_id);
 
+	const t_comm_backend *backend = get_comm_backend();
+
 	int world_size;
-	check_mpi( MPI_Comm_size(map->comm, &world_size) );
+	backend->comm_size(map->comm, &world_size);
 	int world_rank;
-	check_mpi( MPI_Comm_rank(map->comm, &world_rank) );
+	backend->comm_rank(map->comm, &world_rank);
 
 	vtable_wait->pre_wait(mpi_exchange);
 
@@ -113,21 +365,17 @@ static void exchanger_IsendIrecv1(t_exchange *exch_send, t_exchange *exch_recv,
 
 		int size = upper_bound - map->exch_send->buffer_offset[count];
 
-		vtable->pack(exch_send->buffer,
-		             src_data,
-		             exch_send->buffer_idxlist,
-		             size,
-		             offset,
-		             transform_src);
+		exchanger_pack(exch_send, vtable, src_data, count, map->exch_send->exch[count]->exch_rank,
+		               size, offset, transform_src);
+
+		/* the exchange with the same process does not use MPI */
+		if (count == exch_send->self) continue;
 
 		/* send the buffer */
-		mpi_exchange->isend(exch_send->buffer,
-		                    size,
-		                    mpi_exchange->type,
-		                    map->exch_send->exch[count]->exch_rank,
-		                    world_rank + world_size * (map->exch_send->exch[count]->exch_rank + 1),
-		                    map->comm, mpi_exchange->req + nreq,
-		                    offset);
+		exchanger_isend(exch_send, mpi_exchange, count, size, offset,
+		                map->exch_send->exch[count]->exch_rank,
+		                world_rank + world_size * (map->exch_send->exch[count]->exch_rank + 1),
+		                map->comm, mpi_exchange->req + nreq);
 		mpi_exchange->nreq_send++;
 		nreq++;
 	}
@@ -143,13 +391,13 @@ static void exchanger_IsendIrecv1(t_exchange *exch_send, t_exchange *exch_recv,
 
 		int size = upper_bound - map->exch_recv->buffer_offset[count];
 
-		mpi_exchange->irecv(exch_recv->buffer,
-		                    size,
-		                    mpi_exchange->type,
-		                    map->exch_recv->exch[count]->exch_rank,
-		                    map->exch_recv->exch[count]->exch_rank + world_size * (world_rank + 1),
-		                    map->comm, mpi_exchange->req + nreq,
-		                    offset);
+		/* the exchange with the same process does not use MPI */
+		if (count == exch_recv->self) continue;
+
+		exchanger_irecv(exch_recv, mpi_exchange, count, size, offset,
+		                map->exch_recv->exch[count]->exch_rank,
+		                map->exch_recv->exch[count]->exch_rank + world_size * (world_rank + 1),
+		                map->comm, mpi_exchange->req + nreq);
 		mpi_exchange->nreq_recv++;
 		nreq++;
 	}
@@ -157,13 +405,10 @@ static void exchanger_IsendIrecv1(t_exchange *exch_send, t_exchange *exch_recv,
 	/* wait for all messages */
 	vtable_wait->post_wait(mpi_exchange);
 
+	exchanger_decode_all(exch_recv, map->exch_recv, mpi_exchange);
+
 	/* unpack all recv buffers */
-	vtable->unpack(exch_recv->buffer,
-	               dst_data,
-	               exch_recv->buffer_idxlist,
-	               map->exch_recv->buffer_size,
-	               0,
-	               transform_dst);
+	exchanger_unpack_all(exch_recv, map->exch_recv, vtable, dst_data, transform_dst);
 
 	timer_stop(timer_exchanger_IsendIrecv1_id);
 }
@@ -175,14 +420,16 @@ static void exchanger_IsendIrecv2(t_exchange *exch_send, t_exchange *exch_recv,
                                  int *transform_src, int *transform_dst) {
 
 	if (timer_exchanger_IsendIrecv2_id == -1)
-		timer_exchanger_IsendIrecv2_id = new_timer(__func__);
+		timer_exchanger_IsendIrecv2_id = new_timer_region(__func__, region_exchanger_IsendIrecv2);
 
 	timer_start(timer_exchanger_IsendIrecv2_id);
 
+	const t_comm_backend *backend = get_comm_backend();
+
 	int world_size;
-	check_mpi( MPI_Comm_size(map->comm, &world_size) );
+	backend->comm_size(map->comm, &world_size);
 	int world_rank;
-	check_mpi( MPI_Comm_rank(map->comm, &world_rank) );
+	backend->comm_rank(map->comm, &world_rank);
 
 	vtable_wait->pre_wait(mpi_exchange);
 
@@ -190,12 +437,7 @@ static void exchanger_IsendIrecv2(t_exchange *exch_send, t_exchange *exch_recv,
 	mpi_exchange->nreq_recv = 0;
 	int nreq = 0;
 
-	vtable->pack(exch_send->buffer,
-		         src_data,
-		         exch_send->buffer_idxlist,
-		         map->exch_send->buffer_size,
-		         0,
-	             transform_src);
+	exchanger_pack_all(exch_send, map->exch_send, vtable, src_data, transform_src);
 
 	for (int count = 0; count < map->exch_send->count; count++) {
 
@@ -208,14 +450,14 @@ static void exchanger_IsendIrecv2(t_exchange *exch_send, t_exchange *exch_recv,
 
 		int size = upper_bound - map->exch_send->buffer_offset[count];
 
+		/* the exchange with the same process does not use MPI */
+		if (count == exch_send->self) continue;
+
 		/* send the buffer */
-		mpi_exchange->isend(exch_send->buffer,
-		                    size,
-		                    mpi_exchange->type,
-		                    map->exch_send->exch[count]->exch_rank,
-		                    world_rank + world_size * (map->exch_send->exch[count]->exch_rank + 1),
-		                    map->comm, mpi_exchange->req + nreq,
-		                    offset);
+		exchanger_isend(exch_send, mpi_exchange, count, size, offset,
+		                map->exch_send->exch[count]->exch_rank,
+		                world_rank + world_size * (map->exch_send->exch[count]->exch_rank + 1),
+		                map->comm, mpi_exchange->req + nreq);
 		mpi_exchange->nreq_send++;
 		nreq++;
 	}
@@ -231,13 +473,13 @@ static void exchanger_IsendIrecv2(t_exchange *exch_send, t_exchange *exch_recv,
 
 		int size = upper_bound - map->exch_recv->buffer_offset[count];
 
-		mpi_exchange->irecv(exch_recv->buffer,
-		                    size,
-		                    mpi_exchange->type,
-		                    map->exch_recv->exch[count]->exch_rank,
-		                    map->exch_recv->exch[count]->exch_rank + world_size * (world_rank + 1),
-		                    map->comm, mpi_exchange->req + nreq,
-		                    offset);
+		/* the exchange with the same process does not use MPI */
+		if (count == exch_recv->self) continue;
+
+		exchanger_irecv(exch_recv, mpi_exchange, count, size, offset,
+		                map->exch_recv->exch[count]->exch_rank,
+		                map->exch_recv->exch[count]->exch_rank + world_size * (world_rank + 1),
+		                map->comm, mpi_exchange->req + nreq);
 		mpi_exchange->nreq_recv++;
 		nreq++;
 	}
@@ -245,13 +487,10 @@ static void exchanger_IsendIrecv2(t_exchange *exch_send, t_exchange *exch_recv,
 	/* wait for all messages */
 	vtable_wait->post_wait(mpi_exchange);
 
+	exchanger_decode_all(exch_recv, map->exch_recv, mpi_exchange);
+
 	/* unpack all recv buffers */
-	vtable->unpack(exch_recv->buffer,
-	               dst_data,
-	               exch_recv->buffer_idxlist,
-	               map->exch_recv->buffer_size,
-	               0,
-	               transform_dst);
+	exchanger_unpack_all(exch_recv, map->exch_recv, vtable, dst_data, transform_dst);
 
 	timer_stop(timer_exchanger_IsendIrecv2_id);
 }
@@ -263,14 +502,16 @@ static void exchanger_IsendRecv1(t_exchange *exch_send, t_exchange *exch_recv,
                                  int *transform_src, int *transform_dst) {
 
 	if (timer_exchanger_IsendRecv1_id == -1)
-		timer_exchanger_IsendRecv1_id = new_timer(__func__);
+		timer_exchanger_IsendRecv1_id = new_timer_region(__func__, region_exchanger_IsendRecv1);
 
 	timer_start(timer_exchanger_IsendRecv1_id);
 
+	const t_comm_backend *backend = get_comm_backend();
+
 	int world_size;
-	check_mpi( MPI_Comm_size(map->comm, &world_size) );
+	backend->comm_size(map->comm, &world_size);
 	int world_rank;
-	check_mpi( MPI_Comm_rank(map->comm, &world_rank) );
+	backend->comm_rank(map->comm, &world_rank);
 
 	vtable_wait->pre_wait(mpi_exchange);
 
@@ -287,25 +528,20 @@ static void exchanger_IsendRecv1(t_exchange *exch_send, t_exchange *exch_recv,
 
 		int size = upper_bound - map->exch_send->buffer_offset[count];
 
-		vtable->pack(exch_send->buffer,
-		             src_data,
-		             exch_send->buffer_idxlist,
-		             size, offset, transform_src);
+		exchanger_pack(exch_send, vtable, src_data, count, map->exch_send->exch[count]->exch_rank,
+		               size, offset, transform_src);
+
+		/* the exchange with the same process does not use MPI */
+		if (count == exch_send->self) continue;
 
 		/* send the buffer */
-		mpi_exchange->isend(exch_send->buffer,
-		                    size,
-		                    mpi_exchange->type,
-		                    map->exch_send->exch[count]->exch_rank,
-		                    world_rank + world_size * (map->exch_send->exch[count]->exch_rank + 1),
-		                    map->comm, mpi_exchange->req + mpi_exchange->nreq_send,
-		                    offset);
+		exchanger_isend(exch_send, mpi_exchange, count, size, offset,
+		                map->exch_send->exch[count]->exch_rank,
+		                world_rank + world_size * (map->exch_send->exch[count]->exch_rank + 1),
+		                map->comm, mpi_exchange->req + mpi_exchange->nreq_send);
 		mpi_exchange->nreq_send++;
 	}
 
-	/* wait for all messages */
-	vtable_wait->post_wait(mpi_exchange);
-
 	// recv step
 	for (int count = 0; count < map->exch_recv->count; count++) {
 
@@ -317,21 +553,21 @@ static void exchanger_IsendRecv1(t_exchange *exch_send, t_exchange *exch_recv,
 
 		int size = upper_bound - map->exch_recv->buffer_offset[count];
 
-		mpi_exchange->recv(exch_recv->buffer,
-		                   size,
-		                   mpi_exchange->type,
-		                   map->exch_recv->exch[count]->exch_rank,
-		                   map->exch_recv->exch[count]->exch_rank + world_size * (world_rank + 1),
-		                   map->comm, mpi_exchange->stat,
-		                   offset);
+		/* the exchange with the same process does not use MPI */
+		if (count == exch_recv->self) continue;
+
+		exchanger_recv(exch_recv, mpi_exchange, count, size, offset,
+		               map->exch_recv->exch[count]->exch_rank,
+		               map->exch_recv->exch[count]->exch_rank + world_size * (world_rank + 1),
+		               map->comm, mpi_exchange->stat);
 	}
 
+	/* the sends are completed after the receives, otherwise the processes
+	 * sending to each other could wait forever for a message that is not eager */
+	vtable_wait->post_wait(mpi_exchange);
+
 	/* unpack all recv buffers */
-	vtable->unpack(exch_recv->buffer,
-	               dst_data,
-	               exch_recv->buffer_idxlist,
-	               map->exch_recv->buffer_size,
-	               0, transform_dst);
+	exchanger_unpack_all(exch_recv, map->exch_recv, vtable, dst_data, transform_dst);
 
 	timer_stop(timer_exchanger_IsendRecv1_id);
 }
@@ -343,14 +579,16 @@ static void exchanger_IsendRecv2(t_exchange *exch_send, t_exchange *exch_recv,
                                  int *transform_src, int *transform_dst) {
 
 	if (timer_exchanger_IsendRecv2_id == -1)
-		timer_exchanger_IsendRecv2_id = new_timer(__func__);
+		timer_exchanger_IsendRecv2_id = new_timer_region(__func__, region_exchanger_IsendRecv2);
 
 	timer_start(timer_exchanger_IsendRecv2_id);
 
+	const t_comm_backend *backend = get_comm_backend();
+
 	int world_size;
-	check_mpi( MPI_Comm_size(map->comm, &world_size) );
+	backend->comm_size(map->comm, &world_size);
 	int world_rank;
-	check_mpi( MPI_Comm_rank(map->comm, &world_rank) );
+	backend->comm_rank(map->comm, &world_rank);
 
 	vtable_wait->pre_wait(mpi_exchange);
 
@@ -367,25 +605,20 @@ static void exchanger_IsendRecv2(t_exchange *exch_send, t_exchange *exch_recv,
 
 		int size = upper_bound - map->exch_send->buffer_offset[count];
 
-		vtable->pack(exch_send->buffer,
-		             src_data,
-		             exch_send->buffer_idxlist,
-		             size, offset, transform_src);
+		exchanger_pack(exch_send, vtable, src_data, count, map->exch_send->exch[count]->exch_rank,
+		               size, offset, transform_src);
+
+		/* the exchange with the same process does not use MPI */
+		if (count == exch_send->self) continue;
 
 		/* send the buffer */
-		mpi_exchange->isend(exch_send->buffer,
-		                    size,
-		                    mpi_exchange->type,
-		                    map->exch_send->exch[count]->exch_rank,
-		                    world_rank + world_size * (map->exch_send->exch[count]->exch_rank + 1),
-		                    map->comm, mpi_exchange->req + mpi_exchange->nreq_send,
-		                    offset);
+		exchanger_isend(exch_send, mpi_exchange, count, size, offset,
+		                map->exch_send->exch[count]->exch_rank,
+		                world_rank + world_size * (map->exch_send->exch[count]->exch_rank + 1),
+		                map->comm, mpi_exchange->req + mpi_exchange->nreq_send);
 		mpi_exchange->nreq_send++;
 	}
 
-	/* wait for all messages */
-	vtable_wait->post_wait(mpi_exchange);
-
 	// recv and unpack step
 	for (int count = 0; count < map->exch_recv->count; count++) {
 
@@ -397,92 +630,43 @@ static void exchanger_IsendRecv2(t_exchange *exch_send, t_exchange *exch_recv,
 
 		int size = upper_bound - map->exch_recv->buffer_offset[count];
 
-		mpi_exchange->recv(exch_recv->buffer,
-		                   size,
-		                   mpi_exchange->type,
-		                   map->exch_recv->exch[count]->exch_rank,
-		                   map->exch_recv->exch[count]->exch_rank + world_size * (world_rank + 1),
-		                   map->comm, mpi_exchange->stat,
-		                   offset);
+		/* the exchange with the same process does not use MPI */
+		if (count != exch_recv->self)
+			exchanger_recv(exch_recv, mpi_exchange, count, size, offset,
+			               map->exch_recv->exch[count]->exch_rank,
+			               map->exch_recv->exch[count]->exch_rank + world_size * (world_rank + 1),
+			               map->comm, mpi_exchange->stat);
 
-		vtable->unpack(exch_recv->buffer,
-		               dst_data,
-		               exch_recv->buffer_idxlist,
-		               size, offset, transform_dst);
+		exchanger_unpack(exch_recv, vtable, dst_data, count, map->exch_recv->exch[count]->exch_rank,
+		                 size, offset, transform_dst);
 	}
 
+	/* the sends are completed after the receives (see exchanger_IsendRecv1) */
+	vtable_wait->post_wait(mpi_exchange);
+
 	timer_stop(timer_exchanger_IsendRecv2_id);
 }
 
-t_exchanger* new_exchanger(t_map        *map  ,
-                           MPI_Datatype  type ,
-                           distdir_hardware hw) {
-
-#ifdef ERROR_CHECK
-	assert(type == MPI_INT     || type == MPI_REAL  || type == MPI_DOUBLE          ||
-	       type == MPI_INTEGER || type == MPI_FLOAT || type == MPI_DOUBLE_PRECISION);
-	assert(hw == CPU           || hw == GPU_NVIDIA  || hw == GPU_AMD               );
-#endif
-
-	if (timer_new_exchanger_id == -1)
-		timer_new_exchanger_id = new_timer(__func__);
-
-	timer_start(timer_new_exchanger_id);
-
-	// group all info into data structure
-	t_exchanger *exchanger;
-
-	exchanger = (t_exchanger *)malloc(sizeof(t_exchanger));
-	exchanger->exch_send = (t_exchange *)malloc(sizeof(t_exchange));
-	exchanger->exch_recv = (t_exchange *)malloc(sizeof(t_exchange));
-
-	exchanger->exch_send->count = map->exch_send->count;
-	exchanger->exch_send->buffer_size = map->exch_send->buffer_size;
+/* set the exchange and wait functions of an exchanger type */
+static void exchanger_set_mode(t_exchanger *exchanger, int mode) {
 
-	exchanger->exch_recv->count = map->exch_recv->count;
-	exchanger->exch_recv->buffer_size = map->exch_recv->buffer_size;
-
-	exchanger->vtable_wait = (t_wait*)malloc(sizeof(t_wait));
-
-	switch (hw) {
-		case CPU:
-			exchanger->vtable = new_vtable_cpu(type);
-			exchanger->exch_send->buffer_idxlist = map->exch_send->buffer_idxlist;
-			exchanger->exch_recv->buffer_idxlist = map->exch_recv->buffer_idxlist;
-			break;
-#ifdef CUDA
-		case GPU_NVIDIA:
-			exchanger->vtable = new_vtable_cuda(type);
-			exchanger->exch_send->buffer_idxlist = map->exch_send->buffer_idxlist_gpu;
-			exchanger->exch_recv->buffer_idxlist = map->exch_recv->buffer_idxlist_gpu;
-			break;
-#endif
-	}
-
-	exchanger->map = map;
-	int mpi_size;
-	int exchanger_type = get_config_exchanger();
-	switch (exchanger_type) {
+	switch (mode) {
 		case IsendIrecv1:
-			mpi_size = exchanger->map->exch_send->count + exchanger->map->exch_recv->count;
 			exchanger->go = exchanger_IsendIrecv1;
 			exchanger->vtable_wait->pre_wait = exchanger_waitall_dummy;
 			exchanger->vtable_wait->post_wait = exchanger_waitall;
 			break;
 		case IsendIrecv2:
-			mpi_size = exchanger->map->exch_send->count + exchanger->map->exch_recv->count;
 			exchanger->go = exchanger_IsendIrecv2;
 			exchanger->vtable_wait->pre_wait = exchanger_waitall_dummy;
 			exchanger->vtable_wait->post_wait = exchanger_waitall;
 			break;
 		case IsendRecv1:
-			mpi_size = exchanger->map->exch_send->count;
 			exchanger->go = exchanger_IsendRecv1;
 			exchanger->vtable_wait->pre_wait = exchanger_waitall_dummy;
 			exchanger->vtable_wait->post_wait = exchanger_waitall;
 			break;
 		case IsendRecv2:
-			mpi_size = exchanger->map->exch_send->count;
 			exchanger->go = exchanger_IsendRecv2;
 			exchanger->vtable_wait->pre_wait = exchanger_waitall_dummy;
 			exchanger->vtable_wait->post_wait = exchanger_waitall;
@@ -492,7 +676,6 @@ t_exchanger* new_exchanger(t_map        *map  ,
 #ifdef ERROR_CHECK
 			assert(exchanger->map->exch_send->count == 0 || exchanger->map->exch_recv->count == 0);
 #endif
-			mpi_size = exchanger->map->exch_send->count + exchanger->map->exch_recv->count;
 			exchanger->go = exchanger_IsendIrecv1;
 			exchanger->vtable_wait->pre_wait = exchanger_waitall_send;
 			exchanger->vtable_wait->post_wait = exchanger_waitall_recv;
@@ -502,7 +685,6 @@ t_exchanger* new_exchanger(t_map        *map  ,
 #ifdef ERROR_CHECK
 			assert(exchanger->map->exch_send->count == 0 || exchanger->map->exch_recv->count == 0);
 #endif
-			mpi_size = exchanger->map->exch_send->count + exchanger->map->exch_recv->count;
 			exchanger->go = exchanger_IsendIrecv2;
 			exchanger->vtable_wait->pre_wait = exchanger_waitall_send;
 			exchanger->vtable_wait->post_wait = exchanger_waitall_recv;
@@ -512,7 +694,6 @@ t_exchanger* new_exchanger(t_map        *map  ,
 #ifdef ERROR_CHECK
 			assert(exchanger->map->exch_send->count == 0 || exchanger->map->exch_recv->count == 0);
 #endif
-			mpi_size = exchanger->map->exch_send->count;
 			exchanger->go = exchanger_IsendRecv1;
 			exchanger->vtable_wait->pre_wait = exchanger_waitall_send;
 			exchanger->vtable_wait->post_wait = exchanger_waitall_recv;
@@ -522,20 +703,185 @@ t_exchanger* new_exchanger(t_map        *map  ,
 #ifdef ERROR_CHECK
 			assert(exchanger->map->exch_send->count == 0 || exchanger->map->exch_recv->count == 0);
 #endif
-			mpi_size = exchanger->map->exch_send->count;
 			exchanger->go = exchanger_IsendRecv2;
 			exchanger->vtable_wait->pre_wait = exchanger_waitall_send;
 			exchanger->vtable_wait->post_wait = exchanger_waitall_recv;
 			break;
 	}
-	exchanger->mpi_exchange = new_mpi_exchanger(type, mpi_size);
+}
+
+t_exchanger* new_exchanger(t_map        *map  ,
+                           MPI_Datatype  type ,
+                           distdir_hardware hw) {
+
+	return new_exchanger_with_block_size(map, type, 1, hw);
+}
+
+t_exchanger* new_exchanger_with_block_size(t_map        *map       ,
+                                           MPI_Datatype  type      ,
+                                           int           block_size,
+                                           distdir_hardware hw     ) {
+
+#ifdef ERROR_CHECK
+	assert(type != MPI_DATATYPE_NULL);
+	assert(block_size > 0);
+	assert(hw == CPU           || hw == GPU_NVIDIA  || hw == GPU_AMD               );
+#endif
+
+	if (timer_new_exchanger_id == -1)
+		timer_new_exchanger_id = new_timer_region(__func__, region_new_exchanger);
+
+	timer_start(timer_new_exchanger_id);
+
+	// group all info into data structure
+	t_exchanger *exchanger;
+
+	exchanger = (t_exchanger *)memory_malloc(sizeof(t_exchanger), memory_exchange);
+	exchanger->exch_send = (t_exchange *)memory_malloc(sizeof(t_exchange), memory_exchange);
+	exchanger->exch_recv = (t_exchange *)memory_malloc(sizeof(t_exchange), memory_exchange);
+
+	exchanger->exch_send->count = map->exch_send->count;
+	exchanger->exch_send->buffer_size = map->exch_send->buffer_size;
+
+	exchanger->exch_recv->count = map->exch_recv->count;
+	exchanger->exch_recv->buffer_size = map->exch_recv->buffer_size;
+
+	exchanger->vtable_wait = (t_wait*)memory_malloc(sizeof(t_wait), memory_exchange);
+
+	exchanger->request = NULL;
+
+	exchanger->map = map;
+	exchanger->block_size = block_size;
+	int mpi_size;
+	int exchanger_type = get_config_exchanger();
+	switch (exchanger_type) {
+		case IsendRecv1:
+		case IsendRecv2:
+		case IsendRecv1NoWait:
+		case IsendRecv2NoWait:
+			mpi_size = exchanger->map->exch_send->count;
+			break;
+		default:
+			/* the Auto exchanger can use all the exchanger types */
+			mpi_size = exchanger->map->exch_send->count + exchanger->map->exch_recv->count;
+			break;
+	}
+	/* double fields (C or Fortran handle) can be sent with reduced precision */
+	int is_double = type == MPI_DOUBLE || type == MPI_DOUBLE_PRECISION;
+	int precision = is_double && hw == CPU ? get_config_precision() : precision_full;
+	switch (precision) {
+		case precision_float:
+			exchanger->mpi_exchange = new_mpi_exchanger(MPI_FLOAT, block_size, mpi_size);
+			break;
+		case precision_bfloat16:
+			exchanger->mpi_exchange = new_mpi_exchanger(MPI_UINT16_T, block_size, mpi_size);
+			break;
+		default:
+			exchanger->mpi_exchange = new_mpi_exchanger(type, block_size, mpi_size);
+			break;
+	}
+
+	/* the volume of one exchange is computed once */
+	exchanger->pattern = new_comm_pattern(map, exchanger->mpi_exchange->type_size);
+
+	/* the Auto exchanger starts with the first candidate type */
+	exchanger->autotune = NULL;
+	if (exchanger_type == Auto) {
+		exchanger->autotune = new_autotune(map, exchanger->mpi_exchange->type_size);
+		exchanger_type = autotune_mode(exchanger->autotune);
+	}
+	exchanger_set_mode(exchanger, exchanger_type);
+
+	/* pack and unpack kernels are selected based on the size of a block
+	 * (datatype extent times block size) */
+	switch (hw) {
+		case CPU:
+			if (precision == precision_full)
+				exchanger->vtable = new_vtable_cpu(exchanger->mpi_exchange->type_size);
+			else
+				exchanger->vtable = new_vtable_cpu_reduced_precision(block_size, precision);
+			if (get_config_allocator() != allocator_malloc)
+				exchanger->vtable->allocator = allocator_cpu_policy;
+			exchanger->exch_send->buffer_idxlist = map->exch_send->buffer_idxlist;
+			exchanger->exch_recv->buffer_idxlist = map->exch_recv->buffer_idxlist;
+			break;
+#ifdef CUDA
+		case GPU_NVIDIA:
+			exchanger->vtable = new_vtable_cuda(exchanger->mpi_exchange->type_size);
+			exchanger->exch_send->buffer_idxlist = map->exch_send->buffer_idxlist_gpu;
+			exchanger->exch_recv->buffer_idxlist = map->exch_recv->buffer_idxlist_gpu;
+			break;
+#endif
+	}
+
+	/* with reduced precision the exchange with the same process is a local copy
+	 * in full precision, so it does not go through the conversion */
+	exchanger->exch_send->self = -1;
+	exchanger->exch_recv->self = -1;
+	exchanger->exch_send->self_buffer = NULL;
+	exchanger->exch_recv->self_buffer = NULL;
+	if (precision != precision_full) {
+		int world_rank;
+		get_comm_backend()->comm_rank(map->comm, &world_rank);
+		for (int count = 0; count < map->exch_send->count; count++)
+			if (map->exch_send->exch[count]->exch_rank == world_rank)
+				exchanger->exch_send->self = count;
+		for (int count = 0; count < map->exch_recv->count; count++)
+			if (map->exch_recv->exch[count]->exch_rank == world_rank)
+				exchanger->exch_recv->self = count;
+	}
+	if (exchanger->exch_send->self >= 0 && exchanger->exch_recv->self >= 0) {
+		int count = exchanger->exch_send->self;
+		int upper_bound = count == map->exch_send->count-1 ?
+		                           map->exch_send->buffer_size :
+		                           map->exch_send->buffer_offset[count + 1];
+		int size = upper_bound - map->exch_send->buffer_offset[count];
+		void *self_buffer = exchanger->vtable->allocator(size * exchanger->vtable->local_type_size);
+		exchanger->exch_send->self_buffer = self_buffer;
+		exchanger->exch_recv->self_buffer = self_buffer;
+	} else {
+		exchanger->exch_send->self = -1;
+		exchanger->exch_recv->self = -1;
+	}
+
+	/* delta stage of the messages (CPU only) */
+	exchanger->exch_send->delta = NULL;
+	exchanger->exch_recv->delta = NULL;
+	if (get_config_delta() == delta_on && hw == CPU) {
+		exchanger->exch_send->delta = new_delta(map->exch_send, exchanger->mpi_exchange->type_size, 1);
+		exchanger->exch_recv->delta = new_delta(map->exch_recv, exchanger->mpi_exchange->type_size, 0);
+	}
+
+	/* compression stage of large messages (CPU only, replaced by the delta stage) */
+	exchanger->exch_send->compression = NULL;
+	exchanger->exch_recv->compression = NULL;
+	if (get_config_compression() == compression_on && get_config_delta() == delta_off && hw == CPU) {
+		exchanger->exch_send->compression = new_compression(map->exch_send, exchanger->mpi_exchange->type_size);
+		exchanger->exch_recv->compression = new_compression(map->exch_recv, exchanger->mpi_exchange->type_size);
+	}
+
+	/* the buffers are lent by the pool during the exchange, the receive
+	 * buffer of the delta exchange keeps the last messages, the pool
+	 * is not shared by the thread ranks */
+	int pool = get_config_buffer_pool() == buffer_pool_on && !thread_ranks_active();
+	exchanger->exch_send->pooled = pool &&
+	                               exchanger->exch_send->buffer_size > 0;
+	exchanger->exch_recv->pooled = pool &&
+	                               exchanger->exch_recv->buffer_size > 0 &&
+	                               exchanger->exch_recv->delta == NULL;
+	exchanger->exch_send->block = NULL;
+	exchanger->exch_recv->block = NULL;
+	exchanger->exch_send->pending = NULL;
+	exchanger->exch_recv->pending = NULL;
+	exchanger->exch_send->buffer = NULL;
+	exchanger->exch_recv->buffer = NULL;
 
 	/* allocate the buffer */
-	if (exchanger->exch_send->buffer_size > 0)
+	if (exchanger->exch_send->buffer_size > 0 && !exchanger->exch_send->pooled)
 		exchanger->exch_send->buffer = exchanger->vtable->allocator(exchanger->exch_send->buffer_size *
 		                                                            exchanger->mpi_exchange->type_size);
 
-	if (exchanger->exch_recv->buffer_size > 0)
+	if (exchanger->exch_recv->buffer_size > 0 && !exchanger->exch_recv->pooled)
 		exchanger->exch_recv->buffer = exchanger->vtable->allocator(exchanger->exch_recv->buffer_size *
 		                                                            exchanger->mpi_exchange->type_size);
 
@@ -544,15 +890,38 @@ t_exchanger* new_exchanger(t_map        *map  ,
 	return exchanger;
 }
 
+/* record the time of an exchange of the Auto exchanger and change the exchanger
+ * type if needed, the messages of a NoWait type are completed before */
+static void exchanger_autotune(t_exchanger *exchanger, double time) {
+
+	if (!autotune_record(exchanger->autotune, time)) return;
+
+	exchanger->vtable_wait->pre_wait(exchanger->mpi_exchange);
+	if (exchanger->exch_send->pending != NULL) {
+		buffer_pool_release(exchanger->exch_send->pending);
+		exchanger->exch_send->pending = NULL;
+	}
+
+	exchanger_set_mode(exchanger, autotune_mode(exchanger->autotune));
+}
+
 void exchanger_go(t_exchanger  *exchanger    ,
                   void         *src_data     ,
                   void         *dst_data     ) {
 
 	if (timer_exchanger_go_id == -1)
-		timer_exchanger_go_id = new_timer(__func__);
+		timer_exchanger_go_id = new_timer_region(__func__, region_exchanger_go);
 
 	timer_start(timer_exchanger_go_id);
 
+	comm_pattern_count(exchanger->pattern);
+
+	/* the exchanges are timed during the selection of the Auto exchanger */
+	int tuning = exchanger->autotune != NULL && exchanger->autotune->mode < 0;
+	double start = tuning ? MPI_Wtime() : 0.0;
+
+	exchanger_lend_buffers(exchanger);
+
 	exchanger->go(exchanger->exch_send,
 	              exchanger->exch_recv,
 	              exchanger->map,
@@ -562,6 +931,13 @@ void exchanger_go(t_exchanger  *exchanger    ,
 	              src_data, dst_data,
 	              NULL, NULL);
 
+	/* the next messages are encoded as difference to these ones */
+	delta_commit(exchanger->exch_send->delta);
+
+	exchanger_return_buffers(exchanger);
+
+	if (tuning) exchanger_autotune(exchanger, MPI_Wtime() - start);
+
 	timer_stop(timer_exchanger_go_id);
 }
 
@@ -572,10 +948,18 @@ void exchanger_go_with_transform(t_exchanger  *exchanger    ,
                                  int          *transform_dst) {
 
 	if (timer_exchanger_go_with_transform_id == -1)
-		timer_exchanger_go_with_transform_id = new_timer(__func__);
+		timer_exchanger_go_with_transform_id = new_timer_region(__func__, region_exchanger_go_with_transform);
 
 	timer_start(timer_exchanger_go_with_transform_id);
 
+	comm_pattern_count(exchanger->pattern);
+
+	/* the exchanges are timed during the selection of the Auto exchanger */
+	int tuning = exchanger->autotune != NULL && exchanger->autotune->mode < 0;
+	double start = tuning ? MPI_Wtime() : 0.0;
+
+	exchanger_lend_buffers(exchanger);
+
 	exchanger->go(exchanger->exch_send,
 	              exchanger->exch_recv,
 	              exchanger->map,
@@ -585,41 +969,330 @@ void exchanger_go_with_transform(t_exchanger  *exchanger    ,
 	              src_data, dst_data,
 	              transform_src, transform_dst);
 
+	/* the next messages are encoded as difference to these ones */
+	delta_commit(exchanger->exch_send->delta);
+
+	exchanger_return_buffers(exchanger);
+
+	if (tuning) exchanger_autotune(exchanger, MPI_Wtime() - start);
+
 	timer_stop(timer_exchanger_go_with_transform_id);
 }
 
+/* post all the messages of a non blocking exchange */
+static void exchanger_start_request(t_exchanger *exchanger, void *src_data, void *dst_data,
+                                    int *transform_src, int *transform_dst) {
+
+	t_map *map = exchanger->map;
+	t_exchange *exch_send = exchanger->exch_send;
+	t_exchange *exch_recv = exchanger->exch_recv;
+	t_mpi_exchange *mpi_exchange = exchanger->mpi_exchange;
+
+	if (exchanger->request == NULL) {
+		int nmessages = map->exch_send->count + map->exch_recv->count;
+		exchanger->request = (t_exchange_request *)memory_malloc(sizeof(t_exchange_request), memory_exchange);
+		exchanger->request->active = 0;
+		exchanger->request->req = (MPI_Request *)memory_malloc(nmessages * sizeof(MPI_Request), memory_exchange);
+		exchanger->request->stat = (MPI_Status *)memory_malloc(nmessages * sizeof(MPI_Status), memory_exchange);
+		exchanger->request->indices = (int *)memory_malloc(nmessages * sizeof(int), memory_exchange);
+		exchanger->request->recv_count = (int *)memory_malloc(nmessages * sizeof(int), memory_exchange);
+	}
+	t_exchange_request *request = exchanger->request;
+
+#ifdef ERROR_CHECK
+	assert(!request->active);
+#endif
+
+	/* send messages of a previous NoWait exchange */
+	exchanger->vtable_wait->pre_wait(mpi_exchange);
+	exchanger_lend_buffers(exchanger);
+
+	const t_comm_backend *backend = get_comm_backend();
+
+	int world_size;
+	backend->comm_size(map->comm, &world_size);
+	int world_rank;
+	backend->comm_rank(map->comm, &world_rank);
+
+	int nreq = 0;
+
+	for (int count = 0; count < map->exch_send->count; count++) {
+
+		int offset = map->exch_send->buffer_offset[count];
+
+		int upper_bound = count == map->exch_send->count-1 ?
+		                           map->exch_send->buffer_size :
+		                           map->exch_send->buffer_offset[count + 1];
+
+		int size = upper_bound - map->exch_send->buffer_offset[count];
+
+		exchanger_pack(exch_send, exchanger->vtable, src_data, count,
+		               map->exch_send->exch[count]->exch_rank, size, offset, transform_src);
+
+		/* the exchange with the same process does not use MPI */
+		if (count == exch_send->self) continue;
+
+		exchanger_isend(exch_send, mpi_exchange, count, size, offset,
+		                map->exch_send->exch[count]->exch_rank,
+		                world_rank + world_size * (map->exch_send->exch[count]->exch_rank + 1),
+		                map->comm, request->req + nreq);
+		nreq++;
+	}
+	request->nreq_send = nreq;
+
+	for (int count = 0; count < map->exch_recv->count; count++) {
+
+		int offset = map->exch_recv->buffer_offset[count];
+
+		int upper_bound = count == map->exch_recv->count-1 ?
+		                           map->exch_recv->buffer_size :
+		                           map->exch_recv->buffer_offset[count + 1];
+
+		int size = upper_bound - map->exch_recv->buffer_offset[count];
+
+		/* the exchange with the same process is unpacked immediately */
+		if (count == exch_recv->self) {
+			exchanger_unpack(exch_recv, exchanger->vtable, dst_data, count,
+			                 map->exch_recv->exch[count]->exch_rank, size, offset, transform_dst);
+			continue;
+		}
+
+		exchanger_irecv(exch_recv, mpi_exchange, count, size, offset,
+		                map->exch_recv->exch[count]->exch_rank,
+		                map->exch_recv->exch[count]->exch_rank + world_size * (world_rank + 1),
+		                map->comm, request->req + nreq);
+		request->recv_count[nreq - request->nreq_send] = count;
+		nreq++;
+	}
+	request->nreq_recv = nreq - request->nreq_send;
+	request->nrecv_done = 0;
+	request->nrecv_unpacked = 0;
+	request->dst_data = dst_data;
+	request->transform_dst = transform_dst;
+	request->active = 1;
+}
+
+/* decode and unpack the messages completed and not yet unpacked */
+static void exchanger_unpack_messages(t_exchanger *exchanger) {
+
+	t_exchange_request *request = exchanger->request;
+	t_map *map = exchanger->map;
+	t_exchange *exch_recv = exchanger->exch_recv;
+
+	for (; request->nrecv_unpacked < request->nrecv_done; request->nrecv_unpacked++) {
+
+		int count = request->recv_count[request->indices[request->nrecv_unpacked]];
+		int offset = map->exch_recv->buffer_offset[count];
+
+		int upper_bound = count == map->exch_recv->count-1 ?
+		                           map->exch_recv->buffer_size :
+		                           map->exch_recv->buffer_offset[count + 1];
+
+		int size = upper_bound - map->exch_recv->buffer_offset[count];
+
+		exchanger_decode(exch_recv, map->exch_recv, exchanger->mpi_exchange, count);
+		exchanger_unpack(exch_recv, exchanger->vtable, request->dst_data, count,
+		                 map->exch_recv->exch[count]->exch_rank, size, offset,
+		                 request->transform_dst);
+	}
+}
+
+/* complete the messages and return 1 if all the messages are completed, the completed
+ * receive requests are appended to request->indices. The thread of the exchange (owner set)
+ * traces the calls and unpacks the messages as they arrive, the progress thread does not */
+static int exchanger_complete_messages(t_exchanger *exchanger, int blocking, int owner) {
+
+	t_exchange_request *request = exchanger->request;
+	t_mpi_exchange *mpi_exchange = exchanger->mpi_exchange;
+
+	while (request->nrecv_done < request->nreq_recv) {
+
+		int outcount;
+		int region = blocking ? region_wait_recv : region_test_recv;
+		const char *name = blocking ? "wait_recv" : "test_recv";
+		double begin = owner ? trace_begin(region, name, -1, 0) : 0.0;
+		/* at most nreq_recv - nrecv_done requests are still active */
+		if (blocking)
+			mpi_exchange->waitsome(request->nreq_recv, request->req + request->nreq_send,
+			                       &outcount, request->indices + request->nrecv_done, request->stat);
+		else
+			mpi_exchange->testsome(request->nreq_recv, request->req + request->nreq_send,
+			                       &outcount, request->indices + request->nrecv_done, request->stat);
+
+		if (owner) trace_end(region, name, -1, 0, begin);
+
+		if (outcount == MPI_UNDEFINED) break;
+
+		request->nrecv_done += outcount;
+		if (owner) exchanger_unpack_messages(exchanger);
+
+		if (!blocking) break;
+	}
+
+	if (request->nrecv_done < request->nreq_recv) return 0;
+
+	if (request->nreq_send > 0) {
+		if (blocking) {
+			double begin = trace_begin(region_wait_send, "wait_send", -1, 0);
+			mpi_exchange->wait(request->nreq_send, request->req, request->stat);
+			trace_end(region_wait_send, "wait_send", -1, 0, begin);
+		} else {
+			int flag;
+			mpi_exchange->testall(request->nreq_send, request->req, &flag, request->stat);
+			if (!flag) return 0;
+		}
+	}
+
+	return 1;
+}
+
+/* poll function of the progress thread, it only completes the MPI requests */
+static int exchanger_poll_messages(void *exchanger) {
+
+	return exchanger_complete_messages((t_exchanger *)exchanger, 0, 0);
+}
+
+/* hand the MPI requests of the exchange over to the progress thread, the messages
+ * are decoded and unpacked by the thread calling exchanger_test or exchanger_wait,
+ * so the trace and the hooks are never called by the progress thread */
+static void exchanger_offload_request(t_exchanger *exchanger) {
+
+	t_exchange_request *request = exchanger->request;
+
+	request->offloaded = !thread_ranks_active() && progress_thread_available();
+	if (request->offloaded)
+		progress_submit(&request->task, exchanger_poll_messages, exchanger);
+}
+
+/* complete the exchange and return 1 if it is completed */
+static int exchanger_progress_request(t_exchanger *exchanger, int blocking) {
+
+	t_exchange_request *request = exchanger->request;
+
+	if (request == NULL || !request->active) return 1;
+
+	if (request->offloaded) {
+		if (blocking) {
+			double begin = trace_begin(region_wait_recv, "wait_recv", -1, 0);
+			progress_task_wait(&request->task);
+			trace_end(region_wait_recv, "wait_recv", -1, 0, begin);
+		} else if (!progress_task_done(&request->task)) {
+			return 0;
+		}
+		exchanger_unpack_messages(exchanger);
+	} else if (!exchanger_complete_messages(exchanger, blocking, 1)) {
+		return 0;
+	}
+
+	/* the exchange is completed */
+	delta_commit(exchanger->exch_send->delta);
+	exchanger_return_buffers(exchanger);
+	request->active = 0;
+
+	return 1;
+}
+
+void exchanger_start(t_exchanger  *exchanger    ,
+                     void         *src_data     ,
+                     void         *dst_data     ) {
+
+	exchanger_start_with_transform(exchanger, src_data, dst_data, NULL, NULL);
+}
+
+void exchanger_start_with_transform(t_exchanger  *exchanger    ,
+                                    void         *src_data     ,
+                                    void         *dst_data     ,
+                                    int          *transform_src,
+                                    int          *transform_dst) {
+
+	if (timer_exchanger_start_id == -1)
+		timer_exchanger_start_id = new_timer_region(__func__, region_exchanger_start);
+
+	timer_start(timer_exchanger_start_id);
+
+	comm_pattern_count(exchanger->pattern);
+
+	exchanger_start_request(exchanger, src_data, dst_data, transform_src, transform_dst);
+	exchanger_offload_request(exchanger);
+
+	timer_stop(timer_exchanger_start_id);
+}
+
+int exchanger_test(t_exchanger *exchanger) {
+
+	return exchanger_progress_request(exchanger, 0);
+}
+
+void exchanger_wait(t_exchanger *exchanger) {
+
+	if (timer_exchanger_wait_id == -1)
+		timer_exchanger_wait_id = new_timer_region(__func__, region_exchanger_wait);
+
+	timer_start(timer_exchanger_wait_id);
+
+	exchanger_progress_request(exchanger, 1);
+
+	timer_stop(timer_exchanger_wait_id);
+}
+
+void exchanger_get_comm_stats(t_exchanger  *exchanger,
+                              t_comm_stats *stats    ) {
+
+	comm_pattern_get_stats(exchanger->pattern, stats);
+}
+
 void delete_exchanger(t_exchanger *exchanger) {
 
 	if (timer_delete_exchanger_id == -1)
-		timer_delete_exchanger_id = new_timer(__func__);
+		timer_delete_exchanger_id = new_timer_region(__func__, region_delete_exchanger);
 
 	timer_start(timer_delete_exchanger_id);
 
+	/* Complete a non blocking exchange in progress */
+	if (exchanger->request != NULL) {
+		exchanger_progress_request(exchanger, 1);
+		memory_free(exchanger->request->req);
+		memory_free(exchanger->request->stat);
+		memory_free(exchanger->request->indices);
+		memory_free(exchanger->request->recv_count);
+		memory_free(exchanger->request);
+	}
+
 	/* Wait for possible send messages (because of no wait in final step) */
 	exchanger->vtable_wait->pre_wait(exchanger->mpi_exchange);
+	buffer_pool_release(exchanger->exch_send->pending);
+
+	if (exchanger->exch_send->self_buffer != NULL)
+		exchanger->vtable->deallocator(exchanger->exch_send->self_buffer);
+
+	delete_delta(exchanger->exch_send->delta);
+	delete_delta(exchanger->exch_recv->delta);
+
+	delete_compression(exchanger->exch_send->compression);
+	delete_compression(exchanger->exch_recv->compression);
+
+	delete_comm_pattern(exchanger->pattern);
+
+	if (exchanger->autotune != NULL)
+		delete_autotune(exchanger->autotune);
 
 	// free memory
-	if (exchanger->exch_send->buffer_size > 0)
+	if (exchanger->exch_send->buffer_size > 0 && !exchanger->exch_send->pooled)
 		 exchanger->vtable->deallocator(exchanger->exch_send->buffer);
 
-	if (exchanger->exch_recv->buffer_size > 0)
+	if (exchanger->exch_recv->buffer_size > 0 && !exchanger->exch_recv->pooled)
 		 exchanger->vtable->deallocator(exchanger->exch_recv->buffer);
 
-	if (exchanger->exch_send->count > 0) {
-		free(exchanger->exch_send);
-	}
-
-	if (exchanger->exch_recv->count > 0) {
-		free(exchanger->exch_recv);
-	}
+	memory_free(exchanger->exch_send);
+	memory_free(exchanger->exch_recv);
 
 	delete_vtable(exchanger->vtable);
 
-	free(exchanger->vtable_wait);
+	memory_free(exchanger->vtable_wait);
 
 	delete_mpi_exchanger(exchanger->mpi_exchange);
 
-	free(exchanger);
+	memory_free(exchanger);
 
 	timer_stop(timer_delete_exchanger_id);
 
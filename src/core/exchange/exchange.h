@@ -38,6 +38,13 @@
 #include "src/setup/setting.h"
 #include "src/core/exchange/backend_communication/backend_mpi.h"
 #include "src/core/exchange/backend_hardware/backend_cpu.h"
+#include "src/core/exchange/compression/compression.h"
+#include "src/core/exchange/delta/delta.h"
+#include "src/core/exchange/buffer_pool/buffer_pool.h"
+#include "src/core/exchange/comm_stats/comm_stats.h"
+#include "src/core/exchange/autotune/autotune.h"
+#include "src/core/exchange/cost_model/cost_model.h"
+#include "src/core/exchange/progress/progress.h"
 #ifdef CUDA
 #include "src/core/exchange/backend_hardware/backend_cuda.h"
 #endif
@@ -56,6 +63,20 @@ struct t_exchange {
 	void *buffer;
 	/** @brief pointer to buffer_idxlist **/
 	int *buffer_idxlist;
+	/** @brief index of the exchange with the same process done without MPI (-1 if none) */
+	int self;
+	/** @brief buffer of the exchange with the same process (shared by both directions) */
+	void *self_buffer;
+	/** @brief pointer to the compression stage of the messages (NULL if disabled) */
+	t_compression *compression;
+	/** @brief pointer to the delta stage of the messages (NULL if disabled) */
+	t_delta *delta;
+	/** @brief flag to use a buffer lent by the buffer pool during the exchange */
+	int pooled;
+	/** @brief buffer lent by the buffer pool (NULL outside of the exchange) */
+	t_buffer_block *block;
+	/** @brief buffer of the pool kept by pending send messages (NoWait exchangers) */
+	t_buffer_block *pending;
 };
 typedef struct t_exchange t_exchange;
 
@@ -74,6 +95,41 @@ struct t_wait {
 };
 typedef struct t_wait t_wait;
 
+/** @struct t_exchange_request
+ * 
+ *  @brief The structure contains the state of a non blocking exchange
+ * 
+ */
+struct t_exchange_request {
+	/** @brief flag set while the exchange is in progress */
+	int active;
+	/** @brief number of send requests (stored first in req) */
+	int nreq_send;
+	/** @brief number of receive requests (stored after the send requests in req) */
+	int nreq_recv;
+	/** @brief number of receive requests completed */
+	int nrecv_done;
+	/** @brief number of completed receive requests already unpacked */
+	int nrecv_unpacked;
+	/** @brief MPI requests of the exchange */
+	MPI_Request *req;
+	/** @brief MPI statuses of the exchange */
+	MPI_Status *stat;
+	/** @brief indices of the completed receive requests (in completion order) */
+	int *indices;
+	/** @brief index of the receive message of each receive request */
+	int *recv_count;
+	/** @brief pointer to the data to be received */
+	void *dst_data;
+	/** @brief memory layout transformation of the data to be received */
+	int *transform_dst;
+	/** @brief flag set if the messages are completed by the progress thread */
+	int offloaded;
+	/** @brief task of the progress thread */
+	t_progress_task task;
+};
+typedef struct t_exchange_request t_exchange_request;
+
 typedef void (*backend_func_go) (t_exchange *, t_exchange*,  t_map*, t_kernels*,
                                  t_mpi_exchange*, t_wait*, void*, void *, int *, int*);
 
@@ -97,6 +153,14 @@ struct t_exchanger {
 	t_map *map;
 	/** @brief pointer to mpi_exchange struct */
 	t_mpi_exchange *mpi_exchange;
+	/** @brief number of contiguous values exchanged per index */
+	int block_size;
+	/** @brief pointer to the state of the non blocking exchange (NULL if never started) */
+	t_exchange_request *request;
+	/** @brief pointer to the communication volume counters */
+	t_comm_pattern *pattern;
+	/** @brief pointer to the automatic selection of the exchanger type (NULL if not Auto) */
+	t_autotune *autotune;
 };
 typedef struct t_exchanger t_exchanger;
 
@@ -115,6 +179,27 @@ t_exchanger* new_exchanger(t_map        *map  ,
                            MPI_Datatype  type ,
                            distdir_hardware hw);
 
+/**
+ * @brief Create a new t_exchanger structure for multi-component fields
+ * 
+ * @details Create an exchanger given a map object, a datatype and a block size.
+ *          Each index of the map moves block_size contiguous values of the datatype,
+ *          i.e. the fields are stored with the components of a grid point contiguous
+ *          in memory (e.g. u, v, w of a vector field). The map is the same used for
+ *          single component fields.
+ * 
+ * @param[in] map        pointer to a t_map structure
+ * @param[in] type       type of the data in the form of MPI datatype
+ * @param[in] block_size number of values per index of the map
+ * @param[in] hw         hardware location of the data on the MPI process
+ * 
+ * @ingroup exchange
+ */
+t_exchanger* new_exchanger_with_block_size(t_map        *map       ,
+                                           MPI_Datatype  type      ,
+                                           int           block_size,
+                                           distdir_hardware hw     );
+
 /**
  * @brief Arbitrary exchange given a map
  * 
@@ -152,6 +237,84 @@ void exchanger_go_with_transform(t_exchanger  *exchanger    ,
                                  int          *transform_src,
                                  int          *transform_dst);
 
+/**
+ * @brief Start a non blocking exchange given a map
+ * 
+ * @details Pack the data and post all the messages of the exchange, then return.
+ *          The exchange is completed by \c exchanger_test or \c exchanger_wait:
+ *          the source data can be modified and the destination data can be read
+ *          only after the completion. Only one exchange per exchanger can be in
+ *          progress and the exchanges in progress on the same processes have to be
+ *          started in the same order.
+ * 
+ * @param[in] exchanger     pointer to a t_exchanger structure
+ * @param[in] src_data      pointer to the data to be sent
+ * @param[in] dst_data      pointer to the data to be received
+ * 
+ * @ingroup exchange
+ */
+void exchanger_start(t_exchanger  *exchanger    ,
+                     void         *src_data     ,
+                     void         *dst_data     );
+
+/**
+ * @brief Start a non blocking exchange given a map with transformation of memory layout
+ * 
+ * @details Same as \c exchanger_start with a transformation array for source and destination.
+ * 
+ * @param[in] exchanger     pointer to a t_exchanger structure
+ * @param[in] src_data      pointer to the data to be sent
+ * @param[in] dst_data      pointer to the data to be received
+ * @param[in] transform_src array of indices to define a memory layout transformation of the src_data
+ * @param[in] transform_dst array of indices to define a memory layout transformation of the dst_data
+ * 
+ * @ingroup exchange
+ */
+void exchanger_start_with_transform(t_exchanger  *exchanger    ,
+                                    void         *src_data     ,
+                                    void         *dst_data     ,
+                                    int          *transform_src,
+                                    int          *transform_dst);
+
+/**
+ * @brief Progress a non blocking exchange
+ * 
+ * @details Test the messages of the exchange in progress (\c MPI_Testsome), the
+ *          received messages are unpacked as soon as they arrive. It does not block.
+ * 
+ * @param[in] exchanger pointer to a t_exchanger structure
+ * 
+ * @return 1 if the exchange is completed (or no exchange is in progress), 0 otherwise
+ * 
+ * @ingroup exchange
+ */
+int exchanger_test(t_exchanger *exchanger);
+
+/**
+ * @brief Complete a non blocking exchange
+ * 
+ * @details Wait for the messages of the exchange in progress and unpack them.
+ * 
+ * @param[in] exchanger pointer to a t_exchanger structure
+ * 
+ * @ingroup exchange
+ */
+void exchanger_wait(t_exchanger *exchanger);
+
+/**
+ * @brief Get the communication volume of an exchanger
+ * 
+ * @details Return the number of exchanges done with the exchanger and the messages,
+ *          bytes and peers they involved on the calling process.
+ * 
+ * @param[in]  exchanger pointer to a t_exchanger structure
+ * @param[out] stats     pointer to a t_comm_stats structure
+ * 
+ * @ingroup exchange
+ */
+void exchanger_get_comm_stats(t_exchanger  *exchanger,
+                              t_comm_stats *stats    );
+
 /**
  * @brief Clean memory of a t_exchanger structure
  * 
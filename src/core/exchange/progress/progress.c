@@ -0,0 +1,203 @@
+/*
+ * @file progress.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include "mpi.h"
+#include "src/core/exchange/progress/progress.h"
+#include "src/setup/setting.h"
+#include "src/utils/check.h"
+
+/* tasks submitted and not yet taken by the progress thread */
+static t_progress_task *pending = NULL;
+static int stop = 0;
+static int started = 0;
+static int available = 0;
+static pthread_t thread;
+static pthread_mutex_t progress_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t progress_cond = PTHREAD_COND_INITIALIZER;
+/* signalled when tasks are completed */
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+
+/* polls without completion before the thread starts to sleep */
+#define PROGRESS_SPIN 64
+/* bounds of the sleep between two polls (nanoseconds) */
+#define PROGRESS_SLEEP_MIN 1000
+#define PROGRESS_SLEEP_MAX 100000
+
+static void * progress_main(void *arg) {
+
+	/* tasks polled by the thread, only the thread touches the list */
+	t_progress_task *active = NULL;
+	/* polls without completion and current sleep */
+	int idle = 0;
+	long sleep_ns = PROGRESS_SLEEP_MIN;
+
+	for (;;) {
+		pthread_mutex_lock(&progress_mutex);
+		while (!stop && pending == NULL && active == NULL)
+			pthread_cond_wait(&progress_cond, &progress_mutex);
+		while (pending != NULL) {
+			t_progress_task *task = pending;
+			pending = task->next;
+			task->next = active;
+			active = task;
+			idle = 0;
+			sleep_ns = PROGRESS_SLEEP_MIN;
+		}
+		int exit = stop && active == NULL;
+		pthread_mutex_unlock(&progress_mutex);
+
+		if (exit) break;
+
+		int completed = 0;
+		t_progress_task **link = &active;
+		while (*link != NULL) {
+			t_progress_task *task = *link;
+			if (task->poll(task->ctx)) {
+				/* the task can be freed by its owner as soon as the flag is set */
+				*link = task->next;
+				__atomic_store_n(&task->done, 1, __ATOMIC_RELEASE);
+				completed++;
+			} else {
+				link = &task->next;
+			}
+		}
+
+		if (completed) {
+			/* the waiters check the flag under the mutex, no wake up is lost */
+			pthread_mutex_lock(&progress_mutex);
+			pthread_cond_broadcast(&done_cond);
+			pthread_mutex_unlock(&progress_mutex);
+			idle = 0;
+			sleep_ns = PROGRESS_SLEEP_MIN;
+			continue;
+		}
+
+		/* back off while nothing completes: yield first, then sleep with an
+		 * exponential delay, a new task wakes the thread up */
+		if (++idle < PROGRESS_SPIN) {
+			sched_yield();
+			continue;
+		}
+
+		struct timespec deadline;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_nsec += sleep_ns;
+		if (deadline.tv_nsec >= 1000000000L) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
+		}
+		pthread_mutex_lock(&progress_mutex);
+		if (!stop && pending == NULL)
+			pthread_cond_timedwait(&progress_cond, &progress_mutex, &deadline);
+		pthread_mutex_unlock(&progress_mutex);
+
+		if (sleep_ns < PROGRESS_SLEEP_MAX) sleep_ns *= 2;
+	}
+
+	return arg;
+}
+
+int progress_thread_available() {
+
+	if (__atomic_load_n(&started, __ATOMIC_ACQUIRE))
+		return available;
+
+	if (get_config_progress_thread() != progress_thread_on) return 0;
+
+	pthread_mutex_lock(&progress_mutex);
+	if (!started) {
+		int provided;
+		check_mpi( MPI_Query_thread(&provided) );
+		if (provided == MPI_THREAD_MULTIPLE) {
+			stop = 0;
+			available = pthread_create(&thread, NULL, progress_main, NULL) == 0;
+		}
+		if (!available && get_config_verbose() == verbose_true)
+			fprintf(stderr, "distdir: the progress thread requires MPI_THREAD_MULTIPLE, it is disabled\n");
+		__atomic_store_n(&started, 1, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&progress_mutex);
+
+	return available;
+}
+
+void progress_submit(t_progress_task *task, progress_func_poll poll, void *ctx) {
+
+	task->poll = poll;
+	task->ctx = ctx;
+	task->done = 0;
+
+	pthread_mutex_lock(&progress_mutex);
+	task->next = pending;
+	pending = task;
+	pthread_cond_signal(&progress_cond);
+	pthread_mutex_unlock(&progress_mutex);
+}
+
+int progress_task_done(t_progress_task *task) {
+
+	return __atomic_load_n(&task->done, __ATOMIC_ACQUIRE);
+}
+
+void progress_task_wait(t_progress_task *task) {
+
+	if (progress_task_done(task)) return;
+
+	pthread_mutex_lock(&progress_mutex);
+	while (!progress_task_done(task))
+		pthread_cond_wait(&done_cond, &progress_mutex);
+	pthread_mutex_unlock(&progress_mutex);
+}
+
+void progress_thread_stop() {
+
+	pthread_mutex_lock(&progress_mutex);
+	int join = started && available;
+	stop = 1;
+	pthread_cond_signal(&progress_cond);
+	pthread_mutex_unlock(&progress_mutex);
+
+	if (join) pthread_join(thread, NULL);
+
+	/* the thread can be started again by a later configuration */
+	pthread_mutex_lock(&progress_mutex);
+	__atomic_store_n(&started, 0, __ATOMIC_RELEASE);
+	available = 0;
+	stop = 0;
+	pthread_mutex_unlock(&progress_mutex);
+}
@@ -0,0 +1,117 @@
+/*
+ * @file progress.h
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+typedef int (*progress_func_poll) (void *);
+
+/** @struct t_progress_task
+ * 
+ *  @brief The structure contains a task polled by the progress thread
+ * 
+ */
+struct t_progress_task {
+	/** @brief pointer to the poll function (it returns 1 when the task is completed) */
+	progress_func_poll poll;
+	/** @brief pointer passed to the poll function */
+	void *ctx;
+	/** @brief completion flag (set by the progress thread with release semantic) */
+	int done;
+	/** @brief next task of the progress thread */
+	struct t_progress_task *next;
+};
+typedef struct t_progress_task t_progress_task;
+
+/**
+ * @brief Return 1 if the progress thread can be used, 0 otherwise.
+ * 
+ * @details The progress thread is used if it is enabled by the configuration of the
+ *          library and MPI provides \c MPI_THREAD_MULTIPLE. The thread is started by
+ *          the first call.
+ * 
+ * @ingroup progress
+ */
+int progress_thread_available();
+
+/**
+ * @brief Hand a task over to the progress thread.
+ * 
+ * @details The progress thread calls the poll function until it returns 1, then it
+ *          sets the completion flag of the task. The data touched by the poll function
+ *          must not be used by the caller before the completion. While no task completes,
+ *          the thread backs off from yielding to sleeping up to 100 microseconds between
+ *          two polls.
+ * 
+ * @param[out] task pointer to t_progress_task object (owned by the caller)
+ * @param[in]  poll pointer to the poll function
+ * @param[in]  ctx  pointer passed to the poll function
+ * 
+ * @ingroup progress
+ */
+void progress_submit(t_progress_task *task, progress_func_poll poll, void *ctx);
+
+/**
+ * @brief Return 1 if a task is completed, 0 otherwise.
+ * 
+ * @details The flag is read with acquire semantic, so the results of the task are
+ *          visible to the caller after the completion. It does not block.
+ * 
+ * @param[in] task pointer to t_progress_task object
+ * 
+ * @ingroup progress
+ */
+int progress_task_done(t_progress_task *task);
+
+/**
+ * @brief Wait for the completion of a task.
+ * 
+ * @details The caller sleeps on a condition variable signalled by the progress thread.
+ * 
+ * @param[in] task pointer to t_progress_task object
+ * 
+ * @ingroup progress
+ */
+void progress_task_wait(t_progress_task *task);
+
+/**
+ * @brief Stop the progress thread.
+ * 
+ * @details The tasks in progress are completed before the thread exits.
+ *          It is called by \c distdir_finalize.
+ * 
+ * @ingroup progress
+ */
+void progress_thread_stop();
+
+#endif
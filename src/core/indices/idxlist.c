@@ -35,6 +35,8 @@
 
 #include "src/core/indices/idxlist.h"
 #include "src/utils/timer.h"
+#include "src/utils/trace.h"
+#include "src/utils/memory.h"
 
 int timer_new_idxlist_id       = -1;
 int timer_new_idxlist_empty_id = -1;
@@ -44,15 +46,15 @@ t_idxlist * new_idxlist(int *idx_array  ,
                         int  num_indices) {
 
 	if (timer_new_idxlist_id == -1)
-		timer_new_idxlist_id = new_timer(__func__);
+		timer_new_idxlist_id = new_timer_region(__func__, region_new_idxlist);
 
 	timer_start(timer_new_idxlist_id);
 
 	t_idxlist *idxlist;
-	idxlist = (t_idxlist *)malloc(sizeof(t_idxlist));
+	idxlist = (t_idxlist *)memory_malloc(sizeof(t_idxlist), memory_idxlist);
 	idxlist->count = num_indices;
 	if (idxlist->count > 0)
-		idxlist->list = (int *)malloc(idxlist->count * sizeof(int));
+		idxlist->list = (int *)memory_malloc(idxlist->count * sizeof(int), memory_idxlist);
 	for (int i = 0; i < idxlist->count; i++)
 		idxlist->list[i] = idx_array[i];
 
@@ -64,12 +66,12 @@ t_idxlist * new_idxlist(int *idx_array  ,
 t_idxlist * new_idxlist_empty() {
 
 	if (timer_new_idxlist_empty_id == -1)
-		timer_new_idxlist_empty_id = new_timer(__func__);
+		timer_new_idxlist_empty_id = new_timer_region(__func__, region_new_idxlist_empty);
 
 	timer_start(timer_new_idxlist_empty_id);
 
 	t_idxlist *idxlist;
-	idxlist = (t_idxlist *)malloc(sizeof(t_idxlist));
+	idxlist = (t_idxlist *)memory_malloc(sizeof(t_idxlist), memory_idxlist);
 	idxlist->count = 0;
 	idxlist->list = NULL;
 
@@ -81,13 +83,13 @@ t_idxlist * new_idxlist_empty() {
 void delete_idxlist(t_idxlist *idxlist) {
 
 	if (timer_delete_idxlist_id == -1)
-		timer_delete_idxlist_id = new_timer(__func__);
+		timer_delete_idxlist_id = new_timer_region(__func__, region_delete_idxlist);
 
 	timer_start(timer_delete_idxlist_id);
 
 	if (idxlist->count > 0)
-		free(idxlist->list);
-	free(idxlist);
+		memory_free(idxlist->list);
+	memory_free(idxlist);
 
 	timer_stop(timer_delete_idxlist_id);
 }
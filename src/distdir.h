@@ -36,8 +36,13 @@
 
 #include "src/core/indices/idxlist.h"
 #include "src/core/algorithm/map.h"
+#include "src/core/algorithm/backend_communication/backend_comm.h"
+#include "src/core/algorithm/simulator/simulator.h"
+#include "src/core/exchange/backend_communication/backend_threads.h"
 #include "src/core/exchange/exchange.h"
 #include "src/setup/group.h"
 #include "src/setup/setting.h"
+#include "src/utils/trace.h"
+#include "src/utils/memory.h"
 
 #endif
@@ -33,9 +33,14 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "src/setup/setting.h"
 #include "src/utils/check.h"
 #include "src/utils/timer.h"
+#include "src/utils/trace.h"
+#include "src/core/exchange/buffer_pool/buffer_pool.h"
+#include "src/core/exchange/comm_stats/comm_stats.h"
+#include "src/core/exchange/progress/progress.h"
 
 static t_config *config;
 
@@ -56,15 +61,43 @@ static int get_env_variable(const char* variable_name) {
 static void set_default_config(t_config *config) {
 
 	config->exchanger = IsendIrecv1;
+	config->exchanger_auto_trials = EXCHANGER_AUTO_TRIALS;
+	config->exchanger_auto_file = NULL;
 	config->verbose = verbose_false;
 	config->sort = mergesort;
+	config->precision = precision_full;
+	config->compression = compression_off;
+	config->delta = delta_off;
+	config->buffer_pool = buffer_pool_off;
+	config->allocator = allocator_malloc;
+	config->timers = timers_on;
+	config->trace = trace_off;
+	config->timers_report = timers_report_off;
+	config->timers_report_file = strdup(TIMERS_REPORT_FILE);
+	config->comm = MPI_COMM_WORLD;
+	config->thread_ranks = 0;
+	config->progress_thread = progress_thread_off;
 }
 
 static void print_config() {
 
-	printf("DISTDIR_EXCHANGER = %d\n", config->exchanger);
-	printf("DISTDIR_VERBOSE   = %d\n", config->verbose  );
-	printf("DISTDIR_SORT      = %d\n", config->sort     );
+	printf("DISTDIR_EXCHANGER   = %d\n", config->exchanger  );
+	printf("DISTDIR_VERBOSE     = %d\n", config->verbose    );
+	printf("DISTDIR_SORT        = %d\n", config->sort       );
+	printf("DISTDIR_PRECISION   = %d\n", config->precision  );
+	printf("DISTDIR_COMPRESSION = %d\n", config->compression);
+	printf("DISTDIR_DELTA       = %d\n", config->delta      );
+	printf("DISTDIR_BUFFER_POOL = %d\n", config->buffer_pool);
+	printf("DISTDIR_ALLOCATOR   = %d\n", config->allocator  );
+	printf("DISTDIR_TIMERS      = %d\n", config->timers     );
+	printf("DISTDIR_TRACE       = %d\n", config->trace      );
+	printf("DISTDIR_TIMERS_REPORT      = %d\n", config->timers_report     );
+	printf("DISTDIR_TIMERS_REPORT_FILE = %s\n", config->timers_report_file);
+	printf("DISTDIR_EXCHANGER_AUTO_TRIALS = %d\n", config->exchanger_auto_trials);
+	printf("DISTDIR_EXCHANGER_AUTO_FILE   = %s\n",
+	       config->exchanger_auto_file != NULL ? config->exchanger_auto_file : "");
+	printf("DISTDIR_THREAD_RANKS = %d\n", config->thread_ranks);
+	printf("DISTDIR_PROGRESS_THREAD = %d\n", config->progress_thread);
 }
 
 void set_config_exchanger(int exchanger_type) {
@@ -72,6 +105,17 @@ void set_config_exchanger(int exchanger_type) {
 	config->exchanger = exchanger_type;
 }
 
+void set_config_exchanger_auto_trials(int trials) {
+
+	config->exchanger_auto_trials = trials;
+}
+
+void set_config_exchanger_auto_file(const char *path) {
+
+	free(config->exchanger_auto_file);
+	config->exchanger_auto_file = path != NULL ? strdup(path) : NULL;
+}
+
 void set_config_verbose(int verbose_type) {
 
 	config->verbose = verbose_type;
@@ -82,11 +126,84 @@ void set_config_sort(int sort_type) {
 	config->sort = sort_type;
 }
 
+void set_config_precision(int precision_type) {
+
+	config->precision = precision_type;
+}
+
+void set_config_compression(int compression_type) {
+
+	config->compression = compression_type;
+}
+
+void set_config_delta(int delta_type) {
+
+	config->delta = delta_type;
+}
+
+void set_config_buffer_pool(int buffer_pool_type) {
+
+	config->buffer_pool = buffer_pool_type;
+}
+
+void set_config_allocator(int allocator_type) {
+
+	config->allocator = allocator_type;
+}
+
+void set_config_timers(int timers_type) {
+
+	config->timers = timers_type;
+	timers_set_active(timers_type == timers_on);
+}
+
+void set_config_trace(int trace_type) {
+
+	config->trace = trace_type;
+	trace_set_active(trace_type == trace_on);
+}
+
+void set_config_timers_report(int timers_report_type) {
+
+	config->timers_report = timers_report_type;
+}
+
+void set_config_timers_report_file(const char *path) {
+
+	free(config->timers_report_file);
+	config->timers_report_file = strdup(path);
+}
+
+void set_config_comm(MPI_Comm comm) {
+
+	config->comm = comm;
+}
+
+void set_config_thread_ranks(int nranks) {
+
+	config->thread_ranks = nranks;
+}
+
+void set_config_progress_thread(int progress_thread_type) {
+
+	config->progress_thread = progress_thread_type;
+}
+
 int get_config_exchanger() {
 
 	return config->exchanger;
 }
 
+int get_config_exchanger_auto_trials() {
+
+	return config->exchanger_auto_trials;
+}
+
+const char * get_config_exchanger_auto_file() {
+
+	return config->exchanger_auto_file;
+}
+
 int get_config_verbose() {
 
 	return config->verbose;
@@ -97,12 +214,76 @@ int get_config_sort() {
 	return config->sort;
 }
 
+int get_config_precision() {
+
+	return config->precision;
+}
+
+int get_config_compression() {
+
+	return config->compression;
+}
+
+int get_config_delta() {
+
+	return config->delta;
+}
+
+int get_config_buffer_pool() {
+
+	return config->buffer_pool;
+}
+
+int get_config_allocator() {
+
+	return config->allocator;
+}
+
+int get_config_timers() {
+
+	return config->timers;
+}
+
+int get_config_trace() {
+
+	return config->trace;
+}
+
+int get_config_timers_report() {
+
+	return config->timers_report;
+}
+
+MPI_Comm get_config_comm() {
+
+	return config->comm;
+}
+
+int get_config_thread_ranks() {
+
+	return config->thread_ranks;
+}
+
+int get_config_progress_thread() {
+
+	return config->progress_thread;
+}
+
 void distdir_initialize() {
 
+	// the thread ranks and the progress thread call MPI concurrently
+	int thread_ranks = get_env_variable("DISTDIR_THREAD_RANKS");
+	int progress_thread = get_env_variable("DISTDIR_PROGRESS_THREAD");
+
 	int mpi_initialized;
 	check_mpi( MPI_Initialized( &mpi_initialized ) );
 	if (!mpi_initialized) {
-		MPI_Init(NULL, NULL);
+		if (thread_ranks > 0 || progress_thread == progress_thread_on) {
+			int provided;
+			MPI_Init_thread(NULL, NULL, MPI_THREAD_MULTIPLE, &provided);
+		} else {
+			MPI_Init(NULL, NULL);
+		}
 		check_mpi( MPI_Initialized( &mpi_initialized ) );
 	}
 
@@ -116,6 +297,18 @@ void distdir_initialize() {
 		if (variable != -1) config->exchanger = variable;
 	}
 
+	// set timed exchanges of the Auto exchanger from env variable
+	{
+		int variable = get_env_variable("DISTDIR_EXCHANGER_AUTO_TRIALS");
+		if (variable != -1) config->exchanger_auto_trials = variable;
+	}
+
+	// set file of the selections of the Auto exchanger from env variable
+	{
+		const char *variable = getenv("DISTDIR_EXCHANGER_AUTO_FILE");
+		if (variable != NULL && variable[0] != '\0') set_config_exchanger_auto_file(variable);
+	}
+
 	// set verbose from env variable
 	{
 		int variable = get_env_variable("DISTDIR_VERBOSE");
@@ -128,18 +321,88 @@ void distdir_initialize() {
 		if (variable != -1) config->sort = variable;
 	}
 
+	// set wire precision from env variable
+	{
+		int variable = get_env_variable("DISTDIR_PRECISION");
+		if (variable != -1) config->precision = variable;
+	}
+
+	// set compression from env variable
+	{
+		int variable = get_env_variable("DISTDIR_COMPRESSION");
+		if (variable != -1) config->compression = variable;
+	}
+
+	// set delta exchange from env variable
+	{
+		int variable = get_env_variable("DISTDIR_DELTA");
+		if (variable != -1) config->delta = variable;
+	}
+
+	// set buffer pool from env variable
+	{
+		int variable = get_env_variable("DISTDIR_BUFFER_POOL");
+		if (variable != -1) config->buffer_pool = variable;
+	}
+
+	// set memory placement policy from env variable
+	{
+		int variable = get_env_variable("DISTDIR_ALLOCATOR");
+		if (variable != -1) config->allocator = variable;
+	}
+
+	// set timers from env variable
+	{
+		int variable = get_env_variable("DISTDIR_TIMERS");
+		if (variable != -1) config->timers = variable;
+	}
+	timers_set_active(config->timers == timers_on);
+
+	// set tracing from env variable
+	{
+		int variable = get_env_variable("DISTDIR_TRACE");
+		if (variable != -1) config->trace = variable;
+	}
+	trace_set_active(config->trace == trace_on);
+
+	// set report of the timers from env variable
+	{
+		int variable = get_env_variable("DISTDIR_TIMERS_REPORT");
+		if (variable != -1) config->timers_report = variable;
+	}
+
+	// set path of the report of the timers from env variable
+	{
+		const char *variable = getenv("DISTDIR_TIMERS_REPORT_FILE");
+		if (variable != NULL && variable[0] != '\0') set_config_timers_report_file(variable);
+	}
+
+	// set number of thread ranks from env variable
+	if (thread_ranks != -1) config->thread_ranks = thread_ranks;
+
+	// set progress thread from env variable
+	if (progress_thread != -1) config->progress_thread = progress_thread;
+
 	if (config->verbose == verbose_true) print_config();
 }
 
 void distdir_finalize() {
 
-	timers_report();
+	progress_thread_stop();
+	trace_finalize();
+	if (config->timers_report != timers_report_off)
+		timers_report(config->comm, config->timers_report_file,
+		              config->timers_report == timers_report_full);
 	delete_timers();
+	buffer_pool_clear();
+	distdir_reset_comm_stats();
 
 	int mpi_finalized;
 	int mpi_initialized = config->initialized;
 	check_mpi( MPI_Finalized( &mpi_finalized ) );
 
+	free(config->timers_report_file);
+	free(config->exchanger_auto_file);
 	free(config);
 
 	if (mpi_initialized && !mpi_finalized)
@@ -34,6 +34,14 @@
 #ifndef SETTING_H
 #define SETTING_H
 
+#include <mpi.h>
+
+/** @brief default path of the report of the timers */
+#define TIMERS_REPORT_FILE "distdir_timers.txt"
+
+/** @brief default number of timed exchanges per exchanger type of the Auto exchanger */
+#define EXCHANGER_AUTO_TRIALS 3
+
 /** @enum distdir_hardware
  * 
  *  @brief Enum for supported hardware
@@ -58,7 +66,8 @@ enum distdir_exchanger {
 	IsendIrecv1NoWait = 4,
 	IsendIrecv2NoWait = 5,
 	IsendRecv1NoWait = 6,
-	IsendRecv2NoWait = 7
+	IsendRecv2NoWait = 7,
+	Auto = 8
 };
 
 /** @enum distdir_verbose
@@ -82,6 +91,101 @@ enum distdir_sort {
 	timsort   = 2
 };
 
+/** @enum distdir_precision
+ * 
+ *  @brief Enum for the precision of double fields on the wire
+ * 
+ */
+enum distdir_precision {
+	precision_full     = 0,
+	precision_float    = 1,
+	precision_bfloat16 = 2
+};
+
+/** @enum distdir_compression
+ * 
+ *  @brief Enum for the compression of the exchange messages
+ * 
+ */
+enum distdir_compression {
+	compression_off = 0,
+	compression_on  = 1
+};
+
+/** @enum distdir_delta
+ * 
+ *  @brief Enum for the delta exchange of the messages
+ * 
+ */
+enum distdir_delta {
+	delta_off = 0,
+	delta_on  = 1
+};
+
+/** @enum distdir_buffer_pool
+ * 
+ *  @brief Enum for the buffer pool of the exchangers
+ * 
+ */
+enum distdir_buffer_pool {
+	buffer_pool_off = 0,
+	buffer_pool_on  = 1
+};
+
+/** @enum distdir_allocator
+ * 
+ *  @brief Enum for the memory placement policy of the exchanger buffers on CPU
+ *         (the values can be combined)
+ * 
+ */
+enum distdir_allocator {
+	allocator_malloc      = 0,
+	allocator_first_touch = 1,
+	allocator_huge_pages  = 2,
+	allocator_local_node  = 4
+};
+
+/** @enum distdir_timers
+ * 
+ *  @brief Enum for the timers of the library
+ * 
+ */
+enum distdir_timers {
+	timers_off = 0,
+	timers_on  = 1
+};
+
+/** @enum distdir_timers_report
+ * 
+ *  @brief Enum for the report of the timers written by distdir_finalize
+ * 
+ */
+enum distdir_timers_report {
+	timers_report_off     = 0,
+	timers_report_summary = 1,
+	timers_report_full    = 2
+};
+
+/** @enum distdir_trace
+ * 
+ *  @brief Enum for the tracing of the library
+ * 
+ */
+enum distdir_trace {
+	trace_off = 0,
+	trace_on  = 1
+};
+
+/** @enum distdir_progress_thread
+ * 
+ *  @brief Enum for the background progress thread of the non blocking exchanges
+ * 
+ */
+enum distdir_progress_thread {
+	progress_thread_off = 0,
+	progress_thread_on  = 1
+};
+
 /** @struct t_config
  * 
  *  @brief The structure contains information about the library configuration
@@ -92,10 +196,38 @@ struct t_config {
 	int initialized;
 	/** @brief exchanger type */
 	enum distdir_exchanger exchanger;
+	/** @brief number of timed exchanges per exchanger type of the Auto exchanger */
+	int exchanger_auto_trials;
+	/** @brief path of the file of the selections of the Auto exchanger (NULL if not stored) */
+	char *exchanger_auto_file;
 	/** @brief verbose type */
 	enum distdir_verbose verbose;
 	/** @brief sort type */
 	enum distdir_sort sort;
+	/** @brief precision of double fields on the wire */
+	enum distdir_precision precision;
+	/** @brief compression of the exchange messages */
+	enum distdir_compression compression;
+	/** @brief delta exchange of the messages */
+	enum distdir_delta delta;
+	/** @brief buffer pool of the exchangers */
+	enum distdir_buffer_pool buffer_pool;
+	/** @brief memory placement policy of the exchanger buffers on CPU */
+	int allocator;
+	/** @brief timers of the library */
+	enum distdir_timers timers;
+	/** @brief tracing of the library */
+	enum distdir_trace trace;
+	/** @brief report of the timers written by distdir_finalize */
+	enum distdir_timers_report timers_report;
+	/** @brief path of the report of the timers */
+	char *timers_report_file;
+	/** @brief MPI communicator of the collective calls of distdir_finalize */
+	MPI_Comm comm;
+	/** @brief number of threads of distdir_run_ranks (0 means the MPI processes) */
+	int thread_ranks;
+	/** @brief background progress thread of the non blocking exchanges */
+	enum distdir_progress_thread progress_thread;
 };
 typedef struct t_config t_config;
 
@@ -129,6 +261,34 @@ void distdir_finalize();
  */
 void set_config_exchanger(int exchanger_type);
 
+/**
+ * @brief Set library number of timed exchanges of the Auto exchanger
+ * 
+ * @details It can also be set up with environment variable \c DISTDIR_EXCHANGER_AUTO_TRIALS.
+ *          The default value is \c EXCHANGER_AUTO_TRIALS. The function should be
+ *          called before a call to \c new_exchanger.
+ * 
+ * @param[in] trials number of timed exchanges per exchanger type
+ * 
+ * @ingroup setting
+ */
+void set_config_exchanger_auto_trials(int trials);
+
+/**
+ * @brief Set library file of the selections of the Auto exchanger
+ * 
+ * @details It can also be set up with environment variable \c DISTDIR_EXCHANGER_AUTO_FILE.
+ *          The exchanger type selected for a communication pattern is appended to the
+ *          file and it is used without timing the exchanger types by the following
+ *          exchangers (also in later runs) with the same pattern. The selections are
+ *          not stored by default.
+ * 
+ * @param[in] path path of the file (NULL to disable)
+ * 
+ * @ingroup setting
+ */
+void set_config_exchanger_auto_file(const char *path);
+
 /**
  * @brief Set library verbosity
  * 
@@ -152,6 +312,177 @@ void set_config_verbose(int verbose_type);
  */
 void set_config_sort(int sort_type);
 
+/**
+ * @brief Set library wire precision for double fields
+ * 
+ * @details It can also be set up with environment variable \c DISTDIR_PRECISION.
+ *          The function should be called before a call to \c new_exchanger.
+ *          Exchangers of \c MPI_DOUBLE (or \c MPI_DOUBLE_PRECISION) fields convert the
+ *          data to the selected precision during packing and back to double during unpacking.
+ * 
+ * @param[in] precision_type wire precision using values of distdir_precision enum
+ * 
+ * @ingroup setting
+ */
+void set_config_precision(int precision_type);
+
+/**
+ * @brief Set library compression of the exchange messages
+ * 
+ * @details It can also be set up with environment variable \c DISTDIR_COMPRESSION.
+ *          The function should be called before a call to \c new_exchanger.
+ *          Messages larger than \c COMPRESSION_MIN_SIZE bytes are compressed with a
+ *          lossless codec before they are sent.
+ * 
+ * @param[in] compression_type compression using values of distdir_compression enum
+ * 
+ * @ingroup setting
+ */
+void set_config_compression(int compression_type);
+
+/**
+ * @brief Set library delta exchange of the messages
+ * 
+ * @details It can also be set up with environment variable \c DISTDIR_DELTA.
+ *          The function should be called before a call to \c new_exchanger.
+ *          Each message is sent as the difference to the previous exchange
+ *          (nothing, changed values or the full message, whichever is smaller).
+ *          It replaces the compression of the messages.
+ * 
+ * @param[in] delta_type delta exchange using values of distdir_delta enum
+ * 
+ * @ingroup setting
+ */
+void set_config_delta(int delta_type);
+
+/**
+ * @brief Set library buffer pool of the exchangers
+ * 
+ * @details It can also be set up with environment variable \c DISTDIR_BUFFER_POOL.
+ *          The function should be called before a call to \c new_exchanger.
+ *          The exchangers created with the buffer pool do not own their message
+ *          buffers: the buffers are lent by a library pool during the exchange.
+ * 
+ * @param[in] buffer_pool_type buffer pool using values of distdir_buffer_pool enum
+ * 
+ * @ingroup setting
+ */
+void set_config_buffer_pool(int buffer_pool_type);
+
+/**
+ * @brief Set library memory placement policy of the exchanger buffers on CPU
+ * 
+ * @details It can also be set up with environment variable \c DISTDIR_ALLOCATOR.
+ *          The function should be called before a call to \c new_exchanger.
+ *          The policy is a combination (bitwise or) of the values of the
+ *          distdir_allocator enum.
+ * 
+ * @param[in] allocator_type policy using values of distdir_allocator enum
+ * 
+ * @ingroup setting
+ */
+void set_config_allocator(int allocator_type);
+
+/**
+ * @brief Set library timers
+ * 
+ * @details It can also be set up with environment variable \c DISTDIR_TIMERS.
+ *          The timers are enabled by default. When disabled, the instrumented
+ *          regions of the library are not timed. The timers can also be removed
+ *          at compile time with the \c DISTDIR_NO_TIMERS macro. In both cases the
+ *          regions are still reported to the trace and to the hooks.
+ * 
+ * @param[in] timers_type timers using values of distdir_timers enum
+ * 
+ * @ingroup setting
+ */
+void set_config_timers(int timers_type);
+
+/**
+ * @brief Set library tracing
+ * 
+ * @details It can also be set up with environment variable \c DISTDIR_TRACE.
+ *          When enabled, the timed regions and the pack, post, wait and unpack
+ *          phases of each message are recorded in a ring buffer of \c TRACE_BUFFER_SIZE
+ *          events. The trace is written in Chrome trace format by \c distdir_finalize
+ *          in \c TRACE_FILE or on demand by \c distdir_dump_trace.
+ * 
+ * @param[in] trace_type tracing using values of distdir_trace enum
+ * 
+ * @ingroup setting
+ */
+void set_config_trace(int trace_type);
+
+/**
+ * @brief Set library report of the timers
+ * 
+ * @details It can also be set up with environment variable \c DISTDIR_TIMERS_REPORT.
+ *          The report is disabled by default. When enabled, \c distdir_finalize
+ *          writes a summary of the timers among the processes and, with
+ *          \c timers_report_full, the timers of each process in a single file.
+ * 
+ * @param[in] timers_report_type report using values of distdir_timers_report enum
+ * 
+ * @ingroup setting
+ */
+void set_config_timers_report(int timers_report_type);
+
+/**
+ * @brief Set library path of the report of the timers
+ * 
+ * @details It can also be set up with environment variable \c DISTDIR_TIMERS_REPORT_FILE.
+ *          The default path is \c TIMERS_REPORT_FILE.
+ * 
+ * @param[in] path path of the report file
+ * 
+ * @ingroup setting
+ */
+void set_config_timers_report_file(const char *path);
+
+/**
+ * @brief Set library communicator
+ * 
+ * @details The collective calls of \c distdir_finalize (e.g. the report of the
+ *          timers) are done over the communicator. The default communicator is
+ *          \c MPI_COMM_WORLD. The communicator has to be valid until
+ *          \c distdir_finalize is called.
+ * 
+ * @param[in] comm MPI communicator of the processes using the library
+ * 
+ * @ingroup setting
+ */
+void set_config_comm(MPI_Comm comm);
+
+/**
+ * @brief Set the number of thread ranks
+ * 
+ * @details When the number is larger than zero, \c distdir_run_ranks runs a function
+ *          on that number of threads of the calling process, which are the ranks of
+ *          the maps and of the exchangers. The default is zero (the ranks are the MPI
+ *          processes). When the number is set with the \c DISTDIR_THREAD_RANKS environment
+ *          variable, \c distdir_initialize initializes MPI with \c MPI_THREAD_MULTIPLE.
+ * 
+ * @param[in] nranks number of thread ranks
+ * 
+ * @ingroup setting
+ */
+void set_config_thread_ranks(int nranks);
+
+/**
+ * @brief Set the background progress thread of the non blocking exchanges
+ * 
+ * @details It can also be set up with environment variable \c DISTDIR_PROGRESS_THREAD.
+ *          The function should be called before a call to \c exchanger_start.
+ *          The thread is used only if MPI provides \c MPI_THREAD_MULTIPLE: when the
+ *          parameter is set with the environment variable, \c distdir_initialize
+ *          initializes MPI with \c MPI_THREAD_MULTIPLE.
+ * 
+ * @param[in] progress_thread_type progress thread using values of distdir_progress_thread enum
+ * 
+ * @ingroup setting
+ */
+void set_config_progress_thread(int progress_thread_type);
+
 /**
  * @brief get current exchanger configuration
  * 
@@ -163,6 +494,24 @@ void set_config_sort(int sort_type);
  */
 int get_config_exchanger();
 
+/**
+ * @brief get current number of timed exchanges of the Auto exchanger
+ * 
+ * @return number of timed exchanges per exchanger type
+ * 
+ * @ingroup setting
+ */
+int get_config_exchanger_auto_trials();
+
+/**
+ * @brief get current file of the selections of the Auto exchanger
+ * 
+ * @return path of the file (NULL if the selections are not stored)
+ * 
+ * @ingroup setting
+ */
+const char * get_config_exchanger_auto_file();
+
 /**
  * @brief get current verbose configuration
  * 
@@ -185,4 +534,123 @@ int get_config_verbose();
  */
 int get_config_sort();
 
+/**
+ * @brief get current wire precision configuration
+ * 
+ * @details Return a value of the distdir_precision enum.
+ * 
+ * @return value of the distdir_precision enum
+ * 
+ * @ingroup setting
+ */
+int get_config_precision();
+
+/**
+ * @brief get current compression configuration
+ * 
+ * @details Return a value of the distdir_compression enum.
+ * 
+ * @return value of the distdir_compression enum
+ * 
+ * @ingroup setting
+ */
+int get_config_compression();
+
+/**
+ * @brief get current delta exchange configuration
+ * 
+ * @details Return a value of the distdir_delta enum.
+ * 
+ * @return value of the distdir_delta enum
+ * 
+ * @ingroup setting
+ */
+int get_config_delta();
+
+/**
+ * @brief get current buffer pool configuration
+ * 
+ * @details Return a value of the distdir_buffer_pool enum.
+ * 
+ * @return value of the distdir_buffer_pool enum
+ * 
+ * @ingroup setting
+ */
+int get_config_buffer_pool();
+
+/**
+ * @brief get current memory placement policy configuration
+ * 
+ * @details Return a combination of the values of the distdir_allocator enum.
+ * 
+ * @return combination of the values of the distdir_allocator enum
+ * 
+ * @ingroup setting
+ */
+int get_config_allocator();
+
+/**
+ * @brief get current timers configuration
+ * 
+ * @details Return a value of the distdir_timers enum.
+ * 
+ * @return value of the distdir_timers enum
+ * 
+ * @ingroup setting
+ */
+int get_config_timers();
+
+/**
+ * @brief get current tracing configuration
+ * 
+ * @details Return a value of the distdir_trace enum.
+ * 
+ * @return value of the distdir_trace enum
+ * 
+ * @ingroup setting
+ */
+int get_config_trace();
+
+/**
+ * @brief get current report of the timers configuration
+ * 
+ * @details Return a value of the distdir_timers_report enum.
+ * 
+ * @return value of the distdir_timers_report enum
+ * 
+ * @ingroup setting
+ */
+int get_config_timers_report();
+
+/**
+ * @brief get current library communicator
+ * 
+ * @details Return the communicator set with \c set_config_comm.
+ * 
+ * @return MPI communicator of the library
+ * 
+ * @ingroup setting
+ */
+MPI_Comm get_config_comm();
+
+/**
+ * @brief get current number of thread ranks
+ * 
+ * @return number of thread ranks (0 means the MPI processes)
+ * 
+ * @ingroup setting
+ */
+int get_config_thread_ranks();
+
+/**
+ * @brief get current progress thread configuration
+ * 
+ * @details Return a value of the distdir_progress_thread enum.
+ * 
+ * @return value of the distdir_progress_thread enum
+ * 
+ * @ingroup setting
+ */
+int get_config_progress_thread();
+
 #endif
\ No newline at end of file
@@ -66,6 +66,16 @@ t_exchanger * t_exchanger_f2c(struct t_exchanger_f *p)
 	return p->cptr;
 }
 
+void set_config_comm_f(MPI_Fint comm_f) {
+
+	set_config_comm(MPI_Comm_f2c(comm_f));
+}
+
+void distdir_calibrate_f(MPI_Fint comm_f) {
+
+	distdir_calibrate(MPI_Comm_f2c(comm_f));
+}
+
 void new_group_f(MPI_Fint *new_comm_f ,
                  MPI_Fint  work_comm_f,
                  int       id       ) {
@@ -87,6 +97,21 @@ t_map * new_map_f(struct t_idxlist_f *src_idxlist_f,
 	return new_map(src_idxlist_f->cptr, dst_idxlist_f->cptr, stride, comm_c);
 }
 
+double map_predict_cost_f(struct t_map_f *map   ,
+                          MPI_Fint        type_f,
+                          int             mode  ) {
+
+	MPI_Datatype type_c = MPI_Type_f2c(type_f);
+	return map_predict_cost(map->cptr, type_c, mode);
+}
+
+int map_predict_exchanger_f(struct t_map_f *map   ,
+                            MPI_Fint        type_f) {
+
+	MPI_Datatype type_c = MPI_Type_f2c(type_f);
+	return map_predict_exchanger(map->cptr, type_c);
+}
+
 t_map * extend_map_3d_f(struct t_map_f *map2d  ,
                       int             nlevels) {
 	return extend_map_3d(map2d->cptr, nlevels);
@@ -100,6 +125,15 @@ t_exchanger* new_exchanger_f(struct t_map_f *map    ,
 	return new_exchanger(map->cptr, type_c, hw);
 }
 
+t_exchanger* new_exchanger_with_block_size_f(struct t_map_f *map       ,
+                                             MPI_Fint        type_f    ,
+                                             int             block_size,
+                                             int             hw        ) {
+
+	MPI_Datatype type_c = MPI_Type_f2c(type_f);
+	return new_exchanger_with_block_size(map->cptr, type_c, block_size, hw);
+}
+
 void exchanger_go_f(struct t_exchanger_f *exchanger,
                     void *src_data,
                     void *dst_data) {
@@ -113,3 +147,8 @@ void exchanger_go_with_transform_f(struct t_exchanger_f *exchanger,
                                    int *transform_dst) {
 	exchanger_go_with_transform(exchanger->cptr, src_data, dst_data, transform_src, transform_dst);
 }
+
+void exchanger_get_comm_stats_f(struct t_exchanger_f *exchanger,
+                                t_comm_stats *stats) {
+	exchanger_get_comm_stats(exchanger->cptr, stats);
+}
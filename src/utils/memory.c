@@ -0,0 +1,329 @@
+/*
+ * @file memory.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <mpi.h>
+
+#include "src/utils/memory.h"
+#include "src/setup/setting.h"
+#include "src/utils/check.h"
+
+/* header stored before the memory returned by memory_malloc, the union keeps
+ * the alignment of malloc */
+union t_memory_header {
+	struct {
+		size_t size;
+		int category;
+	} info;
+	max_align_t align;
+};
+typedef union t_memory_header t_memory_header;
+
+/* memory allocated without header (aligned or device memory) */
+struct t_memory_entry {
+	void *ptr;
+	size_t size;
+	int category;
+};
+typedef struct t_memory_entry t_memory_entry;
+
+/* bytes allocated and peak of each category, the last element is the total */
+static size_t memory_current[MEMORY_NCATEGORIES + 1] = {0};
+static size_t memory_peak[MEMORY_NCATEGORIES + 1] = {0};
+
+/* registered memory (device memory) */
+static t_memory_entry *entries = NULL;
+static int nentries = 0;
+static int capacity = 0;
+static pthread_mutex_t memory_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* aligned memory in a hash table with linear probing (capacity is a power of two),
+ * the smallest alignment lets memory_free skip the table for the other pointers */
+static t_memory_entry *aligned_entries = NULL;
+static size_t naligned = 0;
+static size_t aligned_capacity = 0;
+static size_t aligned_min = SIZE_MAX;
+
+static void memory_update_peak(int index, size_t current) {
+
+	size_t peak = __atomic_load_n(&memory_peak[index], __ATOMIC_RELAXED);
+	while (current > peak &&
+	       !__atomic_compare_exchange_n(&memory_peak[index], &peak, current, 1,
+	                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+static void memory_add(int category, size_t size) {
+
+	size_t current = __atomic_add_fetch(&memory_current[category], size, __ATOMIC_RELAXED);
+	memory_update_peak(category, current);
+	size_t total = __atomic_add_fetch(&memory_current[MEMORY_NCATEGORIES], size, __ATOMIC_RELAXED);
+	memory_update_peak(MEMORY_NCATEGORIES, total);
+}
+
+static void memory_sub(int category, size_t size) {
+
+	__atomic_sub_fetch(&memory_current[category], size, __ATOMIC_RELAXED);
+	__atomic_sub_fetch(&memory_current[MEMORY_NCATEGORIES], size, __ATOMIC_RELAXED);
+}
+
+void * memory_malloc(size_t size, int category) {
+
+	t_memory_header *header = (t_memory_header *)malloc(sizeof(t_memory_header) + size);
+	if (header == NULL) {
+		fprintf(stderr, "distdir: malloc of %zu bytes failed!\n", size);
+		exit(EXIT_FAILURE);
+	}
+
+	header->info.size = size;
+	header->info.category = category;
+	memory_add(category, size);
+
+	return header + 1;
+}
+
+void * memory_calloc(size_t nmemb, size_t size, int category) {
+
+	t_memory_header *header = (t_memory_header *)calloc(1, sizeof(t_memory_header) + nmemb * size);
+	if (header == NULL) {
+		fprintf(stderr, "distdir: calloc of %zu bytes failed!\n", nmemb * size);
+		exit(EXIT_FAILURE);
+	}
+
+	header->info.size = nmemb * size;
+	header->info.category = category;
+	memory_add(category, nmemb * size);
+
+	return header + 1;
+}
+
+void * memory_realloc(void *ptr, size_t size, int category) {
+
+	if (ptr == NULL) return memory_malloc(size, category);
+
+	t_memory_header *header = (t_memory_header *)ptr - 1;
+	size_t old_size = header->info.size;
+	category = header->info.category;
+
+	header = (t_memory_header *)realloc(header, sizeof(t_memory_header) + size);
+	if (header == NULL) {
+		fprintf(stderr, "distdir: realloc of %zu bytes failed!\n", size);
+		exit(EXIT_FAILURE);
+	}
+
+	header->info.size = size;
+	memory_sub(category, old_size);
+	memory_add(category, size);
+
+	return header + 1;
+}
+
+static size_t memory_hash(const void *ptr) {
+
+	/* the low bits of aligned pointers are zero, the high bits of the product are folded */
+	uint64_t key = (uint64_t)(uintptr_t)ptr * 0x9E3779B97F4A7C15ULL;
+	return (size_t)(key ^ (key >> 32));
+}
+
+/* insert an entry in the table of the aligned memory, called with the mutex held */
+static void memory_aligned_insert(t_memory_entry entry) {
+
+	if (2 * (naligned + 1) > aligned_capacity) {
+		t_memory_entry *old = aligned_entries;
+		size_t old_capacity = aligned_capacity;
+		aligned_capacity = aligned_capacity > 0 ? 2 * aligned_capacity : 64;
+		aligned_entries = (t_memory_entry *)calloc(aligned_capacity, sizeof(t_memory_entry));
+		if (aligned_entries == NULL) {
+			fprintf(stderr, "distdir: calloc of %zu bytes failed!\n", aligned_capacity * sizeof(t_memory_entry));
+			exit(EXIT_FAILURE);
+		}
+		for (size_t i = 0; i < old_capacity; i++)
+			if (old[i].ptr != NULL) {
+				size_t slot = memory_hash(old[i].ptr) & (aligned_capacity - 1);
+				while (aligned_entries[slot].ptr != NULL) slot = (slot + 1) & (aligned_capacity - 1);
+				aligned_entries[slot] = old[i];
+			}
+		free(old);
+	}
+
+	size_t slot = memory_hash(entry.ptr) & (aligned_capacity - 1);
+	while (aligned_entries[slot].ptr != NULL) slot = (slot + 1) & (aligned_capacity - 1);
+	aligned_entries[slot] = entry;
+	__atomic_store_n(&naligned, naligned + 1, __ATOMIC_RELAXED);
+}
+
+/* remove an entry of the table of the aligned memory and return 1 if it is found,
+ * called with the mutex held */
+static int memory_aligned_remove(void *ptr, t_memory_entry *entry) {
+
+	if (aligned_capacity == 0) return 0;
+
+	size_t mask = aligned_capacity - 1;
+	size_t slot = memory_hash(ptr) & mask;
+	while (aligned_entries[slot].ptr != ptr) {
+		if (aligned_entries[slot].ptr == NULL) return 0;
+		slot = (slot + 1) & mask;
+	}
+	*entry = aligned_entries[slot];
+
+	/* the following entries of the cluster are shifted back, so no entry is
+	 * separated from its home slot by an empty slot */
+	size_t hole = slot;
+	for (size_t next = (slot + 1) & mask; aligned_entries[next].ptr != NULL; next = (next + 1) & mask) {
+		size_t home = memory_hash(aligned_entries[next].ptr) & mask;
+		if (((next - home) & mask) >= ((next - hole) & mask)) {
+			aligned_entries[hole] = aligned_entries[next];
+			hole = next;
+		}
+	}
+	aligned_entries[hole].ptr = NULL;
+	__atomic_store_n(&naligned, naligned - 1, __ATOMIC_RELAXED);
+
+	return 1;
+}
+
+void * memory_aligned_alloc(size_t alignment, size_t size, int category) {
+
+	void *ptr;
+	if (posix_memalign(&ptr, alignment, size) != 0) {
+		fprintf(stderr, "distdir: posix_memalign of %zu bytes failed!\n", size);
+		exit(EXIT_FAILURE);
+	}
+
+	t_memory_entry entry = {ptr, size, category};
+	pthread_mutex_lock(&memory_mutex);
+	memory_aligned_insert(entry);
+	if (alignment < aligned_min) __atomic_store_n(&aligned_min, alignment, __ATOMIC_RELAXED);
+	pthread_mutex_unlock(&memory_mutex);
+
+	memory_add(category, size);
+
+	return ptr;
+}
+
+void memory_free(void *ptr) {
+
+	if (ptr == NULL) return;
+
+	/* only the pointers with the alignment of the aligned memory are looked up */
+	size_t alignment = __atomic_load_n(&aligned_min, __ATOMIC_RELAXED);
+	if (__atomic_load_n(&naligned, __ATOMIC_RELAXED) > 0 && ((uintptr_t)ptr & (alignment - 1)) == 0) {
+		t_memory_entry entry;
+		pthread_mutex_lock(&memory_mutex);
+		int found = memory_aligned_remove(ptr, &entry);
+		pthread_mutex_unlock(&memory_mutex);
+		if (found) {
+			memory_sub(entry.category, entry.size);
+			free(ptr);
+			return;
+		}
+	}
+
+	t_memory_header *header = (t_memory_header *)ptr - 1;
+	memory_sub(header->info.category, header->info.size);
+	free(header);
+}
+
+void memory_register(void *ptr, size_t size, int category) {
+
+	pthread_mutex_lock(&memory_mutex);
+
+	if (nentries == capacity) {
+		capacity = capacity > 0 ? 2 * capacity : 16;
+		entries = (t_memory_entry *)realloc(entries, capacity * sizeof(t_memory_entry));
+	}
+	entries[nentries].ptr = ptr;
+	entries[nentries].size = size;
+	entries[nentries].category = category;
+	nentries++;
+
+	pthread_mutex_unlock(&memory_mutex);
+
+	memory_add(category, size);
+}
+
+int memory_unregister(void *ptr) {
+
+	pthread_mutex_lock(&memory_mutex);
+
+	/* the latest entries are usually freed first */
+	int found = 0;
+	for (int i = nentries - 1; i >= 0; i--) {
+		if (entries[i].ptr == ptr) {
+			memory_sub(entries[i].category, entries[i].size);
+			entries[i] = entries[nentries - 1];
+			nentries--;
+			found = 1;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&memory_mutex);
+
+	return found;
+}
+
+void memory_get_report(t_memory_report *report) {
+
+	for (int i = 0; i <= MEMORY_NCATEGORIES; i++) {
+		t_memory_usage *usage = i < MEMORY_NCATEGORIES ? &report->category[i] : &report->total;
+		usage->current = __atomic_load_n(&memory_current[i], __ATOMIC_RELAXED);
+		usage->peak = __atomic_load_n(&memory_peak[i], __ATOMIC_RELAXED);
+		usage->global_current = usage->current;
+		usage->global_peak = usage->peak;
+	}
+}
+
+void distdir_memory_report(t_memory_report *report) {
+
+	memory_get_report(report);
+
+	unsigned long long values[2 * (MEMORY_NCATEGORIES + 1)];
+	for (int i = 0; i <= MEMORY_NCATEGORIES; i++) {
+		t_memory_usage *usage = i < MEMORY_NCATEGORIES ? &report->category[i] : &report->total;
+		values[2 * i] = usage->current;
+		values[2 * i + 1] = usage->peak;
+	}
+
+	check_mpi( MPI_Allreduce(MPI_IN_PLACE, values, 2 * (MEMORY_NCATEGORIES + 1), MPI_UNSIGNED_LONG_LONG,
+	                         MPI_MAX, get_config_comm()) );
+
+	for (int i = 0; i <= MEMORY_NCATEGORIES; i++) {
+		t_memory_usage *usage = i < MEMORY_NCATEGORIES ? &report->category[i] : &report->total;
+		usage->global_current = (size_t)values[2 * i];
+		usage->global_peak = (size_t)values[2 * i + 1];
+	}
+}
@@ -0,0 +1,220 @@
+/*
+ * @file memory.h
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief number of memory categories */
+#define MEMORY_NCATEGORIES 5
+
+/** @enum distdir_memory_category
+ * 
+ *  @brief Enum for the categories of the memory held by the library
+ * 
+ *  @details The categories are the index lists (t_idxlist), the indices and offsets
+ *           of the messages of the maps (t_map), the buffers, requests and stages of
+ *           the exchangers (t_exchanger), the transient workspace of new_map and of
+ *           the reports, and the timers, the trace and the communication statistics.
+ * 
+ */
+enum distdir_memory_category {
+	memory_idxlist         = 0,
+	memory_map             = 1,
+	memory_exchange        = 2,
+	memory_workspace       = 3,
+	memory_instrumentation = 4
+};
+
+/** @struct t_memory_usage
+ * 
+ *  @brief The structure contains the memory held in one category
+ * 
+ */
+struct t_memory_usage {
+	/** @brief bytes currently allocated */
+	size_t current;
+	/** @brief highest number of bytes allocated at the same time */
+	size_t peak;
+	/** @brief maximum among the processes of the bytes currently allocated */
+	size_t global_current;
+	/** @brief maximum among the processes of the peak */
+	size_t global_peak;
+};
+typedef struct t_memory_usage t_memory_usage;
+
+/** @struct t_memory_report
+ * 
+ *  @brief The structure contains the memory held by the library
+ * 
+ *  @details The total peak is the highest sum of all the categories at the same time,
+ *           so it can be lower than the sum of the peaks of the categories.
+ * 
+ */
+struct t_memory_report {
+	/** @brief memory of each category (distdir_memory_category) */
+	t_memory_usage category[MEMORY_NCATEGORIES];
+	/** @brief memory of all the categories */
+	t_memory_usage total;
+};
+typedef struct t_memory_report t_memory_report;
+
+/**
+ * @brief Allocate tracked memory.
+ * 
+ * @details The size and the category are stored in a header before the returned memory,
+ *          which is aligned as the memory returned by malloc. It exits if the
+ *          allocation fails. The memory is freed with \c memory_free.
+ * 
+ * @param[in] size     size in bytes
+ * @param[in] category category of the memory (distdir_memory_category)
+ * 
+ * @return pointer to the allocated memory
+ * 
+ * @ingroup memory
+ */
+void * memory_malloc(size_t size, int category);
+
+/**
+ * @brief Allocate tracked memory set to zero.
+ * 
+ * @param[in] nmemb    number of elements
+ * @param[in] size     size in bytes of an element
+ * @param[in] category category of the memory (distdir_memory_category)
+ * 
+ * @return pointer to the allocated memory
+ * 
+ * @ingroup memory
+ */
+void * memory_calloc(size_t nmemb, size_t size, int category);
+
+/**
+ * @brief Resize tracked memory.
+ * 
+ * @details As realloc for the memory allocated by \c memory_malloc or \c memory_calloc
+ *          (or NULL). The memory keeps its category. It exits if the allocation fails.
+ * 
+ * @param[in] ptr      pointer to the memory (it can be NULL)
+ * @param[in] size     new size in bytes
+ * @param[in] category category of the memory if ptr is NULL (distdir_memory_category)
+ * 
+ * @return pointer to the resized memory
+ * 
+ * @ingroup memory
+ */
+void * memory_realloc(void *ptr, size_t size, int category);
+
+/**
+ * @brief Allocate tracked memory with a given alignment.
+ * 
+ * @details The memory has no header (the alignment can be a huge page), it is
+ *          stored in a hash table instead. The memory is freed with \c memory_free,
+ *          which looks up only the pointers with the alignment of the aligned memory.
+ * 
+ * @param[in] alignment alignment in bytes (power of two multiple of sizeof(void *))
+ * @param[in] size      size in bytes
+ * @param[in] category  category of the memory (distdir_memory_category)
+ * 
+ * @return pointer to the allocated memory
+ * 
+ * @ingroup memory
+ */
+void * memory_aligned_alloc(size_t alignment, size_t size, int category);
+
+/**
+ * @brief Free memory allocated by \c memory_malloc, \c memory_calloc or \c memory_aligned_alloc.
+ * 
+ * @param[in] ptr pointer to the memory (NULL is ignored)
+ * 
+ * @ingroup memory
+ */
+void memory_free(void *ptr);
+
+/**
+ * @brief Register memory allocated outside of the tracked allocator (e.g. device memory).
+ * 
+ * @details The memory is not freed by \c memory_free, it is removed with \c memory_unregister.
+ * 
+ * @param[in] ptr      pointer to the memory
+ * @param[in] size     size in bytes
+ * @param[in] category category of the memory (distdir_memory_category)
+ * 
+ * @ingroup memory
+ */
+void memory_register(void *ptr, size_t size, int category);
+
+/**
+ * @brief Remove registered memory before it is freed.
+ * 
+ * @param[in] ptr pointer to the memory
+ * 
+ * @return 1 if the memory was registered, 0 otherwise
+ * 
+ * @ingroup memory
+ */
+int memory_unregister(void *ptr);
+
+/**
+ * @brief Get the memory held by the library on the calling process.
+ * 
+ * @details The global fields are set to the local values.
+ * 
+ * @param[out] report pointer to t_memory_report structure
+ * 
+ * @ingroup memory
+ */
+void memory_get_report(t_memory_report *report);
+
+/**
+ * @brief Get the memory held by the library.
+ * 
+ * @details Collective call over the communicator of the library (\c set_config_comm).
+ *          The local fields are the memory of the calling process and the global
+ *          fields are the maximum among the processes.
+ * 
+ * @param[out] report pointer to t_memory_report structure
+ * 
+ * @ingroup memory
+ */
+void distdir_memory_report(t_memory_report *report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
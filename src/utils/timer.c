@@ -33,285 +33,655 @@
 
 
 #include <stdio.h>
-#include <sys/types.h>
-#include <sys/stat.h>
+#include <stdarg.h>
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
-#include <dirent.h>
-
-#define __USE_XOPEN_EXTENDED
-#include <ftw.h>
+#include <pthread.h>
 
 #include "src/utils/timer.h"
+#include "src/utils/trace.h"
 #include "src/utils/check.h"
+#include "src/utils/memory.h"
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define TIMER_THREAD_LOCAL _Thread_local
+#else
+#define TIMER_THREAD_LOCAL __thread
+#endif
 
+/* table of the timers (timer ID i is stored at index i-1) */
+static t_timer_data *timers = NULL;
 static int timer_count = 0;
-static t_list_node *list_head = NULL;
+static int timers_size = 0;
 
-static int new_timer_node(t_list_node **list_tail, const char * timer_name) {
+/* list of the timers of all the threads */
+static t_timer_thread *thread_head = NULL;
+static int thread_count = 0;
 
-	timer_count++;
-	t_timer_data *timer_data = (t_timer_data *)malloc(sizeof(t_timer_data));
-	timer_data->id = timer_count;
-	timer_data->name = strdup(timer_name);
-	timer_data->total_time = 0.0;
-	timer_data->start_time = -1.0;
-	
-	t_list_node *new_node = (t_list_node *)malloc(sizeof(t_list_node));
-	new_node->data = timer_data;
-	new_node->next = NULL;
-
-	// if the list_tail is empty, it means that the list is empty
-	if (*list_tail == NULL) {
-		// Create first element of the list
-		(*list_tail) = new_node;
-	} else {
-
-		// Add new node to the list
-		(*list_tail)->next = new_node;
-	}
+/* incremented by delete_timers to invalidate the structures of the threads */
+static int timers_generation = 0;
 
-	return timer_count;
-}
+static int timers_active = 1;
 
-int new_timer(const char * timer_name) {
+static pthread_mutex_t timer_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-	int timer_id = -1;
+static TIMER_THREAD_LOCAL t_timer_thread *timer_thread = NULL;
+static TIMER_THREAD_LOCAL int timer_thread_generation = -1;
 
-	if (timer_count == 0) {
+/* regions of the timers started while the timers are not active, they are only
+ * reported to the trace and to the hooks (the flag is set if the begin is reported) */
+static TIMER_THREAD_LOCAL double trace_begin_time[TIMER_MAX_DEPTH];
+static TIMER_THREAD_LOCAL int trace_reported[TIMER_MAX_DEPTH];
+static TIMER_THREAD_LOCAL int trace_depth = 0;
 
-		// The list is empty so the timer is created
-		timer_id = new_timer_node(&list_head, timer_name);
-	} else {
+int new_timer(const char * timer_name) {
 
-		t_list_node *list_iterator = list_head;
+	return new_timer_region(timer_name, -1);
+}
 
-		// check if timer already exist
-		while (list_iterator->next != NULL) {
+int new_timer_region(const char * timer_name, int region) {
 
-			if (strcmp(timer_name, list_iterator->data->name) == 0) {
-				timer_id = list_iterator->data->id;
-				return timer_id;
-			}
-			list_iterator = list_iterator->next;
-		}
+	pthread_mutex_lock(&timer_mutex);
 
-		// check for last element of the list
-		if (strcmp(timer_name, list_iterator->data->name) == 0) {
-			timer_id = list_iterator->data->id;
-			return timer_id;
+	// check if timer already exist (done once per timer by the callers)
+	for (int i = 0; i < timer_count; i++) {
+		if (strcmp(timer_name, timers[i].name) == 0) {
+			pthread_mutex_unlock(&timer_mutex);
+			return timers[i].id;
 		}
+	}
 
-		// The timer does not exist so it is created
-		if (timer_id == -1)
-			timer_id = new_timer_node(&list_iterator, timer_name);
+	// The timer does not exist so it is created
+	if (timer_count == timers_size) {
+		timers_size = timers_size > 0 ? 2 * timers_size : 32;
+		timers = (t_timer_data *)memory_realloc(timers, timers_size * sizeof(t_timer_data),
+		                                        memory_instrumentation);
 	}
+	timers[timer_count].id = timer_count + 1;
+	timers[timer_count].name = (char *)memory_malloc(strlen(timer_name) + 1, memory_instrumentation);
+	strcpy(timers[timer_count].name, timer_name);
+	// the user-defined timers follow the fixed regions
+	timers[timer_count].region = region >= 0 ? region : region_timer + timer_count + 1;
+	timer_count++;
+
+	int timer_id = timer_count;
+	pthread_mutex_unlock(&timer_mutex);
+
 	return timer_id;
 }
 
-void timer_start(int timer_id) {
+static int timer_thread_new_node(t_timer_thread *thread, int parent, int timer_id) {
+
+	// the nodes are read by the other threads under the mutex (timer_calls, timers_report)
+	pthread_mutex_lock(&timer_mutex);
+
+	if (thread->nnodes == thread->nodes_size) {
+		thread->nodes_size *= 2;
+		thread->nodes = (t_timer_node *)memory_realloc(thread->nodes,
+		                                               thread->nodes_size * sizeof(t_timer_node),
+		                                               memory_instrumentation);
+	}
+
+	int node = thread->nnodes++;
+	thread->nodes[node].timer_id       = timer_id;
+	thread->nodes[node].name           = NULL;
+	thread->nodes[node].region         = region_timer;
+	thread->nodes[node].parent         = parent;
+	thread->nodes[node].first_child    = -1;
+	thread->nodes[node].next_sibling   = -1;
+	thread->nodes[node].calls          = 0;
+	thread->nodes[node].inclusive_time = 0.0;
+	thread->nodes[node].self_time      = 0.0;
+
+	if (timer_id > 0) {
+		thread->nodes[node].name   = timers[timer_id - 1].name;
+		thread->nodes[node].region = timers[timer_id - 1].region;
+	}
+
+	// the children are kept in the order of their first call
+	if (parent != -1) {
+		int *last = &thread->nodes[parent].first_child;
+		while (*last != -1)
+			last = &thread->nodes[*last].next_sibling;
+		*last = node;
+	}
+
+	pthread_mutex_unlock(&timer_mutex);
+
+	return node;
+}
+
+static t_timer_thread *timer_thread_get() {
+
+	// the generation is checked first: after delete_timers the structure
+	// pointed by timer_thread is freed and must not be accessed
+	if (timer_thread_generation == timers_generation && timer_thread != NULL)
+		return timer_thread;
+
+	t_timer_thread *thread = (t_timer_thread *)memory_malloc(sizeof(t_timer_thread), memory_instrumentation);
+	thread->nnodes     = 0;
+	thread->nodes_size = 64;
+	thread->nodes      = (t_timer_node *)memory_malloc(thread->nodes_size * sizeof(t_timer_node),
+	                                                   memory_instrumentation);
+	thread->ntimers    = 0;
+	thread->last_node  = NULL;
+	thread->active     = NULL;
+	thread->total_time = NULL;
+	thread->depth      = 0;
+
+	// the root of the tree is never stopped
+	thread->stack[0].node       = timer_thread_new_node(thread, -1, 0);
+	thread->stack[0].start_time = 0.0;
+	thread->stack[0].child_time = 0.0;
+
+	pthread_mutex_lock(&timer_mutex);
+	thread->thread_id  = thread_count++;
+	thread->generation = timers_generation;
+	thread->next       = thread_head;
+	thread_head        = thread;
+	pthread_mutex_unlock(&timer_mutex);
+
+	timer_thread = thread;
+	timer_thread_generation = thread->generation;
+	return thread;
+}
+
+/* resize the arrays indexed by timer ID of a thread */
+static void timer_thread_resize(t_timer_thread *thread, int timer_id) {
+
+	int ntimers = 2 * thread->ntimers > timer_id + 1 ? 2 * thread->ntimers : timer_id + 1;
+
+	// the arrays are read by the other threads under the mutex (timer_total_time)
+	pthread_mutex_lock(&timer_mutex);
+	thread->last_node  = (int *)memory_realloc(thread->last_node, ntimers * sizeof(int),
+	                                           memory_instrumentation);
+	thread->active     = (int *)memory_realloc(thread->active, ntimers * sizeof(int),
+	                                           memory_instrumentation);
+	thread->total_time = (double *)memory_realloc(thread->total_time, ntimers * sizeof(double),
+	                                              memory_instrumentation);
+	for (int i = thread->ntimers; i < ntimers; i++) {
+		thread->last_node[i]  = -1;
+		thread->active[i]     = 0;
+		thread->total_time[i] = 0.0;
+	}
+	thread->ntimers = ntimers;
+	pthread_mutex_unlock(&timer_mutex);
+}
+
+/* report the region of a timer to the trace and to the hooks without timing it */
+static void timer_trace_start(int timer_id) {
 
 #ifdef ERROR_CHECK
-	assert(list_head != NULL);
+	assert(trace_depth < TIMER_MAX_DEPTH);
 #endif
 
-	t_list_node *list_iterator = list_head;
-	t_timer_data *timer_data = NULL;
-	while (timer_data == NULL && list_iterator != NULL) {
+	trace_reported[trace_depth] = trace_flags != 0;
+	if (trace_reported[trace_depth]) {
+		pthread_mutex_lock(&timer_mutex);
+		int region = timers[timer_id - 1].region;
+		const char *name = timers[timer_id - 1].name;
+		pthread_mutex_unlock(&timer_mutex);
+		trace_begin_time[trace_depth] = trace_begin(region, name, -1, 0);
+	}
+	trace_depth++;
+}
+
+static void timer_trace_stop(int timer_id) {
+
+#ifdef ERROR_CHECK
+	assert(trace_depth > 0);
+#endif
+
+	trace_depth--;
+	if (trace_reported[trace_depth]) {
+		pthread_mutex_lock(&timer_mutex);
+		int region = timers[timer_id - 1].region;
+		const char *name = timers[timer_id - 1].name;
+		pthread_mutex_unlock(&timer_mutex);
+		trace_end(region, name, -1, 0, trace_begin_time[trace_depth]);
+	}
+}
+
+void timer_start(int timer_id) {
 
-		if (timer_id == list_iterator->data->id)
-			timer_data = list_iterator->data;
-		list_iterator = list_iterator->next;
+#ifndef DISTDIR_NO_TIMERS
+	if (!timers_active) {
+		timer_trace_start(timer_id);
+		return;
 	}
 
+	t_timer_thread *thread = timer_thread_get();
+
 #ifdef ERROR_CHECK
-	assert(timer_data != NULL);
-	assert(timer_data->start_time == -1.0);
+	assert(timer_id > 0 && timer_id <= timer_count);
+	assert(thread->depth < TIMER_MAX_DEPTH);
 #endif
 
-	timer_data->start_time = MPI_Wtime();
+	if (timer_id >= thread->ntimers)
+		timer_thread_resize(thread, timer_id);
+
+	// a timer is almost always nested in the same parent, so the last node
+	// used by the timer is checked before the children of the parent
+	int parent = thread->stack[thread->depth].node;
+	int node = thread->last_node[timer_id];
+	if (node == -1 || thread->nodes[node].parent != parent) {
+		node = thread->nodes[parent].first_child;
+		while (node != -1 && thread->nodes[node].timer_id != timer_id)
+			node = thread->nodes[node].next_sibling;
+		if (node == -1)
+			node = timer_thread_new_node(thread, parent, timer_id);
+		thread->last_node[timer_id] = node;
+	}
 
+	thread->active[timer_id]++;
+	thread->depth++;
+	t_timer_frame *frame = &thread->stack[thread->depth];
+	frame->node       = node;
+	frame->child_time = 0.0;
+
+	// the begin hook is not timed
+	trace_begin(thread->nodes[node].region, thread->nodes[node].name, -1, 0);
+	frame->start_time = MPI_Wtime();
+#else
+	timer_trace_start(timer_id);
+#endif
 }
 
 void timer_stop(int timer_id) {
 
+#ifndef DISTDIR_NO_TIMERS
+	if (!timers_active) {
+		timer_trace_stop(timer_id);
+		return;
+	}
+
+	double stop_time = MPI_Wtime();
+
+	t_timer_thread *thread = timer_thread_get();
+
 #ifdef ERROR_CHECK
-	assert(list_head != NULL);
+	assert(thread->depth > 0);
+	assert(thread->nodes[thread->stack[thread->depth].node].timer_id == timer_id);
 #endif
 
-	t_list_node *list_iterator = list_head;
-	t_timer_data *timer_data = NULL;
-	while (timer_data == NULL && list_iterator != NULL) {
+	t_timer_frame *frame = &thread->stack[thread->depth];
+	t_timer_node *node = &thread->nodes[frame->node];
+	double time = stop_time - frame->start_time;
 
-		if (timer_id == list_iterator->data->id)
-			timer_data = list_iterator->data;
-		list_iterator = list_iterator->next;
-	}
+	node->calls++;
+	node->inclusive_time += time;
+	node->self_time      += time - frame->child_time;
 
-#ifdef ERROR_CHECK
-	assert(timer_data != NULL);
-	assert(timer_data->start_time != -1.0);
+	thread->depth--;
+	thread->stack[thread->depth].child_time += time;
+
+	// nested calls of the same timer are counted once
+	if (--thread->active[timer_id] == 0)
+		thread->total_time[timer_id] += time;
+
+	trace_end(node->region, node->name, -1, 0, frame->start_time);
+#else
+	timer_trace_stop(timer_id);
 #endif
+}
 
-	timer_data->total_time += (MPI_Wtime() - timer_data->start_time) ;
-	timer_data->start_time = -1.0;
+void timers_set_active(int active) {
+
+	timers_active = active;
 }
 
-static int unlink_cb(const char *fpath, const struct stat *sb, int typeflag, struct FTW *ftwbuf)
-{
+int timers_get_active() {
+
+	return timers_active;
+}
 
-	int rv = remove(fpath);
+double timer_total_time(int timer_id) {
 
-	if (rv)
-		perror(fpath);
+	double total_time = 0.0;
 
-	return rv;
+	pthread_mutex_lock(&timer_mutex);
+	for (t_timer_thread *thread = thread_head; thread != NULL; thread = thread->next)
+		if (timer_id < thread->ntimers)
+			total_time += thread->total_time[timer_id];
+	pthread_mutex_unlock(&timer_mutex);
+
+	return total_time;
 }
 
-static int rmrf(char *path)
-{
+int timer_calls(int timer_id) {
+
+	int calls = 0;
+
+	pthread_mutex_lock(&timer_mutex);
+	for (t_timer_thread *thread = thread_head; thread != NULL; thread = thread->next)
+		for (int node = 1; node < thread->nnodes; node++)
+			if (thread->nodes[node].timer_id == timer_id)
+				calls += thread->nodes[node].calls;
+	pthread_mutex_unlock(&timer_mutex);
 
-	return nftw(path, unlink_cb, 64, FTW_DEPTH | FTW_PHYS);
+	return calls;
 }
 
-void timers_report() {
+/* text of the report of a process */
+struct t_timer_string {
+	char *data;
+	size_t length;
+	size_t size;
+};
+typedef struct t_timer_string t_timer_string;
+
+static void timer_append(t_timer_string *string, const char *format, ...) {
+
+	va_list args;
+	va_start(args, format);
+	int length = vsnprintf(NULL, 0, format, args);
+	va_end(args);
+
+	if (string->length + length + 1 > string->size) {
+		while (string->length + length + 1 > string->size)
+			string->size = string->size > 0 ? 2 * string->size : 4096;
+		string->data = (char *)memory_realloc(string->data, string->size, memory_workspace);
+	}
 
-	int world_rank;
-	check_mpi( MPI_Comm_rank(MPI_COMM_WORLD, &world_rank) );
+	va_start(args, format);
+	vsnprintf(string->data + string->length, length + 1, format, args);
+	va_end(args);
+	string->length += length;
+}
 
-	MPI_Comm comm;
+/* write a node of the call tree and its children (depth first) */
+static void timer_write_node(t_timer_string *string, t_timer_thread *thread, int node, int level) {
 
-	// Create communicator with ranks having timers
-	// This is needed for collective communication later on
-	int comm_id = list_head != NULL ? 0 : 1;
-	check_mpi( MPI_Comm_split(MPI_COMM_WORLD, comm_id, 0, &comm) );
+	t_timer_node *timer_node = &thread->nodes[node];
 
-	if (list_head == NULL)
-		return;
+	char name[STRING_MAX];
+	snprintf(name, sizeof(name), "%*s%s", 2 * level, "", timers[timer_node->timer_id - 1].name);
+	timer_append(string, "%-40s | %8d | %.5e | %.5e |\n", name,
+	                                                      timer_node->calls,
+	                                                      timer_node->inclusive_time,
+	                                                      timer_node->self_time);
 
-	int comm_rank;
-	check_mpi( MPI_Comm_rank(comm, &comm_rank) );
+	for (int child = timer_node->first_child; child != -1; child = thread->nodes[child].next_sibling)
+		timer_write_node(string, thread, child, level + 1);
+}
 
-	int comm_size;
+static int timer_compare_names(const void *a, const void *b) {
+
+	return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/* hash of the sorted names of the timers (FNV-1a) */
+static unsigned long long timer_hash_names(char **names, int count) {
+
+	unsigned long long hash = 14695981039346656037ULL;
+	for (int i = 0; i < count; i++)
+		for (const char *c = names[i]; ; c++) {
+			hash = (hash ^ (unsigned char)*c) * 1099511628211ULL;
+			if (*c == '\0') break;
+		}
+
+	return hash;
+}
+
+/* union of the names of the timers of all the processes (sorted, allocated in *buffer) */
+static int timer_union_names(char **names, int count, MPI_Comm comm, char **buffer, char ***union_names) {
+
+	int comm_rank, comm_size;
+	check_mpi( MPI_Comm_rank(comm, &comm_rank) );
 	check_mpi( MPI_Comm_size(comm, &comm_size) );
 
-	char directory_name[STRING_MAX] = "reports";
+	int length = 0;
+	for (int i = 0; i < count; i++)
+		length += strlen(names[i]) + 1;
+	char *local = (char *)memory_malloc((length > 0 ? length : 1) * sizeof(char), memory_workspace);
+	for (int i = 0, offset = 0; i < count; i++) {
+		strcpy(local + offset, names[i]);
+		offset += strlen(names[i]) + 1;
+	}
 
-	// Create reports directory and delete it first if already exists
+	int *lengths = NULL, *displs = NULL;
+	char *all = NULL;
 	if (comm_rank == 0) {
-		DIR* dir = opendir(directory_name);
-		if (dir) {
-
-			closedir(dir);
-			if (rmrf(directory_name) != 0 ) {
+		lengths = (int *)memory_malloc(comm_size * sizeof(int), memory_workspace);
+		displs = (int *)memory_malloc(comm_size * sizeof(int), memory_workspace);
+	}
+	check_mpi( MPI_Gather(&length, 1, MPI_INT, lengths, 1, MPI_INT, 0, comm) );
 
-				printf("Error deleting reports directory\n");
-				exit(EXIT_FAILURE);
-			}
+	int total = 0;
+	if (comm_rank == 0) {
+		for (int i = 0; i < comm_size; i++) {
+			displs[i] = total;
+			total += lengths[i];
 		}
+		all = (char *)memory_malloc((total > 0 ? total : 1) * sizeof(char), memory_workspace);
+	}
+	check_mpi( MPI_Gatherv(local, length, MPI_CHAR, all, lengths, displs, MPI_CHAR, 0, comm) );
+	memory_free(local);
 
-		if (mkdir("reports", S_IRWXU | S_IRWXG | S_IRWXO) == -1) {
+	// the root keeps the sorted names without duplicates
+	int union_length = 0;
+	if (comm_rank == 0) {
+		int nall = 0;
+		for (int i = 0; i < total; i++)
+			if (all[i] == '\0') nall++;
+		char **all_names = (char **)memory_malloc((nall > 0 ? nall : 1) * sizeof(char *), memory_workspace);
+		for (int i = 0, offset = 0; i < nall; i++) {
+			all_names[i] = all + offset;
+			offset += strlen(all_names[i]) + 1;
+		}
+		qsort(all_names, nall, sizeof(char *), timer_compare_names);
 
-			printf("Error creating reports directory\n");
-			exit(EXIT_FAILURE);
+		*buffer = (char *)memory_malloc((total > 0 ? total : 1) * sizeof(char), memory_workspace);
+		for (int i = 0; i < nall; i++) {
+			if (i > 0 && strcmp(all_names[i], all_names[i-1]) == 0) continue;
+			strcpy(*buffer + union_length, all_names[i]);
+			union_length += strlen(all_names[i]) + 1;
 		}
+		memory_free(all_names);
+		memory_free(all);
+		memory_free(lengths);
+		memory_free(displs);
 	}
 
-	check_mpi( MPI_Barrier(comm) );
+	check_mpi( MPI_Bcast(&union_length, 1, MPI_INT, 0, comm) );
+	if (comm_rank != 0)
+		*buffer = (char *)memory_malloc((union_length > 0 ? union_length : 1) * sizeof(char),
+		                                memory_workspace);
+	check_mpi( MPI_Bcast(*buffer, union_length, MPI_CHAR, 0, comm) );
+
+	int union_count = 0;
+	for (int i = 0; i < union_length; i++)
+		if ((*buffer)[i] == '\0') union_count++;
+	*union_names = (char **)memory_malloc((union_count > 0 ? union_count : 1) * sizeof(char *),
+	                                      memory_workspace);
+	for (int i = 0, offset = 0; i < union_count; i++) {
+		(*union_names)[i] = *buffer + offset;
+		offset += strlen((*union_names)[i]) + 1;
+	}
 
-	// Create full path to report files
-	char filename[STRING_MAX];
-	snprintf(filename, sizeof(filename), "/distdir_report_%d.dat", comm_rank);
+	return union_count;
+}
+
+/* reduction of the statistics of the timers (sum, min and max of the time and sum of the calls) */
+static void timer_reduce_stats(void *in, void *inout, int *len, MPI_Datatype *type) {
 
-	char filenamepath[STRING_MAX] = "";
-	strcat(filenamepath, directory_name);
-	strcat(filenamepath, filename);
+	(void)type;
 
-	FILE *fptr;
+	double *a = (double *)in;
+	double *b = (double *)inout;
+	for (int i = 0; i < *len; i++) {
+		b[4*i+0] += a[4*i+0];
+		b[4*i+1]  = a[4*i+1] < b[4*i+1] ? a[4*i+1] : b[4*i+1];
+		b[4*i+2]  = a[4*i+2] > b[4*i+2] ? a[4*i+2] : b[4*i+2];
+		b[4*i+3] += a[4*i+3];
+	}
+}
 
-	// Open a file in writing mode
-	fptr = fopen(filenamepath, "w");
+void timers_report(MPI_Comm comm, const char *path, int per_rank) {
 
-	// header
-	fprintf(fptr, "%-30s | %-11s |\n", "Name", "Time [s]");
-	fprintf(fptr, "----------------------------------------------\n");
+	int comm_rank, comm_size;
+	check_mpi( MPI_Comm_rank(comm, &comm_rank) );
+	check_mpi( MPI_Comm_size(comm, &comm_size) );
 
-	// Write some text to the file
-	t_list_node *list_iterator = list_head;
-	while (list_iterator != NULL) {
-		fprintf(fptr, "%-30s | %.5e |\n", list_iterator->data->name, list_iterator->data->total_time);
-		list_iterator = list_iterator->next;
+	pthread_mutex_lock(&timer_mutex);
+	int count = timer_count;
+	char **names = (char **)memory_malloc((count > 0 ? count : 1) * sizeof(char *), memory_workspace);
+	for (int i = 0; i < count; i++)
+		names[i] = timers[i].name;
+	pthread_mutex_unlock(&timer_mutex);
+
+	qsort(names, count, sizeof(char *), timer_compare_names);
+
+	// the processes usually create the same timers, then the names are not exchanged
+	unsigned long long hash[2];
+	hash[0] = timer_hash_names(names, count) ^ (unsigned long long)count;
+	hash[1] = ~hash[0];
+	check_mpi( MPI_Allreduce(MPI_IN_PLACE, hash, 2, MPI_UNSIGNED_LONG_LONG, MPI_MAX, comm) );
+
+	char *union_buffer = NULL;
+	char **union_names = names;
+	int union_count = count;
+	if (hash[0] != ~hash[1])
+		union_count = timer_union_names(names, count, comm, &union_buffer, &union_names);
+
+	// one reduction for all the timers
+	double *stats = (double *)memory_malloc((union_count > 0 ? 4 * union_count : 1) * sizeof(double),
+	                                        memory_workspace);
+	for (int i = 0, j = 0; i < union_count; i++) {
+		while (j < count && strcmp(names[j], union_names[i]) < 0) j++;
+		double time = 0.0;
+		double calls = 0.0;
+		if (j < count && strcmp(names[j], union_names[i]) == 0) {
+			int timer_id = new_timer(names[j]);
+			time = timer_total_time(timer_id);
+			calls = (double)timer_calls(timer_id);
+		}
+		stats[4*i+0] = time;
+		stats[4*i+1] = time;
+		stats[4*i+2] = time;
+		stats[4*i+3] = calls;
 	}
 
-	// Close the file
-	fclose(fptr);
+	MPI_Datatype stats_type;
+	check_mpi( MPI_Type_contiguous(4, MPI_DOUBLE, &stats_type) );
+	check_mpi( MPI_Type_commit(&stats_type) );
+	MPI_Op stats_op;
+	check_mpi( MPI_Op_create(timer_reduce_stats, 1, &stats_op) );
+	check_mpi( MPI_Reduce(comm_rank == 0 ? MPI_IN_PLACE : stats, stats, union_count,
+	                      stats_type, stats_op, 0, comm) );
+	check_mpi( MPI_Op_free(&stats_op) );
+	check_mpi( MPI_Type_free(&stats_type) );
+
+	t_timer_string string = {NULL, 0, 0};
 
-	// Create report summary
-	char filenamesummarypath[STRING_MAX] = "";
-	strcat(filenamesummarypath, directory_name);
-	strcat(filenamesummarypath, "/distdir_report_summary.dat");
-	// Open a file in writing mode
+	// summary
 	if (comm_rank == 0) {
-		fptr = fopen(filenamesummarypath, "w");
-
-		// header
-		fprintf(fptr, "%-30s | %-13s | %-13s | %-13s |\n", "Name",
-		                                                   "Mean Time [s]",
-		                                                   "Max  Time [s]",
-		                                                   "Min  Time [s]");
-		fprintf(fptr, "--------------------------------"
-		              "----------------"
-		              "----------------"
-		              "----------------\n");
+		timer_append(&string, "%-40s | %-13s | %-13s | %-13s | %-9s | %-10s |\n", "Name",
+		             "Mean Time [s]", "Max  Time [s]", "Min  Time [s]", "Imbalance", "Calls");
+		timer_append(&string, "----------------------------------------------"
+		                      "-----------------------------------------------"
+		                      "--------------------------------\n");
+		for (int i = 0; i < union_count; i++) {
+			double mean = stats[4*i+0] / comm_size;
+			timer_append(&string, "%-40s |   %.5e |   %.5e |   %.5e | %9.3f | %10.0f |\n",
+			             union_names[i], mean, stats[4*i+2], stats[4*i+1],
+			             mean > 0.0 ? stats[4*i+2] / mean : 1.0, stats[4*i+3]);
+		}
 	}
 
-	// Write some text to the file
-	list_iterator = list_head;
-	while (list_iterator != NULL) {
-
-		double value_mean, value_max, value_min;
-		check_mpi(MPI_Reduce(&list_iterator->data->total_time, &value_mean, 1,
-		                      MPI_DOUBLE, MPI_SUM, 0, comm));
-		check_mpi(MPI_Reduce(&list_iterator->data->total_time, &value_min , 1,
-		                      MPI_DOUBLE, MPI_MIN, 0, comm));
-		check_mpi(MPI_Reduce(&list_iterator->data->total_time, &value_max , 1,
-		                      MPI_DOUBLE, MPI_MAX, 0, comm));
-		if (comm_rank == 0)
-			fprintf(fptr, "%-30s |   %.5e |   %.5e |   %.5e |\n",
-			                                                list_iterator->data->name,
-			                                                value_mean / comm_size   ,
-			                                                value_max                ,
-			                                                value_min                );
-		list_iterator = list_iterator->next;
+	// tree of the timers of each thread
+	if (per_rank) {
+		timer_append(&string, "\nRank %d\n", comm_rank);
+
+		pthread_mutex_lock(&timer_mutex);
+		for (int thread_id = 0; thread_id < thread_count; thread_id++) {
+
+			t_timer_thread *thread = thread_head;
+			while (thread->thread_id != thread_id)
+				thread = thread->next;
+
+			if (thread_count > 1)
+				timer_append(&string, "Thread %d\n", thread->thread_id);
+			timer_append(&string, "%-40s | %-8s | %-11s | %-11s |\n", "Name", "Calls",
+			             "Incl. [s]", "Self [s]");
+			timer_append(&string, "----------------------------------------------"
+			                      "--------------------------------------\n");
+
+			for (int child = thread->nodes[0].first_child; child != -1;
+			     child = thread->nodes[child].next_sibling)
+				timer_write_node(&string, thread, child, 0);
+		}
+		pthread_mutex_unlock(&timer_mutex);
 	}
 
-	// Close the file
-	if (comm_rank == 0)
-		fclose(fptr);
+	// single file written with MPI-IO
+	long long length = (long long)string.length;
+	long long offset = 0;
+	check_mpi( MPI_Exscan(&length, &offset, 1, MPI_LONG_LONG, MPI_SUM, comm) );
+	if (comm_rank == 0) offset = 0;
+
+	MPI_File file;
+	check_mpi( MPI_File_open(comm, path, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+	                         MPI_INFO_NULL, &file) );
+	check_mpi( MPI_File_set_size(file, 0) );
+	check_mpi( MPI_File_write_at_all(file, (MPI_Offset)offset, string.data, (int)string.length,
+	                                 MPI_CHAR, MPI_STATUS_IGNORE) );
+	check_mpi( MPI_File_close(&file) );
+
+	memory_free(string.data);
+	memory_free(stats);
+	if (union_names != names) {
+		memory_free(union_names);
+		memory_free(union_buffer);
+	}
+	memory_free(names);
 }
 
 void timers_reset() {
 
-	t_list_node *list_iterator = list_head;
-	while (list_iterator != NULL) {
+	pthread_mutex_lock(&timer_mutex);
+	for (t_timer_thread *thread = thread_head; thread != NULL; thread = thread->next) {
 
-		list_iterator->data->start_time = -1.0;
-		list_iterator->data->total_time =  0.0;
-		list_iterator = list_iterator->next;
+		for (int node = 0; node < thread->nnodes; node++) {
+			thread->nodes[node].calls          = 0;
+			thread->nodes[node].inclusive_time = 0.0;
+			thread->nodes[node].self_time      = 0.0;
+		}
+		for (int i = 0; i < thread->ntimers; i++)
+			thread->total_time[i] = 0.0;
 	}
+	pthread_mutex_unlock(&timer_mutex);
 }
 
 void delete_timers() {
 
-	t_list_node *list_iterator = list_head;
+	pthread_mutex_lock(&timer_mutex);
+
+	for (int i = 0; i < timer_count; i++)
+		memory_free(timers[i].name);
+	memory_free(timers);
+	timers = NULL;
+	timer_count = 0;
+	timers_size = 0;
+
+	t_timer_thread *thread = thread_head;
+	while (thread != NULL) {
+
+		t_timer_thread *thread_empty = thread;
+		thread = thread->next;
+		memory_free(thread_empty->nodes);
+		memory_free(thread_empty->last_node);
+		memory_free(thread_empty->active);
+		memory_free(thread_empty->total_time);
+		memory_free(thread_empty);
+	}
+	thread_head = NULL;
+	thread_count = 0;
 
-	while (list_iterator != NULL) {
+	// the threads create new structures at the next timer_start
+	timers_generation++;
+	timer_thread = NULL;
 
-		free(list_iterator->data->name);
-		free(list_iterator->data);
-		t_list_node *list_node_empty = list_iterator;
-		list_iterator = list_iterator->next;
-		free(list_node_empty);
-	}
-}
\ No newline at end of file
+	pthread_mutex_unlock(&timer_mutex);
+}
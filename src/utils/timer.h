@@ -38,6 +38,9 @@
 
 #define STRING_MAX 1024
 
+/** @brief maximum nesting level of the timers */
+#define TIMER_MAX_DEPTH 64
+
 /** @struct t_timer_data
  * 
  *  @brief The structure contains information about a single timer
@@ -49,34 +52,96 @@ struct t_timer_data {
 	int id;
 	/** @brief timer name */
 	char* name;
-	/** @brief timer total time */
-	double total_time;
+	/** @brief ID of the instrumented region of the timer (distdir_region) */
+	int region;
+};
+typedef struct t_timer_data t_timer_data;
+
+/** @struct t_timer_node
+ * 
+ *  @brief The structure contains a node of the call tree of the timers of a thread
+ * 
+ */
+struct t_timer_node {
+
+	/** @brief timer ID (0 for the root of the tree) */
+	int timer_id;
+	/** @brief timer name (NULL for the root of the tree) */
+	const char *name;
+	/** @brief ID of the instrumented region of the timer */
+	int region;
+	/** @brief index of the parent node (-1 for the root of the tree) */
+	int parent;
+	/** @brief index of the first child node (-1 if none) */
+	int first_child;
+	/** @brief index of the next node with the same parent (-1 if none) */
+	int next_sibling;
+	/** @brief number of calls */
+	int calls;
+	/** @brief time including the time of the children nodes */
+	double inclusive_time;
+	/** @brief time excluding the time of the children nodes */
+	double self_time;
+};
+typedef struct t_timer_node t_timer_node;
+
+/** @struct t_timer_frame
+ * 
+ *  @brief The structure contains a running timer of a thread
+ * 
+ */
+struct t_timer_frame {
+
+	/** @brief index of the node of the running timer */
+	int node;
 	/** @brief timer start time */
 	double start_time;
+	/** @brief time spent in the children timers */
+	double child_time;
 };
-typedef struct t_timer_data t_timer_data;
+typedef struct t_timer_frame t_timer_frame;
 
-/** @struct t_list_node
+/** @struct t_timer_thread
  * 
- *  @brief The structure contains a linked list single node for the timer module
+ *  @brief The structure contains the timers accumulated by a single thread
  * 
  */
-struct t_list_node
-{
+struct t_timer_thread {
 
-	/** @brief pointer to t_timer_data holding single timer information */
-	t_timer_data *data;
-	/** @brief pointer to next node of the linked list */
-	struct t_list_node *next;
+	/** @brief thread index (order of the first timer started) */
+	int thread_id;
+	/** @brief generation of the timers the structure belongs to */
+	int generation;
+	/** @brief nodes of the call tree (node 0 is the root) */
+	t_timer_node *nodes;
+	/** @brief number of nodes of the call tree */
+	int nnodes;
+	/** @brief allocated number of nodes */
+	int nodes_size;
+	/** @brief size of the arrays indexed by timer ID */
+	int ntimers;
+	/** @brief last node used by each timer ID (-1 if none) */
+	int *last_node;
+	/** @brief nesting level of each timer ID (for recursive timers) */
+	int *active;
+	/** @brief total time of each timer ID (outermost calls only) */
+	double *total_time;
+	/** @brief stack of the running timers (frame 0 is the root) */
+	t_timer_frame stack[TIMER_MAX_DEPTH + 1];
+	/** @brief number of running timers */
+	int depth;
+	/** @brief pointer to the structure of the next thread */
+	struct t_timer_thread *next;
 };
-typedef struct t_list_node t_list_node;
+typedef struct t_timer_thread t_timer_thread;
 
 /**
  * @brief Create a new timer
  * 
- * @details A timer is created and added to the internal linked list,
+ * @details A timer is created and added to the internal table of timers,
  *          then the timer ID is returned.
  *          If the timer already exists, its ID is returned.
+ *          The function is thread-safe.
  * 
  * @param[in] timer_name timer name string
  * 
@@ -87,11 +152,31 @@ typedef struct t_list_node t_list_node;
 int new_timer(const char * timer_name) ;
 
 /**
- * @brief Start timer based on ID.
+ * @brief Create a new timer of a timed function of the library
  * 
- * @details The timer is started using internally MPI_Wtime()
+ * @details As new_timer, but the timer is reported to the trace and to the hooks
+ *          with a fixed region ID instead of region_timer plus the timer ID.
+ *          If the timer already exists, its ID is returned and its region is unchanged.
  * 
  * @param[in] timer_name timer name string
+ * @param[in] region     ID of the instrumented region (distdir_region)
+ * 
+ * @return timer ID
+ * 
+ * @ingroup timer
+ */
+int new_timer_region(const char * timer_name, int region) ;
+
+/**
+ * @brief Start timer based on ID.
+ * 
+ * @details The timer is started using internally MPI_Wtime().
+ *          Timers started while another timer is running are nested in it.
+ *          The time is accumulated by the calling thread. The region is reported
+ *          to the trace and to the hooks also when the timers are disabled or
+ *          compiled out (\c DISTDIR_NO_TIMERS), but then it is not timed.
+ * 
+ * @param[in] timer_id timer ID
  * 
  * @ingroup timer
  */
@@ -102,25 +187,80 @@ void timer_start(int timer_id) ;
  * 
  * @details The timer is stopped using internally MPI_Wtime() and 
  *          adding the time to the total timer time.
- *          If timer_start() was not called before, it fails.
+ *          It has to be the last timer started by the calling thread.
+ *          The timed region is also recorded in the trace if enabled.
  * 
- * @param[in] timer_name timer name string
+ * @param[in] timer_id timer ID
  * 
  * @ingroup timer
  */
 void timer_stop(int timer_id) ;
 
 /**
- * @brief Create reports of all timers.
+ * @brief Enable or disable the timers at runtime.
+ * 
+ * @details When the timers are disabled, \c timer_start and \c timer_stop
+ *          only report the regions to the trace and to the hooks. It should not
+ *          be called while a timer is running.
+ * 
+ * @param[in] active 1 to enable the timers, 0 to disable them
+ * 
+ * @ingroup timer
+ */
+void timers_set_active(int active) ;
+
+/**
+ * @brief Return 1 if the timers are enabled, 0 otherwise.
+ * 
+ * @ingroup timer
+ */
+int timers_get_active() ;
+
+/**
+ * @brief Get the total time of a timer.
+ * 
+ * @details The time is summed over all the threads. Nested calls of the
+ *          same timer are counted once.
+ * 
+ * @param[in] timer_id timer ID
+ * 
+ * @return total time of the timer
+ * 
+ * @ingroup timer
+ */
+double timer_total_time(int timer_id) ;
+
+/**
+ * @brief Get the number of calls of a timer.
+ * 
+ * @details The calls are summed over all the threads.
+ * 
+ * @param[in] timer_id timer ID
+ * 
+ * @return number of calls of the timer
+ * 
+ * @ingroup timer
+ */
+int timer_calls(int timer_id) ;
+
+/**
+ * @brief Create the report of all timers.
+ * 
+ * @details Collective call over comm. The report is written in a single file
+ *          using MPI-IO. It contains a summary with the mean, max and min times
+ *          and the calls of each timer among the MPI ranks, computed with a single
+ *          reduction. If per_rank is set, the summary is followed by the tree of
+ *          the nested timers of each rank and thread (inclusive and self times).
+ *          The processes can create different timers: a timer missing on a
+ *          process counts as zero time for that process.
  * 
- * @details The reports are stored in a specific directory and 
- *          a report is created by each MPI rank.
- *          A summary report is also created with min, max and mean 
- *          timers' times.
+ * @param[in] comm     MPI communicator of the processes of the report
+ * @param[in] path     path of the report file
+ * @param[in] per_rank 1 to add the timers of each rank, 0 for the summary only
  * 
  * @ingroup timer
  */
-void timers_report() ;
+void timers_report(MPI_Comm comm, const char *path, int per_rank) ;
 
 /**
  * @brief Reset all the timers.
@@ -134,8 +274,7 @@ void timers_reset() ;
 /**
  * @brief Free timers memory.
  * 
- * @details Free each timer memory and the memory related to the linked 
- *          list.
+ * @details Free the table of the timers and the memory of all the threads.
  * 
  * @ingroup timer
  */
@@ -0,0 +1,222 @@
+/*
+ * @file trace.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <float.h>
+
+#include "src/utils/trace.h"
+#include "src/utils/check.h"
+#include "src/utils/memory.h"
+#include "src/setup/setting.h"
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define TRACE_THREAD_LOCAL _Thread_local
+#else
+#define TRACE_THREAD_LOCAL __thread
+#endif
+
+/* ring buffer of the events, the number of recorded events is never reset */
+static t_trace_event *events = NULL;
+static unsigned long long event_count = 0;
+
+static int trace_active = 0;
+
+int trace_flags = 0;
+
+static distdir_hook hook_begin = NULL;
+static distdir_hook hook_end = NULL;
+static void *hook_user_ctx = NULL;
+
+static int thread_count = 0;
+static TRACE_THREAD_LOCAL int thread_id = -1;
+
+/* growing string used to format the trace */
+struct t_trace_string {
+	char *data;
+	size_t length;
+	size_t size;
+};
+typedef struct t_trace_string t_trace_string;
+
+void trace_set_active(int active) {
+
+	if (active && events == NULL)
+		events = (t_trace_event *)memory_malloc(TRACE_BUFFER_SIZE * sizeof(t_trace_event),
+		                                        memory_instrumentation);
+
+	trace_active = active;
+	if (active)
+		trace_flags |= TRACE_FLAG_TRACE;
+	else
+		trace_flags &= ~TRACE_FLAG_TRACE;
+}
+
+void distdir_set_hooks(distdir_hook begin_fn, distdir_hook end_fn, void *user_ctx) {
+
+	hook_begin = begin_fn;
+	hook_end = end_fn;
+	hook_user_ctx = user_ctx;
+	if (begin_fn != NULL || end_fn != NULL)
+		trace_flags |= TRACE_FLAG_HOOKS;
+	else
+		trace_flags &= ~TRACE_FLAG_HOOKS;
+}
+
+double trace_region_begin(int region, const char *name, int peer, size_t bytes) {
+
+	if (hook_begin != NULL)
+		hook_begin(region, name, peer, bytes, hook_user_ctx);
+
+	return trace_active ? MPI_Wtime() : 0.0;
+}
+
+void trace_region_end(int region, const char *name, int peer, size_t bytes, double begin) {
+
+	if (trace_active) {
+
+		double end = MPI_Wtime();
+
+		if (thread_id == -1)
+			thread_id = __atomic_fetch_add(&thread_count, 1, __ATOMIC_RELAXED);
+
+		unsigned long long index = __atomic_fetch_add(&event_count, 1ULL, __ATOMIC_RELAXED);
+		t_trace_event *event = &events[index & (TRACE_BUFFER_SIZE - 1)];
+		event->name  = name;
+		event->begin = begin;
+		event->end   = end;
+		event->peer  = peer;
+		event->tid   = thread_id;
+		event->bytes = bytes;
+	}
+
+	if (hook_end != NULL)
+		hook_end(region, name, peer, bytes, hook_user_ctx);
+}
+
+static void trace_append(t_trace_string *string, const char *format, ...) {
+
+	va_list args;
+
+	va_start(args, format);
+	int length = vsnprintf(string->data + string->length, string->size - string->length,
+	                       format, args);
+	va_end(args);
+
+	if (string->length + length >= string->size) {
+		while (string->length + length >= string->size)
+			string->size *= 2;
+		string->data = (char *)memory_realloc(string->data, string->size, memory_workspace);
+		va_start(args, format);
+		vsnprintf(string->data + string->length, string->size - string->length, format, args);
+		va_end(args);
+	}
+	string->length += length;
+}
+
+void distdir_dump_trace(const char *path) {
+
+	MPI_Comm comm = get_config_comm();
+	int world_rank;
+	check_mpi( MPI_Comm_rank(comm, &world_rank) );
+	int world_size;
+	check_mpi( MPI_Comm_size(comm, &world_size) );
+
+	unsigned long long first = event_count > TRACE_BUFFER_SIZE ? event_count - TRACE_BUFFER_SIZE : 0;
+
+	// the times are relative to the first event of all processes
+	double time0 = DBL_MAX;
+	for (unsigned long long i = first; i < event_count; i++)
+		if (events[i & (TRACE_BUFFER_SIZE - 1)].begin < time0)
+			time0 = events[i & (TRACE_BUFFER_SIZE - 1)].begin;
+	check_mpi( MPI_Allreduce(MPI_IN_PLACE, &time0, 1, MPI_DOUBLE, MPI_MIN, comm) );
+
+	t_trace_string string;
+	string.length = 0;
+	string.size = 256 * (event_count - first + 4);
+	string.data = (char *)memory_malloc(string.size, memory_workspace);
+
+	if (world_rank == 0)
+		trace_append(&string, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	else
+		trace_append(&string, ",\n");
+
+	trace_append(&string, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,"
+	                      "\"args\":{\"name\":\"rank %d\"}}", world_rank, world_rank);
+
+	for (unsigned long long i = first; i < event_count; i++) {
+		t_trace_event *event = &events[i & (TRACE_BUFFER_SIZE - 1)];
+		trace_append(&string, ",\n{\"name\":\"%s\",\"cat\":\"distdir\",\"ph\":\"X\","
+		                      "\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d",
+		             event->name, (event->begin - time0) * 1e6,
+		             (event->end - event->begin) * 1e6, world_rank, event->tid);
+		if (event->peer >= 0)
+			trace_append(&string, ",\"args\":{\"peer\":%d,\"bytes\":%zu}}", event->peer, event->bytes);
+		else
+			trace_append(&string, ",\"args\":{\"bytes\":%zu}}", event->bytes);
+	}
+
+	if (world_rank == world_size - 1)
+		trace_append(&string, "\n]}\n");
+
+	// each process writes its events after the ones of the previous processes
+	long long length = string.length;
+	long long offset = 0;
+	check_mpi( MPI_Exscan(&length, &offset, 1, MPI_LONG_LONG, MPI_SUM, comm) );
+	if (world_rank == 0) offset = 0;
+
+	MPI_File file;
+	check_mpi( MPI_File_open(comm, path, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+	                         MPI_INFO_NULL, &file) );
+	check_mpi( MPI_File_set_size(file, 0) );
+	check_mpi( MPI_File_write_at_all(file, (MPI_Offset)offset, string.data, (int)string.length,
+	                                 MPI_CHAR, MPI_STATUS_IGNORE) );
+	check_mpi( MPI_File_close(&file) );
+
+	memory_free(string.data);
+}
+
+void trace_finalize() {
+
+	// no collective call when the tracing is off
+	if (trace_active)
+		distdir_dump_trace(TRACE_FILE);
+
+	trace_active = 0;
+	trace_flags &= ~TRACE_FLAG_TRACE;
+	memory_free(events);
+	events = NULL;
+	event_count = 0;
+}
@@ -0,0 +1,244 @@
+/*
+ * @file trace.h
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stddef.h>
+#include "mpi.h"
+
+/** @brief number of events of the ring buffer of each process (power of 2) */
+#define TRACE_BUFFER_SIZE 65536
+
+/** @brief file written by distdir_finalize when the tracing is enabled */
+#define TRACE_FILE "distdir_trace.json"
+
+/** @struct t_trace_event
+ * 
+ *  @brief The structure contains a single event of the trace
+ * 
+ */
+struct t_trace_event {
+
+	/** @brief name of the region (not owned by the event) */
+	const char *name;
+	/** @brief begin time of the region */
+	double begin;
+	/** @brief end time of the region */
+	double end;
+	/** @brief rank of the peer process in the communicator of the map (-1 if none) */
+	int peer;
+	/** @brief thread index */
+	int tid;
+	/** @brief number of bytes moved in the region */
+	size_t bytes;
+};
+typedef struct t_trace_event t_trace_event;
+
+/** @enum distdir_region
+ * 
+ *  @brief Enum for the ID of the instrumented regions
+ * 
+ *  @details The phases of the exchanges and the timed functions of the library have
+ *          fixed IDs. The ID of the region of a user-defined timer is region_timer plus
+ *          the ID of the timer, which depends on the order in which the timers are
+ *          created and is not stable across runs.
+ * 
+ */
+enum distdir_region {
+	region_pack                        = 0,
+	region_unpack                      = 1,
+	region_post_send                   = 2,
+	region_post_recv                   = 3,
+	region_recv                        = 4,
+	region_wait                        = 5,
+	region_wait_send                   = 6,
+	region_wait_recv                   = 7,
+	region_test_recv                   = 8,
+	region_new_idxlist                 = 16,
+	region_new_idxlist_empty           = 17,
+	region_delete_idxlist              = 18,
+	region_new_map                     = 19,
+	region_extend_map_3d               = 20,
+	region_map_stats                   = 21,
+	region_delete_map                  = 22,
+	region_map_idxlist_to_RD_decomp    = 23,
+	region_map_RD_decomp_to_idxlist    = 24,
+	region_new_exchanger               = 25,
+	region_exchanger_go                = 26,
+	region_exchanger_go_with_transform = 27,
+	region_exchanger_start             = 28,
+	region_exchanger_wait              = 29,
+	region_delete_exchanger            = 30,
+	region_exchanger_IsendIrecv1       = 31,
+	region_exchanger_IsendIrecv2       = 32,
+	region_exchanger_IsendRecv1        = 33,
+	region_exchanger_IsendRecv2        = 34,
+	region_timer                       = 64
+};
+
+/**
+ * @brief Hook called at the begin or at the end of an instrumented region.
+ * 
+ * @param[in] region   ID of the region (distdir_region)
+ * @param[in] name     name of the region
+ * @param[in] peer     rank of the peer process in the communicator of the map (-1 if none)
+ * @param[in] bytes    number of bytes moved in the region
+ * @param[in] user_ctx pointer given to distdir_set_hooks
+ * 
+ * @ingroup trace
+ */
+typedef void (*distdir_hook) (int region, const char *name, int peer, size_t bytes, void *user_ctx);
+
+/** @brief flag of trace_flags set when the tracing is enabled */
+#define TRACE_FLAG_TRACE 1
+/** @brief flag of trace_flags set when hooks are registered */
+#define TRACE_FLAG_HOOKS 2
+
+/** @brief instrumentation enabled (0 if neither tracing nor hooks are active) */
+extern int trace_flags;
+
+/**
+ * @brief Enable or disable the tracing.
+ * 
+ * @details The ring buffer of the events is allocated the first time the tracing
+ *          is enabled, so that no memory is allocated while recording the events.
+ * 
+ * @param[in] active 1 to enable the tracing, 0 to disable it
+ * 
+ * @ingroup trace
+ */
+void trace_set_active(int active) ;
+
+/**
+ * @brief Register hooks called at every instrumented region.
+ * 
+ * @details The begin hook is called when a region starts and the end hook when it ends,
+ *          both with the ID of the region and its metadata. The regions are the phases
+ *          of the exchanges (distdir_region) and the timers. Any hook can be NULL and
+ *          calling the function with both hooks NULL removes them. It should not be
+ *          called while an exchange is in progress. The hooks are called by the thread
+ *          of the application calling the library, never by the progress thread.
+ * 
+ * @param[in] begin_fn hook called at the begin of a region
+ * @param[in] end_fn   hook called at the end of a region
+ * @param[in] user_ctx pointer passed to the hooks
+ * 
+ * @ingroup trace
+ */
+void distdir_set_hooks(distdir_hook begin_fn, distdir_hook end_fn, void *user_ctx) ;
+
+/**
+ * @brief Begin of an instrumented region (out of line part of trace_begin).
+ * 
+ * @ingroup trace
+ */
+double trace_region_begin(int region, const char *name, int peer, size_t bytes) ;
+
+/**
+ * @brief End of an instrumented region (out of line part of trace_end).
+ * 
+ * @ingroup trace
+ */
+void trace_region_end(int region, const char *name, int peer, size_t bytes, double begin) ;
+
+/**
+ * @brief Begin of an instrumented region.
+ * 
+ * @details It calls the begin hook and returns MPI_Wtime() if the tracing is enabled.
+ *          Without tracing and hooks it costs a single branch.
+ * 
+ * @param[in] region ID of the region
+ * @param[in] name   name of the region (it has to be valid until the trace is written)
+ * @param[in] peer   rank of the peer process (-1 if none)
+ * @param[in] bytes  number of bytes moved in the region
+ * 
+ * @return begin time of the region
+ * 
+ * @ingroup trace
+ */
+static inline double trace_begin(int region, const char *name, int peer, size_t bytes) {
+
+	if (__builtin_expect(trace_flags != 0, 0))
+		return trace_region_begin(region, name, peer, bytes);
+	return 0.0;
+}
+
+/**
+ * @brief End of an instrumented region.
+ * 
+ * @details The region is recorded in the trace, the event overwrites the oldest one
+ *          when the ring buffer is full. Then the end hook is called.
+ *          Without tracing and hooks it costs a single branch.
+ * 
+ * @param[in] region ID of the region
+ * @param[in] name   name of the region (it has to be valid until the trace is written)
+ * @param[in] peer   rank of the peer process (-1 if none)
+ * @param[in] bytes  number of bytes moved in the region
+ * @param[in] begin  begin time of the region returned by trace_begin()
+ * 
+ * @ingroup trace
+ */
+static inline void trace_end(int region, const char *name, int peer, size_t bytes, double begin) {
+
+	if (__builtin_expect(trace_flags != 0, 0))
+		trace_region_end(region, name, peer, bytes, begin);
+}
+
+/**
+ * @brief Write the trace in Chrome trace format.
+ * 
+ * @details Collective call over the communicator of the library (get_config_comm).
+ *          The events of all processes are written in a single JSON file which can be
+ *          opened with chrome://tracing or Perfetto. The rank in the communicator is used
+ *          as process ID and the times are relative to the first event of all processes.
+ *          The events are kept after the call.
+ * 
+ * @param[in] path path of the JSON file
+ * 
+ * @ingroup trace
+ */
+void distdir_dump_trace(const char *path) ;
+
+/**
+ * @brief Write the trace at finalization.
+ * 
+ * @details If the tracing is enabled, the trace is written to \c TRACE_FILE with a
+ *          collective call over the communicator of the library, so the tracing has to be
+ *          enabled on all of its processes. Then the ring buffer is freed.
+ * 
+ * @ingroup trace
+ */
+void trace_finalize() ;
+
+#endif
@@ -36,6 +36,7 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <unistd.h>
 
 #include "src/core/algorithm/backend/backend.h"
 #include "src/sort/mergesort.h"
@@ -82,6 +83,7 @@ static int senders_to_bucket_test01(MPI_Comm comm) {
 	                   n_idx_each_bucket        , 
 	                   n_procs_sending_to_bucket,
 	                   bucket_max_size          ,
+	                   0                        ,
 	                   idxlist_size             ,
 	                   comm                     ,
 	                   mergeSort                );
@@ -100,6 +102,63 @@ static int senders_to_bucket_test01(MPI_Comm comm) {
 	return error;
 }
 
+/**
+ * @brief test02 for senders_to_bucket function
+ * 
+ * @details All the processes send to bucket (rank) 0 twice, with the tag ranges
+ *          of the src and of the dst index lists. The last process is delayed, so
+ *          the other ones already send the second message while rank 0 still waits
+ *          for the first one: the second message must not be matched by the
+ *          receives of the first call. Both calls have the values 0,1,...,world_size-1.
+ * 
+ * @ingroup backend_tests
+ */
+static int senders_to_bucket_test02(MPI_Comm comm) {
+
+	int world_size;
+	MPI_Comm_size(comm, &world_size);
+	int world_rank;
+	MPI_Comm_rank(comm, &world_rank);
+
+	int bucket_max_size = 10;
+	int idxlist_size = world_size;
+	int n_procs_sending_to_bucket = world_rank == 0 ? world_size : 0;
+
+	int *n_idx_each_bucket = (int *)malloc(world_size*sizeof(int));
+	int *senders_to_bucket_array = (int *)malloc(world_size*sizeof(int));
+	for (int i=0; i<world_size; i++)
+		n_idx_each_bucket[i] = 0;
+	n_idx_each_bucket[0] = 1;
+
+	// the messages of test01 have the same tag range
+	MPI_Barrier(comm);
+
+	int error = 0;
+	for (int tag_range=0; tag_range<2; tag_range++) {
+
+		if (tag_range == 0 && world_rank == world_size-1)
+			usleep(200000);
+
+		senders_to_bucket( senders_to_bucket_array  ,
+		                   n_idx_each_bucket        , 
+		                   n_procs_sending_to_bucket,
+		                   bucket_max_size          ,
+		                   tag_range                ,
+		                   idxlist_size             ,
+		                   comm                     ,
+		                   mergeSort                );
+
+		for (int i=0; i<n_procs_sending_to_bucket; i++)
+			if (senders_to_bucket_array[i] != i)
+				error = 1;
+	}
+
+	free(n_idx_each_bucket);
+	free(senders_to_bucket_array);
+
+	return error;
+}
+
 int main() {
 
 	// Initialize the MPI environment
@@ -108,6 +167,7 @@ int main() {
 	int error = 0;
 
 	error += senders_to_bucket_test01(MPI_COMM_WORLD);
+	error += senders_to_bucket_test02(MPI_COMM_WORLD);
 
 	// Finalize the MPI environment.
 	MPI_Finalize();
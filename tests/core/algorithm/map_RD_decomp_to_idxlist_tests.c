@@ -116,6 +116,7 @@ static int map_RD_decomp_to_idxlist_test01(MPI_Comm comm) {
 	bucket1->min_size_stride = bucket_min_size_stride;
 	bucket1->max_size_stride = bucket_max_size_stride;
 	bucket1->stride = stride;
+	bucket1->tag_range = 0;
 	int *idxlist_local1;
 
 	t_bucket *bucket2;
@@ -129,6 +130,7 @@ static int map_RD_decomp_to_idxlist_test01(MPI_Comm comm) {
 	bucket2->min_size_stride = bucket_min_size_stride;
 	bucket2->max_size_stride = bucket_max_size_stride;
 	bucket2->stride = stride;
+	bucket2->tag_range = 1;
 	int *idxlist_local2;
 
 	if (world_role == I_SRC) {
@@ -177,21 +179,21 @@ static int map_RD_decomp_to_idxlist_test01(MPI_Comm comm) {
 	free(bucket1->idxlist);
 	free(bucket1->ranks);
 	if (bucket1->count_recv > 0)
-		free(bucket1->src_recv);
+		memory_free(bucket1->src_recv);
 	if (bucket1->count_recv > 0)
-		free(bucket1->msg_size_recv);
-	free(bucket1->size_ranks);
-	free(bucket1->rank_exch);
+		memory_free(bucket1->msg_size_recv);
+	memory_free(bucket1->size_ranks);
+	memory_free(bucket1->rank_exch);
 	free(bucket1);
 
 	free(bucket2->idxlist);
 	free(bucket2->ranks);
 	if (bucket2->count_recv > 0)
-		free(bucket2->src_recv);
+		memory_free(bucket2->src_recv);
 	if (bucket2->count_recv > 0)
-		free(bucket2->msg_size_recv);
-	free(bucket2->size_ranks);
-	free(bucket2->rank_exch);
+		memory_free(bucket2->msg_size_recv);
+	memory_free(bucket2->size_ranks);
+	memory_free(bucket2->rank_exch);
 	free(bucket2);
 
 	// free memory
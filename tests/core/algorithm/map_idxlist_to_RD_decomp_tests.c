@@ -111,6 +111,7 @@ static int map_idxlist_to_RD_decomp_test01(MPI_Comm comm) {
 	bucket->min_size_stride = bucket_min_size_stride;
 	bucket->max_size_stride = bucket_max_size_stride;
 	bucket->stride = stride;
+	bucket->tag_range = 0;
 	int *idxlist_local;
 
 	if (world_role == I_SRC) {
@@ -136,11 +137,11 @@ static int map_idxlist_to_RD_decomp_test01(MPI_Comm comm) {
 	free(bucket->idxlist);
 	free(bucket->ranks);
 	if (bucket->count_recv > 0)
-		free(bucket->src_recv);
+		memory_free(bucket->src_recv);
 	if (bucket->count_recv > 0)
-		free(bucket->msg_size_recv);
-	free(bucket->size_ranks);
-	free(bucket->rank_exch);
+		memory_free(bucket->msg_size_recv);
+	memory_free(bucket->size_ranks);
+	memory_free(bucket->rank_exch);
 	free(bucket);
 
 	delete_idxlist(p_idxlist);
@@ -221,6 +222,7 @@ static int map_idxlist_to_RD_decomp_test02(MPI_Comm comm) {
 	bucket->min_size_stride = bucket_min_size_stride;
 	bucket->max_size_stride = bucket_max_size_stride;
 	bucket->stride = stride;
+	bucket->tag_range = 0;
 	int *idxlist_local;
 
 	idxlist_local = (int *)malloc(p_idxlist->count*sizeof(int));
@@ -242,11 +244,11 @@ static int map_idxlist_to_RD_decomp_test02(MPI_Comm comm) {
 	free(bucket->idxlist);
 	free(bucket->ranks);
 	if (bucket->count_recv > 0)
-		free(bucket->src_recv);
+		memory_free(bucket->src_recv);
 	if (bucket->count_recv > 0)
-		free(bucket->msg_size_recv);
-	free(bucket->size_ranks);
-	free(bucket->rank_exch);
+		memory_free(bucket->msg_size_recv);
+	memory_free(bucket->size_ranks);
+	memory_free(bucket->rank_exch);
 	free(bucket);
 
 	delete_idxlist(p_idxlist);
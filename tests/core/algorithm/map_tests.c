@@ -528,6 +528,188 @@ static int map_test04(MPI_Comm comm) {
 	return error;
 }
 
+/**
+ * @brief test05 for map module
+ * 
+ * @details The test uses a total of 4 MPI processes with the domain decomposition of test01,
+ *          so that ranks 0,1 send two messages of 4 contiguous indices to ranks 2,3 and
+ *          the messages received by ranks 2,3 have two runs of contiguous indices.
+ *          The statistics of the map are tested, then the statistics of a map with
+ *          the same source and destination decomposition (only exchange with the same process).
+ * 
+ * @ingroup map_tests
+ */
+static int map_test05(MPI_Comm comm) {
+
+	const int NCOLS = 4;
+	const int NROWS = 4;
+
+	int world_rank;
+	MPI_Comm_rank(comm, &world_rank);
+	int world_size;
+	MPI_Comm_size(comm, &world_size);
+	int npoints_local = NCOLS * NROWS / (world_size / 2);
+	int idxlist[npoints_local];
+	int error = 0;
+
+	if (world_size != 4) return 1;
+
+	// index list with global indices
+	if (world_rank < 2) {
+		int ncols_local = NCOLS / (world_size / 2);
+		for (int i=0; i < NROWS; i++)
+			for (int j=0; j < ncols_local; j++)
+				idxlist[j+i*ncols_local] = j + i * NCOLS + world_rank * (NCOLS - ncols_local);
+	} else {
+		int nrows_local = NROWS / (world_size / 2);
+		for (int i=0; i < nrows_local; i++)
+			for (int j=0; j < NCOLS; j++)
+				idxlist[j+i*NCOLS] = j + i * NCOLS + (world_rank - (world_size / 2)) * (NROWS - nrows_local) * NCOLS;
+	}
+
+	t_idxlist *p_idxlist = new_idxlist(idxlist, npoints_local);
+	t_idxlist *p_idxlist_empty = new_idxlist_empty();
+	t_map *p_map;
+
+	if (world_rank < 2)
+		p_map = new_map(p_idxlist, p_idxlist_empty, -1, comm);
+	else
+		p_map = new_map(p_idxlist_empty, p_idxlist, -1, comm);
+
+	t_map_stats stats;
+	map_stats(p_map, &stats);
+
+	if (stats.peers_send != (world_rank < 2 ? 2 : 0)) error = 1;
+	if (stats.peers_recv != (world_rank < 2 ? 0 : 2)) error = 1;
+	if (stats.messages != 2) error = 1;
+	if (stats.min_message != 4 || stats.max_message != 4) error = 1;
+	if (stats.mean_message != 4.0) error = 1;
+	if (stats.histogram[2] != 2) error = 1;
+	if (stats.volume != npoints_local || stats.volume_self != 0) error = 1;
+	if (stats.self_fraction != 0.0) error = 1;
+	if (stats.runs != (world_rank < 2 ? 2 : 4)) error = 1;
+	if (stats.index_memory == 0) error = 1;
+	if (stats.global_max_peers_send != 2 || stats.global_max_peers_recv != 2) error = 1;
+	if (stats.global_messages != 4) error = 1;
+	if (stats.global_min_message != 4 || stats.global_max_message != 4) error = 1;
+	if (stats.global_mean_message != 4.0) error = 1;
+	if (stats.global_histogram[2] != 4) error = 1;
+	if (stats.global_max_volume != npoints_local) error = 1;
+	if (stats.global_mean_volume != (double)npoints_local) error = 1;
+	if (stats.global_runs_per_message != 1.5) error = 1;
+	if (stats.global_max_index_memory < stats.index_memory) error = 1;
+	if (stats.global_index_memory < world_size * sizeof(t_map)) error = 1;
+
+	delete_map(p_map);
+
+	// all the indices stay on the same process
+	int npoints_self = NCOLS * NROWS / world_size;
+	int idxlist_self[npoints_self];
+	for (int i = 0; i < npoints_self; i++)
+		idxlist_self[i] = i + world_rank * npoints_self;
+	t_idxlist *p_src_idxlist_self = new_idxlist(idxlist_self, npoints_self);
+	t_idxlist *p_dst_idxlist_self = new_idxlist(idxlist_self, npoints_self);
+	p_map = new_map(p_src_idxlist_self, p_dst_idxlist_self, -1, comm);
+	map_stats(p_map, &stats);
+
+	if (stats.messages != 0 || stats.min_message != 0) error = 1;
+	if (stats.volume != 0 || stats.volume_self != npoints_self) error = 1;
+	if (stats.self_fraction != 1.0 || stats.global_self_fraction != 1.0) error = 1;
+	if (stats.global_messages != 0 || stats.global_min_message != 0) error = 1;
+
+	delete_idxlist(p_idxlist);
+	delete_idxlist(p_src_idxlist_self);
+	delete_idxlist(p_dst_idxlist_self);
+	delete_idxlist(p_idxlist_empty);
+	delete_map(p_map);
+
+	return error;
+}
+
+/* domain decomposition of test01 scaled to the number of virtual processes:
+ * the first half of the processes owns blocks of columns (source) and the
+ * second half owns blocks of rows (destination) of a size x size domain */
+static void map_test06_fn(int rank, int size, void *ctx) {
+
+	int *error = (int *)ctx;
+	int nhalf = size / 2;
+	int npoints_local = size * size / nhalf;
+	int idxlist[npoints_local];
+
+	if (rank < nhalf) {
+		int ncols_local = size / nhalf;
+		for (int i=0; i < size; i++)
+			for (int j=0; j < ncols_local; j++)
+				idxlist[j+i*ncols_local] = j + i * size + rank * ncols_local;
+	} else {
+		int nrows_local = size / nhalf;
+		for (int i=0; i < nrows_local; i++)
+			for (int j=0; j < size; j++)
+				idxlist[j+i*size] = j + i * size + (rank - nhalf) * nrows_local * size;
+	}
+
+	t_idxlist *p_idxlist = new_idxlist(idxlist, npoints_local);
+	t_idxlist *p_idxlist_empty = new_idxlist_empty();
+	t_map *p_map;
+
+	if (rank < nhalf) {
+		p_map = new_map(p_idxlist, p_idxlist_empty, -1, MPI_COMM_WORLD);
+		if (p_map->exch_send->count != nhalf) *error = 1;
+		if (p_map->exch_send->buffer_size != npoints_local) *error = 1;
+		if (p_map->exch_recv->count != 0) *error = 1;
+		for (int i = 0; i < p_map->exch_send->count; i++)
+			if (p_map->exch_send->exch[i]->exch_rank != i + nhalf)
+				*error = 1;
+	} else {
+		p_map = new_map(p_idxlist_empty, p_idxlist, -1, MPI_COMM_WORLD);
+		if (p_map->exch_recv->count != nhalf) *error = 1;
+		if (p_map->exch_recv->buffer_size != npoints_local) *error = 1;
+		if (p_map->exch_send->count != 0) *error = 1;
+		for (int i = 0; i < p_map->exch_recv->count; i++)
+			if (p_map->exch_recv->exch[i]->exch_rank != i)
+				*error = 1;
+	}
+
+	delete_idxlist(p_idxlist);
+	delete_idxlist(p_idxlist_empty);
+	delete_map(p_map);
+}
+
+/**
+ * @brief test06 for map module
+ * 
+ * @details The maps of test01 are created by 4 and 64 virtual processes of the
+ *          simulator (on two nodes), then the statistics of the simulation are tested.
+ *          Each MPI process runs its own simulation.
+ * 
+ * @ingroup map_tests
+ */
+static int map_test06(MPI_Comm comm) {
+
+	(void)comm;
+	int error = 0;
+	const int nranks[2] = {4, 64};
+
+	for (int n = 0; n < 2; n++) {
+		t_simulator_config config = {.nranks = nranks[n], .ranks_per_node = nranks[n] / 2, .stack_size = 0};
+		t_simulator_stats stats;
+		int error_sim = 0;
+		distdir_simulate(&config, map_test06_fn, &error_sim, &stats);
+
+		if (error_sim) error = 1;
+		if (stats.nranks != nranks[n]) error = 1;
+		if (stats.messages <= 0 || stats.bytes <= 0) error = 1;
+		if (stats.max_messages <= 0 || stats.max_bytes < stats.bytes / nranks[n]) error = 1;
+		if (stats.collectives <= 0) error = 1;
+		if (stats.time <= 0.0 || stats.wall_time <= 0.0) error = 1;
+	}
+
+	// the MPI backend is restored after the simulation
+	if (get_comm_backend() != get_comm_backend_mpi()) error = 1;
+
+	return error;
+}
+
 int main() {
 
 	distdir_initialize();
@@ -538,6 +720,8 @@ int main() {
 	error += map_test02(MPI_COMM_WORLD);
 	error += map_test03(MPI_COMM_WORLD);
 	error += map_test04(MPI_COMM_WORLD);
+	error += map_test05(MPI_COMM_WORLD);
+	error += map_test06(MPI_COMM_WORLD);
 
 	distdir_finalize();
 	return error;
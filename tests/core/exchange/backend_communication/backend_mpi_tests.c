@@ -53,7 +53,7 @@ static int backend_mpi_test01(MPI_Comm comm) {
 	int world_rank, world_size;
 	t_mpi_exchange *mpi_exchange;
 
-	mpi_exchange = new_mpi_exchanger(MPI_INT, 1);
+	mpi_exchange = new_mpi_exchanger(MPI_INT, 1, 1);
 
 	MPI_Comm_rank(comm, &world_rank);
 	MPI_Comm_size(comm, &world_size);
@@ -78,6 +78,54 @@ static int backend_mpi_test01(MPI_Comm comm) {
 	return error;
 }
 
+/**
+ * @brief test02 for backend_mpi module
+ * 
+ * @details Two processes initialize the mpi_exchange object with a block
+ *          of 3 integers and then process 0 send two blocks to process 1.
+ *          Isend and Irecv are used.
+ * 
+ * @ingroup backend_mpi_tests
+ */
+static int backend_mpi_test02(MPI_Comm comm) {
+
+	int world_rank, world_size;
+	t_mpi_exchange *mpi_exchange;
+
+	mpi_exchange = new_mpi_exchanger(MPI_INT, 3, 1);
+
+	MPI_Comm_rank(comm, &world_rank);
+	MPI_Comm_size(comm, &world_size);
+
+	int error = 0;
+	if (mpi_exchange->type_size != 3 * sizeof(int))
+		error = 1;
+
+	int value[9] = {0};
+	if (world_rank == 0) {
+
+		for (int i = 0; i < 9; i++) value[i] = 10 + i;
+		mpi_exchange->isend(value, 2, mpi_exchange->type, 1, 0, comm, mpi_exchange->req,
+		                    mpi_exchange->type_size);
+	} else {
+
+		mpi_exchange->irecv(value, 2, mpi_exchange->type, 0, 0, comm, mpi_exchange->req,
+		                    mpi_exchange->type_size);
+	}
+
+	mpi_exchange->wait(1, mpi_exchange->req, mpi_exchange->stat);
+
+	delete_mpi_exchanger(mpi_exchange);
+
+	for (int i = 0; i < 3; i++)
+		if (world_rank == 1 && value[i] != 0)
+			error = 1;
+	for (int i = 3; i < 9; i++)
+		if (value[i] != 10 + i)
+			error = 1;
+	return error;
+}
+
 int main() {
 
 	distdir_initialize();
@@ -85,6 +133,7 @@ int main() {
 	int error = 0;
 
 	error += backend_mpi_test01(MPI_COMM_WORLD);
+	error += backend_mpi_test02(MPI_COMM_WORLD);
 
 	distdir_finalize();
 
@@ -0,0 +1,318 @@
+/*
+ * @file backend_threads_tests.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdarg.h>
+#include <setjmp.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "src/distdir.h"
+
+#define NTHREADS 4
+#define LSIZE 8
+
+/* error of each thread rank, each rank writes only its own entry */
+struct t_test_ctx {
+	int error[NTHREADS];
+	int exchanger_type;
+};
+typedef struct t_test_ctx t_test_ctx;
+
+static int test_ctx_error(t_test_ctx *ctx) {
+
+	int error = 0;
+	for (int i = 0; i < NTHREADS; i++)
+		error += ctx->error[i];
+	return error;
+}
+
+static void backend_threads_ring(int rank, int size, MPI_Comm comm, void *ctx) {
+
+	t_test_ctx *test_ctx = (t_test_ctx *)ctx;
+	t_mpi_exchange *mpi_exchange = new_mpi_exchanger(MPI_INT, 3, 2);
+
+	int send[3], recv[3] = {0};
+	for (int i = 0; i < 3; i++)
+		send[i] = 100 * rank + i;
+
+	int dest = (rank + 1) % size;
+	int source = (rank + size - 1) % size;
+	mpi_exchange->irecv(recv, 1, mpi_exchange->type, source, 0, comm, &mpi_exchange->req[1], 0);
+	mpi_exchange->isend(send, 1, mpi_exchange->type, dest, 0, comm, &mpi_exchange->req[0], 0);
+
+	/* the messages are completed by testsome */
+	int completed = 0;
+	while (completed < 2) {
+		int outcount;
+		int indices[2];
+		mpi_exchange->testsome(2, mpi_exchange->req, &outcount, indices, mpi_exchange->stat);
+		if (outcount != MPI_UNDEFINED)
+			completed += outcount;
+	}
+
+	int flag;
+	mpi_exchange->testall(2, mpi_exchange->req, &flag, mpi_exchange->stat);
+	if (!flag)
+		test_ctx->error[rank] = 1;
+
+	delete_mpi_exchanger(mpi_exchange);
+
+	for (int i = 0; i < 3; i++)
+		if (recv[i] != 100 * source + i)
+			test_ctx->error[rank] = 1;
+}
+
+/**
+ * @brief test01 for backend_threads module
+ * 
+ * @details Four thread ranks initialize the mpi_exchange object with a block
+ *          of 3 integers and send one block to the next rank of a ring.
+ *          The messages are completed with testsome.
+ * 
+ * @ingroup backend_threads_tests
+ */
+static int backend_threads_test01() {
+
+	t_test_ctx ctx = {0};
+
+	set_config_thread_ranks(NTHREADS);
+	distdir_run_ranks(backend_threads_ring, &ctx);
+
+	return test_ctx_error(&ctx);
+}
+
+static void backend_threads_collectives(int rank, int size, MPI_Comm comm, void *ctx) {
+
+	t_test_ctx *test_ctx = (t_test_ctx *)ctx;
+	const t_comm_backend *backend = get_comm_backend();
+
+	int backend_rank, backend_size;
+	backend->comm_rank(comm, &backend_rank);
+	backend->comm_size(comm, &backend_size);
+	if (backend_rank != rank || backend_size != size || !thread_ranks_active())
+		test_ctx->error[rank] = 1;
+
+	long long sum = rank + 1;
+	backend->allreduce(MPI_IN_PLACE, &sum, 1, MPI_LONG_LONG, MPI_SUM, comm);
+	if (sum != size * (size + 1) / 2)
+		test_ctx->error[rank] = 1;
+
+	int send[NTHREADS], recv;
+	for (int i = 0; i < size; i++)
+		send[i] = rank * i;
+	backend->reduce_scatter_block(send, &recv, 1, MPI_INT, MPI_MAX, comm);
+	if (recv != (size - 1) * rank)
+		test_ctx->error[rank] = 1;
+
+	backend->barrier(comm);
+}
+
+/**
+ * @brief test02 for backend_threads module
+ * 
+ * @details Four thread ranks check their rank and size and call the
+ *          collectives of the communication backend of the thread ranks.
+ * 
+ * @ingroup backend_threads_tests
+ */
+static int backend_threads_test02() {
+
+	t_test_ctx ctx = {0};
+
+	set_config_thread_ranks(NTHREADS);
+	distdir_run_ranks(backend_threads_collectives, &ctx);
+
+	return test_ctx_error(&ctx);
+}
+
+static void backend_threads_exchange(int rank, int size, MPI_Comm comm, void *ctx) {
+
+	t_test_ctx *test_ctx = (t_test_ctx *)ctx;
+
+	const int NCOLS = 4;
+	const int NROWS = 4;
+	int idxlist[LSIZE];
+
+	if (rank < 2) {
+		for (int i = 0; i < NROWS; i++)
+			for (int j = 0; j < NCOLS / 2; j++)
+				idxlist[j + i * NCOLS / 2] = j + i * NCOLS + rank * NCOLS / 2;
+	} else {
+		for (int i = 0; i < NROWS / 2; i++)
+			for (int j = 0; j < NCOLS; j++)
+				idxlist[j + i * NCOLS] = j + i * NCOLS + (rank - 2) * NROWS / 2 * NCOLS;
+	}
+
+	t_idxlist *p_idxlist = new_idxlist(idxlist, LSIZE);
+	t_idxlist *p_idxlist_empty = new_idxlist_empty();
+	t_map *p_map;
+	if (rank < 2)
+		p_map = new_map(p_idxlist, p_idxlist_empty, -1, comm);
+	else
+		p_map = new_map(p_idxlist_empty, p_idxlist, -1, comm);
+
+	/* each source rank sends a message to each destination rank */
+	t_map_stats stats;
+	map_stats(p_map, &stats);
+	if (stats.global_messages != 4)
+		test_ctx->error[rank] = 1;
+
+	int solution2[LSIZE] = {0, 1, 8, 9, 2, 3, 10, 11};
+	int solution3[LSIZE] = {4, 5, 12, 13, 6, 7, 14, 15};
+
+	t_exchanger *exchanger = new_exchanger(p_map, MPI_INT, CPU);
+	for (int blocking = 0; blocking < 2; blocking++) {
+		int data[LSIZE] = {0};
+		if (rank < 2)
+			for (int i = 0; i < LSIZE; i++)
+				data[i] = i + LSIZE * rank;
+
+		if (blocking) {
+			exchanger_go(exchanger, data, data);
+		} else {
+			exchanger_start(exchanger, data, data);
+			exchanger_wait(exchanger);
+		}
+
+		for (int i = 0; i < LSIZE; i++)
+			if ((rank == 2 && data[i] != solution2[i]) ||
+			    (rank == 3 && data[i] != solution3[i]))
+				test_ctx->error[rank] = 1;
+	}
+
+	/* the Auto exchanger selects the same type on all the thread ranks */
+	if (test_ctx->exchanger_type == Auto) {
+		int data[LSIZE] = {0};
+		while (exchanger->autotune->mode < 0)
+			exchanger_go(exchanger, data, data);
+		int mode[2] = {exchanger->autotune->mode, -exchanger->autotune->mode};
+		get_comm_backend()->allreduce(MPI_IN_PLACE, mode, 2, MPI_INT, MPI_MAX, comm);
+		if (mode[0] != -mode[1] || mode[0] < IsendIrecv1 || mode[0] > IsendRecv2NoWait)
+			test_ctx->error[rank] = 1;
+	}
+	delete_exchanger(exchanger);
+
+	delete_map(p_map);
+	delete_idxlist(p_idxlist);
+	delete_idxlist(p_idxlist_empty);
+}
+
+/**
+ * @brief test03 for backend_threads module
+ * 
+ * @details The test uses four thread ranks over a 4x4 global 2D domain with
+ *          the domain decomposition of the test01 of the exchange module:
+ *          ranks 0,1 are senders and ranks 2,3 are receivers.
+ * 
+ *          The map is created by the thread ranks and all the exchanger types
+ *          are tested with blocking and non blocking exchanges. The Auto
+ *          exchanger completes its selection with the thread ranks.
+ * 
+ * @ingroup backend_threads_tests
+ */
+static int backend_threads_test03() {
+
+	int error = 0;
+
+	set_config_thread_ranks(NTHREADS);
+	set_config_exchanger_auto_trials(1);
+	for (int exchanger_type = IsendIrecv1; exchanger_type <= Auto; exchanger_type++) {
+		t_test_ctx ctx = {0};
+		ctx.exchanger_type = exchanger_type;
+		set_config_exchanger(exchanger_type);
+		distdir_run_ranks(backend_threads_exchange, &ctx);
+		error += test_ctx_error(&ctx);
+	}
+	set_config_exchanger_auto_trials(EXCHANGER_AUTO_TRIALS);
+
+	return error;
+}
+
+static void backend_threads_comms(int rank, int size, MPI_Comm comm, void *ctx) {
+
+	(void)comm;
+	t_test_ctx *test_ctx = (t_test_ctx *)ctx;
+	const t_comm_backend *backend = get_comm_backend();
+
+	int dest = (rank + 1) % size;
+	int source = (rank + size - 1) % size;
+
+	/* same source and tag, the messages differ only by the communicator */
+	int send[2] = {rank, -rank - 1};
+	int recv[2] = {0};
+	t_comm_request requests[4];
+	backend->isend(&send[0], 1, MPI_INT, dest, 0, MPI_COMM_WORLD, &requests[0]);
+	backend->isend(&send[1], 1, MPI_INT, dest, 0, MPI_COMM_SELF, &requests[1]);
+	backend->irecv(&recv[1], 1, MPI_INT, source, 0, MPI_COMM_SELF, &requests[2]);
+	backend->irecv(&recv[0], 1, MPI_INT, source, 0, MPI_COMM_WORLD, &requests[3]);
+	backend->waitall(4, requests);
+
+	if (recv[0] != source || recv[1] != -source - 1)
+		test_ctx->error[rank] = 1;
+}
+
+/**
+ * @brief test04 for backend_threads module
+ * 
+ * @details Four thread ranks send two messages with the same tag to the next
+ *          rank of a ring on two communicators. The receives are posted in the
+ *          opposite order and each one matches the message of its communicator.
+ * 
+ * @ingroup backend_threads_tests
+ */
+static int backend_threads_test04() {
+
+	t_test_ctx ctx = {0};
+
+	set_config_thread_ranks(NTHREADS);
+	distdir_run_ranks(backend_threads_comms, &ctx);
+
+	return test_ctx_error(&ctx);
+}
+
+int main() {
+
+	distdir_initialize();
+
+	int error = 0;
+
+	error += backend_threads_test01();
+	error += backend_threads_test02();
+	error += backend_threads_test03();
+	error += backend_threads_test04();
+
+	distdir_finalize();
+
+	return error;
+}
@@ -36,8 +36,11 @@
 #include <stddef.h>
 #include <cmocka.h>
 #include <stdlib.h>
+#include <stdint.h>
 
 #include "src/core/exchange/backend_hardware/backend_cpu.h"
+#include "src/setup/setting.h"
+#include "src/utils/memory.h"
 
 /**
  * @brief Test01 of cpu allocator/deallocator
@@ -50,17 +53,86 @@
 static void allocate_cpu_test01(void **state __attribute__((unused))) {
 
 	const int size = 10;
-	t_kernels *vtable = new_vtable_cpu(MPI_INT);
+	t_kernels *vtable = new_vtable_cpu(sizeof(int));
 	int *array = (int *)vtable->allocator(size*sizeof(int));
 	assert_true(array != NULL);
 	vtable->deallocator(array);
 	delete_vtable(vtable);
 }
 
+/**
+ * @brief Test02 of cpu allocator/deallocator
+ * 
+ * @details Allocate and deallocate small and large arrays with all the
+ *          combinations of the memory placement policies. The arrays are
+ *          page aligned (huge page aligned if large enough) and zeroed
+ *          if touched at allocation.
+ * 
+ * @ingroup backend_cpu_tests
+ */
+static void allocate_cpu_test02(void **state __attribute__((unused))) {
+
+	const size_t sizes[3] = {100, ALLOCATOR_PAGE_SIZE + 1, 2 * ALLOCATOR_HUGE_PAGE_SIZE + 8};
+
+	for (int policy = 0; policy < 8; policy++) {
+		for (int i = 0; i < 3; i++) {
+			char *array = (char *)allocator_cpu_with_policy(sizes[i], policy);
+			assert_true(array != NULL);
+			if (policy != allocator_malloc) {
+				size_t alignment = (policy & allocator_huge_pages) && sizes[i] >= ALLOCATOR_HUGE_PAGE_SIZE ?
+				                   ALLOCATOR_HUGE_PAGE_SIZE : ALLOCATOR_PAGE_SIZE;
+				assert_int_equal((uintptr_t)array % alignment, 0);
+			}
+			if (policy & allocator_first_touch)
+				for (size_t j = 0; j < sizes[i]; j++)
+					assert_int_equal(array[j], 0);
+			array[0] = 1;
+			array[sizes[i] - 1] = 1;
+			deallocator_cpu(array);
+		}
+	}
+}
+
+/**
+ * @brief Test03 of cpu allocator/deallocator
+ * 
+ * @details Allocate many page aligned and malloc arrays at the same time and
+ *          free them in a different order: the accounted memory of the
+ *          exchangers goes back to its initial value.
+ * 
+ * @ingroup backend_cpu_tests
+ */
+static void allocate_cpu_test03(void **state __attribute__((unused))) {
+
+	enum {NARRAYS = 300};
+	void *arrays[NARRAYS];
+
+	t_memory_report start, report;
+	memory_get_report(&start);
+
+	for (int i = 0; i < NARRAYS; i++)
+		arrays[i] = allocator_cpu_with_policy(100 + i, i % 3 == 0 ? allocator_malloc : allocator_local_node);
+
+	memory_get_report(&report);
+	assert_true(report.category[memory_exchange].current > start.category[memory_exchange].current);
+
+	// every 7th array first, then the others backwards
+	for (int i = 0; i < NARRAYS; i += 7)
+		deallocator_cpu(arrays[i]);
+	for (int i = NARRAYS - 1; i >= 0; i--)
+		if (i % 7 != 0)
+			deallocator_cpu(arrays[i]);
+
+	memory_get_report(&report);
+	assert_int_equal(report.category[memory_exchange].current, start.category[memory_exchange].current);
+}
+
 int main(void) {
 
 	const struct CMUnitTest tests[] = {
 		cmocka_unit_test(allocate_cpu_test01),
+		cmocka_unit_test(allocate_cpu_test02),
+		cmocka_unit_test(allocate_cpu_test03),
 	};
 	return cmocka_run_group_tests(tests, NULL, NULL);
 }
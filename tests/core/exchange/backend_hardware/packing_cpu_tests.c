@@ -36,8 +36,11 @@
 #include <stddef.h>
 #include <cmocka.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 
 #include "src/core/exchange/backend_hardware/backend_cpu.h"
+#include "src/setup/setting.h"
 
 /**
  * @brief Test01 of cpu packing
@@ -58,7 +61,7 @@ static void packing_cpu_test01(void **state __attribute__((unused))) {
 
 	// Integer tests
 	{
-		t_kernels *vtable = new_vtable_cpu(MPI_INT);
+		t_kernels *vtable = new_vtable_cpu(sizeof(int));
 		// create and fill data array
 		int *data = (int *)malloc(size*sizeof(int));
 		for (int i=0; i<size; i++)
@@ -66,7 +69,7 @@ static void packing_cpu_test01(void **state __attribute__((unused))) {
 		// create buffer array
 		int *buffer = (int *)malloc(size*sizeof(int));
 
-		vtable->pack(buffer, data, buffer_idxlist, size, 0, NULL);
+		vtable->pack(buffer, data, buffer_idxlist, size, 0, NULL, vtable->type_size);
 		for (int i=0; i<size; i++)
 			assert_true(buffer[i] == i);
 
@@ -77,7 +80,7 @@ static void packing_cpu_test01(void **state __attribute__((unused))) {
 
 	// Float tests
 	{
-		t_kernels *vtable = new_vtable_cpu(MPI_REAL);
+		t_kernels *vtable = new_vtable_cpu(sizeof(float));
 		// create and fill data array
 		float *data = (float *)malloc(size*sizeof(float));
 		for (int i=0; i<size; i++)
@@ -85,7 +88,7 @@ static void packing_cpu_test01(void **state __attribute__((unused))) {
 		// create buffer array
 		float *buffer = (float *)malloc(size*sizeof(float));
 
-		vtable->pack(buffer, data, buffer_idxlist, size, 0, NULL);
+		vtable->pack(buffer, data, buffer_idxlist, size, 0, NULL, vtable->type_size);
 		for (int i=0; i<size; i++)
 			assert_true(buffer[i] == (float)i);
 
@@ -96,7 +99,7 @@ static void packing_cpu_test01(void **state __attribute__((unused))) {
 
 	// Double tests
 	{
-		t_kernels *vtable = new_vtable_cpu(MPI_DOUBLE);
+		t_kernels *vtable = new_vtable_cpu(sizeof(double));
 		// create and fill data array
 		double *data = (double *)malloc(size*sizeof(double));
 		for (int i=0; i<size; i++)
@@ -104,7 +107,7 @@ static void packing_cpu_test01(void **state __attribute__((unused))) {
 		// create buffer array
 		double *buffer = (double *)malloc(size*sizeof(double));
 
-		vtable->pack(buffer, data, buffer_idxlist, size, 0, NULL);
+		vtable->pack(buffer, data, buffer_idxlist, size, 0, NULL, vtable->type_size);
 		for (int i=0; i<size; i++)
 			assert_true(buffer[i] == (double)i);
 
@@ -116,10 +119,180 @@ static void packing_cpu_test01(void **state __attribute__((unused))) {
 	free(buffer_idxlist);
 }
 
+/**
+ * @brief Test02 of cpu packing
+ * 
+ * @details Fill buffer with a reversed buffer index list.
+ *          Elements of 1, 8, 16 and 24 bytes and a 20 bytes block
+ *          (generic packing function) are tested.
+ * 
+ * @ingroup backend_cpu_tests
+ */
+static void packing_cpu_test02(void **state __attribute__((unused))) {
+
+	const int size = 10;
+	// create and fill buffer idxlist array
+	int * buffer_idxlist = (int *)malloc(size*sizeof(int));
+	for (int i=0; i<size; i++)
+		buffer_idxlist[i] = size - 1 - i;
+
+	// 1 byte tests
+	{
+		t_kernels *vtable = new_vtable_cpu(sizeof(char));
+		char data[size];
+		char buffer[size];
+		for (int i=0; i<size; i++)
+			data[i] = (char)i;
+
+		vtable->pack(buffer, data, buffer_idxlist, size, 0, NULL, vtable->type_size);
+		for (int i=0; i<size; i++)
+			assert_true(buffer[i] == (char)(size - 1 - i));
+
+		delete_vtable(vtable);
+	}
+
+	// 8 bytes tests
+	{
+		t_kernels *vtable = new_vtable_cpu(sizeof(long long));
+		long long data[size];
+		long long buffer[size];
+		for (int i=0; i<size; i++)
+			data[i] = (1LL << 40) + i;
+
+		vtable->pack(buffer, data, buffer_idxlist, size, 0, NULL, vtable->type_size);
+		for (int i=0; i<size; i++)
+			assert_true(buffer[i] == (1LL << 40) + size - 1 - i);
+
+		delete_vtable(vtable);
+	}
+
+	// 16 bytes tests
+	{
+		t_kernels *vtable = new_vtable_cpu(2*sizeof(double));
+		double data[2*size];
+		double buffer[2*size];
+		for (int i=0; i<size; i++) {
+			data[2*i  ] = (double)i;
+			data[2*i+1] = (double)-i;
+		}
+
+		vtable->pack(buffer, data, buffer_idxlist, size, 0, NULL, vtable->type_size);
+		for (int i=0; i<size; i++) {
+			assert_true(buffer[2*i  ] == (double)(size - 1 - i));
+			assert_true(buffer[2*i+1] == (double)-(size - 1 - i));
+		}
+
+		delete_vtable(vtable);
+	}
+
+	// 24 bytes tests
+	{
+		t_kernels *vtable = new_vtable_cpu(3*sizeof(double));
+		double data[3*size];
+		double buffer[3*size];
+		for (int i=0; i<3*size; i++)
+			data[i] = (double)i;
+
+		vtable->pack(buffer, data, buffer_idxlist, size, 0, NULL, vtable->type_size);
+		for (int i=0; i<size; i++)
+			for (int j=0; j<3; j++)
+				assert_true(buffer[3*i+j] == (double)(3*(size - 1 - i)+j));
+
+		delete_vtable(vtable);
+	}
+
+	// 20 bytes tests
+	{
+		t_kernels *vtable = new_vtable_cpu(5*sizeof(int));
+		int data[5*size];
+		int buffer[5*size];
+		for (int i=0; i<5*size; i++)
+			data[i] = i;
+
+		vtable->pack(buffer, data, buffer_idxlist, size, 0, NULL, vtable->type_size);
+		for (int i=0; i<size; i++)
+			for (int j=0; j<5; j++)
+				assert_true(buffer[5*i+j] == 5*(size - 1 - i)+j);
+
+		delete_vtable(vtable);
+	}
+
+	free(buffer_idxlist);
+}
+
+/**
+ * @brief Test03 of cpu packing
+ * 
+ * @details Fill buffer with a reversed buffer index list converting
+ *          doubles to float and to bfloat16 (single values and blocks of 3).
+ * 
+ * @ingroup backend_cpu_tests
+ */
+static void packing_cpu_test03(void **state __attribute__((unused))) {
+
+	const int size = 10;
+	// create and fill buffer idxlist array
+	int * buffer_idxlist = (int *)malloc(size*sizeof(int));
+	for (int i=0; i<size; i++)
+		buffer_idxlist[i] = size - 1 - i;
+
+	// float tests
+	{
+		t_kernels *vtable = new_vtable_cpu_reduced_precision(3, precision_float);
+		assert_true(vtable->type_size == 3*sizeof(float));
+		assert_true(vtable->local_type_size == 3*sizeof(double));
+		double data[3*size];
+		float buffer[3*size];
+		for (int i=0; i<3*size; i++)
+			data[i] = (double)i + 0.1;
+
+		vtable->pack(buffer, data, buffer_idxlist, size, 0, NULL, vtable->type_size);
+		for (int i=0; i<size; i++)
+			for (int j=0; j<3; j++)
+				assert_true(buffer[3*i+j] == (float)((double)(3*(size - 1 - i)+j) + 0.1));
+
+		delete_vtable(vtable);
+	}
+
+	// bfloat16 tests (integers up to 256 are exact)
+	{
+		t_kernels *vtable = new_vtable_cpu_reduced_precision(1, precision_bfloat16);
+		assert_true(vtable->type_size == sizeof(uint16_t));
+		double data[size];
+		uint16_t buffer[size];
+		for (int i=0; i<size; i++)
+			data[i] = (double)i;
+
+		vtable->pack(buffer, data, buffer_idxlist, size, 0, NULL, vtable->type_size);
+		for (int i=0; i<size; i++) {
+			float value = (float)(size - 1 - i);
+			uint32_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			assert_true(buffer[i] == (uint16_t)(bits >> 16));
+		}
+
+		// rounding to nearest
+		data[0] = 1.0 + 1.0 / 256.0 + 1.0 / 1024.0;
+		vtable->pack(buffer, data, buffer_idxlist, 1, size-1, NULL, vtable->type_size);
+		assert_true(buffer[size-1] == 0x3f81);
+
+		// a single rounding (through float the value would be a tie rounded to 0x3f80)
+		data[0] = 1.0 + 1.0 / 256.0 + 1.0 / 1073741824.0;
+		vtable->pack(buffer, data, buffer_idxlist, 1, size-1, NULL, vtable->type_size);
+		assert_true(buffer[size-1] == 0x3f81);
+
+		delete_vtable(vtable);
+	}
+
+	free(buffer_idxlist);
+}
+
 int main(void) {
 
 	const struct CMUnitTest tests[] = {
 		cmocka_unit_test(packing_cpu_test01),
+		cmocka_unit_test(packing_cpu_test02),
+		cmocka_unit_test(packing_cpu_test03),
 	};
 	return cmocka_run_group_tests(tests, NULL, NULL);
 }
\ No newline at end of file
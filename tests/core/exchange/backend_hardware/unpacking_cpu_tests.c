@@ -36,8 +36,11 @@
 #include <stddef.h>
 #include <cmocka.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 
 #include "src/core/exchange/backend_hardware/backend_cpu.h"
+#include "src/setup/setting.h"
 
 /**
  * @brief Test01 of cpu unpacking
@@ -58,7 +61,7 @@ static void unpacking_cpu_test01(void **state __attribute__((unused))) {
 
 	// Integer tests
 	{
-		t_kernels *vtable = new_vtable_cpu(MPI_INT);
+		t_kernels *vtable = new_vtable_cpu(sizeof(int));
 		// create data array
 		int *data = (int *)malloc(size*sizeof(int));
 		// create and fill buffer array
@@ -66,7 +69,7 @@ static void unpacking_cpu_test01(void **state __attribute__((unused))) {
 		for (int i=0; i<size; i++)
 			buffer[i] = i;
 
-		vtable->unpack(buffer, data, buffer_idxlist, size, 0, NULL);
+		vtable->unpack(buffer, data, buffer_idxlist, size, 0, NULL, vtable->type_size);
 		for (int i=0; i<size; i++)
 			assert_true(data[i] == i);
 
@@ -77,7 +80,7 @@ static void unpacking_cpu_test01(void **state __attribute__((unused))) {
 
 	// Float tests
 	{
-		t_kernels *vtable = new_vtable_cpu(MPI_REAL);
+		t_kernels *vtable = new_vtable_cpu(sizeof(float));
 		// create data array
 		float *data = (float *)malloc(size*sizeof(float));
 		// create and fill buffer array
@@ -85,7 +88,7 @@ static void unpacking_cpu_test01(void **state __attribute__((unused))) {
 		for (int i=0; i<size; i++)
 			buffer[i] = (float)i;
 
-		vtable->unpack(buffer, data, buffer_idxlist, size, 0, NULL);
+		vtable->unpack(buffer, data, buffer_idxlist, size, 0, NULL, vtable->type_size);
 		for (int i=0; i<size; i++)
 			assert_true(data[i] == (float)i);
 
@@ -96,7 +99,7 @@ static void unpacking_cpu_test01(void **state __attribute__((unused))) {
 
 	// Double tests
 	{
-		t_kernels *vtable = new_vtable_cpu(MPI_DOUBLE);
+		t_kernels *vtable = new_vtable_cpu(sizeof(double));
 		// create data array
 		double *data = (double *)malloc(size*sizeof(double));
 
@@ -105,7 +108,7 @@ static void unpacking_cpu_test01(void **state __attribute__((unused))) {
 		for (int i=0; i<size; i++)
 			buffer[i] = (double)i;
 
-		vtable->unpack(buffer, data, buffer_idxlist, size, 0, NULL);
+		vtable->unpack(buffer, data, buffer_idxlist, size, 0, NULL, vtable->type_size);
 		for (int i=0; i<size; i++)
 			assert_true(data[i] == (double)i);
 
@@ -117,10 +120,167 @@ static void unpacking_cpu_test01(void **state __attribute__((unused))) {
 	free(buffer_idxlist);
 }
 
+/**
+ * @brief Test02 of cpu unpacking
+ * 
+ * @details Fill data with a reversed buffer index list.
+ *          Elements of 1, 8, 16 and 24 bytes and a 20 bytes block
+ *          (generic unpacking function) are tested.
+ * 
+ * @ingroup backend_cpu_tests
+ */
+static void unpacking_cpu_test02(void **state __attribute__((unused))) {
+
+	const int size = 10;
+	// create and fill buffer idxlist array
+	int * buffer_idxlist = (int *)malloc(size*sizeof(int));
+	for (int i=0; i<size; i++)
+		buffer_idxlist[i] = size - 1 - i;
+
+	// 1 byte tests
+	{
+		t_kernels *vtable = new_vtable_cpu(sizeof(char));
+		char data[size];
+		char buffer[size];
+		for (int i=0; i<size; i++)
+			buffer[i] = (char)i;
+
+		vtable->unpack(buffer, data, buffer_idxlist, size, 0, NULL, vtable->type_size);
+		for (int i=0; i<size; i++)
+			assert_true(data[i] == (char)(size - 1 - i));
+
+		delete_vtable(vtable);
+	}
+
+	// 8 bytes tests
+	{
+		t_kernels *vtable = new_vtable_cpu(sizeof(long long));
+		long long data[size];
+		long long buffer[size];
+		for (int i=0; i<size; i++)
+			buffer[i] = (1LL << 40) + i;
+
+		vtable->unpack(buffer, data, buffer_idxlist, size, 0, NULL, vtable->type_size);
+		for (int i=0; i<size; i++)
+			assert_true(data[i] == (1LL << 40) + size - 1 - i);
+
+		delete_vtable(vtable);
+	}
+
+	// 16 bytes tests
+	{
+		t_kernels *vtable = new_vtable_cpu(2*sizeof(double));
+		double data[2*size];
+		double buffer[2*size];
+		for (int i=0; i<size; i++) {
+			buffer[2*i  ] = (double)i;
+			buffer[2*i+1] = (double)-i;
+		}
+
+		vtable->unpack(buffer, data, buffer_idxlist, size, 0, NULL, vtable->type_size);
+		for (int i=0; i<size; i++) {
+			assert_true(data[2*i  ] == (double)(size - 1 - i));
+			assert_true(data[2*i+1] == (double)-(size - 1 - i));
+		}
+
+		delete_vtable(vtable);
+	}
+
+	// 24 bytes tests
+	{
+		t_kernels *vtable = new_vtable_cpu(3*sizeof(double));
+		double data[3*size];
+		double buffer[3*size];
+		for (int i=0; i<3*size; i++)
+			buffer[i] = (double)i;
+
+		vtable->unpack(buffer, data, buffer_idxlist, size, 0, NULL, vtable->type_size);
+		for (int i=0; i<size; i++)
+			for (int j=0; j<3; j++)
+				assert_true(data[3*i+j] == (double)(3*(size - 1 - i)+j));
+
+		delete_vtable(vtable);
+	}
+
+	// 20 bytes tests
+	{
+		t_kernels *vtable = new_vtable_cpu(5*sizeof(int));
+		int data[5*size];
+		int buffer[5*size];
+		for (int i=0; i<5*size; i++)
+			buffer[i] = i;
+
+		vtable->unpack(buffer, data, buffer_idxlist, size, 0, NULL, vtable->type_size);
+		for (int i=0; i<size; i++)
+			for (int j=0; j<5; j++)
+				assert_true(data[5*i+j] == 5*(size - 1 - i)+j);
+
+		delete_vtable(vtable);
+	}
+
+	free(buffer_idxlist);
+}
+
+/**
+ * @brief Test03 of cpu unpacking
+ * 
+ * @details Unpack buffer with a reversed buffer index list converting
+ *          float and bfloat16 to doubles (single values and blocks of 3).
+ * 
+ * @ingroup backend_cpu_tests
+ */
+static void unpacking_cpu_test03(void **state __attribute__((unused))) {
+
+	const int size = 10;
+	// create and fill buffer idxlist array
+	int * buffer_idxlist = (int *)malloc(size*sizeof(int));
+	for (int i=0; i<size; i++)
+		buffer_idxlist[i] = size - 1 - i;
+
+	// float tests
+	{
+		t_kernels *vtable = new_vtable_cpu_reduced_precision(3, precision_float);
+		double data[3*size];
+		float buffer[3*size];
+		for (int i=0; i<3*size; i++)
+			buffer[i] = (float)i + 0.5f;
+
+		vtable->unpack(buffer, data, buffer_idxlist, size, 0, NULL, vtable->type_size);
+		for (int i=0; i<size; i++)
+			for (int j=0; j<3; j++)
+				assert_true(data[3*i+j] == (double)(3*(size - 1 - i)+j) + 0.5);
+
+		delete_vtable(vtable);
+	}
+
+	// bfloat16 tests
+	{
+		t_kernels *vtable = new_vtable_cpu_reduced_precision(1, precision_bfloat16);
+		double data[size];
+		uint16_t buffer[size];
+		for (int i=0; i<size; i++) {
+			float value = (float)i;
+			uint32_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			buffer[i] = (uint16_t)(bits >> 16);
+		}
+
+		vtable->unpack(buffer, data, buffer_idxlist, size, 0, NULL, vtable->type_size);
+		for (int i=0; i<size; i++)
+			assert_true(data[i] == (double)(size - 1 - i));
+
+		delete_vtable(vtable);
+	}
+
+	free(buffer_idxlist);
+}
+
 int main(void) {
 
 	const struct CMUnitTest tests[] = {
 		cmocka_unit_test(unpacking_cpu_test01),
+		cmocka_unit_test(unpacking_cpu_test02),
+		cmocka_unit_test(unpacking_cpu_test03),
 	};
 	return cmocka_run_group_tests(tests, NULL, NULL);
 }
\ No newline at end of file
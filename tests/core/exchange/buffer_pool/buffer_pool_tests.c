@@ -0,0 +1,175 @@
+/*
+ * @file buffer_pool_tests.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdarg.h>
+#include <setjmp.h>
+#include <stddef.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "src/core/exchange/buffer_pool/buffer_pool.h"
+
+static void* allocator_test(size_t buffer_size) {
+
+	return malloc(buffer_size);
+}
+
+static void deallocator_test(void *buffer) {
+
+	free(buffer);
+}
+
+/**
+ * @brief Test01 of buffer_pool
+ * 
+ * @details Acquire and release buffers of different sizes: a released buffer
+ *          is reused for a request of the same size class, buffers in use at
+ *          the same time are different and a retained buffer is returned to
+ *          the pool only after the last release.
+ * 
+ * @ingroup buffer_pool_tests
+ */
+static void buffer_pool_test01(void **state __attribute__((unused))) {
+
+	t_buffer_block *block1 = buffer_pool_acquire(1000, malloc, free);
+	assert_int_equal(block1->size, 1024);
+	assert_int_equal(buffer_pool_allocated_size(), 1024);
+	buffer_pool_release(block1);
+
+	// same size class
+	t_buffer_block *block2 = buffer_pool_acquire(600, malloc, free);
+	assert_ptr_equal(block1, block2);
+	assert_int_equal(buffer_pool_allocated_size(), 1024);
+
+	// buffer in use
+	t_buffer_block *block3 = buffer_pool_acquire(600, malloc, free);
+	assert_ptr_not_equal(block2, block3);
+	assert_int_equal(buffer_pool_allocated_size(), 2048);
+
+	// smallest size class
+	t_buffer_block *block4 = buffer_pool_acquire(1, malloc, free);
+	assert_int_equal(block4->size, 1 << BUFFER_POOL_MIN_CLASS);
+
+	// retained buffer
+	buffer_pool_retain(block3);
+	buffer_pool_release(block3);
+	assert_int_equal(block3->refcount, 1);
+	buffer_pool_release(block2);
+	t_buffer_block *block5 = buffer_pool_acquire(1024, malloc, free);
+	assert_ptr_equal(block2, block5);
+	buffer_pool_release(block3);
+	buffer_pool_release(block4);
+	buffer_pool_release(block5);
+
+	buffer_pool_clear();
+	assert_int_equal(buffer_pool_allocated_size(), 0);
+}
+
+/**
+ * @brief Test02 of buffer_pool
+ * 
+ * @details Buffers allocated with different allocators (hardware) are not shared.
+ * 
+ * @ingroup buffer_pool_tests
+ */
+static void buffer_pool_test02(void **state __attribute__((unused))) {
+
+	t_buffer_block *block1 = buffer_pool_acquire(5000, malloc, free);
+	buffer_pool_release(block1);
+
+	t_buffer_block *block2 = buffer_pool_acquire(5000, allocator_test, deallocator_test);
+	assert_ptr_not_equal(block1, block2);
+	assert_int_equal(block2->size, 8192);
+	buffer_pool_release(block2);
+
+	t_buffer_block *block3 = buffer_pool_acquire(4097, allocator_test, deallocator_test);
+	assert_ptr_equal(block2, block3);
+	buffer_pool_release(block3);
+
+	buffer_pool_clear();
+	assert_int_equal(buffer_pool_allocated_size(), 0);
+}
+
+#define NTHREADS 4
+#define NITERATIONS 1000
+
+static void * buffer_pool_thread(void *arg) {
+
+	(void)arg;
+
+	for (int i = 0; i < NITERATIONS; i++) {
+		t_buffer_block *block1 = buffer_pool_acquire(3000, malloc, free);
+		t_buffer_block *block2 = buffer_pool_acquire(1 + i % 2000, malloc, free);
+		buffer_pool_retain(block1);
+		buffer_pool_release(block1);
+		buffer_pool_release(block2);
+		buffer_pool_release(block1);
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Test03 of buffer_pool
+ * 
+ * @details Threads acquire and release buffers at the same time. At most two
+ *          buffers per thread are in use at the same time, so the pool allocates
+ *          at most two buffers of each class per thread.
+ * 
+ * @ingroup buffer_pool_tests
+ */
+static void buffer_pool_test03(void **state __attribute__((unused))) {
+
+	pthread_t threads[NTHREADS];
+	for (int i = 0; i < NTHREADS; i++)
+		assert_int_equal(pthread_create(&threads[i], NULL, buffer_pool_thread, NULL), 0);
+	for (int i = 0; i < NTHREADS; i++)
+		pthread_join(threads[i], NULL);
+
+	// classes of 256, 512, 1024, 2048 and 4096 bytes
+	assert_true(buffer_pool_allocated_size() <= 2 * NTHREADS * (256 + 512 + 1024 + 2048 + 4096));
+
+	buffer_pool_clear();
+	assert_int_equal(buffer_pool_allocated_size(), 0);
+}
+
+int main(void) {
+
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(buffer_pool_test01),
+		cmocka_unit_test(buffer_pool_test02),
+		cmocka_unit_test(buffer_pool_test03),
+	};
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,145 @@
+/*
+ * @file compression_tests.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdarg.h>
+#include <setjmp.h>
+#include <stddef.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/core/exchange/compression/compression.h"
+
+/**
+ * @brief Test01 of compression
+ * 
+ * @details Compress and decompress arrays of doubles: a constant field
+ *          (e.g. masked land points), a smooth field and a field
+ *          with pseudo random values. The round trip must be exact and
+ *          the constant field must compress well.
+ * 
+ * @ingroup compression_tests
+ */
+static void compression_test01(void **state __attribute__((unused))) {
+
+	const size_t size = 1000;
+	const size_t nbytes = size * sizeof(double);
+	double *data = (double *)malloc(nbytes);
+	double *result = (double *)malloc(nbytes);
+	char *compressed = (char *)malloc(compress_bound(nbytes));
+	char *work = (char *)malloc(nbytes);
+
+	// constant field
+	{
+		for (size_t i = 0; i < size; i++)
+			data[i] = -9999.0;
+
+		size_t csize = compress_bytes(data, nbytes, sizeof(double), compressed, work);
+		assert_true(csize * 10 < nbytes);
+		decompress_bytes(compressed, csize, sizeof(double), result, nbytes, work);
+		assert_memory_equal(data, result, nbytes);
+	}
+
+	// smooth field with a masked region
+	{
+		for (size_t i = 0; i < size; i++)
+			data[i] = i < size / 2 ? 280.0 + (double)(i / 10) * 0.5 : 0.0;
+
+		size_t csize = compress_bytes(data, nbytes, sizeof(double), compressed, work);
+		assert_true(csize < nbytes / 2);
+		decompress_bytes(compressed, csize, sizeof(double), result, nbytes, work);
+		assert_memory_equal(data, result, nbytes);
+	}
+
+	// pseudo random field
+	{
+		unsigned int seed = 12345;
+		for (size_t i = 0; i < size; i++) {
+			seed = seed * 1103515245u + 12345u;
+			data[i] = (double)seed / 3.0;
+		}
+
+		size_t csize = compress_bytes(data, nbytes, sizeof(double), compressed, work);
+		assert_true(csize <= compress_bound(nbytes));
+		decompress_bytes(compressed, csize, sizeof(double), result, nbytes, work);
+		assert_memory_equal(data, result, nbytes);
+	}
+
+	free(data);
+	free(result);
+	free(compressed);
+	free(work);
+}
+
+/**
+ * @brief Test02 of compression
+ * 
+ * @details Compress and decompress arrays of 1 byte and 12 bytes elements
+ *          with runs at the boundaries of the run length encoding.
+ * 
+ * @ingroup compression_tests
+ */
+static void compression_test02(void **state __attribute__((unused))) {
+
+	const size_t nbytes = 12 * 300;
+	unsigned char *data = (unsigned char *)malloc(nbytes);
+	unsigned char *result = (unsigned char *)malloc(nbytes);
+	char *compressed = (char *)malloc(compress_bound(nbytes));
+	char *work = (char *)malloc(nbytes);
+
+	for (size_t i = 0; i < nbytes; i++)
+		data[i] = (i % 131 < 2) ? (unsigned char)i : (unsigned char)(i / 131);
+
+	size_t type_sizes[2] = {1, 12};
+	for (int t = 0; t < 2; t++) {
+		size_t csize = compress_bytes(data, nbytes, type_sizes[t], compressed, work);
+		assert_true(csize <= compress_bound(nbytes));
+		memset(result, 0, nbytes);
+		decompress_bytes(compressed, csize, type_sizes[t], result, nbytes, work);
+		assert_memory_equal(data, result, nbytes);
+	}
+
+	free(data);
+	free(result);
+	free(compressed);
+	free(work);
+}
+
+int main(void) {
+
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(compression_test01),
+		cmocka_unit_test(compression_test02),
+	};
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,165 @@
+/*
+ * @file delta_tests.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdarg.h>
+#include <setjmp.h>
+#include <stddef.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "src/core/exchange/delta/delta.h"
+
+/**
+ * @brief Test01 of delta
+ * 
+ * @details Encode and decode two messages of doubles in successive exchanges:
+ *          the first exchange sends the full messages, then an unchanged message
+ *          is sent as header only, a few changed values are sent as sparse
+ *          message and many changed values as full message.
+ * 
+ * @ingroup delta_tests
+ */
+static void delta_test01(void **state __attribute__((unused))) {
+
+	const int size = 100;
+	int buffer_offset[2] = {0, 60};
+	t_map_exch map_exch = {.count = 2, .exch = NULL, .buffer_size = size,
+	                       .buffer_idxlist = NULL, .buffer_idxlist_gpu = NULL,
+	                       .buffer_offset = buffer_offset};
+
+	t_delta *send = new_delta(&map_exch, sizeof(double), 1);
+	t_delta *recv = new_delta(&map_exch, sizeof(double), 0);
+
+	double *data = (double *)malloc(size * sizeof(double));
+	double *result = (double *)malloc(size * sizeof(double));
+	for (int i = 0; i < size; i++) {
+		data[i] = (double)i;
+		result[i] = -1.0;
+	}
+
+	const int msg_size[2] = {60, 40};
+	int expected_nbytes[2];
+
+	for (int step = 0; step < 4; step++) {
+
+		if (step == 2) data[3] = 1000.0;
+		if (step == 3)
+			for (int i = 0; i < size; i++) data[i] += 1.0;
+
+		for (int count = 0; count < 2; count++) {
+			int nbytes, max_nbytes;
+			void *message = delta_encode(send, count, data + buffer_offset[count], &nbytes);
+			void *recv_message = delta_recv_buffer(recv, count, &max_nbytes);
+			assert_true(nbytes <= max_nbytes);
+			memcpy(recv_message, message, nbytes);
+			delta_decode(recv, count, result + buffer_offset[count]);
+
+			if (step == 0 || step == 3)
+				expected_nbytes[count] = DELTA_HEADER_SIZE + msg_size[count] * sizeof(double);
+			else if (step == 2 && count == 0)
+				expected_nbytes[count] = DELTA_HEADER_SIZE + sizeof(int32_t) + sizeof(double);
+			else
+				expected_nbytes[count] = DELTA_HEADER_SIZE;
+			assert_int_equal(nbytes, expected_nbytes[count]);
+		}
+		delta_commit(send);
+
+		assert_memory_equal(data, result, size * sizeof(double));
+	}
+
+	delete_delta(send);
+	delete_delta(recv);
+	free(data);
+	free(result);
+}
+
+/**
+ * @brief Test02 of delta
+ * 
+ * @details Encode and decode a message of 12 bytes elements with changes
+ *          at the boundaries of the message.
+ * 
+ * @ingroup delta_tests
+ */
+static void delta_test02(void **state __attribute__((unused))) {
+
+	const int size = 50;
+	const size_t type_size = 12;
+	int buffer_offset[1] = {0};
+	t_map_exch map_exch = {.count = 1, .exch = NULL, .buffer_size = size,
+	                       .buffer_idxlist = NULL, .buffer_idxlist_gpu = NULL,
+	                       .buffer_offset = buffer_offset};
+
+	t_delta *send = new_delta(&map_exch, type_size, 1);
+	t_delta *recv = new_delta(&map_exch, type_size, 0);
+
+	unsigned char *data = (unsigned char *)malloc(size * type_size);
+	unsigned char *result = (unsigned char *)malloc(size * type_size);
+	for (size_t i = 0; i < size * type_size; i++)
+		data[i] = (unsigned char)i;
+
+	for (int step = 0; step < 3; step++) {
+
+		/* change one byte of the first and of the last element */
+		if (step > 0) {
+			data[0] += 1;
+			data[size * type_size - 1] += 1;
+		}
+
+		int nbytes, max_nbytes;
+		void *message = delta_encode(send, 0, data, &nbytes);
+		void *recv_message = delta_recv_buffer(recv, 0, &max_nbytes);
+		memcpy(recv_message, message, nbytes);
+		delta_decode(recv, 0, result);
+		delta_commit(send);
+
+		if (step > 0) assert_int_equal(nbytes, DELTA_HEADER_SIZE + 2 * (sizeof(int32_t) + type_size));
+		assert_memory_equal(data, result, size * type_size);
+	}
+
+	delete_delta(send);
+	delete_delta(recv);
+	free(data);
+	free(result);
+}
+
+int main(void) {
+
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(delta_test01),
+		cmocka_unit_test(delta_test02),
+	};
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
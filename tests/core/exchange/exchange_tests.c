@@ -36,6 +36,8 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <math.h>
 
 #include "src/distdir.h"
 
@@ -69,8 +71,6 @@
  */
 static int exchange_test01(MPI_Comm comm) {
 
-	distdir_initialize();
-
 	const int I_SRC = 0;
 	const int I_DST = 1;
 	const int NCOLS = 4;
@@ -164,16 +164,1584 @@ static int exchange_test01(MPI_Comm comm) {
 	// synch error among processes
 	MPI_Allreduce(&error, &error, 1, MPI_INT, MPI_SUM, comm);
 
-	distdir_finalize();
+	return error;
+}
+
+/**
+ * @brief test02 for exchange module
+ * 
+ * @details Same domain decomposition of test01.
+ * 
+ *          The exchange is tested with 1 byte (MPI_SIGNED_CHAR), 8 bytes (MPI_LONG_LONG),
+ *          16 bytes (MPI_C_DOUBLE_COMPLEX) elements and with a user defined datatype made of
+ *          three doubles.
+ * 
+ * @ingroup exchange_tests
+ */
+static int exchange_test02(MPI_Comm comm) {
+
+	const int I_SRC = 0;
+	const int I_DST = 1;
+	const int NCOLS = 4;
+	const int NROWS = 4;
+
+	int world_rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+	int world_size;
+	MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+	int world_role;
+	int npoints_local = NCOLS * NROWS / (world_size / 2);
+	int idxlist[npoints_local];
+	t_idxlist *p_idxlist;
+	t_idxlist *p_idxlist_empty;
+	t_map *p_map;
+	int error = 0;
+
+	if (world_size != 4) error = 1;
+
+	// index list with global indices
+	if (world_rank < 2) {
+		world_role = I_SRC;
+		int ncols_local = NCOLS / (world_size / 2);
+		for (int i=0; i < NROWS; i++)
+			for (int j=0; j < ncols_local; j++)
+				idxlist[j+i*ncols_local] = j + i * NCOLS + world_rank * (NCOLS - ncols_local);
+	} else {
+		world_role = I_DST;
+		int nrows_local = NROWS / (world_size / 2);
+		for (int i=0; i < nrows_local; i++)
+			for (int j=0; j < NCOLS; j++)
+				idxlist[j+i*NCOLS] = j + i * NCOLS + (world_rank - (world_size / 2)) * (NROWS - nrows_local) * NCOLS;
+	}
+
+	p_idxlist = new_idxlist(idxlist, npoints_local);
+	p_idxlist_empty = new_idxlist_empty();
+
+	if (world_role == I_SRC) {
+		p_map = new_map(p_idxlist, p_idxlist_empty, -1, MPI_COMM_WORLD);
+	} else {
+		p_map = new_map(p_idxlist_empty, p_idxlist, -1, MPI_COMM_WORLD);
+	}
+
+	// solutions for processes 2 and 3
+	int solution2[LSIZE] = {0, 1, 8, 9, 2, 3, 10, 11};
+	int solution3[LSIZE] = {4, 5, 12, 13, 6, 7, 14, 15};
+	int *solution = world_rank == 2 ? solution2 : solution3;
+
+	// signed char
+	{
+		t_exchanger *exchanger = new_exchanger(p_map, MPI_SIGNED_CHAR, CPU);
+		signed char data[npoints_local];
+		if (world_role == I_SRC)
+			for (int i = 0; i < npoints_local; i++)
+				data[i] = i + npoints_local * world_rank;
+
+		exchanger_go(exchanger, data, data);
+		delete_exchanger(exchanger);
+
+		if (world_role == I_DST)
+			for (int i = 0; i < npoints_local; i++)
+				if (data[i] != solution[i])
+					error = 1;
+	}
+
+	// long long
+	{
+		t_exchanger *exchanger = new_exchanger(p_map, MPI_LONG_LONG, CPU);
+		long long data[npoints_local];
+		if (world_role == I_SRC)
+			for (int i = 0; i < npoints_local; i++)
+				data[i] = (1LL << 40) + i + npoints_local * world_rank;
+
+		exchanger_go(exchanger, data, data);
+		delete_exchanger(exchanger);
+
+		if (world_role == I_DST)
+			for (int i = 0; i < npoints_local; i++)
+				if (data[i] != (1LL << 40) + solution[i])
+					error = 1;
+	}
+
+	// double complex
+	{
+		t_exchanger *exchanger = new_exchanger(p_map, MPI_C_DOUBLE_COMPLEX, CPU);
+		double data[2*npoints_local];
+		if (world_role == I_SRC)
+			for (int i = 0; i < npoints_local; i++) {
+				data[2*i  ] =  (double)(i + npoints_local * world_rank);
+				data[2*i+1] = -(double)(i + npoints_local * world_rank);
+			}
+
+		exchanger_go(exchanger, data, data);
+		delete_exchanger(exchanger);
+
+		if (world_role == I_DST)
+			for (int i = 0; i < npoints_local; i++)
+				if (data[2*i] != (double)solution[i] || data[2*i+1] != -(double)solution[i])
+					error = 1;
+	}
+
+	// user defined datatype
+	{
+		MPI_Datatype type;
+		MPI_Type_contiguous(3, MPI_DOUBLE, &type);
+		MPI_Type_commit(&type);
+
+		t_exchanger *exchanger = new_exchanger(p_map, type, CPU);
+		double data[3*npoints_local];
+		if (world_role == I_SRC)
+			for (int i = 0; i < npoints_local; i++)
+				for (int j = 0; j < 3; j++)
+					data[3*i+j] = (double)(i + npoints_local * world_rank) + 0.25 * j;
+
+		exchanger_go(exchanger, data, data);
+		delete_exchanger(exchanger);
+
+		if (world_role == I_DST)
+			for (int i = 0; i < npoints_local; i++)
+				for (int j = 0; j < 3; j++)
+					if (data[3*i+j] != (double)solution[i] + 0.25 * j)
+						error = 1;
+
+		MPI_Type_free(&type);
+	}
+
+	delete_idxlist(p_idxlist);
+	delete_idxlist(p_idxlist_empty);
+	delete_map(p_map);
+
+	// synch error among processes
+	MPI_Allreduce(&error, &error, 1, MPI_INT, MPI_SUM, comm);
 
 	return error;
 }
 
-int main() {
+/**
+ * @brief test03 for exchange module
+ * 
+ * @details Same domain decomposition of test01.
+ * 
+ *          The exchange of multi-component fields is tested with blocks of
+ *          3 doubles (u, v, w), 2 floats and 5 integers, which uses the generic
+ *          packing functions.
+ * 
+ * @ingroup exchange_tests
+ */
+static int exchange_test03(MPI_Comm comm) {
+
+	const int I_SRC = 0;
+	const int I_DST = 1;
+	const int NCOLS = 4;
+	const int NROWS = 4;
+
+	int world_rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+	int world_size;
+	MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+	int world_role;
+	int npoints_local = NCOLS * NROWS / (world_size / 2);
+	int idxlist[npoints_local];
+	t_idxlist *p_idxlist;
+	t_idxlist *p_idxlist_empty;
+	t_map *p_map;
+	int error = 0;
+
+	if (world_size != 4) error = 1;
+
+	// index list with global indices
+	if (world_rank < 2) {
+		world_role = I_SRC;
+		int ncols_local = NCOLS / (world_size / 2);
+		for (int i=0; i < NROWS; i++)
+			for (int j=0; j < ncols_local; j++)
+				idxlist[j+i*ncols_local] = j + i * NCOLS + world_rank * (NCOLS - ncols_local);
+	} else {
+		world_role = I_DST;
+		int nrows_local = NROWS / (world_size / 2);
+		for (int i=0; i < nrows_local; i++)
+			for (int j=0; j < NCOLS; j++)
+				idxlist[j+i*NCOLS] = j + i * NCOLS + (world_rank - (world_size / 2)) * (NROWS - nrows_local) * NCOLS;
+	}
+
+	p_idxlist = new_idxlist(idxlist, npoints_local);
+	p_idxlist_empty = new_idxlist_empty();
+
+	if (world_role == I_SRC) {
+		p_map = new_map(p_idxlist, p_idxlist_empty, -1, MPI_COMM_WORLD);
+	} else {
+		p_map = new_map(p_idxlist_empty, p_idxlist, -1, MPI_COMM_WORLD);
+	}
+
+	// solutions for processes 2 and 3
+	int solution2[LSIZE] = {0, 1, 8, 9, 2, 3, 10, 11};
+	int solution3[LSIZE] = {4, 5, 12, 13, 6, 7, 14, 15};
+	int *solution = world_rank == 2 ? solution2 : solution3;
+
+	// vector field of 3 doubles
+	{
+		t_exchanger *exchanger = new_exchanger_with_block_size(p_map, MPI_DOUBLE, 3, CPU);
+		double data[3*npoints_local];
+		if (world_role == I_SRC)
+			for (int i = 0; i < npoints_local; i++)
+				for (int j = 0; j < 3; j++)
+					data[3*i+j] = (double)(i + npoints_local * world_rank) + 0.25 * j;
+
+		exchanger_go(exchanger, data, data);
+		delete_exchanger(exchanger);
+
+		if (world_role == I_DST)
+			for (int i = 0; i < npoints_local; i++)
+				for (int j = 0; j < 3; j++)
+					if (data[3*i+j] != (double)solution[i] + 0.25 * j)
+						error = 1;
+	}
+
+	// 2 floats
+	{
+		t_exchanger *exchanger = new_exchanger_with_block_size(p_map, MPI_FLOAT, 2, CPU);
+		float data[2*npoints_local];
+		if (world_role == I_SRC)
+			for (int i = 0; i < npoints_local; i++)
+				for (int j = 0; j < 2; j++)
+					data[2*i+j] = (float)(i + npoints_local * world_rank) + 0.5f * j;
+
+		exchanger_go(exchanger, data, data);
+		delete_exchanger(exchanger);
+
+		if (world_role == I_DST)
+			for (int i = 0; i < npoints_local; i++)
+				for (int j = 0; j < 2; j++)
+					if (data[2*i+j] != (float)solution[i] + 0.5f * j)
+						error = 1;
+	}
+
+	// 5 integers
+	{
+		t_exchanger *exchanger = new_exchanger_with_block_size(p_map, MPI_INT, 5, CPU);
+		int data[5*npoints_local];
+		if (world_role == I_SRC)
+			for (int i = 0; i < npoints_local; i++)
+				for (int j = 0; j < 5; j++)
+					data[5*i+j] = 100 * (i + npoints_local * world_rank) + j;
+
+		exchanger_go(exchanger, data, data);
+		delete_exchanger(exchanger);
+
+		if (world_role == I_DST)
+			for (int i = 0; i < npoints_local; i++)
+				for (int j = 0; j < 5; j++)
+					if (data[5*i+j] != 100 * solution[i] + j)
+						error = 1;
+	}
+
+	delete_idxlist(p_idxlist);
+	delete_idxlist(p_idxlist_empty);
+	delete_map(p_map);
 
+	// synch error among processes
+	MPI_Allreduce(&error, &error, 1, MPI_INT, MPI_SUM, comm);
+
+	return error;
+}
+
+/**
+ * @brief test04 for exchange module
+ * 
+ * @details The test uses a total of 4 MPI processes over a 4x4 global 2D domain.
+ *          The source decomposition is by rows and the destination one by columns,
+ *          so each process also exchanges one point with itself:
+ * 
+ *          Rank r
+ *          Source indices: 4r, 4r+1, 4r+2, 4r+3
+ *          Destination indices: r, r+4, r+8, r+12
+ * 
+ *          Doubles are exchanged with float and bfloat16 precision on the wire,
+ *          with the C (MPI_DOUBLE) and the Fortran (MPI_DOUBLE_PRECISION) handles.
+ *          The point exchanged with the same process keeps the full precision.
+ * 
+ * @ingroup exchange_tests
+ */
+static int exchange_test04(MPI_Comm comm) {
+
+	const int NCOLS = 4;
+	const int NROWS = 4;
+
+	int world_rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+	int world_size;
+	MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+	int npoints_local = NCOLS * NROWS / world_size;
+	int src_idxlist[npoints_local];
+	int dst_idxlist[npoints_local];
+	t_idxlist *p_src_idxlist;
+	t_idxlist *p_dst_idxlist;
+	t_map *p_map;
 	int error = 0;
 
-	error += exchange_test01(MPI_COMM_WORLD);
+	if (world_size != 4) error = 1;
+
+	for (int i = 0; i < npoints_local; i++) {
+		src_idxlist[i] = i + world_rank * NCOLS;
+		dst_idxlist[i] = world_rank + i * NCOLS;
+	}
+
+	p_src_idxlist = new_idxlist(src_idxlist, npoints_local);
+	p_dst_idxlist = new_idxlist(dst_idxlist, npoints_local);
+
+	p_map = new_map(p_src_idxlist, p_dst_idxlist, -1, MPI_COMM_WORLD);
+
+	// the exchange is in both directions
+	set_config_exchanger(IsendIrecv1);
+
+	MPI_Datatype types[2] = {MPI_DOUBLE, MPI_DOUBLE_PRECISION};
+	int precisions[2] = {precision_float, precision_bfloat16};
+	for (int t = 0; t < 2; t++)
+	for (int p = 0; p < 2; p++) {
+
+		set_config_precision(precisions[p]);
+		t_exchanger *exchanger = new_exchanger(p_map, types[t], CPU);
+		set_config_precision(precision_full);
+
+		double src_data[npoints_local];
+		double dst_data[npoints_local];
+		for (int i = 0; i < npoints_local; i++)
+			src_data[i] = (double)src_idxlist[i] + 1.0 / 3.0;
+
+		exchanger_go(exchanger, src_data, dst_data);
+		delete_exchanger(exchanger);
+
+		for (int i = 0; i < npoints_local; i++) {
+			double value = (double)dst_idxlist[i] + 1.0 / 3.0;
+			if (dst_idxlist[i] == world_rank * (NCOLS + 1)) {
+				if (dst_data[i] != value)
+					error = 1;
+			} else if (precisions[p] == precision_float) {
+				if (dst_data[i] != (double)(float)value)
+					error = 1;
+			} else {
+				if (dst_data[i] == value || fabs(dst_data[i] - value) > value / 256.0)
+					error = 1;
+			}
+		}
+	}
+
+	delete_idxlist(p_src_idxlist);
+	delete_idxlist(p_dst_idxlist);
+	delete_map(p_map);
+
+	// synch error among processes
+	MPI_Allreduce(&error, &error, 1, MPI_INT, MPI_SUM, comm);
+
+	return error;
+}
+
+/**
+ * @brief test05 for exchange module
+ * 
+ * @details The test uses a total of 4 MPI processes over a 64x64 global 2D domain
+ *          with the same type of domain decomposition of test01, so that the
+ *          messages are large enough to be compressed.
+ * 
+ *          A double field with a masked constant region and a smooth region and
+ *          an integer field with pseudo random values (poor compression ratio)
+ *          are exchanged several times with compression enabled.
+ * 
+ * @ingroup exchange_tests
+ */
+static int exchange_test05(MPI_Comm comm) {
+
+	const int I_SRC = 0;
+	const int I_DST = 1;
+	const int NCOLS = 64;
+	const int NROWS = 64;
+
+	int world_rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+	int world_size;
+	MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+	int world_role;
+	int npoints_local = NCOLS * NROWS / (world_size / 2);
+	int *idxlist = (int *)malloc(npoints_local * sizeof(int));
+	t_idxlist *p_idxlist;
+	t_idxlist *p_idxlist_empty;
+	t_map *p_map;
+	int error = 0;
+
+	if (world_size != 4) error = 1;
+
+	// index list with global indices
+	if (world_rank < 2) {
+		world_role = I_SRC;
+		int ncols_local = NCOLS / (world_size / 2);
+		for (int i=0; i < NROWS; i++)
+			for (int j=0; j < ncols_local; j++)
+				idxlist[j+i*ncols_local] = j + i * NCOLS + world_rank * (NCOLS - ncols_local);
+	} else {
+		world_role = I_DST;
+		int nrows_local = NROWS / (world_size / 2);
+		for (int i=0; i < nrows_local; i++)
+			for (int j=0; j < NCOLS; j++)
+				idxlist[j+i*NCOLS] = j + i * NCOLS + (world_rank - (world_size / 2)) * (NROWS - nrows_local) * NCOLS;
+	}
+
+	p_idxlist = new_idxlist(idxlist, npoints_local);
+	p_idxlist_empty = new_idxlist_empty();
+
+	if (world_role == I_SRC) {
+		p_map = new_map(p_idxlist, p_idxlist_empty, -1, MPI_COMM_WORLD);
+	} else {
+		p_map = new_map(p_idxlist_empty, p_idxlist, -1, MPI_COMM_WORLD);
+	}
+
+	set_config_compression(compression_on);
+	t_exchanger *exchanger_double = new_exchanger(p_map, MPI_DOUBLE, CPU);
+	t_exchanger *exchanger_int = new_exchanger(p_map, MPI_INT, CPU);
+	set_config_compression(compression_off);
+
+	double *data_double = (double *)malloc(npoints_local * sizeof(double));
+	int *data_int = (int *)malloc(npoints_local * sizeof(int));
+
+	for (int step = 0; step < 3; step++) {
+
+		for (int i = 0; i < npoints_local; i++) {
+			int idx = idxlist[i];
+			data_double[i] = world_role == I_DST ? 0.0 :
+			                 idx % NCOLS < NCOLS / 4 ? -9999.0 : 280.0 + 0.01 * (idx / NCOLS) + step;
+			data_int[i] = world_role == I_DST ? 0 : (int)((unsigned int)(idx + step) * 2654435761u);
+		}
+
+		exchanger_go(exchanger_double, data_double, data_double);
+		exchanger_go(exchanger_int, data_int, data_int);
+
+		if (world_role == I_DST)
+			for (int i = 0; i < npoints_local; i++) {
+				int idx = idxlist[i];
+				double value = idx % NCOLS < NCOLS / 4 ? -9999.0 : 280.0 + 0.01 * (idx / NCOLS) + step;
+				if (data_double[i] != value)
+					error = 1;
+				if (data_int[i] != (int)((unsigned int)(idx + step) * 2654435761u))
+					error = 1;
+			}
+	}
+
+	delete_exchanger(exchanger_double);
+	delete_exchanger(exchanger_int);
+
+	free(data_double);
+	free(data_int);
+	free(idxlist);
+	delete_idxlist(p_idxlist);
+	delete_idxlist(p_idxlist_empty);
+	delete_map(p_map);
+
+	// synch error among processes
+	MPI_Allreduce(&error, &error, 1, MPI_INT, MPI_SUM, comm);
+
+	return error;
+}
+
+/**
+ * @brief test06 for exchange module
+ * 
+ * @details The test uses a total of 4 MPI processes with the same domain decomposition
+ *          of test05. A double field is exchanged several times with the delta exchange
+ *          enabled: the field is static in the first steps, then a few values change
+ *          and finally all values change. The destination field is reset before
+ *          each exchange, so all values must come from the exchange.
+ * 
+ * @ingroup exchange_tests
+ */
+static int exchange_test06(MPI_Comm comm) {
+
+	const int I_SRC = 0;
+	const int I_DST = 1;
+	const int NCOLS = 16;
+	const int NROWS = 16;
+
+	int world_rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+	int world_size;
+	MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+	int world_role;
+	int npoints_local = NCOLS * NROWS / (world_size / 2);
+	int *idxlist = (int *)malloc(npoints_local * sizeof(int));
+	t_idxlist *p_idxlist;
+	t_idxlist *p_idxlist_empty;
+	t_map *p_map;
+	int error = 0;
+
+	if (world_size != 4) error = 1;
+
+	// index list with global indices
+	if (world_rank < 2) {
+		world_role = I_SRC;
+		int ncols_local = NCOLS / (world_size / 2);
+		for (int i=0; i < NROWS; i++)
+			for (int j=0; j < ncols_local; j++)
+				idxlist[j+i*ncols_local] = j + i * NCOLS + world_rank * (NCOLS - ncols_local);
+	} else {
+		world_role = I_DST;
+		int nrows_local = NROWS / (world_size / 2);
+		for (int i=0; i < nrows_local; i++)
+			for (int j=0; j < NCOLS; j++)
+				idxlist[j+i*NCOLS] = j + i * NCOLS + (world_rank - (world_size / 2)) * (NROWS - nrows_local) * NCOLS;
+	}
+
+	p_idxlist = new_idxlist(idxlist, npoints_local);
+	p_idxlist_empty = new_idxlist_empty();
+
+	if (world_role == I_SRC) {
+		p_map = new_map(p_idxlist, p_idxlist_empty, -1, MPI_COMM_WORLD);
+	} else {
+		p_map = new_map(p_idxlist_empty, p_idxlist, -1, MPI_COMM_WORLD);
+	}
+
+	set_config_delta(delta_on);
+	t_exchanger *exchanger = new_exchanger(p_map, MPI_DOUBLE, CPU);
+	set_config_delta(delta_off);
+
+	double *data = (double *)malloc(npoints_local * sizeof(double));
+
+	for (int step = 0; step < 6; step++) {
+
+		/* static field in steps 0-2, a few values change in step 3 and 4, all values in step 5 */
+		for (int i = 0; i < npoints_local; i++) {
+			int idx = idxlist[i];
+			double value = (double)idx;
+			if (step >= 3 && idx % 37 == 0) value += step;
+			if (step == 5) value = -value;
+			data[i] = world_role == I_DST ? 0.0 : value;
+		}
+
+		exchanger_go(exchanger, data, data);
+
+		if (world_role == I_DST)
+			for (int i = 0; i < npoints_local; i++) {
+				int idx = idxlist[i];
+				double value = (double)idx;
+				if (step >= 3 && idx % 37 == 0) value += step;
+				if (step == 5) value = -value;
+				if (data[i] != value)
+					error = 1;
+			}
+	}
+
+	delete_exchanger(exchanger);
+
+	free(data);
+	free(idxlist);
+	delete_idxlist(p_idxlist);
+	delete_idxlist(p_idxlist_empty);
+	delete_map(p_map);
+
+	// synch error among processes
+	MPI_Allreduce(&error, &error, 1, MPI_INT, MPI_SUM, comm);
+
+	return error;
+}
+
+/**
+ * @brief test07 for exchange module
+ * 
+ * @details The test uses a total of 4 MPI processes with the same domain decomposition
+ *          of test05. Two double fields and an integer field are exchanged several times
+ *          with exchangers using the buffer pool, one of them with the NoWait version of
+ *          the exchanger. The buffers are lent only during the exchange and they are
+ *          shared among the exchangers.
+ * 
+ * @ingroup exchange_tests
+ */
+static int exchange_test07(MPI_Comm comm) {
+
+	const int I_SRC = 0;
+	const int I_DST = 1;
+	const int NCOLS = 16;
+	const int NROWS = 16;
+
+	int world_rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+	int world_size;
+	MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+	int world_role;
+	int npoints_local = NCOLS * NROWS / (world_size / 2);
+	int *idxlist = (int *)malloc(npoints_local * sizeof(int));
+	t_idxlist *p_idxlist;
+	t_idxlist *p_idxlist_empty;
+	t_map *p_map;
+	int error = 0;
+
+	if (world_size != 4) error = 1;
+
+	// index list with global indices
+	if (world_rank < 2) {
+		world_role = I_SRC;
+		int ncols_local = NCOLS / (world_size / 2);
+		for (int i=0; i < NROWS; i++)
+			for (int j=0; j < ncols_local; j++)
+				idxlist[j+i*ncols_local] = j + i * NCOLS + world_rank * (NCOLS - ncols_local);
+	} else {
+		world_role = I_DST;
+		int nrows_local = NROWS / (world_size / 2);
+		for (int i=0; i < nrows_local; i++)
+			for (int j=0; j < NCOLS; j++)
+				idxlist[j+i*NCOLS] = j + i * NCOLS + (world_rank - (world_size / 2)) * (NROWS - nrows_local) * NCOLS;
+	}
+
+	p_idxlist = new_idxlist(idxlist, npoints_local);
+	p_idxlist_empty = new_idxlist_empty();
+
+	if (world_role == I_SRC) {
+		p_map = new_map(p_idxlist, p_idxlist_empty, -1, MPI_COMM_WORLD);
+	} else {
+		p_map = new_map(p_idxlist_empty, p_idxlist, -1, MPI_COMM_WORLD);
+	}
+
+	buffer_pool_clear();
+	size_t allocated_size = buffer_pool_allocated_size();
+
+	int exchanger_type = get_config_exchanger();
+	set_config_buffer_pool(buffer_pool_on);
+	set_config_exchanger(IsendIrecv1);
+	t_exchanger *exchanger_double1 = new_exchanger(p_map, MPI_DOUBLE, CPU);
+	t_exchanger *exchanger_double2 = new_exchanger(p_map, MPI_DOUBLE, CPU);
+	set_config_exchanger(IsendIrecv1NoWait);
+	t_exchanger *exchanger_int = new_exchanger(p_map, MPI_INT, CPU);
+	set_config_exchanger(exchanger_type);
+	set_config_buffer_pool(buffer_pool_off);
+
+	double *data_double1 = (double *)malloc(npoints_local * sizeof(double));
+	double *data_double2 = (double *)malloc(npoints_local * sizeof(double));
+	int *data_int = (int *)malloc(npoints_local * sizeof(int));
+
+	for (int step = 0; step < 3; step++) {
+
+		for (int i = 0; i < npoints_local; i++) {
+			int idx = idxlist[i];
+			data_double1[i] = world_role == I_DST ? 0.0 : (double)idx + step;
+			data_double2[i] = world_role == I_DST ? 0.0 : -(double)idx - step;
+			data_int[i] = world_role == I_DST ? 0 : idx * 10 + step;
+		}
+
+		exchanger_go(exchanger_double1, data_double1, data_double1);
+		exchanger_go(exchanger_double2, data_double2, data_double2);
+		exchanger_go(exchanger_int, data_int, data_int);
+
+		/* the buffers are returned to the pool after the exchange */
+		if (exchanger_double1->exch_send->buffer != NULL ||
+		    exchanger_double1->exch_recv->buffer != NULL)
+			error = 1;
+
+		if (world_role == I_DST)
+			for (int i = 0; i < npoints_local; i++) {
+				int idx = idxlist[i];
+				if (data_double1[i] != (double)idx + step)
+					error = 1;
+				if (data_double2[i] != -(double)idx - step)
+					error = 1;
+				if (data_int[i] != idx * 10 + step)
+					error = 1;
+			}
+	}
+
+	/* the double exchangers share the same buffer */
+	size_t double_size = exchanger_double1->exch_send->buffer_size > 0 ?
+	                     exchanger_double1->exch_send->buffer_size * sizeof(double) :
+	                     exchanger_double1->exch_recv->buffer_size * sizeof(double);
+	if (buffer_pool_allocated_size() - allocated_size >= 2 * double_size)
+		error = 1;
+
+	delete_exchanger(exchanger_double1);
+	delete_exchanger(exchanger_double2);
+	delete_exchanger(exchanger_int);
+
+	free(data_double1);
+	free(data_double2);
+	free(data_int);
+	free(idxlist);
+	delete_idxlist(p_idxlist);
+	delete_idxlist(p_idxlist_empty);
+	delete_map(p_map);
+
+	// synch error among processes
+	MPI_Allreduce(&error, &error, 1, MPI_INT, MPI_SUM, comm);
+
+	return error;
+}
+
+/**
+ * @brief test08 for exchange module
+ * 
+ * @details The test uses a total of 4 MPI processes with the same domain decomposition
+ *          of test05. Two non blocking exchanges (a double field and an integer field with
+ *          a transposition of the destination memory layout) are in progress at the same
+ *          time. The first one is completed by polling with exchanger_test and the second
+ *          one with exchanger_wait.
+ * 
+ * @ingroup exchange_tests
+ */
+static int exchange_test08(MPI_Comm comm) {
+
+	const int I_SRC = 0;
+	const int I_DST = 1;
+	const int NCOLS = 16;
+	const int NROWS = 16;
+
+	int world_rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+	int world_size;
+	MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+	int world_role;
+	int npoints_local = NCOLS * NROWS / (world_size / 2);
+	int *idxlist = (int *)malloc(npoints_local * sizeof(int));
+	t_idxlist *p_idxlist;
+	t_idxlist *p_idxlist_empty;
+	t_map *p_map;
+	int error = 0;
+
+	if (world_size != 4) error = 1;
+
+	// index list with global indices
+	if (world_rank < 2) {
+		world_role = I_SRC;
+		int ncols_local = NCOLS / (world_size / 2);
+		for (int i=0; i < NROWS; i++)
+			for (int j=0; j < ncols_local; j++)
+				idxlist[j+i*ncols_local] = j + i * NCOLS + world_rank * (NCOLS - ncols_local);
+	} else {
+		world_role = I_DST;
+		int nrows_local = NROWS / (world_size / 2);
+		for (int i=0; i < nrows_local; i++)
+			for (int j=0; j < NCOLS; j++)
+				idxlist[j+i*NCOLS] = j + i * NCOLS + (world_rank - (world_size / 2)) * (NROWS - nrows_local) * NCOLS;
+	}
+
+	p_idxlist = new_idxlist(idxlist, npoints_local);
+	p_idxlist_empty = new_idxlist_empty();
+
+	if (world_role == I_SRC) {
+		p_map = new_map(p_idxlist, p_idxlist_empty, -1, MPI_COMM_WORLD);
+	} else {
+		p_map = new_map(p_idxlist_empty, p_idxlist, -1, MPI_COMM_WORLD);
+	}
+
+	t_exchanger *exchanger_double = new_exchanger(p_map, MPI_DOUBLE, CPU);
+	t_exchanger *exchanger_int = new_exchanger(p_map, MPI_INT, CPU);
+
+	double *data_double = (double *)malloc(npoints_local * sizeof(double));
+	int *data_int = (int *)malloc(npoints_local * sizeof(int));
+
+	/* reversed memory layout of the integer field on the destination processes */
+	int *transform = (int *)malloc(npoints_local * sizeof(int));
+	for (int i = 0; i < npoints_local; i++)
+		transform[i] = npoints_local - 1 - i;
+
+	for (int step = 0; step < 3; step++) {
+
+		for (int i = 0; i < npoints_local; i++) {
+			int idx = idxlist[i];
+			data_double[i] = world_role == I_DST ? 0.0 : (double)idx + 0.5 * step;
+			data_int[i] = world_role == I_DST ? 0 : idx + step;
+		}
+
+		exchanger_start(exchanger_double, data_double, data_double);
+		exchanger_start_with_transform(exchanger_int, data_int, data_int, NULL,
+		                               world_role == I_DST ? transform : NULL);
+
+		while (!exchanger_test(exchanger_double));
+		exchanger_wait(exchanger_int);
+
+		/* no exchange in progress */
+		if (!exchanger_test(exchanger_int))
+			error = 1;
+
+		if (world_role == I_DST)
+			for (int i = 0; i < npoints_local; i++) {
+				int idx = idxlist[i];
+				if (data_double[i] != (double)idx + 0.5 * step)
+					error = 1;
+				if (data_int[transform[i]] != idx + step)
+					error = 1;
+			}
+	}
+
+	delete_exchanger(exchanger_double);
+	delete_exchanger(exchanger_int);
+
+	free(data_double);
+	free(data_int);
+	free(transform);
+	free(idxlist);
+	delete_idxlist(p_idxlist);
+	delete_idxlist(p_idxlist_empty);
+	delete_map(p_map);
+
+	// synch error among processes
+	MPI_Allreduce(&error, &error, 1, MPI_INT, MPI_SUM, comm);
+
+	return error;
+}
+
+/**
+ * @brief test09 for exchange module
+ * 
+ * @details The test uses a total of 4 MPI processes with the same domain decomposition
+ *          of test04. The tracing is enabled during an exchange and the trace is written
+ *          on demand. The trace file has to be a Chrome trace with the pack, post, wait
+ *          and unpack phases of the exchange of all the processes.
+ * 
+ * @ingroup exchange_tests
+ */
+static int exchange_test09(MPI_Comm comm) {
+
+	const int NCOLS = 4;
+	const int NROWS = 4;
+	const char *path = "exchange_test09_trace.json";
+
+	int world_rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+	int world_size;
+	MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+	int npoints_local = NCOLS * NROWS / world_size;
+	int src_idxlist[npoints_local];
+	int dst_idxlist[npoints_local];
+	int error = 0;
+
+	if (world_size != 4) error = 1;
+
+	for (int i = 0; i < npoints_local; i++) {
+		src_idxlist[i] = i + world_rank * NCOLS;
+		dst_idxlist[i] = world_rank + i * NCOLS;
+	}
+
+	t_idxlist *p_src_idxlist = new_idxlist(src_idxlist, npoints_local);
+	t_idxlist *p_dst_idxlist = new_idxlist(dst_idxlist, npoints_local);
+	t_map *p_map = new_map(p_src_idxlist, p_dst_idxlist, -1, MPI_COMM_WORLD);
+
+	set_config_exchanger(IsendIrecv1);
+	set_config_trace(trace_on);
+	if (get_config_trace() != trace_on)
+		error = 1;
+
+	t_exchanger *exchanger = new_exchanger(p_map, MPI_INT, CPU);
+	int src_data[npoints_local];
+	int dst_data[npoints_local];
+	for (int i = 0; i < npoints_local; i++)
+		src_data[i] = src_idxlist[i];
+	exchanger_go(exchanger, src_data, dst_data);
+	delete_exchanger(exchanger);
+
+	set_config_trace(trace_off);
+
+	for (int i = 0; i < npoints_local; i++)
+		if (dst_data[i] != dst_idxlist[i])
+			error = 1;
+
+	distdir_dump_trace(path);
+
+	if (world_rank == 0) {
+		FILE *file = fopen(path, "r");
+		if (file == NULL) {
+			error = 1;
+		} else {
+			fseek(file, 0, SEEK_END);
+			long length = ftell(file);
+			fseek(file, 0, SEEK_SET);
+			char *trace = (char *)malloc(length + 1);
+			trace[fread(trace, 1, length, file)] = '\0';
+			fclose(file);
+
+			const char *header = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+			if (strncmp(trace, header, strlen(header)) != 0)
+				error = 1;
+			if (strcmp(trace + length - 4, "\n]}\n") != 0)
+				error = 1;
+			const char *names[5] = {"\"pack\"", "\"post_send\"", "\"post_recv\"",
+			                        "\"wait\"", "\"unpack\""};
+			for (int i = 0; i < 5; i++)
+				if (strstr(trace, names[i]) == NULL)
+					error = 1;
+			for (int rank = 0; rank < world_size; rank++) {
+				char pid[32];
+				snprintf(pid, sizeof(pid), "\"pid\":%d,", rank);
+				if (strstr(trace, pid) == NULL)
+					error = 1;
+			}
+			free(trace);
+			remove(path);
+		}
+	}
+
+	delete_idxlist(p_src_idxlist);
+	delete_idxlist(p_dst_idxlist);
+	delete_map(p_map);
+
+	// synch error among processes
+	MPI_Allreduce(&error, &error, 1, MPI_INT, MPI_SUM, comm);
+
+	return error;
+}
+
+/**
+ * @brief test10 for exchange module
+ * 
+ * @details The test uses a total of 4 MPI processes with the same domain decomposition
+ *          of test04, so that each process sends one integer to each process. The
+ *          communication volume of the exchanger and of the process is checked after
+ *          three exchanges and the communication matrix contains all the pairs of processes.
+ * 
+ * @ingroup exchange_tests
+ */
+static int exchange_test10(MPI_Comm comm) {
+
+	const int NCOLS = 4;
+	const int NROWS = 4;
+	const int NEXCHANGES = 3;
+	const char *path = "exchange_test10_matrix.csv";
+
+	int world_rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+	int world_size;
+	MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+	int npoints_local = NCOLS * NROWS / world_size;
+	int src_idxlist[npoints_local];
+	int dst_idxlist[npoints_local];
+	int error = 0;
+
+	if (world_size != 4) error = 1;
+
+	for (int i = 0; i < npoints_local; i++) {
+		src_idxlist[i] = i + world_rank * NCOLS;
+		dst_idxlist[i] = world_rank + i * NCOLS;
+	}
+
+	t_idxlist *p_src_idxlist = new_idxlist(src_idxlist, npoints_local);
+	t_idxlist *p_dst_idxlist = new_idxlist(dst_idxlist, npoints_local);
+	t_map *p_map = new_map(p_src_idxlist, p_dst_idxlist, -1, MPI_COMM_WORLD);
+
+	set_config_exchanger(IsendIrecv1);
+	distdir_reset_comm_stats();
+
+	t_exchanger *exchanger = new_exchanger(p_map, MPI_INT, CPU);
+	int src_data[npoints_local];
+	int dst_data[npoints_local];
+	for (int i = 0; i < npoints_local; i++)
+		src_data[i] = src_idxlist[i];
+	for (int n = 0; n < NEXCHANGES; n++)
+		exchanger_go(exchanger, src_data, dst_data);
+
+	for (int i = 0; i < npoints_local; i++)
+		if (dst_data[i] != dst_idxlist[i])
+			error = 1;
+
+	t_comm_stats stats;
+	exchanger_get_comm_stats(exchanger, &stats);
+	delete_exchanger(exchanger);
+
+	long long bytes = NEXCHANGES * (world_size - 1) * sizeof(int);
+	if (stats.exchanges != NEXCHANGES) error = 1;
+	if (stats.messages_sent != NEXCHANGES * (world_size - 1)) error = 1;
+	if (stats.messages_received != NEXCHANGES * (world_size - 1)) error = 1;
+	if (stats.bytes_sent != bytes || stats.bytes_received != bytes) error = 1;
+	if (stats.bytes_self != NEXCHANGES * sizeof(int)) error = 1;
+	if (stats.peers_send != world_size - 1 || stats.peers_recv != world_size - 1) error = 1;
+	if (stats.max_message != sizeof(int)) error = 1;
+
+	/* the counters of the deleted exchanger are kept by the process */
+	t_comm_stats total;
+	distdir_get_comm_stats(&total);
+	if (memcmp(&stats, &total, sizeof(t_comm_stats)) != 0) error = 1;
+
+	distdir_dump_comm_matrix(path);
+
+	if (world_rank == 0) {
+		FILE *file = fopen(path, "r");
+		if (file == NULL) {
+			error = 1;
+		} else {
+			char line[64];
+			if (fgets(line, sizeof(line), file) == NULL ||
+			    strcmp(line, "src,dst,bytes,messages\n") != 0)
+				error = 1;
+			int nlines = 0;
+			int src, dst;
+			long long matrix_bytes, matrix_messages;
+			while (fscanf(file, "%d,%d,%lld,%lld", &src, &dst, &matrix_bytes, &matrix_messages) == 4) {
+				if (src != nlines / world_size || dst != nlines % world_size) error = 1;
+				if (matrix_bytes != NEXCHANGES * sizeof(int)) error = 1;
+				if (matrix_messages != NEXCHANGES) error = 1;
+				nlines++;
+			}
+			if (nlines != world_size * world_size) error = 1;
+			fclose(file);
+			remove(path);
+		}
+	}
+
+	delete_idxlist(p_src_idxlist);
+	delete_idxlist(p_dst_idxlist);
+	delete_map(p_map);
+
+	// synch error among processes
+	MPI_Allreduce(&error, &error, 1, MPI_INT, MPI_SUM, comm);
+
+	return error;
+}
+
+/* state of the hooks of test11 */
+struct t_test11_hooks {
+	int begin[region_timer + 1];
+	int end[region_timer + 1];
+	int stack[64];
+	int depth;
+	int error;
+};
+
+static void exchange_test11_begin(int region, const char *name, int peer, size_t bytes,
+                                  void *user_ctx) {
+
+	struct t_test11_hooks *hooks = (struct t_test11_hooks *)user_ctx;
+
+	if (name == NULL || hooks->depth == 64) {
+		hooks->error = 1;
+		return;
+	}
+	if (region == region_post_send && (peer < 0 || bytes != sizeof(int)))
+		hooks->error = 1;
+	hooks->stack[hooks->depth++] = region;
+	hooks->begin[region < region_timer ? region : region_timer]++;
+}
+
+static void exchange_test11_end(int region, const char *name, int peer, size_t bytes,
+                                void *user_ctx) {
+
+	struct t_test11_hooks *hooks = (struct t_test11_hooks *)user_ctx;
+
+	// the regions are nested
+	if (name == NULL || hooks->depth == 0 || hooks->stack[--hooks->depth] != region) {
+		hooks->error = 1;
+		return;
+	}
+	hooks->end[region < region_timer ? region : region_timer]++;
+}
+
+/**
+ * @brief test11 for exchange module
+ * 
+ * @details The test uses a total of 4 MPI processes with the same domain decomposition
+ *          of test04. Hooks are registered during an exchange: the begin and end hooks
+ *          of each region have to be called in pairs and nested, the send messages have a
+ *          peer and their size. After the removal of the hooks they are not called anymore.
+ * 
+ * @ingroup exchange_tests
+ */
+static int exchange_test11(MPI_Comm comm) {
+
+	const int NCOLS = 4;
+	const int NROWS = 4;
+
+	int world_rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+	int world_size;
+	MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+	int npoints_local = NCOLS * NROWS / world_size;
+	int src_idxlist[npoints_local];
+	int dst_idxlist[npoints_local];
+	int error = 0;
+
+	if (world_size != 4) error = 1;
+
+	for (int i = 0; i < npoints_local; i++) {
+		src_idxlist[i] = i + world_rank * NCOLS;
+		dst_idxlist[i] = world_rank + i * NCOLS;
+	}
+
+	t_idxlist *p_src_idxlist = new_idxlist(src_idxlist, npoints_local);
+	t_idxlist *p_dst_idxlist = new_idxlist(dst_idxlist, npoints_local);
+	t_map *p_map = new_map(p_src_idxlist, p_dst_idxlist, -1, MPI_COMM_WORLD);
+
+	set_config_exchanger(IsendIrecv1);
+	t_exchanger *exchanger = new_exchanger(p_map, MPI_INT, CPU);
+	int src_data[npoints_local];
+	int dst_data[npoints_local];
+	for (int i = 0; i < npoints_local; i++)
+		src_data[i] = src_idxlist[i];
+
+	struct t_test11_hooks hooks;
+	memset(&hooks, 0, sizeof(hooks));
+	distdir_set_hooks(exchange_test11_begin, exchange_test11_end, &hooks);
+	exchanger_go(exchanger, src_data, dst_data);
+	distdir_set_hooks(NULL, NULL, NULL);
+
+	for (int i = 0; i < npoints_local; i++)
+		if (dst_data[i] != dst_idxlist[i])
+			error = 1;
+
+	if (hooks.error || hooks.depth != 0) error = 1;
+	for (int region = 0; region <= region_timer; region++)
+		if (hooks.begin[region] != hooks.end[region])
+			error = 1;
+	if (hooks.begin[region_pack] == 0 || hooks.begin[region_unpack] == 0) error = 1;
+	if (hooks.begin[region_post_send] < world_size - 1) error = 1;
+	if (hooks.begin[region_post_recv] < world_size - 1) error = 1;
+#ifndef DISTDIR_NO_TIMERS
+	// the timed functions of the library have fixed regions
+	if (hooks.begin[region_exchanger_go] != 1) error = 1;
+#endif
+
+	// the hooks are removed
+	int ncalls = hooks.begin[region_pack];
+	exchanger_go(exchanger, src_data, dst_data);
+	if (hooks.begin[region_pack] != ncalls) error = 1;
+
+	delete_exchanger(exchanger);
+	delete_idxlist(p_src_idxlist);
+	delete_idxlist(p_dst_idxlist);
+	delete_map(p_map);
+
+	// synch error among processes
+	MPI_Allreduce(&error, &error, 1, MPI_INT, MPI_SUM, comm);
+
+	return error;
+}
+
+/**
+ * @brief test12 for exchange module
+ * 
+ * @details The test uses a total of 4 MPI processes over a 4x4 global 2D domain.
+ *          The domain is transposed among all the processes (each process sends
+ *          and receives) with the Auto exchanger: the 4 exchanger types without
+ *          NoWait are timed and the selection is stored in a file, so that a second
+ *          exchanger with the same pattern uses it without timing. Then processes
+ *          0,1 send the whole domain to processes 2,3 and all the 8 exchanger
+ *          types are candidates.
+ * 
+ * @ingroup exchange_tests
+ */
+static int exchange_test12(MPI_Comm comm) {
+
+	const int NCOLS = 4;
+	const int NROWS = 4;
+	const int TRIALS = 2;
+	const char *AUTO_FILE = "exchange_test12_auto.txt";
+
+	int world_rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+	int world_size;
+	MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+	int npoints_local = NCOLS * NROWS / world_size;
+	int src_idxlist[npoints_local];
+	int dst_idxlist[npoints_local];
+	int error = 0;
+
+	if (world_size != 4) error = 1;
+
+	if (world_rank == 0) remove(AUTO_FILE);
+	MPI_Barrier(comm);
+
+	int exchanger_type = get_config_exchanger();
+	set_config_exchanger(Auto);
+	set_config_exchanger_auto_trials(TRIALS);
+	set_config_exchanger_auto_file(AUTO_FILE);
+
+	for (int i = 0; i < npoints_local; i++) {
+		src_idxlist[i] = i + world_rank * NCOLS;
+		dst_idxlist[i] = world_rank + i * NCOLS;
+	}
+
+	t_idxlist *p_src_idxlist = new_idxlist(src_idxlist, npoints_local);
+	t_idxlist *p_dst_idxlist = new_idxlist(dst_idxlist, npoints_local);
+	t_map *p_map = new_map(p_src_idxlist, p_dst_idxlist, -1, MPI_COMM_WORLD);
+
+	t_exchanger *exchanger = new_exchanger(p_map, MPI_INT, CPU);
+	if (exchanger->autotune == NULL || exchanger->autotune->ncandidates != 4 ||
+	    exchanger->autotune->mode != -1)
+		error = 1;
+
+	// the data are exchanged correctly while the exchanger types change
+	int nsteps = 4 * (TRIALS + 1) + 2;
+	for (int step = 0; step < nsteps; step++) {
+		int src_data[npoints_local];
+		int dst_data[npoints_local];
+		for (int i = 0; i < npoints_local; i++) {
+			src_data[i] = src_idxlist[i] + step;
+			dst_data[i] = -1;
+		}
+		exchanger_go(exchanger, src_data, dst_data);
+		for (int i = 0; i < npoints_local; i++)
+			if (dst_data[i] != dst_idxlist[i] + step)
+				error = 1;
+	}
+
+	int mode = exchanger->autotune->mode;
+	if (mode < IsendIrecv1 || mode > IsendRecv2) error = 1;
+
+	// the same pattern uses the stored selection, another datatype is timed again
+	t_exchanger *exchanger_stored = new_exchanger(p_map, MPI_INT, CPU);
+	if (exchanger_stored->autotune->mode != mode) error = 1;
+	t_exchanger *exchanger_double = new_exchanger(p_map, MPI_DOUBLE, CPU);
+	if (exchanger_double->autotune->mode != -1) error = 1;
+
+	delete_exchanger(exchanger_double);
+	delete_exchanger(exchanger_stored);
+	delete_exchanger(exchanger);
+	delete_map(p_map);
+	delete_idxlist(p_src_idxlist);
+	delete_idxlist(p_dst_idxlist);
+
+	// one direction exchange
+	set_config_exchanger_auto_file(NULL);
+
+	int npoints_oneway = NCOLS * NROWS / (world_size / 2);
+	int idxlist[npoints_oneway];
+	for (int i = 0; i < npoints_oneway; i++)
+		idxlist[i] = i + (world_rank % 2) * npoints_oneway;
+
+	t_idxlist *p_idxlist = new_idxlist(idxlist, npoints_oneway);
+	t_idxlist *p_idxlist_empty = new_idxlist_empty();
+	if (world_rank < 2)
+		p_map = new_map(p_idxlist, p_idxlist_empty, -1, MPI_COMM_WORLD);
+	else
+		p_map = new_map(p_idxlist_empty, p_idxlist, -1, MPI_COMM_WORLD);
+
+	exchanger = new_exchanger(p_map, MPI_INT, CPU);
+	if (exchanger->autotune->ncandidates != 8) error = 1;
+
+	nsteps = 8 * (TRIALS + 1) + 2;
+	for (int step = 0; step < nsteps; step++) {
+		int data[npoints_oneway];
+		for (int i = 0; i < npoints_oneway; i++)
+			data[i] = world_rank < 2 ? idxlist[i] * 10 + step : -1;
+		exchanger_go(exchanger, data, data);
+		if (world_rank >= 2)
+			for (int i = 0; i < npoints_oneway; i++)
+				if (data[i] != idxlist[i] * 10 + step)
+					error = 1;
+	}
+
+	if (exchanger->autotune->mode < IsendIrecv1 || exchanger->autotune->mode > IsendRecv2NoWait)
+		error = 1;
+
+	delete_exchanger(exchanger);
+	delete_map(p_map);
+	delete_idxlist(p_idxlist);
+	delete_idxlist(p_idxlist_empty);
+
+	set_config_exchanger(exchanger_type);
+	set_config_exchanger_auto_trials(EXCHANGER_AUTO_TRIALS);
+
+	// the selection of the transposition is stored once
+	MPI_Barrier(comm);
+	if (world_rank == 0) {
+		FILE *file = fopen(AUTO_FILE, "r");
+		int nlines = 0;
+		unsigned long long key;
+		int value;
+		if (file == NULL) {
+			error = 1;
+		} else {
+			while (fscanf(file, "%llx %d", &key, &value) == 2) {
+				if (value != mode) error = 1;
+				nlines++;
+			}
+			fclose(file);
+		}
+		if (nlines != 1) error = 1;
+		remove(AUTO_FILE);
+	}
+
+	// synch error among processes
+	MPI_Allreduce(&error, &error, 1, MPI_INT, MPI_SUM, comm);
+
+	return error;
+}
+
+/**
+ * @brief test13 for exchange module
+ * 
+ * @details Same domain decomposition of test01 (two messages of 4 ints per process).
+ * 
+ *          The prediction of the cost model is tested with given parameters: the
+ *          receivers are the slowest processes, with the latencies of the posted
+ *          receives overlapping and the ones of the blocking receives adding up.
+ *          Then the parameters measured by distdir_calibrate are tested.
+ * 
+ * @ingroup exchange_tests
+ */
+static int exchange_test13(MPI_Comm comm) {
+
+	const int NCOLS = 4;
+	const int NROWS = 4;
+	const double TOLERANCE = 1.0e-12;
+
+	int world_rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+	int world_size;
+	MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+	int npoints_local = NCOLS * NROWS / (world_size / 2);
+	int idxlist[npoints_local];
+	int error = 0;
+
+	if (world_size != 4) return 1;
+
+	// index list with global indices
+	if (world_rank < 2) {
+		int ncols_local = NCOLS / (world_size / 2);
+		for (int i=0; i < NROWS; i++)
+			for (int j=0; j < ncols_local; j++)
+				idxlist[j+i*ncols_local] = j + i * NCOLS + world_rank * (NCOLS - ncols_local);
+	} else {
+		int nrows_local = NROWS / (world_size / 2);
+		for (int i=0; i < nrows_local; i++)
+			for (int j=0; j < NCOLS; j++)
+				idxlist[j+i*NCOLS] = j + i * NCOLS + (world_rank - (world_size / 2)) * (NROWS - nrows_local) * NCOLS;
+	}
+
+	t_idxlist *p_idxlist = new_idxlist(idxlist, npoints_local);
+	t_idxlist *p_idxlist_empty = new_idxlist_empty();
+	t_map *p_map;
+
+	if (world_rank < 2)
+		p_map = new_map(p_idxlist, p_idxlist_empty, -1, MPI_COMM_WORLD);
+	else
+		p_map = new_map(p_idxlist_empty, p_idxlist, -1, MPI_COMM_WORLD);
+
+	t_cost_params params_default;
+	distdir_get_cost_params(&params_default);
+
+	// a message of 16 bytes takes 1 us + 16 ns and it is packed in 16 ns
+	t_cost_params params = {1.0e-6, 1.0e9, 1.0e-6, 1.0e9, 1.0e9, 0};
+	distdir_set_cost_params(&params);
+
+	// receivers: latency, two transfers and two unpacks
+	if (fabs(map_predict_cost(p_map, MPI_INT, IsendIrecv1) - 1.064e-6) > TOLERANCE) error = 1;
+	if (fabs(map_predict_cost(p_map, MPI_INT, IsendIrecv2NoWait) - 1.064e-6) > TOLERANCE) error = 1;
+	// receivers: two latencies, two transfers and two unpacks
+	if (fabs(map_predict_cost(p_map, MPI_INT, IsendRecv1) - 2.064e-6) > TOLERANCE) error = 1;
+	if (fabs(map_predict_cost(p_map, MPI_INT, IsendRecv2) - 2.064e-6) > TOLERANCE) error = 1;
+	if (fabs(map_predict_cost(p_map, MPI_INT, Auto) - 1.064e-6) > TOLERANCE) error = 1;
+	// the size of the datatype scales the transfers and the unpacks
+	if (fabs(map_predict_cost(p_map, MPI_DOUBLE, IsendIrecv1) - 1.128e-6) > TOLERANCE) error = 1;
+	if (map_predict_exchanger(p_map, MPI_INT) != IsendIrecv1) error = 1;
+
+	distdir_calibrate(MPI_COMM_WORLD);
+	distdir_get_cost_params(&params);
+	if (!params.calibrated) error = 1;
+	if (params.latency_intra <= 0.0 || params.bandwidth_intra <= 0.0) error = 1;
+	if (params.latency_inter <= 0.0 || params.bandwidth_inter <= 0.0) error = 1;
+	if (params.pack_bandwidth <= 0.0) error = 1;
+	if (map_predict_cost(p_map, MPI_INT, IsendIrecv1) <= 0.0) error = 1;
+
+	// the parameters are the same on all the processes
+	double latency_max;
+	MPI_Allreduce(&params.latency_intra, &latency_max, 1, MPI_DOUBLE, MPI_MAX, comm);
+	if (latency_max != params.latency_intra) error = 1;
+
+	distdir_set_cost_params(&params_default);
+
+	delete_idxlist(p_idxlist);
+	delete_idxlist(p_idxlist_empty);
+	delete_map(p_map);
+
+	// synch error among processes
+	MPI_Allreduce(&error, &error, 1, MPI_INT, MPI_SUM, comm);
+
+	return error;
+}
+
+/**
+ * @brief test14 for exchange module
+ * 
+ * @details Same domain decomposition of test01 (two messages of 4 ints per process).
+ * 
+ *          The memory report is tested: the index lists account their structures
+ *          and indices, the map and the exchanger hold memory until they are deleted,
+ *          the workspace of new_map is released at the end of the call and the
+ *          global values are the maximum among the processes.
+ * 
+ * @ingroup exchange_tests
+ */
+static int exchange_test14(MPI_Comm comm) {
+
+	const int NCOLS = 4;
+	const int NROWS = 4;
+
+	int world_rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+	int world_size;
+	MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+	int npoints_local = NCOLS * NROWS / (world_size / 2);
+	int idxlist[npoints_local];
+	int error = 0;
+
+	if (world_size != 4) return 1;
+
+	// index list with global indices
+	if (world_rank < 2) {
+		int ncols_local = NCOLS / (world_size / 2);
+		for (int i=0; i < NROWS; i++)
+			for (int j=0; j < ncols_local; j++)
+				idxlist[j+i*ncols_local] = j + i * NCOLS + world_rank * (NCOLS - ncols_local);
+	} else {
+		int nrows_local = NROWS / (world_size / 2);
+		for (int i=0; i < nrows_local; i++)
+			for (int j=0; j < NCOLS; j++)
+				idxlist[j+i*NCOLS] = j + i * NCOLS + (world_rank - (world_size / 2)) * (NROWS - nrows_local) * NCOLS;
+	}
+
+	t_memory_report start, report;
+	memory_get_report(&start);
+
+	t_idxlist *p_idxlist = new_idxlist(idxlist, npoints_local);
+	t_idxlist *p_idxlist_empty = new_idxlist_empty();
+
+	memory_get_report(&report);
+	if (report.category[memory_idxlist].current - start.category[memory_idxlist].current !=
+	    2 * sizeof(t_idxlist) + npoints_local * sizeof(int)) error = 1;
+
+	t_map *p_map;
+	if (world_rank < 2)
+		p_map = new_map(p_idxlist, p_idxlist_empty, -1, MPI_COMM_WORLD);
+	else
+		p_map = new_map(p_idxlist_empty, p_idxlist, -1, MPI_COMM_WORLD);
+
+	t_exchanger *exchanger = new_exchanger(p_map, MPI_INT, CPU);
+
+	distdir_memory_report(&report);
+	if (report.category[memory_map].current <= start.category[memory_map].current) error = 1;
+	if (report.category[memory_exchange].current <= start.category[memory_exchange].current) error = 1;
+	// communication statistics of the exchanger
+	if (report.category[memory_instrumentation].current <= start.category[memory_instrumentation].current) error = 1;
+	if (report.category[memory_workspace].current != start.category[memory_workspace].current) error = 1;
+	if (report.category[memory_workspace].peak <= report.category[memory_workspace].current) error = 1;
+	if (report.total.peak < report.total.current) error = 1;
+	size_t sum = 0;
+	for (int i = 0; i < MEMORY_NCATEGORIES; i++) {
+		sum += report.category[i].current;
+		if (report.category[i].global_current < report.category[i].current) error = 1;
+		if (report.category[i].global_peak < report.category[i].peak) error = 1;
+	}
+	if (sum != report.total.current) error = 1;
+
+	// the global values are the same on all the processes
+	unsigned long long global_peak = report.total.global_peak;
+	unsigned long long global_peak_min;
+	MPI_Allreduce(&global_peak, &global_peak_min, 1, MPI_UNSIGNED_LONG_LONG, MPI_MIN, comm);
+	if (global_peak_min != global_peak) error = 1;
+
+	delete_exchanger(exchanger);
+	delete_map(p_map);
+	delete_idxlist(p_idxlist);
+	delete_idxlist(p_idxlist_empty);
+
+	// the timers and the communication statistics can grow during the test
+	memory_get_report(&report);
+	for (int i = 0; i < MEMORY_NCATEGORIES; i++)
+		if (i != memory_instrumentation && report.category[i].current != start.category[i].current)
+			error = 1;
+
+	// synch error among processes
+	MPI_Allreduce(&error, &error, 1, MPI_INT, MPI_SUM, comm);
+
+	return error;
+}
+
+/**
+ * @brief test15 for exchange module
+ * 
+ * @details The test uses a total of 4 MPI processes. The library is set to the
+ *          communicator of the first two processes and only they dump the trace:
+ *          the file contains the two processes and the other ones are not involved.
+ * 
+ * @ingroup exchange_tests
+ */
+static int exchange_test15(MPI_Comm comm) {
+
+	const char *path = "exchange_test15_trace.json";
+
+	int world_rank;
+	MPI_Comm_rank(comm, &world_rank);
+	int world_size;
+	MPI_Comm_size(comm, &world_size);
+	int error = 0;
+
+	if (world_size != 4) error = 1;
+
+	MPI_Comm sub_comm;
+	MPI_Comm_split(comm, world_rank < 2, world_rank, &sub_comm);
+
+	if (world_rank < 2) {
+
+		set_config_comm(sub_comm);
+		distdir_dump_trace(path);
+		set_config_comm(MPI_COMM_WORLD);
+
+		if (world_rank == 0) {
+			FILE *file = fopen(path, "r");
+			if (file == NULL) {
+				error = 1;
+			} else {
+				fseek(file, 0, SEEK_END);
+				long length = ftell(file);
+				fseek(file, 0, SEEK_SET);
+				char *trace = (char *)malloc(length + 1);
+				trace[fread(trace, 1, length, file)] = '\0';
+				fclose(file);
+
+				if (strcmp(trace + length - 4, "\n]}\n") != 0)
+					error = 1;
+				if (strstr(trace, "\"pid\":1,") == NULL || strstr(trace, "\"pid\":2,") != NULL)
+					error = 1;
+				free(trace);
+				remove(path);
+			}
+		}
+	}
+
+	MPI_Comm_free(&sub_comm);
+
+	// synch error among processes
+	MPI_Allreduce(&error, &error, 1, MPI_INT, MPI_SUM, comm);
+
+	return error;
+}
+
+int main() {
+
+	distdir_initialize();
+
+	int error = 0;
+
+	error += exchange_test01(MPI_COMM_WORLD);
+
+	error += exchange_test02(MPI_COMM_WORLD);
+
+	error += exchange_test03(MPI_COMM_WORLD);
+
+	error += exchange_test04(MPI_COMM_WORLD);
+
+	error += exchange_test05(MPI_COMM_WORLD);
+
+	error += exchange_test06(MPI_COMM_WORLD);
+
+	error += exchange_test07(MPI_COMM_WORLD);
+
+	error += exchange_test08(MPI_COMM_WORLD);
+
+	error += exchange_test09(MPI_COMM_WORLD);
+
+	error += exchange_test10(MPI_COMM_WORLD);
+
+	error += exchange_test11(MPI_COMM_WORLD);
+
+	error += exchange_test12(MPI_COMM_WORLD);
+
+	error += exchange_test13(MPI_COMM_WORLD);
+
+	error += exchange_test14(MPI_COMM_WORLD);
+
+	error += exchange_test15(MPI_COMM_WORLD);
+
+	distdir_finalize();
 
 	return error;
 }
\ No newline at end of file
@@ -0,0 +1,284 @@
+/*
+ * @file progress_tests.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdarg.h>
+#include <setjmp.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#include "src/distdir.h"
+
+#define NCOLS 16
+#define NROWS 16
+#define NSTEPS 4
+
+/* domain decomposition of the test05 of the exchange module */
+static t_map * progress_new_map(int world_rank, int world_size, int *idxlist, int npoints_local,
+                                t_idxlist **p_idxlist, t_idxlist **p_idxlist_empty) {
+
+	if (world_rank < 2) {
+		int ncols_local = NCOLS / (world_size / 2);
+		for (int i=0; i < NROWS; i++)
+			for (int j=0; j < ncols_local; j++)
+				idxlist[j+i*ncols_local] = j + i * NCOLS + world_rank * (NCOLS - ncols_local);
+	} else {
+		int nrows_local = NROWS / (world_size / 2);
+		for (int i=0; i < nrows_local; i++)
+			for (int j=0; j < NCOLS; j++)
+				idxlist[j+i*NCOLS] = j + i * NCOLS + (world_rank - (world_size / 2)) * (NROWS - nrows_local) * NCOLS;
+	}
+
+	*p_idxlist = new_idxlist(idxlist, npoints_local);
+	*p_idxlist_empty = new_idxlist_empty();
+
+	if (world_rank < 2)
+		return new_map(*p_idxlist, *p_idxlist_empty, -1, MPI_COMM_WORLD);
+	else
+		return new_map(*p_idxlist_empty, *p_idxlist, -1, MPI_COMM_WORLD);
+}
+
+/* non blocking exchanges of a double field and of an integer field with a
+ * transposition of the destination memory layout, the expected offloading
+ * of the messages to the progress thread is checked after the start */
+static int progress_exchanges(MPI_Comm comm, int offloaded) {
+
+	int world_rank;
+	MPI_Comm_rank(comm, &world_rank);
+	int world_size;
+	MPI_Comm_size(comm, &world_size);
+	int npoints_local = NCOLS * NROWS / (world_size / 2);
+	int *idxlist = (int *)malloc(npoints_local * sizeof(int));
+	t_idxlist *p_idxlist;
+	t_idxlist *p_idxlist_empty;
+	int error = 0;
+
+	if (world_size != 4) error = 1;
+
+	t_map *p_map = progress_new_map(world_rank, world_size, idxlist, npoints_local,
+	                                &p_idxlist, &p_idxlist_empty);
+
+	t_exchanger *exchanger_double = new_exchanger(p_map, MPI_DOUBLE, CPU);
+	t_exchanger *exchanger_int = new_exchanger(p_map, MPI_INT, CPU);
+
+	double *data_double = (double *)malloc(npoints_local * sizeof(double));
+	int *data_int = (int *)malloc(npoints_local * sizeof(int));
+
+	int *transform = (int *)malloc(npoints_local * sizeof(int));
+	for (int i = 0; i < npoints_local; i++)
+		transform[i] = npoints_local - 1 - i;
+
+	for (int step = 0; step < NSTEPS; step++) {
+
+		for (int i = 0; i < npoints_local; i++) {
+			int idx = idxlist[i];
+			data_double[i] = world_rank >= 2 ? 0.0 : (double)idx + 0.5 * step;
+			data_int[i] = world_rank >= 2 ? 0 : idx + step;
+		}
+
+		exchanger_start(exchanger_double, data_double, data_double);
+		exchanger_start_with_transform(exchanger_int, data_int, data_int, NULL,
+		                               world_rank >= 2 ? transform : NULL);
+
+		if (exchanger_double->request->offloaded != offloaded ||
+		    exchanger_int->request->offloaded != offloaded)
+			error = 1;
+
+		while (!exchanger_test(exchanger_double));
+		exchanger_wait(exchanger_int);
+
+		if (world_rank >= 2)
+			for (int i = 0; i < npoints_local; i++) {
+				int idx = idxlist[i];
+				if (data_double[i] != (double)idx + 0.5 * step)
+					error = 1;
+				if (data_int[transform[i]] != idx + step)
+					error = 1;
+			}
+	}
+
+	/* an exchange in progress is completed by the deletion */
+	exchanger_start(exchanger_int, data_int, data_int);
+
+	delete_exchanger(exchanger_double);
+	delete_exchanger(exchanger_int);
+
+	free(data_double);
+	free(data_int);
+	free(transform);
+	free(idxlist);
+	delete_idxlist(p_idxlist);
+	delete_idxlist(p_idxlist_empty);
+	delete_map(p_map);
+
+	// synch error among processes
+	MPI_Allreduce(MPI_IN_PLACE, &error, 1, MPI_INT, MPI_SUM, comm);
+
+	return error;
+}
+
+/**
+ * @brief test01 for progress module
+ * 
+ * @details The test uses a total of 4 MPI processes over a 16x16 global 2D domain:
+ *          processes 0,1 are senders and processes 2,3 are receivers.
+ * 
+ *          The progress thread is enabled and two non blocking exchanges are in
+ *          progress at the same time. The messages are completed by the progress
+ *          thread when MPI provides MPI_THREAD_MULTIPLE, otherwise by the calling
+ *          thread. They are always unpacked by the calling thread.
+ * 
+ * @ingroup progress_tests
+ */
+static int progress_test01(MPI_Comm comm) {
+
+	int provided;
+	MPI_Query_thread(&provided);
+
+	set_config_progress_thread(progress_thread_on);
+	int error = progress_exchanges(comm, provided == MPI_THREAD_MULTIPLE);
+	if (progress_thread_available() != (provided == MPI_THREAD_MULTIPLE))
+		error = 1;
+	set_config_progress_thread(progress_thread_off);
+
+	return error;
+}
+
+/**
+ * @brief test02 for progress module
+ * 
+ * @details The test uses the same domain decomposition of test01. The exchanges
+ *          of test01 are repeated with the buffer pool and the delta exchange, which
+ *          are handled by the calling thread at the completion of the exchange.
+ * 
+ * @ingroup progress_tests
+ */
+static int progress_test02(MPI_Comm comm) {
+
+	int provided;
+	MPI_Query_thread(&provided);
+
+	set_config_progress_thread(progress_thread_on);
+	set_config_buffer_pool(buffer_pool_on);
+	set_config_delta(delta_on);
+	int error = progress_exchanges(comm, provided == MPI_THREAD_MULTIPLE);
+	set_config_delta(delta_off);
+	set_config_buffer_pool(buffer_pool_off);
+	set_config_progress_thread(progress_thread_off);
+
+	return error;
+}
+
+/**
+ * @brief test03 for progress module
+ * 
+ * @details The test uses the same domain decomposition of test01. The progress
+ *          thread is stopped and disabled, the messages are completed by the
+ *          calling thread.
+ * 
+ * @ingroup progress_tests
+ */
+static int progress_test03(MPI_Comm comm) {
+
+	progress_thread_stop();
+
+	int error = progress_exchanges(comm, 0);
+	if (progress_thread_available())
+		error = 1;
+
+	return error;
+}
+
+/* thread of the application and number of hook calls from other threads */
+static pthread_t main_thread;
+static int foreign_calls = 0;
+static int hook_calls = 0;
+
+static void progress_hook(int region, const char *name, int peer, size_t bytes, void *user_ctx) {
+
+	(void)region; (void)name; (void)peer; (void)bytes; (void)user_ctx;
+
+	if (!pthread_equal(pthread_self(), main_thread))
+		__atomic_add_fetch(&foreign_calls, 1, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&hook_calls, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief test04 for progress module
+ * 
+ * @details The test uses the same domain decomposition of test01. The exchanges
+ *          of test01 are repeated with hooks registered, the hooks must be called
+ *          only by the thread of the application.
+ * 
+ * @ingroup progress_tests
+ */
+static int progress_test04(MPI_Comm comm) {
+
+	int provided;
+	MPI_Query_thread(&provided);
+
+	main_thread = pthread_self();
+	foreign_calls = 0;
+	hook_calls = 0;
+
+	set_config_progress_thread(progress_thread_on);
+	distdir_set_hooks(progress_hook, progress_hook, NULL);
+	int error = progress_exchanges(comm, provided == MPI_THREAD_MULTIPLE);
+	distdir_set_hooks(NULL, NULL, NULL);
+	set_config_progress_thread(progress_thread_off);
+
+	if (foreign_calls != 0 || hook_calls == 0) error = 1;
+
+	return error;
+}
+
+int main() {
+
+	/* the progress thread requires MPI_THREAD_MULTIPLE */
+	int provided;
+	MPI_Init_thread(NULL, NULL, MPI_THREAD_MULTIPLE, &provided);
+
+	distdir_initialize();
+
+	int error = 0;
+
+	error += progress_test01(MPI_COMM_WORLD);
+	error += progress_test02(MPI_COMM_WORLD);
+	error += progress_test03(MPI_COMM_WORLD);
+	error += progress_test04(MPI_COMM_WORLD);
+
+	distdir_finalize();
+
+	return error;
+}
@@ -36,9 +36,13 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "src/distdir.h"
 #include "src/utils/check.h"
+#include "src/utils/timer.h"
+
+#define REPORT_FILE "setting_test01_timers.txt"
 
 /**
  * @brief test01 for setting MPI
@@ -77,6 +81,36 @@ static int setting_test01(MPI_Comm comm) {
 	if (verbose_type != verbose_true)
 		error = 1;
 
+	// test memory placement policy configuration
+	int allocator_type = get_config_allocator();
+	if (allocator_type != allocator_malloc)
+		error = 1;
+
+	set_config_allocator(allocator_first_touch | allocator_local_node);
+	allocator_type = get_config_allocator();
+	if (allocator_type != (allocator_first_touch | allocator_local_node))
+		error = 1;
+
+	// test report of the timers configuration
+	if (get_config_timers_report() != timers_report_off)
+		error = 1;
+	if (get_config_comm() != MPI_COMM_WORLD)
+		error = 1;
+
+	set_config_timers_report(timers_report_full);
+	set_config_timers_report_file(REPORT_FILE);
+	set_config_comm(comm);
+	if (get_config_timers_report() != timers_report_full)
+		error = 1;
+
+	// the processes create different timers
+	int rank, size;
+	check_mpi( MPI_Comm_rank(comm, &rank) );
+	check_mpi( MPI_Comm_size(comm, &size) );
+	new_timer("setting_test01");
+	if (rank == size - 1)
+		new_timer("setting_test01_last");
+
 	// check library finalization
 	distdir_finalize();
 	int mpi_finalized;
@@ -84,6 +118,25 @@ static int setting_test01(MPI_Comm comm) {
 	if (!mpi_finalized)
 		error = 1;
 
+	// check the report written by distdir_finalize
+	if (rank == 0) {
+		FILE *file = fopen(REPORT_FILE, "r");
+		if (file == NULL) return 1;
+		char report[4096];
+		size_t length = fread(report, 1, sizeof(report) - 1, file);
+		report[length] = '\0';
+		fclose(file);
+		remove(REPORT_FILE);
+
+		char rank_header[64];
+		snprintf(rank_header, sizeof(rank_header), "Rank %d", size - 1);
+		if (strstr(report, "Mean Time") == NULL ||
+		    strstr(report, "setting_test01 ") == NULL ||
+		    strstr(report, "setting_test01_last") == NULL ||
+		    strstr(report, rank_header) == NULL)
+			error = 1;
+	}
+
 	return error;
 }
 
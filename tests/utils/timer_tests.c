@@ -0,0 +1,264 @@
+/*
+ * @file timer_tests.c
+ *
+ * @copyright Copyright (C) 2024 Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * @author Enrico Degregori <enrico.degregori@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdarg.h>
+#include <setjmp.h>
+#include <stddef.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "src/utils/timer.h"
+#include "src/utils/trace.h"
+
+#define NUM_THREADS 4
+#define NUM_CALLS 10
+
+/**
+ * @brief Test01 of timer
+ * 
+ * @details Create timers: the same ID is returned for the same name and
+ *          different IDs for different names.
+ * 
+ * @ingroup timer_tests
+ */
+static void timer_test01(void **state __attribute__((unused))) {
+
+	int timer_a = new_timer("timer_test01_a");
+	int timer_b = new_timer("timer_test01_b");
+
+	assert_int_not_equal(timer_a, timer_b);
+	assert_int_equal(timer_a, new_timer("timer_test01_a"));
+	assert_int_equal(timer_b, new_timer("timer_test01_b"));
+
+	delete_timers();
+}
+
+/**
+ * @brief Test02 of timer
+ * 
+ * @details Nest timers: the calls of the nested and recursive timers are
+ *          counted and the time of the outer timer includes the time of
+ *          the nested one.
+ * 
+ * @ingroup timer_tests
+ */
+static void timer_test02(void **state __attribute__((unused))) {
+
+	int timer_outer = new_timer("timer_test02_outer");
+	int timer_inner = new_timer("timer_test02_inner");
+
+	timer_start(timer_outer);
+	for (int i = 0; i < NUM_CALLS; i++) {
+		timer_start(timer_inner);
+		timer_start(timer_inner);
+		timer_stop(timer_inner);
+		timer_stop(timer_inner);
+	}
+	timer_stop(timer_outer);
+
+	assert_int_equal(timer_calls(timer_outer), 1);
+	assert_int_equal(timer_calls(timer_inner), 2 * NUM_CALLS);
+	assert_true(timer_total_time(timer_outer) >= timer_total_time(timer_inner));
+	assert_true(timer_total_time(timer_inner) >= 0.0);
+
+	timers_reset();
+	assert_int_equal(timer_calls(timer_outer), 0);
+	assert_true(timer_total_time(timer_outer) == 0.0);
+
+	delete_timers();
+}
+
+/**
+ * @brief Test03 of timer
+ * 
+ * @details Disable the timers: the calls are not counted until the timers
+ *          are enabled again.
+ * 
+ * @ingroup timer_tests
+ */
+static void timer_test03(void **state __attribute__((unused))) {
+
+	int timer = new_timer("timer_test03");
+
+	timers_set_active(0);
+	timer_start(timer);
+	timer_stop(timer);
+	assert_int_equal(timer_calls(timer), 0);
+
+	timers_set_active(1);
+	timer_start(timer);
+	timer_stop(timer);
+	assert_int_equal(timer_calls(timer), 1);
+
+	delete_timers();
+}
+
+static void *timer_thread_test(void *arg) {
+
+	int timer = *(int *)arg;
+
+	for (int i = 0; i < NUM_CALLS; i++) {
+		timer_start(timer);
+		timer_stop(timer);
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Test04 of timer
+ * 
+ * @details Use the same timer from several threads: the calls of all the
+ *          threads are accumulated.
+ * 
+ * @ingroup timer_tests
+ */
+static void timer_test04(void **state __attribute__((unused))) {
+
+	int timer = new_timer("timer_test04");
+
+	pthread_t threads[NUM_THREADS];
+	for (int i = 0; i < NUM_THREADS; i++)
+		pthread_create(&threads[i], NULL, timer_thread_test, &timer);
+	for (int i = 0; i < NUM_THREADS; i++)
+		pthread_join(threads[i], NULL);
+
+	assert_int_equal(timer_calls(timer), NUM_THREADS * NUM_CALLS);
+
+	delete_timers();
+}
+
+static void timer_test05_hook(int region, const char *name __attribute__((unused)),
+                              int peer __attribute__((unused)), size_t bytes __attribute__((unused)),
+                              void *user_ctx) {
+
+	*(int *)user_ctx = region;
+}
+
+/**
+ * @brief Test05 of timer
+ * 
+ * @details Report the timers to the hooks: a timer of the library has its fixed
+ *          region ID and a user-defined timer has region_timer plus its ID.
+ *          The disabled timers are reported but not counted.
+ * 
+ * @ingroup timer_tests
+ */
+static void timer_test05(void **state __attribute__((unused))) {
+
+	int timer_user = new_timer("timer_test05_user");
+	int timer_lib = new_timer_region("timer_test05_lib", region_new_map);
+	int region = -1;
+
+	distdir_set_hooks(timer_test05_hook, NULL, &region);
+	timer_start(timer_lib);
+	timer_stop(timer_lib);
+	assert_int_equal(region, region_new_map);
+	timer_start(timer_user);
+	timer_stop(timer_user);
+	assert_int_equal(region, region_timer + timer_user);
+
+	// the disabled timers are still reported to the hooks
+	timers_set_active(0);
+	timer_start(timer_lib);
+	timer_stop(timer_lib);
+	assert_int_equal(region, region_new_map);
+	timers_set_active(1);
+	assert_int_equal(timer_calls(timer_lib), 1);
+	distdir_set_hooks(NULL, NULL, NULL);
+
+	// an existing timer keeps its region
+	assert_int_equal(timer_lib, new_timer("timer_test05_lib"));
+
+	delete_timers();
+}
+
+static pthread_barrier_t timer_test06_barrier;
+
+static void *timer_test06_thread(void *arg) {
+
+	int *timer = (int *)arg;
+
+	timer_start(timer[0]);
+	timer_stop(timer[0]);
+
+	// the timers are deleted by the main thread between the barriers
+	pthread_barrier_wait(&timer_test06_barrier);
+	pthread_barrier_wait(&timer_test06_barrier);
+
+	timer[1] = new_timer("timer_test06_after");
+	timer_start(timer[1]);
+	timer_stop(timer[1]);
+
+	return NULL;
+}
+
+/**
+ * @brief Test06 of timer
+ * 
+ * @details Delete the timers while another thread has used them: the thread
+ *          does not access its old structure and accumulates in a new one.
+ * 
+ * @ingroup timer_tests
+ */
+static void timer_test06(void **state __attribute__((unused))) {
+
+	int timer[2] = {new_timer("timer_test06_before"), -1};
+
+	pthread_barrier_init(&timer_test06_barrier, NULL, 2);
+	pthread_t thread;
+	pthread_create(&thread, NULL, timer_test06_thread, timer);
+	pthread_barrier_wait(&timer_test06_barrier);
+	delete_timers();
+	pthread_barrier_wait(&timer_test06_barrier);
+	pthread_join(thread, NULL);
+	pthread_barrier_destroy(&timer_test06_barrier);
+
+	assert_int_equal(timer_calls(timer[1]), 1);
+
+	delete_timers();
+}
+
+int main(void) {
+
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(timer_test01),
+		cmocka_unit_test(timer_test02),
+		cmocka_unit_test(timer_test03),
+		cmocka_unit_test(timer_test04),
+		cmocka_unit_test(timer_test05),
+		cmocka_unit_test(timer_test06),
+	};
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}